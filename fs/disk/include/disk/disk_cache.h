@@ -0,0 +1,116 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#ifndef __DISK_CACHE_H__
+#define __DISK_CACHE_H__
+
+#include <stddef.h>
+#include <inttypes.h>
+#include "os/mynewt.h"
+#include "disk/disk.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Caching policy.
+ */
+#define DISK_CACHE_WRITE_THROUGH    0  /* Writes go to disk immediately */
+#define DISK_CACHE_WRITE_BACK       1  /* Writes go to disk on eviction/flush */
+
+#define DISK_CACHE_BLK_F_VALID      0x01
+#define DISK_CACHE_BLK_F_DIRTY      0x02
+
+struct disk_cache_blk {
+    uint32_t dcb_addr;          /* Disk address of cached block */
+    uint32_t dcb_used;          /* Access stamp, for LRU */
+    uint8_t dcb_flags;
+};
+
+/*
+ * LRU block cache in front of a disk device. Memory for block descriptors
+ * and block data is supplied by caller.
+ */
+struct disk_cache {
+    struct disk_ops *dc_dops;   /* Backing disk */
+    struct disk_cache_blk *dc_blks;
+    uint8_t *dc_data;           /* dc_blk_cnt * dc_blk_sz bytes */
+    uint32_t dc_blk_sz;
+    uint16_t dc_blk_cnt;
+    uint8_t dc_dev;             /* Device number passed to dc_dops */
+    uint8_t dc_policy;
+    uint32_t dc_clock;
+
+    uint32_t dc_hits;
+    uint32_t dc_misses;
+
+    struct os_mutex dc_mtx;
+};
+
+/**
+ * Initialize block cache.
+ *
+ * @param dc                    Cache to initialize.
+ * @param dops                  Backing disk operations.
+ * @param dev                   Device number to pass to dops.
+ * @param blks                  Array of blk_cnt block descriptors.
+ * @param data                  Block data, blk_cnt * blk_sz bytes.
+ * @param blk_cnt               Number of blocks in cache.
+ * @param blk_sz                Size of a block; a power of two, typically
+ *                                  the sector size of the disk.
+ * @param policy                DISK_CACHE_WRITE_THROUGH or
+ *                                  DISK_CACHE_WRITE_BACK.
+ *
+ * @return                      0 on success; DISK_E[...] on failure.
+ */
+int disk_cache_init(struct disk_cache *dc, struct disk_ops *dops, uint8_t dev,
+                    struct disk_cache_blk *blks, uint8_t *data,
+                    uint16_t blk_cnt, uint32_t blk_sz, uint8_t policy);
+
+/**
+ * Read through the cache. Arguments and return code follow the read
+ * callback of struct disk_ops.
+ */
+int disk_cache_read(struct disk_cache *dc, uint32_t addr, void *buf,
+                    uint32_t len);
+
+/**
+ * Write through the cache. With write-back policy data only reaches the
+ * disk when the block is evicted, or the cache is flushed.
+ */
+int disk_cache_write(struct disk_cache *dc, uint32_t addr, const void *buf,
+                     uint32_t len);
+
+/**
+ * Write all dirty blocks to disk.
+ */
+int disk_cache_flush(struct disk_cache *dc);
+
+/**
+ * Flush, and drop all cached blocks.
+ */
+int disk_cache_invalidate(struct disk_cache *dc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DISK_CACHE_H__ */
@@ -0,0 +1,293 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "disk/disk.h"
+#include "disk/disk_cache.h"
+
+static uint8_t *
+disk_cache_blk_data(struct disk_cache *dc, struct disk_cache_blk *blk)
+{
+    return dc->dc_data + (blk - dc->dc_blks) * dc->dc_blk_sz;
+}
+
+static int
+disk_cache_blk_writeout(struct disk_cache *dc, struct disk_cache_blk *blk)
+{
+    int rc;
+
+    if (!(blk->dcb_flags & DISK_CACHE_BLK_F_DIRTY)) {
+        return 0;
+    }
+    rc = dc->dc_dops->write(dc->dc_dev, blk->dcb_addr,
+                            disk_cache_blk_data(dc, blk), dc->dc_blk_sz);
+    if (rc) {
+        return rc;
+    }
+    blk->dcb_flags &= ~DISK_CACHE_BLK_F_DIRTY;
+    return 0;
+}
+
+static struct disk_cache_blk *
+disk_cache_find(struct disk_cache *dc, uint32_t addr)
+{
+    struct disk_cache_blk *blk;
+    int i;
+
+    for (i = 0; i < dc->dc_blk_cnt; i++) {
+        blk = &dc->dc_blks[i];
+        if ((blk->dcb_flags & DISK_CACHE_BLK_F_VALID) &&
+          blk->dcb_addr == addr) {
+            return blk;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Get a cache block for disk block at addr. If fill is set, contents are
+ * read from disk on a miss.
+ */
+static int
+disk_cache_get(struct disk_cache *dc, uint32_t addr, int fill,
+               struct disk_cache_blk **out_blk)
+{
+    struct disk_cache_blk *blk;
+    struct disk_cache_blk *victim;
+    int rc;
+    int i;
+
+    blk = disk_cache_find(dc, addr);
+    if (blk) {
+        dc->dc_hits++;
+        goto done;
+    }
+    dc->dc_misses++;
+
+    /*
+     * Pick an unused block, or the least recently used one.
+     */
+    victim = &dc->dc_blks[0];
+    for (i = 0; i < dc->dc_blk_cnt; i++) {
+        blk = &dc->dc_blks[i];
+        if (!(blk->dcb_flags & DISK_CACHE_BLK_F_VALID)) {
+            victim = blk;
+            break;
+        }
+        if ((int32_t)(blk->dcb_used - victim->dcb_used) < 0) {
+            victim = blk;
+        }
+    }
+    blk = victim;
+
+    if (blk->dcb_flags & DISK_CACHE_BLK_F_VALID) {
+        rc = disk_cache_blk_writeout(dc, blk);
+        if (rc) {
+            return rc;
+        }
+    }
+    blk->dcb_flags = 0;
+
+    if (fill) {
+        rc = dc->dc_dops->read(dc->dc_dev, addr, disk_cache_blk_data(dc, blk),
+                               dc->dc_blk_sz);
+        if (rc) {
+            return rc;
+        }
+    }
+    blk->dcb_addr = addr;
+    blk->dcb_flags = DISK_CACHE_BLK_F_VALID;
+
+done:
+    blk->dcb_used = dc->dc_clock++;
+    *out_blk = blk;
+    return 0;
+}
+
+int
+disk_cache_init(struct disk_cache *dc, struct disk_ops *dops, uint8_t dev,
+                struct disk_cache_blk *blks, uint8_t *data,
+                uint16_t blk_cnt, uint32_t blk_sz, uint8_t policy)
+{
+    if (!dops || !blks || !data || !blk_cnt ||
+      !blk_sz || (blk_sz & (blk_sz - 1))) {
+        return DISK_EUNINIT;
+    }
+    if (policy != DISK_CACHE_WRITE_THROUGH &&
+      policy != DISK_CACHE_WRITE_BACK) {
+        return DISK_EUNINIT;
+    }
+
+    memset(dc, 0, sizeof(*dc));
+    memset(blks, 0, blk_cnt * sizeof(*blks));
+    dc->dc_dops = dops;
+    dc->dc_dev = dev;
+    dc->dc_blks = blks;
+    dc->dc_data = data;
+    dc->dc_blk_cnt = blk_cnt;
+    dc->dc_blk_sz = blk_sz;
+    dc->dc_policy = policy;
+
+    if (os_mutex_init(&dc->dc_mtx)) {
+        return DISK_EOS;
+    }
+    return 0;
+}
+
+int
+disk_cache_read(struct disk_cache *dc, uint32_t addr, void *buf, uint32_t len)
+{
+    struct disk_cache_blk *blk;
+    uint8_t *u8p;
+    uint32_t blk_addr;
+    uint32_t off;
+    uint32_t cnt;
+    int rc;
+
+    os_mutex_pend(&dc->dc_mtx, OS_WAIT_FOREVER);
+
+    rc = 0;
+    u8p = buf;
+    while (len > 0) {
+        blk_addr = addr & ~(dc->dc_blk_sz - 1);
+        off = addr - blk_addr;
+        cnt = dc->dc_blk_sz - off;
+        if (cnt > len) {
+            cnt = len;
+        }
+
+        rc = disk_cache_get(dc, blk_addr, 1, &blk);
+        if (rc) {
+            break;
+        }
+        memcpy(u8p, disk_cache_blk_data(dc, blk) + off, cnt);
+
+        u8p += cnt;
+        addr += cnt;
+        len -= cnt;
+    }
+
+    os_mutex_release(&dc->dc_mtx);
+    return rc;
+}
+
+int
+disk_cache_write(struct disk_cache *dc, uint32_t addr, const void *buf,
+                 uint32_t len)
+{
+    struct disk_cache_blk *blk;
+    const uint8_t *u8p;
+    uint32_t blk_addr;
+    uint32_t off;
+    uint32_t cnt;
+    int rc;
+
+    os_mutex_pend(&dc->dc_mtx, OS_WAIT_FOREVER);
+
+    if (dc->dc_policy == DISK_CACHE_WRITE_THROUGH) {
+        rc = dc->dc_dops->write(dc->dc_dev, addr, buf, len);
+        if (rc) {
+            goto out;
+        }
+    }
+
+    rc = 0;
+    u8p = buf;
+    while (len > 0) {
+        blk_addr = addr & ~(dc->dc_blk_sz - 1);
+        off = addr - blk_addr;
+        cnt = dc->dc_blk_sz - off;
+        if (cnt > len) {
+            cnt = len;
+        }
+
+        if (dc->dc_policy == DISK_CACHE_WRITE_THROUGH) {
+            /*
+             * Only update blocks which are already cached.
+             */
+            blk = disk_cache_find(dc, blk_addr);
+        } else {
+            /*
+             * No need to read the block if it is fully overwritten.
+             */
+            rc = disk_cache_get(dc, blk_addr, cnt != dc->dc_blk_sz, &blk);
+            if (rc) {
+                break;
+            }
+            blk->dcb_flags |= DISK_CACHE_BLK_F_DIRTY;
+        }
+        if (blk) {
+            memcpy(disk_cache_blk_data(dc, blk) + off, u8p, cnt);
+        }
+
+        u8p += cnt;
+        addr += cnt;
+        len -= cnt;
+    }
+
+out:
+    os_mutex_release(&dc->dc_mtx);
+    return rc;
+}
+
+int
+disk_cache_flush(struct disk_cache *dc)
+{
+    struct disk_cache_blk *blk;
+    int rc;
+    int i;
+
+    os_mutex_pend(&dc->dc_mtx, OS_WAIT_FOREVER);
+
+    rc = 0;
+    for (i = 0; i < dc->dc_blk_cnt; i++) {
+        blk = &dc->dc_blks[i];
+        if (blk->dcb_flags & DISK_CACHE_BLK_F_VALID) {
+            rc = disk_cache_blk_writeout(dc, blk);
+            if (rc) {
+                break;
+            }
+        }
+    }
+
+    os_mutex_release(&dc->dc_mtx);
+    return rc;
+}
+
+int
+disk_cache_invalidate(struct disk_cache *dc)
+{
+    int rc;
+    int i;
+
+    rc = disk_cache_flush(dc);
+    if (rc) {
+        return rc;
+    }
+
+    os_mutex_pend(&dc->dc_mtx, OS_WAIT_FOREVER);
+    for (i = 0; i < dc->dc_blk_cnt; i++) {
+        dc->dc_blks[i].dcb_flags = 0;
+    }
+    os_mutex_release(&dc->dc_mtx);
+    return 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#include "disk_test.h"
+
+uint8_t disk_test_ram[DISK_TEST_DISK_SZ];
+int disk_test_reads;
+int disk_test_writes;
+
+struct disk_cache disk_test_cache;
+struct disk_cache_blk disk_test_blks[DISK_TEST_BLK_CNT];
+uint8_t disk_test_data[DISK_TEST_BLK_CNT * DISK_TEST_BLK_SZ];
+
+static int
+disk_test_ram_read(uint8_t dev, uint32_t addr, void *buf, uint32_t len)
+{
+    if (addr + len > sizeof(disk_test_ram)) {
+        return -1;
+    }
+    memcpy(buf, disk_test_ram + addr, len);
+    disk_test_reads++;
+    return 0;
+}
+
+static int
+disk_test_ram_write(uint8_t dev, uint32_t addr, const void *buf, uint32_t len)
+{
+    if (addr + len > sizeof(disk_test_ram)) {
+        return -1;
+    }
+    memcpy(disk_test_ram + addr, buf, len);
+    disk_test_writes++;
+    return 0;
+}
+
+static int
+disk_test_ram_ioctl(uint8_t dev, uint32_t cmd, void *arg)
+{
+    return 0;
+}
+
+struct disk_ops disk_test_ram_ops = {
+    .read = disk_test_ram_read,
+    .write = disk_test_ram_write,
+    .ioctl = disk_test_ram_ioctl,
+};
+
+void
+disk_test_fill(uint8_t *buf, uint32_t addr, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = (addr + i) ^ ((addr + i) >> 8);
+    }
+}
+
+void
+disk_test_init_cache(uint8_t policy)
+{
+    int rc;
+
+    disk_test_fill(disk_test_ram, 0, sizeof(disk_test_ram));
+    disk_test_reads = 0;
+    disk_test_writes = 0;
+
+    rc = disk_cache_init(&disk_test_cache, &disk_test_ram_ops, 0,
+                         disk_test_blks, disk_test_data, DISK_TEST_BLK_CNT,
+                         DISK_TEST_BLK_SZ, policy);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+TEST_CASE_DECL(disk_test_cache_read)
+TEST_CASE_DECL(disk_test_cache_lru)
+TEST_CASE_DECL(disk_test_cache_write_back)
+TEST_CASE_DECL(disk_test_cache_write_through)
+
+TEST_SUITE(disk_test_all)
+{
+    disk_test_cache_read();
+    disk_test_cache_lru();
+    disk_test_cache_write_back();
+    disk_test_cache_write_through();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    disk_test_all();
+
+    return tu_any_failed;
+}
+#endif
@@ -0,0 +1,57 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _DISK_TEST_H
+#define _DISK_TEST_H
+
+#include <stdio.h>
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#include "disk/disk.h"
+#include "disk/disk_cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DISK_TEST_BLK_SZ        512
+#define DISK_TEST_BLK_CNT       4
+#define DISK_TEST_DISK_SZ       (16 * DISK_TEST_BLK_SZ)
+
+/* RAM backed disk, with access counters. */
+extern uint8_t disk_test_ram[DISK_TEST_DISK_SZ];
+extern int disk_test_reads;
+extern int disk_test_writes;
+extern struct disk_ops disk_test_ram_ops;
+
+extern struct disk_cache disk_test_cache;
+extern struct disk_cache_blk disk_test_blks[DISK_TEST_BLK_CNT];
+extern uint8_t disk_test_data[DISK_TEST_BLK_CNT * DISK_TEST_BLK_SZ];
+
+void disk_test_init_cache(uint8_t policy);
+void disk_test_fill(uint8_t *buf, uint32_t addr, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DISK_TEST_H */
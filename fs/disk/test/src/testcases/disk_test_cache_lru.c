@@ -0,0 +1,57 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "disk_test.h"
+
+TEST_CASE(disk_test_cache_lru)
+{
+    uint8_t buf[DISK_TEST_BLK_SZ];
+    int rc;
+    int i;
+
+    disk_test_init_cache(DISK_CACHE_WRITE_BACK);
+
+    /* Fill the cache. */
+    for (i = 0; i < DISK_TEST_BLK_CNT; i++) {
+        rc = disk_cache_read(&disk_test_cache, i * DISK_TEST_BLK_SZ, buf,
+                             sizeof(buf));
+        TEST_ASSERT(rc == 0);
+    }
+    TEST_ASSERT(disk_test_reads == DISK_TEST_BLK_CNT);
+
+    /* Touch block 0; block 1 is now least recently used. */
+    rc = disk_cache_read(&disk_test_cache, 0, buf, sizeof(buf));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_reads == DISK_TEST_BLK_CNT);
+
+    rc = disk_cache_read(&disk_test_cache,
+                         DISK_TEST_BLK_CNT * DISK_TEST_BLK_SZ, buf,
+                         sizeof(buf));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_reads == DISK_TEST_BLK_CNT + 1);
+
+    rc = disk_cache_read(&disk_test_cache, 0, buf, sizeof(buf));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_reads == DISK_TEST_BLK_CNT + 1);
+
+    rc = disk_cache_read(&disk_test_cache, DISK_TEST_BLK_SZ, buf,
+                         sizeof(buf));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_reads == DISK_TEST_BLK_CNT + 2);
+}
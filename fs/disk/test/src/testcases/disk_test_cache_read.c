@@ -0,0 +1,53 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "disk_test.h"
+
+TEST_CASE(disk_test_cache_read)
+{
+    uint8_t buf[2 * DISK_TEST_BLK_SZ];
+    uint8_t exp[2 * DISK_TEST_BLK_SZ];
+    int rc;
+
+    disk_test_init_cache(DISK_CACHE_WRITE_BACK);
+
+    rc = disk_cache_read(&disk_test_cache, 0, buf, DISK_TEST_BLK_SZ);
+    TEST_ASSERT(rc == 0);
+    disk_test_fill(exp, 0, DISK_TEST_BLK_SZ);
+    TEST_ASSERT(!memcmp(buf, exp, DISK_TEST_BLK_SZ));
+    TEST_ASSERT(disk_test_reads == 1);
+
+    /* Same block again comes from cache. */
+    rc = disk_cache_read(&disk_test_cache, 0, buf, DISK_TEST_BLK_SZ);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_reads == 1);
+    TEST_ASSERT(disk_test_cache.dc_hits == 1);
+    TEST_ASSERT(disk_test_cache.dc_misses == 1);
+
+    /* Unaligned read spanning blocks 0, 1 and 2. */
+    rc = disk_cache_read(&disk_test_cache, 100, buf, sizeof(buf));
+    TEST_ASSERT(rc == 0);
+    disk_test_fill(exp, 100, sizeof(exp));
+    TEST_ASSERT(!memcmp(buf, exp, sizeof(exp)));
+    TEST_ASSERT(disk_test_reads == 3);
+
+    /* Read beyond end of disk fails. */
+    rc = disk_cache_read(&disk_test_cache, DISK_TEST_DISK_SZ, buf, 1);
+    TEST_ASSERT(rc != 0);
+}
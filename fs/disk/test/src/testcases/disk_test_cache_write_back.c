@@ -0,0 +1,73 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "disk_test.h"
+
+TEST_CASE(disk_test_cache_write_back)
+{
+    uint8_t buf[DISK_TEST_BLK_SZ];
+    uint8_t rbuf[DISK_TEST_BLK_SZ];
+    int rc;
+    int i;
+
+    disk_test_init_cache(DISK_CACHE_WRITE_BACK);
+
+    /* Full block write does not need to read the block. */
+    memset(buf, 0xa5, sizeof(buf));
+    rc = disk_cache_write(&disk_test_cache, 0, buf, sizeof(buf));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_reads == 0);
+    TEST_ASSERT(disk_test_writes == 0);
+    TEST_ASSERT(disk_test_ram[0] != 0xa5);
+
+    /* Partial write reads the rest of the block first. */
+    rc = disk_cache_write(&disk_test_cache, DISK_TEST_BLK_SZ + 10, buf, 10);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_reads == 1);
+    TEST_ASSERT(disk_test_writes == 0);
+
+    rc = disk_cache_read(&disk_test_cache, 0, rbuf, sizeof(rbuf));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!memcmp(buf, rbuf, sizeof(buf)));
+
+    rc = disk_cache_flush(&disk_test_cache);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_writes == 2);
+    TEST_ASSERT(!memcmp(disk_test_ram, buf, sizeof(buf)));
+    TEST_ASSERT(!memcmp(disk_test_ram + DISK_TEST_BLK_SZ + 10, buf, 10));
+
+    /* Nothing left to flush. */
+    rc = disk_cache_flush(&disk_test_cache);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_writes == 2);
+
+    /* Evicting a dirty block writes it out. */
+    rc = disk_cache_write(&disk_test_cache, 0, buf, 1);
+    TEST_ASSERT(rc == 0);
+    for (i = 1; i <= DISK_TEST_BLK_CNT; i++) {
+        rc = disk_cache_read(&disk_test_cache, (i + 1) * DISK_TEST_BLK_SZ,
+                             rbuf, sizeof(rbuf));
+        TEST_ASSERT(rc == 0);
+    }
+    TEST_ASSERT(disk_test_writes == 3);
+
+    rc = disk_cache_invalidate(&disk_test_cache);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_writes == 3);
+}
@@ -0,0 +1,55 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "disk_test.h"
+
+TEST_CASE(disk_test_cache_write_through)
+{
+    uint8_t buf[DISK_TEST_BLK_SZ];
+    uint8_t rbuf[DISK_TEST_BLK_SZ];
+    int rc;
+
+    disk_test_init_cache(DISK_CACHE_WRITE_THROUGH);
+
+    rc = disk_cache_read(&disk_test_cache, 0, rbuf, sizeof(rbuf));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_reads == 1);
+
+    /* Write updates both the disk and the cached copy. */
+    memset(buf, 0x5a, sizeof(buf));
+    rc = disk_cache_write(&disk_test_cache, 10, buf, 20);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_writes == 1);
+    TEST_ASSERT(!memcmp(disk_test_ram + 10, buf, 20));
+
+    rc = disk_cache_read(&disk_test_cache, 10, rbuf, 20);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_reads == 1);
+    TEST_ASSERT(!memcmp(rbuf, buf, 20));
+
+    /* Uncached blocks are not pulled in by writes. */
+    rc = disk_cache_write(&disk_test_cache, DISK_TEST_BLK_SZ, buf, 20);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_reads == 1);
+    TEST_ASSERT(disk_test_writes == 2);
+
+    rc = disk_cache_flush(&disk_test_cache);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(disk_test_writes == 2);
+}
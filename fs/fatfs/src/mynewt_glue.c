@@ -24,6 +24,9 @@
 #include "os/mynewt.h"
 #include <hal/hal_flash.h>
 #include <disk/disk.h>
+#if MYNEWT_VAL(FATFS_CACHE_BLOCKS)
+#include <disk/disk_cache.h>
+#endif
 #include <flash_map/flash_map.h>
 
 #include <fatfs/ff.h>
@@ -171,12 +174,56 @@ struct mounted_disk {
     char *disk_name;
     int disk_number;
     struct disk_ops *dops;
+#if MYNEWT_VAL(FATFS_CACHE_BLOCKS)
+    struct disk_cache *cache;
+#endif
 
     SLIST_ENTRY(mounted_disk) sc_next;
 };
 
 static SLIST_HEAD(, mounted_disk) mounted_disks = SLIST_HEAD_INITIALIZER();
 
+#if MYNEWT_VAL(FATFS_CACHE_BLOCKS)
+/*
+ * Allocate sector cache for a disk. Disk is used without cache if there is
+ * not enough memory.
+ */
+static struct disk_cache *
+fatfs_cache_alloc(struct disk_ops *dops, int disk_number)
+{
+    struct disk_cache *dc;
+    struct disk_cache_blk *blks;
+    uint8_t *data;
+    int rc;
+
+    if (!dops) {
+        return NULL;
+    }
+
+    dc = malloc(sizeof(*dc));
+    blks = malloc(MYNEWT_VAL(FATFS_CACHE_BLOCKS) * sizeof(*blks));
+    data = malloc(MYNEWT_VAL(FATFS_CACHE_BLOCKS) * _MAX_SS);
+    if (!dc || !blks || !data) {
+        goto err;
+    }
+
+    rc = disk_cache_init(dc, dops, disk_number, blks, data,
+                         MYNEWT_VAL(FATFS_CACHE_BLOCKS), _MAX_SS,
+                         MYNEWT_VAL(FATFS_CACHE_WRITE_BACK) ?
+                           DISK_CACHE_WRITE_BACK : DISK_CACHE_WRITE_THROUGH);
+    if (rc) {
+        goto err;
+    }
+    return dc;
+
+err:
+    free(dc);
+    free(blks);
+    free(data);
+    return NULL;
+}
+#endif
+
 static int
 drivenumber_from_disk(char *disk_name)
 {
@@ -206,6 +253,9 @@ drivenumber_from_disk(char *disk_name)
     new_disk->disk_name = strdup(disk_name);
     new_disk->disk_number = disk_number;
     new_disk->dops = disk_ops_for(disk_name);
+#if MYNEWT_VAL(FATFS_CACHE_BLOCKS)
+    new_disk->cache = fatfs_cache_alloc(new_disk->dops, disk_number);
+#endif
     SLIST_INSERT_HEAD(&mounted_disks, new_disk, sc_next);
 
     return disk_number;
@@ -495,19 +545,30 @@ disk_status(BYTE pdrv)
     return RES_OK;
 }
 
-static struct disk_ops *dops_from_handle(BYTE pdrv)
+static struct mounted_disk *disk_from_handle(BYTE pdrv)
 {
     struct mounted_disk *sc;
 
     SLIST_FOREACH(sc, &mounted_disks, sc_next) {
         if (sc->disk_number == pdrv) {
-            return sc->dops;
+            return sc;
         }
     }
 
     return NULL;
 }
 
+static struct disk_ops *dops_from_handle(BYTE pdrv)
+{
+    struct mounted_disk *sc;
+
+    sc = disk_from_handle(pdrv);
+    if (sc == NULL) {
+        return NULL;
+    }
+    return sc->dops;
+}
+
 DRESULT
 disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
 {
@@ -515,11 +576,25 @@ disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
     uint32_t address;
     uint32_t num_bytes;
     struct disk_ops *dops;
+#if MYNEWT_VAL(FATFS_CACHE_BLOCKS)
+    struct mounted_disk *sc;
+#endif
 
     /* NOTE: safe to assume sector size as 512 for now, see ffconf.h */
     address = (uint32_t) sector * 512;
     num_bytes = (uint32_t) count * 512;
 
+#if MYNEWT_VAL(FATFS_CACHE_BLOCKS)
+    sc = disk_from_handle(pdrv);
+    if (sc && sc->cache) {
+        rc = disk_cache_read(sc->cache, address, (void *) buff, num_bytes);
+        if (rc) {
+            return RES_ERROR;
+        }
+        return RES_OK;
+    }
+#endif
+
     dops = dops_from_handle(pdrv);
     if (dops == NULL) {
         return STA_NOINIT;
@@ -540,11 +615,26 @@ disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
     uint32_t address;
     uint32_t num_bytes;
     struct disk_ops *dops;
+#if MYNEWT_VAL(FATFS_CACHE_BLOCKS)
+    struct mounted_disk *sc;
+#endif
 
     /* NOTE: safe to assume sector size as 512 for now, see ffconf.h */
     address = (uint32_t) sector * 512;
     num_bytes = (uint32_t) count * 512;
 
+#if MYNEWT_VAL(FATFS_CACHE_BLOCKS)
+    sc = disk_from_handle(pdrv);
+    if (sc && sc->cache) {
+        rc = disk_cache_write(sc->cache, address, (const void *) buff,
+                              num_bytes);
+        if (rc) {
+            return RES_ERROR;
+        }
+        return RES_OK;
+    }
+#endif
+
     dops = dops_from_handle(pdrv);
     if (dops == NULL) {
         return STA_NOINIT;
@@ -561,6 +651,17 @@ disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
 DRESULT
 disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
 {
+#if MYNEWT_VAL(FATFS_CACHE_BLOCKS)
+    struct mounted_disk *sc;
+
+    /* f_sync() and f_close() issue CTRL_SYNC; write out cached sectors. */
+    if (cmd == CTRL_SYNC) {
+        sc = disk_from_handle(pdrv);
+        if (sc && sc->cache && disk_cache_flush(sc->cache)) {
+            return RES_ERROR;
+        }
+    }
+#endif
     return RES_OK;
 }
 
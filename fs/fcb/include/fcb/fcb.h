@@ -33,6 +33,9 @@ extern "C" {
 
 #include "os/mynewt.h"
 #include "flash_map/flash_map.h"
+#if MYNEWT_VAL(FCB_ERASE_STATS)
+#include "stats/stats.h"
+#endif
 
 #define FCB_MAX_LEN	(CHAR_MAX | CHAR_MAX << 7) /* Max length of element */
 
@@ -45,6 +48,8 @@ struct fcb_entry {
     uint32_t fe_elem_off;	/* start of entry */
     uint32_t fe_data_off;	/* start of data */
     uint16_t fe_data_len;	/* size of data area */
+    uint16_t fe_crc_len;	/* data bytes covered by fe_crc8, when appending */
+    uint8_t fe_crc8;		/* running CRC, when appending */
 };
 
 struct fcb {
@@ -61,6 +66,15 @@ struct fcb {
     struct fcb_entry f_active;
     uint16_t f_active_id;
     uint8_t f_align;		/* writes to flash have to aligned to this */
+    uint32_t f_crc_err_cnt;	/* elements found with CRC mismatch */
+#if MYNEWT_VAL(FCB_ERASE_CNT)
+    /*
+     * Caller of fcb_init fills this in, or calls fcb_erase_stats_register().
+     * Array of f_sector_cnt erase counters, one per sector. Loaded from
+     * sector headers by fcb_init(). If NULL, erases are not counted.
+     */
+    uint32_t *f_erase_cnt;
+#endif
 };
 
 /**
@@ -88,13 +102,55 @@ struct fcb_log {
 
 /**
  * fcb_append() appends an entry to circular buffer. When writing the
- * contents for the entry, use loc->fl_area and loc->fl_data_off with
- * flash_area_write(). When you're finished, call fcb_append_finish() with
- * loc as argument.
+ * contents for the entry, use fcb_write(), or loc->fl_area and
+ * loc->fl_data_off with flash_area_write(). When you're finished, call
+ * fcb_append_finish() with loc as argument.
  */
 int fcb_append(struct fcb *, uint16_t len, struct fcb_entry *loc);
+
+/**
+ * Write data of an entry being appended, at offset off from start of entry
+ * data. When data is written sequentially with this function, CRC is
+ * computed as data goes by, and fcb_append_finish() does not need to read
+ * the entry back from flash.
+ */
+int fcb_write(struct fcb *, struct fcb_entry *loc, uint16_t off,
+              const void *buf, uint16_t len);
 int fcb_append_finish(struct fcb *, struct fcb_entry *append_loc);
 
+/**
+ * Batched append. Elements are staged into caller supplied RAM buffer,
+ * complete with their length headers and CRCs, and written out with
+ * one flash write per sector when batch is flushed. Each element is
+ * individually valid in flash; if writing is interrupted, only the
+ * elements which did not make it fully to flash are lost.
+ *
+ * Staging buffer must be large enough to hold the largest element,
+ * including its length header, CRC and alignment padding.
+ */
+struct fcb_batch {
+    uint8_t *fb_buf;		/* staging buffer */
+    uint16_t fb_buf_sz;		/* size of staging buffer */
+    uint16_t fb_used;		/* bytes staged */
+    uint16_t fb_cnt;		/* number of elements staged */
+};
+
+int fcb_batch_init(struct fcb *, struct fcb_batch *, uint8_t *buf,
+                   uint16_t buf_sz);
+
+/**
+ * Stage an element to batch. If the buffer fills up, staged elements are
+ * flushed to flash first. Returns FCB_ERR_NOSPACE if flush could not
+ * find room; caller should then fcb_rotate() and retry.
+ */
+int fcb_batch_append(struct fcb *, struct fcb_batch *, const void *data,
+                     uint16_t len);
+
+/**
+ * Write out all staged elements.
+ */
+int fcb_batch_flush(struct fcb *, struct fcb_batch *);
+
 /**
  * Walk over all log entries in FCB, or entries in a given flash_area.
  * cb gets called for every entry. If cb wants to stop the walk, it should
@@ -105,8 +161,29 @@ int fcb_append_finish(struct fcb *, struct fcb_entry *append_loc);
  */
 typedef int (*fcb_walk_cb)(struct fcb_entry *loc, void *arg);
 int fcb_walk(struct fcb *, struct flash_area *, fcb_walk_cb cb, void *cb_arg);
+
+/**
+ * Walk flags.
+ */
+#define FCB_WALK_F_NOCRC	0x01	/* Don't read data to verify CRC */
+
+/**
+ * Same as fcb_walk(), with flags controlling the walk. With
+ * FCB_WALK_F_NOCRC, only length headers are read; entries with bad CRC
+ * are not detected, and do not show up in fcb_crc_err_cnt(). Use only
+ * when contents of the FCB are trusted.
+ */
+int fcb_walk_flags(struct fcb *, struct flash_area *, fcb_walk_cb cb,
+                   void *cb_arg, uint8_t flags);
 int fcb_getnext(struct fcb *, struct fcb_entry *loc);
 
+/**
+ * Given loc->fe_area and loc->fe_elem_off of an entry, as returned earlier
+ * by fcb_getnext() or fcb_append(), fills in loc->fe_data_off and
+ * loc->fe_data_len, and verifies the CRC of the entry.
+ */
+int fcb_elem_info(struct fcb *, struct fcb_entry *loc);
+
 /**
  * Erases the data from oldest sector.
  */
@@ -127,6 +204,11 @@ int fcb_free_sector_cnt(struct fcb *fcb);
  */
 int fcb_is_empty(struct fcb *fcb);
 
+/**
+ * Number of elements found with CRC mismatch since fcb_init().
+ */
+uint32_t fcb_crc_err_cnt(struct fcb *fcb);
+
 /**
  * Element at offset *entries* from last position (backwards).
  */
@@ -139,6 +221,24 @@ fcb_offset_last_n(struct fcb *fcb, uint8_t entries,
  */
 int fcb_clear(struct fcb *fcb);
 
+#if MYNEWT_VAL(FCB_ERASE_STATS)
+/**
+ * Per-sector erase counters as a statistics group. Entry sN is the number
+ * of times sector N has been erased.
+ */
+struct fcb_erase_stats {
+    struct stats_hdr fes_hdr;
+    uint32_t fes_cnt[MYNEWT_VAL(FCB_ERASE_STATS_MAX_SECTORS)];
+};
+
+/**
+ * Use fes for keeping FCB erase counters, and register it with stats
+ * under given name. Must be called before fcb_init().
+ */
+int fcb_erase_stats_register(struct fcb *fcb, struct fcb_erase_stats *fes,
+                             char *name);
+#endif
+
 #ifdef __cplusplus
 }
 
@@ -34,11 +34,16 @@ fcb_init(struct fcb *fcb)
     int oldest = -1, newest = -1;
     struct flash_area *oldest_fap = NULL, *newest_fap = NULL;
     struct fcb_disk_area fda;
+#if MYNEWT_VAL(FCB_ERASE_CNT)
+    uint32_t max_erase_cnt = 0;
+#endif
 
     if (!fcb->f_sectors || fcb->f_sector_cnt - fcb->f_scratch_cnt < 1) {
         return FCB_ERR_ARGS;
     }
 
+    fcb->f_crc_err_cnt = 0;
+
     /* Fill last used, first used */
     for (i = 0; i < fcb->f_sector_cnt; i++) {
         fap = &fcb->f_sectors[i];
@@ -50,6 +55,22 @@ fcb_init(struct fcb *fcb)
         if (rc < 0) {
             return rc;
         }
+#if MYNEWT_VAL(FCB_ERASE_CNT)
+        if (fcb->f_erase_cnt) {
+            if (rc == 0) {
+                /*
+                 * Unused sector; count is not known until we've seen
+                 * the rest.
+                 */
+                fcb->f_erase_cnt[i] = UINT32_MAX;
+            } else {
+                fcb->f_erase_cnt[i] = fda.fd_erase_cnt;
+                if (fda.fd_erase_cnt > max_erase_cnt) {
+                    max_erase_cnt = fda.fd_erase_cnt;
+                }
+            }
+        }
+#endif
         if (rc == 0) {
             continue;
         }
@@ -66,6 +87,17 @@ fcb_init(struct fcb *fcb)
             oldest_fap = fap;
         }
     }
+#if MYNEWT_VAL(FCB_ERASE_CNT)
+    /*
+     * Erase count of sectors without header is lost. Assume they've been
+     * worn as much as the most worn sector.
+     */
+    for (i = 0; fcb->f_erase_cnt && i < fcb->f_sector_cnt; i++) {
+        if (fcb->f_erase_cnt[i] == UINT32_MAX) {
+            fcb->f_erase_cnt[i] = max_erase_cnt;
+        }
+    }
+#endif
     if (oldest < 0) {
         /*
          * No initialized areas.
@@ -80,7 +112,7 @@ fcb_init(struct fcb *fcb)
     fcb->f_align = max_align;
     fcb->f_oldest = oldest_fap;
     fcb->f_active.fe_area = newest_fap;
-    fcb->f_active.fe_elem_off = sizeof(struct fcb_disk_area);
+    fcb->f_active.fe_elem_off = fcb_first_elem_off(fcb);
     fcb->f_active_id = newest;
 
     /* Require alignment to be a power of two.  Some code depends on this
@@ -89,7 +121,7 @@ fcb_init(struct fcb *fcb)
     assert((fcb->f_align & (fcb->f_align - 1)) == 0);
 
     while (1) {
-        rc = fcb_getnext_in_area(fcb, &fcb->f_active);
+        rc = fcb_getnext_in_area(fcb, &fcb->f_active, 0);
         if (rc == FCB_ERR_NOVAR) {
             rc = FCB_OK;
             break;
@@ -122,7 +154,13 @@ int
 fcb_is_empty(struct fcb *fcb)
 {
     return (fcb->f_active.fe_area == fcb->f_oldest &&
-      fcb->f_active.fe_elem_off == sizeof(struct fcb_disk_area));
+      fcb->f_active.fe_elem_off == fcb_first_elem_off(fcb));
+}
+
+uint32_t
+fcb_crc_err_cnt(struct fcb *fcb)
+{
+    return fcb->f_crc_err_cnt;
 }
 
 /**
@@ -172,6 +210,13 @@ fcb_sector_hdr_init(struct fcb *fcb, struct flash_area *fap, uint16_t id)
     fda.fd_ver = fcb->f_version;
     fda._pad = 0xff;
     fda.fd_id = id;
+#if MYNEWT_VAL(FCB_ERASE_CNT)
+    if (fcb->f_erase_cnt) {
+        fda.fd_erase_cnt = fcb->f_erase_cnt[fap - fcb->f_sectors];
+    } else {
+        fda.fd_erase_cnt = 0;
+    }
+#endif
 
     rc = flash_area_write(fap, 0, &fda, sizeof(fda));
     if (rc) {
@@ -266,3 +311,25 @@ fcb_clear(struct fcb *fcb)
     }
     return rc;
 }
+
+#if MYNEWT_VAL(FCB_ERASE_STATS)
+int
+fcb_erase_stats_register(struct fcb *fcb, struct fcb_erase_stats *fes,
+                         char *name)
+{
+    int rc;
+
+    if (fcb->f_sector_cnt > MYNEWT_VAL(FCB_ERASE_STATS_MAX_SECTORS)) {
+        return FCB_ERR_ARGS;
+    }
+    memset(fes->fes_cnt, 0, sizeof(fes->fes_cnt));
+    fcb->f_erase_cnt = fes->fes_cnt;
+
+    rc = stats_init_and_reg(&fes->fes_hdr, STATS_SIZE_32, fcb->f_sector_cnt,
+                            NULL, 0, name);
+    if (rc) {
+        return FCB_ERR_ARGS;
+    }
+    return 0;
+}
+#endif
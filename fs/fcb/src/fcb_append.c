@@ -18,10 +18,12 @@
  */
 #include <stddef.h>
 
+#include <crc/crc8.h>
+
 #include "fcb/fcb.h"
 #include "fcb_priv.h"
 
-static struct flash_area *
+struct flash_area *
 fcb_new_area(struct fcb *fcb, int cnt)
 {
     struct flash_area *fa;
@@ -61,7 +63,7 @@ fcb_append_to_scratch(struct fcb *fcb)
         return rc;
     }
     fcb->f_active.fe_area = fa;
-    fcb->f_active.fe_elem_off = sizeof(struct fcb_disk_area);
+    fcb->f_active.fe_elem_off = fcb_first_elem_off(fcb);
     fcb->f_active_id++;
     return FCB_OK;
 }
@@ -72,6 +74,8 @@ fcb_append(struct fcb *fcb, uint16_t len, struct fcb_entry *append_loc)
     struct fcb_entry *active;
     struct flash_area *fa;
     uint8_t tmp_str[2];
+    uint16_t data_len;
+    uint8_t crc8;
     int cnt;
     int rc;
 
@@ -79,6 +83,10 @@ fcb_append(struct fcb *fcb, uint16_t len, struct fcb_entry *append_loc)
     if (cnt < 0) {
         return cnt;
     }
+    crc8 = crc8_init();
+    crc8 = crc8_calc(crc8, tmp_str, cnt);
+
+    data_len = len;
     cnt = fcb_len_in_flash(fcb, cnt);
     len = fcb_len_in_flash(fcb, len) + fcb_len_in_flash(fcb, FCB_CRC_SZ);
 
@@ -90,7 +98,7 @@ fcb_append(struct fcb *fcb, uint16_t len, struct fcb_entry *append_loc)
     if (active->fe_elem_off + len + cnt > active->fe_area->fa_size) {
         fa = fcb_new_area(fcb, fcb->f_scratch_cnt);
         if (!fa || (fa->fa_size <
-            sizeof(struct fcb_disk_area) + len + cnt)) {
+            fcb_first_elem_off(fcb) + len + cnt)) {
             rc = FCB_ERR_NOSPACE;
             goto err;
         }
@@ -99,7 +107,7 @@ fcb_append(struct fcb *fcb, uint16_t len, struct fcb_entry *append_loc)
             goto err;
         }
         fcb->f_active.fe_area = fa;
-        fcb->f_active.fe_elem_off = sizeof(struct fcb_disk_area);
+        fcb->f_active.fe_elem_off = fcb_first_elem_off(fcb);
         fcb->f_active_id++;
     }
 
@@ -111,6 +119,9 @@ fcb_append(struct fcb *fcb, uint16_t len, struct fcb_entry *append_loc)
     append_loc->fe_area = active->fe_area;
     append_loc->fe_elem_off = active->fe_elem_off;
     append_loc->fe_data_off = active->fe_elem_off + cnt;
+    append_loc->fe_data_len = data_len;
+    append_loc->fe_crc_len = 0;
+    append_loc->fe_crc8 = crc8;
 
     active->fe_elem_off = append_loc->fe_data_off + len;
 
@@ -122,18 +133,55 @@ err:
     return rc;
 }
 
+int
+fcb_write(struct fcb *fcb, struct fcb_entry *loc, uint16_t off,
+          const void *buf, uint16_t len)
+{
+    int rc;
+
+    if (off + len > loc->fe_data_len) {
+        return FCB_ERR_ARGS;
+    }
+    rc = flash_area_write(loc->fe_area, loc->fe_data_off + off, buf, len);
+    if (rc) {
+        return FCB_ERR_FLASH;
+    }
+
+    /*
+     * Running CRC is only valid if data is written in order.
+     */
+    if (off == loc->fe_crc_len) {
+        loc->fe_crc8 = crc8_calc(loc->fe_crc8, (void *)buf, len);
+        loc->fe_crc_len += len;
+    } else {
+        loc->fe_crc_len = UINT16_MAX;
+    }
+    return 0;
+}
+
 int
 fcb_append_finish(struct fcb *fcb, struct fcb_entry *loc)
 {
     int rc;
+    uint8_t tmp_str[2];
     uint8_t crc8;
     uint32_t off;
 
-    rc = fcb_elem_crc8(fcb, loc, &crc8);
-    if (rc) {
-        return rc;
+    if (loc->fe_crc_len == loc->fe_data_len) {
+        /*
+         * All data went through fcb_write(); no need to read it back.
+         */
+        crc8 = loc->fe_crc8;
+        off = loc->fe_elem_off +
+          fcb_len_in_flash(fcb, fcb_put_len(tmp_str, loc->fe_data_len));
+    } else {
+        rc = fcb_elem_crc8(fcb, loc, &crc8);
+        if (rc) {
+            return rc;
+        }
+        off = loc->fe_data_off;
     }
-    off = loc->fe_data_off + fcb_len_in_flash(fcb, loc->fe_data_len);
+    off += fcb_len_in_flash(fcb, loc->fe_data_len);
 
     rc = flash_area_write(loc->fe_area, off, &crc8, sizeof(crc8));
     if (rc) {
@@ -0,0 +1,200 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+
+#include <crc/crc8.h>
+
+#include "fcb/fcb.h"
+#include "fcb_priv.h"
+
+/*
+ * Entries are staged in the batch buffer exactly as they will appear in
+ * flash: length header, data and CRC8, each padded to flash alignment.
+ * Padding is filled with the erased value so flash is left as if it
+ * had not been programmed.
+ */
+#define FCB_BATCH_PAD   0xff
+
+int
+fcb_batch_init(struct fcb *fcb, struct fcb_batch *fb, uint8_t *buf,
+               uint16_t buf_sz)
+{
+    if (!buf || buf_sz < fcb_len_in_flash(fcb, 2) +
+                         fcb_len_in_flash(fcb, FCB_CRC_SZ)) {
+        return FCB_ERR_ARGS;
+    }
+    fb->fb_buf = buf;
+    fb->fb_buf_sz = buf_sz;
+    fb->fb_used = 0;
+    fb->fb_cnt = 0;
+    return FCB_OK;
+}
+
+/*
+ * Size of the staged element which starts at buf.
+ */
+static int
+fcb_batch_elem_sz(struct fcb *fcb, uint8_t *buf)
+{
+    uint16_t len;
+    int cnt;
+
+    cnt = fcb_get_len(buf, &len);
+    return fcb_len_in_flash(fcb, cnt) + fcb_len_in_flash(fcb, len) +
+      fcb_len_in_flash(fcb, FCB_CRC_SZ);
+}
+
+int
+fcb_batch_append(struct fcb *fcb, struct fcb_batch *fb, const void *data,
+                 uint16_t len)
+{
+    uint8_t tmp_str[2];
+    uint8_t *p;
+    uint8_t crc8;
+    int elem_sz;
+    int cnt;
+    int rc;
+
+    cnt = fcb_put_len(tmp_str, len);
+    if (cnt < 0) {
+        return cnt;
+    }
+    elem_sz = fcb_len_in_flash(fcb, cnt) + fcb_len_in_flash(fcb, len) +
+      fcb_len_in_flash(fcb, FCB_CRC_SZ);
+    if (elem_sz > fb->fb_buf_sz) {
+        return FCB_ERR_NOMEM;
+    }
+    if (fb->fb_used + elem_sz > fb->fb_buf_sz) {
+        rc = fcb_batch_flush(fcb, fb);
+        if (rc) {
+            return rc;
+        }
+    }
+
+    p = fb->fb_buf + fb->fb_used;
+    memset(p, FCB_BATCH_PAD, elem_sz);
+    memcpy(p, tmp_str, cnt);
+
+    crc8 = crc8_init();
+    crc8 = crc8_calc(crc8, p, cnt);
+    p += fcb_len_in_flash(fcb, cnt);
+
+    memcpy(p, data, len);
+    crc8 = crc8_calc(crc8, p, len);
+    p += fcb_len_in_flash(fcb, len);
+
+    *p = crc8;
+
+    fb->fb_used += elem_sz;
+    fb->fb_cnt++;
+    return FCB_OK;
+}
+
+/*
+ * Write out staged elements. Elements which fit in the active sector go out
+ * in a single flash write; if sector runs out, rest of the elements are
+ * written to a new sector. Elements never straddle sector boundaries.
+ */
+int
+fcb_batch_flush(struct fcb *fcb, struct fcb_batch *fb)
+{
+    struct fcb_entry *active;
+    struct flash_area *fa;
+    uint32_t room;
+    int off;
+    int wr_len;
+    int elem_sz;
+    int rc;
+
+    if (fb->fb_used == 0) {
+        return FCB_OK;
+    }
+
+    rc = os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    if (rc && rc != OS_NOT_STARTED) {
+        return FCB_ERR_ARGS;
+    }
+    active = &fcb->f_active;
+
+    off = 0;
+    while (off < fb->fb_used) {
+        room = active->fe_area->fa_size - active->fe_elem_off;
+
+        /*
+         * Collect as many whole elements as fit in active sector.
+         */
+        wr_len = 0;
+        while (off + wr_len < fb->fb_used) {
+            elem_sz = fcb_batch_elem_sz(fcb, fb->fb_buf + off + wr_len);
+            if (wr_len + elem_sz > room) {
+                break;
+            }
+            wr_len += elem_sz;
+        }
+
+        if (wr_len == 0) {
+            elem_sz = fcb_batch_elem_sz(fcb, fb->fb_buf + off);
+            fa = fcb_new_area(fcb, fcb->f_scratch_cnt);
+            if (!fa || (fa->fa_size <
+                fcb_first_elem_off(fcb) + elem_sz)) {
+                rc = FCB_ERR_NOSPACE;
+                goto err;
+            }
+            rc = fcb_sector_hdr_init(fcb, fa, fcb->f_active_id + 1);
+            if (rc) {
+                goto err;
+            }
+            fcb->f_active.fe_area = fa;
+            fcb->f_active.fe_elem_off = fcb_first_elem_off(fcb);
+            fcb->f_active_id++;
+            continue;
+        }
+
+        rc = flash_area_write(active->fe_area, active->fe_elem_off,
+                              fb->fb_buf + off, wr_len);
+        if (rc) {
+            rc = FCB_ERR_FLASH;
+            goto err;
+        }
+        active->fe_elem_off += wr_len;
+        off += wr_len;
+    }
+    os_mutex_release(&fcb->f_mtx);
+
+    fb->fb_used = 0;
+    fb->fb_cnt = 0;
+    return FCB_OK;
+err:
+    os_mutex_release(&fcb->f_mtx);
+
+    /*
+     * Keep elements which did not make it to flash, so that caller can
+     * rotate and retry.
+     */
+    if (off) {
+        memmove(fb->fb_buf, fb->fb_buf + off, fb->fb_used - off);
+        fb->fb_used -= off;
+        fb->fb_cnt = 0;
+        for (off = 0; off < fb->fb_used;
+             off += fcb_batch_elem_sz(fcb, fb->fb_buf + off)) {
+            fb->fb_cnt++;
+        }
+    }
+    return rc;
+}
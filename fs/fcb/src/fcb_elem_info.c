@@ -23,19 +23,14 @@
 #include "fcb_priv.h"
 
 /*
- * Given offset in flash area, fill in rest of the fcb_entry, and crc8 over
- * the data.
+ * Given offset in flash area, fill in data offset and length of the element.
+ * Returns number of bytes used by the length field, or error.
  */
-int
-fcb_elem_crc8(struct fcb *fcb, struct fcb_entry *loc, uint8_t *c8p)
+static int
+fcb_elem_hdr_read(struct fcb *fcb, struct fcb_entry *loc, uint8_t *len_buf)
 {
-    uint8_t tmp_str[FCB_TMP_BUF_SZ];
-    int cnt;
-    int blk_sz;
-    uint8_t crc8;
     uint16_t len;
-    uint32_t off;
-    uint32_t end;
+    int cnt;
     int rc;
 
     if (loc->fe_elem_off + 2 > loc->fe_area->fa_size) {
@@ -44,20 +39,43 @@ fcb_elem_crc8(struct fcb *fcb, struct fcb_entry *loc, uint8_t *c8p)
     if (flash_area_isempty_at(loc->fe_area, loc->fe_elem_off, 2)) {
         return FCB_ERR_NOVAR;
     }
-    rc = flash_area_read(loc->fe_area, loc->fe_elem_off, tmp_str, 2);
+    rc = flash_area_read(loc->fe_area, loc->fe_elem_off, len_buf, 2);
     if (rc) {
         return FCB_ERR_FLASH;
     }
 
-    cnt = fcb_get_len(tmp_str, &len);
+    cnt = fcb_get_len(len_buf, &len);
     loc->fe_data_off = loc->fe_elem_off + fcb_len_in_flash(fcb, cnt);
     loc->fe_data_len = len;
 
+    return cnt;
+}
+
+/*
+ * Given offset in flash area, fill in rest of the fcb_entry, and crc8 over
+ * the data.
+ */
+int
+fcb_elem_crc8(struct fcb *fcb, struct fcb_entry *loc, uint8_t *c8p)
+{
+    uint8_t tmp_str[FCB_TMP_BUF_SZ];
+    int cnt;
+    int blk_sz;
+    uint8_t crc8;
+    uint32_t off;
+    uint32_t end;
+    int rc;
+
+    cnt = fcb_elem_hdr_read(fcb, loc, tmp_str);
+    if (cnt < 0) {
+        return cnt;
+    }
+
     crc8 = crc8_init();
     crc8 = crc8_calc(crc8, tmp_str, cnt);
 
     off = loc->fe_data_off;
-    end = loc->fe_data_off + len;
+    end = loc->fe_data_off + loc->fe_data_len;
     for (; off < end; off += blk_sz) {
         blk_sz = end - off;
         if (blk_sz > sizeof(tmp_str)) {
@@ -95,7 +113,24 @@ fcb_elem_info(struct fcb *fcb, struct fcb_entry *loc)
     }
 
     if (fl_crc8 != crc8) {
+        fcb->f_crc_err_cnt++;
         return FCB_ERR_CRC;
     }
     return 0;
 }
+
+/*
+ * Same as fcb_elem_info(), but without reading data to verify the CRC.
+ */
+int
+fcb_elem_info_nocrc(struct fcb *fcb, struct fcb_entry *loc)
+{
+    uint8_t len_buf[2];
+    int rc;
+
+    rc = fcb_elem_hdr_read(fcb, loc, len_buf);
+    if (rc < 0) {
+        return rc;
+    }
+    return 0;
+}
@@ -22,17 +22,17 @@
 #include "fcb_priv.h"
 
 int
-fcb_getnext_in_area(struct fcb *fcb, struct fcb_entry *loc)
+fcb_getnext_in_area(struct fcb *fcb, struct fcb_entry *loc, uint8_t flags)
 {
     int rc;
 
-    rc = fcb_elem_info(fcb, loc);
+    rc = fcb_elem_info_flags(fcb, loc, flags);
     if (rc == 0 || rc == FCB_ERR_CRC) {
         do {
             loc->fe_elem_off = loc->fe_data_off +
               fcb_len_in_flash(fcb, loc->fe_data_len) +
               fcb_len_in_flash(fcb, FCB_CRC_SZ);
-            rc = fcb_elem_info(fcb, loc);
+            rc = fcb_elem_info_flags(fcb, loc, flags);
             if (rc != FCB_ERR_CRC) {
                 break;
             }
@@ -52,7 +52,7 @@ fcb_getnext_area(struct fcb *fcb, struct flash_area *fap)
 }
 
 int
-fcb_getnext_nolock(struct fcb *fcb, struct fcb_entry *loc)
+fcb_getnext_nolock(struct fcb *fcb, struct fcb_entry *loc, uint8_t flags)
 {
     int rc;
 
@@ -66,10 +66,10 @@ fcb_getnext_nolock(struct fcb *fcb, struct fcb_entry *loc)
         /*
          * If offset is zero, we serve the first entry from the area.
          */
-        loc->fe_elem_off = sizeof(struct fcb_disk_area);
-        rc = fcb_elem_info(fcb, loc);
+        loc->fe_elem_off = fcb_first_elem_off(fcb);
+        rc = fcb_elem_info_flags(fcb, loc, flags);
     } else {
-        rc = fcb_getnext_in_area(fcb, loc);
+        rc = fcb_getnext_in_area(fcb, loc, flags);
     }
     switch (rc) {
     case 0:
@@ -80,7 +80,7 @@ fcb_getnext_nolock(struct fcb *fcb, struct fcb_entry *loc)
         goto next_sector;
     }
     while (rc == FCB_ERR_CRC) {
-        rc = fcb_getnext_in_area(fcb, loc);
+        rc = fcb_getnext_in_area(fcb, loc, flags);
         if (rc == 0) {
             return 0;
         }
@@ -94,8 +94,8 @@ next_sector:
                 return FCB_ERR_NOVAR;
             }
             loc->fe_area = fcb_getnext_area(fcb, loc->fe_area);
-            loc->fe_elem_off = sizeof(struct fcb_disk_area);
-            rc = fcb_elem_info(fcb, loc);
+            loc->fe_elem_off = fcb_first_elem_off(fcb);
+            rc = fcb_elem_info_flags(fcb, loc, flags);
             switch (rc) {
             case 0:
                 return 0;
@@ -119,7 +119,7 @@ fcb_getnext(struct fcb *fcb, struct fcb_entry *loc)
     if (rc && rc != OS_NOT_STARTED) {
         return FCB_ERR_ARGS;
     }
-    rc = fcb_getnext_nolock(fcb, loc);
+    rc = fcb_getnext_nolock(fcb, loc, 0);
     os_mutex_release(&fcb->f_mtx);
 
     return rc;
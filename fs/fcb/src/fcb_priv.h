@@ -33,6 +33,9 @@ struct fcb_disk_area {
     uint8_t  fd_ver;
     uint8_t  _pad;
     uint16_t fd_id;
+#if MYNEWT_VAL(FCB_ERASE_CNT)
+    uint32_t fd_erase_cnt;
+#endif
 };
 
 int fcb_put_len(uint8_t *buf, uint16_t len);
@@ -47,13 +50,39 @@ fcb_len_in_flash(struct fcb *fcb, uint16_t len)
     return (len + (fcb->f_align - 1)) & ~(fcb->f_align - 1);
 }
 
-int fcb_getnext_in_area(struct fcb *fcb, struct fcb_entry *loc);
+/*
+ * Offset of the first element in a sector.  The header carrying erase
+ * counters is padded to the write alignment of the flash.  Without them,
+ * elements start right after the header, as they always have.
+ */
+static inline int
+fcb_first_elem_off(struct fcb *fcb)
+{
+#if MYNEWT_VAL(FCB_ERASE_CNT)
+    return fcb_len_in_flash(fcb, sizeof(struct fcb_disk_area));
+#else
+    return sizeof(struct fcb_disk_area);
+#endif
+}
+
+int fcb_getnext_in_area(struct fcb *fcb, struct fcb_entry *loc,
+                        uint8_t flags);
 struct flash_area *fcb_getnext_area(struct fcb *fcb, struct flash_area *fap);
-int fcb_getnext_nolock(struct fcb *fcb, struct fcb_entry *loc);
+struct flash_area *fcb_new_area(struct fcb *fcb, int cnt);
+int fcb_getnext_nolock(struct fcb *fcb, struct fcb_entry *loc, uint8_t flags);
 
-int fcb_elem_info(struct fcb *, struct fcb_entry *);
+int fcb_elem_info_nocrc(struct fcb *, struct fcb_entry *);
 int fcb_elem_crc8(struct fcb *, struct fcb_entry *loc, uint8_t *crc8p);
 
+static inline int
+fcb_elem_info_flags(struct fcb *fcb, struct fcb_entry *loc, uint8_t flags)
+{
+    if (flags & FCB_WALK_F_NOCRC) {
+        return fcb_elem_info_nocrc(fcb, loc);
+    }
+    return fcb_elem_info(fcb, loc);
+}
+
 int fcb_sector_hdr_init(struct fcb *, struct flash_area *fap, uint16_t id);
 int fcb_sector_hdr_read(struct fcb *, struct flash_area *fap,
   struct fcb_disk_area *fdap);
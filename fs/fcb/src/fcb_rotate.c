@@ -36,6 +36,11 @@ fcb_rotate(struct fcb *fcb)
         rc = FCB_ERR_FLASH;
         goto out;
     }
+#if MYNEWT_VAL(FCB_ERASE_CNT)
+    if (fcb->f_erase_cnt) {
+        fcb->f_erase_cnt[fcb->f_oldest - fcb->f_sectors]++;
+    }
+#endif
     if (fcb->f_oldest == fcb->f_active.fe_area) {
         /*
          * Need to create a new active area, as we're wiping the current.
@@ -46,7 +51,7 @@ fcb_rotate(struct fcb *fcb)
             goto out;
         }
         fcb->f_active.fe_area = fap;
-        fcb->f_active.fe_elem_off = sizeof(struct fcb_disk_area);
+        fcb->f_active.fe_elem_off = fcb_first_elem_off(fcb);
         fcb->f_active_id++;
     }
     fcb->f_oldest = fcb_getnext_area(fcb, fcb->f_oldest);
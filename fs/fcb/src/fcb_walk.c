@@ -26,6 +26,13 @@
  */
 int
 fcb_walk(struct fcb *fcb, struct flash_area *fap, fcb_walk_cb cb, void *cb_arg)
+{
+    return fcb_walk_flags(fcb, fap, cb, cb_arg, 0);
+}
+
+int
+fcb_walk_flags(struct fcb *fcb, struct flash_area *fap, fcb_walk_cb cb,
+               void *cb_arg, uint8_t flags)
 {
     struct fcb_entry loc;
     int rc;
@@ -37,7 +44,7 @@ fcb_walk(struct fcb *fcb, struct flash_area *fap, fcb_walk_cb cb, void *cb_arg)
     if (rc && rc != OS_NOT_STARTED) {
         return FCB_ERR_ARGS;
     }
-    while ((rc = fcb_getnext_nolock(fcb, &loc)) != FCB_ERR_NOVAR) {
+    while ((rc = fcb_getnext_nolock(fcb, &loc, flags)) != FCB_ERR_NOVAR) {
         os_mutex_release(&fcb->f_mtx);
         if (fap && loc.fe_area != fap) {
             return 0;
@@ -33,6 +33,9 @@
 #if MYNEWT_VAL(SELFTEST)
 
 struct fcb test_fcb;
+#if MYNEWT_VAL(FCB_ERASE_CNT)
+uint32_t test_fcb_erase_cnt[4];
+#endif
 
 #if MYNEWT_VAL(SELFTEST)
 struct flash_area test_fcb_area[] = {
@@ -131,6 +134,9 @@ fcb_tc_pretest(void* arg)
     memset(fcb, 0, sizeof(*fcb));
     fcb->f_sector_cnt = (int)arg;
     fcb->f_sectors = test_fcb_area; /* XXX */
+#if MYNEWT_VAL(FCB_ERASE_CNT)
+    fcb->f_erase_cnt = test_fcb_erase_cnt;
+#endif
 
     rc = 0;
     rc = fcb_init(fcb);
@@ -158,6 +164,9 @@ TEST_CASE_DECL(fcb_test_reset)
 TEST_CASE_DECL(fcb_test_rotate)
 TEST_CASE_DECL(fcb_test_multiple_scratch)
 TEST_CASE_DECL(fcb_test_last_of_n)
+TEST_CASE_DECL(fcb_test_batch)
+TEST_CASE_DECL(fcb_test_erase_cnt)
+TEST_CASE_DECL(fcb_test_write)
 
 TEST_SUITE(fcb_test_all)
 {
@@ -190,6 +199,15 @@ TEST_SUITE(fcb_test_all)
 
     tu_case_set_pre_cb(fcb_tc_pretest, (void*)4);
     fcb_test_last_of_n();
+
+    tu_case_set_pre_cb(fcb_tc_pretest, (void*)2);
+    fcb_test_batch();
+
+    tu_case_set_pre_cb(fcb_tc_pretest, (void*)4);
+    fcb_test_erase_cnt();
+
+    tu_case_set_pre_cb(fcb_tc_pretest, (void*)2);
+    fcb_test_write();
 }
 
 #if MYNEWT_VAL(SELFTEST)
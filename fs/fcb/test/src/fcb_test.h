@@ -35,6 +35,9 @@
 extern struct fcb test_fcb;
 
 extern struct flash_area test_fcb_area[];
+#if MYNEWT_VAL(FCB_ERASE_CNT)
+extern uint32_t test_fcb_erase_cnt[];
+#endif
 
 struct append_arg {
     int *elem_cnts;
@@ -51,12 +51,12 @@ TEST_CASE(fcb_test_append_too_big)
     rc = fcb_append(fcb, len, &elem_loc);
     TEST_ASSERT(rc != 0);
 
-    len -= sizeof(struct fcb_disk_area);
+    len -= fcb_first_elem_off(fcb);
     rc = fcb_append(fcb, len, &elem_loc);
     TEST_ASSERT(rc != 0);
 
     len = fcb->f_active.fe_area->fa_size -
-      (sizeof(struct fcb_disk_area) + 1 + 2);
+      (fcb_first_elem_off(fcb) + 1 + 2);
     rc = fcb_append(fcb, len, &elem_loc);
     TEST_ASSERT(rc == 0);
 
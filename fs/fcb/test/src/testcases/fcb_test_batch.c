@@ -0,0 +1,104 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb_test.h"
+
+TEST_CASE(fcb_test_batch)
+{
+    int rc;
+    struct fcb *fcb;
+    struct fcb_batch fb;
+    uint8_t batch_buf[256];
+    uint8_t test_data[128];
+    int elem_cnts[2] = {0, 0};
+    struct append_arg aa = {
+        .elem_cnts = elem_cnts
+    };
+    int i;
+    int j;
+    int var_cnt;
+
+    fcb = &test_fcb;
+
+    rc = fcb_batch_init(fcb, &fb, batch_buf, 2);
+    TEST_ASSERT(rc == FCB_ERR_ARGS);
+    rc = fcb_batch_init(fcb, &fb, batch_buf, sizeof(batch_buf));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*
+     * Element which does not fit in staging buffer.
+     */
+    rc = fcb_batch_append(fcb, &fb, test_data, sizeof(batch_buf));
+    TEST_ASSERT(rc == FCB_ERR_NOMEM);
+
+    for (i = 0; i < sizeof(test_data); i++) {
+        for (j = 0; j < i; j++) {
+            test_data[j] = fcb_test_append_data(i, j);
+        }
+        rc = fcb_batch_append(fcb, &fb, test_data, i);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT(fb.fb_cnt > 0);
+
+    /*
+     * Staged elements are not visible until flushed.
+     */
+    var_cnt = 0;
+    rc = fcb_walk(fcb, 0, fcb_test_data_walk_cb, &var_cnt);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(var_cnt == sizeof(test_data) - fb.fb_cnt);
+
+    rc = fcb_batch_flush(fcb, &fb);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fb.fb_cnt == 0 && fb.fb_used == 0);
+
+    var_cnt = 0;
+    rc = fcb_walk(fcb, 0, fcb_test_data_walk_cb, &var_cnt);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(var_cnt == sizeof(test_data));
+
+    /*
+     * Fill up the rest; batch should spill over to the second sector
+     * and report no space when both are full.
+     */
+    for (i = 0; i < sizeof(test_data); i++) {
+        test_data[i] = fcb_test_append_data(sizeof(test_data), i);
+    }
+    while (1) {
+        rc = fcb_batch_append(fcb, &fb, test_data, sizeof(test_data));
+        if (rc == FCB_ERR_NOSPACE) {
+            break;
+        }
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT(fb.fb_cnt > 0);
+
+    rc = fcb_walk(fcb, NULL, fcb_test_cnt_elems_cb, &aa);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(elem_cnts[0] > 0);
+    TEST_ASSERT(elem_cnts[1] > 0);
+
+    /*
+     * After rotation the leftovers can be written out.
+     */
+    rc = fcb_rotate(fcb);
+    TEST_ASSERT(rc == 0);
+    rc = fcb_batch_flush(fcb, &fb);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fb.fb_cnt == 0);
+}
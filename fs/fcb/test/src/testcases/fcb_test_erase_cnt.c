@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb_test.h"
+
+TEST_CASE(fcb_test_erase_cnt)
+{
+#if MYNEWT_VAL(FCB_ERASE_CNT)
+    struct fcb *fcb;
+    struct fcb_entry loc;
+    uint8_t test_data[128];
+    int rc;
+    int i;
+
+    fcb = &test_fcb;
+
+    for (i = 0; i < fcb->f_sector_cnt; i++) {
+        TEST_ASSERT(test_fcb_erase_cnt[i] == 0);
+    }
+
+    /*
+     * Fill up, and rotate every sector twice.
+     */
+    memset(test_data, 0xa5, sizeof(test_data));
+    for (i = 0; i < 2 * fcb->f_sector_cnt; i++) {
+        while (1) {
+            rc = fcb_append(fcb, sizeof(test_data), &loc);
+            if (rc == FCB_ERR_NOSPACE) {
+                break;
+            }
+            TEST_ASSERT_FATAL(rc == 0);
+            rc = flash_area_write(loc.fe_area, loc.fe_data_off, test_data,
+              sizeof(test_data));
+            TEST_ASSERT(rc == 0);
+            rc = fcb_append_finish(fcb, &loc);
+            TEST_ASSERT(rc == 0);
+        }
+        rc = fcb_rotate(fcb);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    for (i = 0; i < fcb->f_sector_cnt; i++) {
+        TEST_ASSERT(test_fcb_erase_cnt[i] == 2);
+    }
+
+    /*
+     * Counters should survive restart. Sectors with header carry their own
+     * count, blank sectors get the maximum.
+     */
+    memset(test_fcb_erase_cnt, 0, fcb->f_sector_cnt * sizeof(uint32_t));
+    rc = fcb_init(fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (i = 0; i < fcb->f_sector_cnt; i++) {
+        TEST_ASSERT(test_fcb_erase_cnt[i] == 2);
+    }
+#endif
+}
@@ -30,6 +30,9 @@ TEST_CASE(fcb_test_init)
     TEST_ASSERT(rc == FCB_ERR_ARGS);
 
     fcb->f_sectors = test_fcb_area;
+#if MYNEWT_VAL(FCB_ERASE_CNT)
+    fcb->f_erase_cnt = test_fcb_erase_cnt;
+#endif
 
     rc = fcb_init(fcb);
     TEST_ASSERT(rc == FCB_ERR_ARGS);
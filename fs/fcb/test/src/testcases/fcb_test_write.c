@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb_test.h"
+
+TEST_CASE(fcb_test_write)
+{
+    int rc;
+    struct fcb *fcb;
+    struct fcb_entry loc;
+    uint8_t test_data[128];
+    uint8_t crc8;
+    int elem_cnts[2];
+    struct append_arg aa = {
+        .elem_cnts = elem_cnts
+    };
+    int half;
+    int i;
+    int j;
+    int var_cnt;
+
+    fcb = &test_fcb;
+
+    for (i = 0; i < sizeof(test_data); i++) {
+        for (j = 0; j < i; j++) {
+            test_data[j] = fcb_test_append_data(i, j);
+        }
+        rc = fcb_append(fcb, i, &loc);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        /*
+         * Odd elements are written out of order, so CRC has to be computed
+         * by reading the element back.
+         */
+        half = i / 2;
+        if (i & 1) {
+            rc = fcb_write(fcb, &loc, half, test_data + half, i - half);
+            TEST_ASSERT(rc == 0);
+            rc = fcb_write(fcb, &loc, 0, test_data, half);
+            TEST_ASSERT(rc == 0);
+            TEST_ASSERT(loc.fe_crc_len != loc.fe_data_len);
+        } else {
+            rc = fcb_write(fcb, &loc, 0, test_data, half);
+            TEST_ASSERT(rc == 0);
+            rc = fcb_write(fcb, &loc, half, test_data + half, i - half);
+            TEST_ASSERT(rc == 0);
+            TEST_ASSERT(loc.fe_crc_len == loc.fe_data_len);
+        }
+        rc = fcb_write(fcb, &loc, i, test_data, 1);
+        TEST_ASSERT(rc == FCB_ERR_ARGS);
+
+        rc = fcb_append_finish(fcb, &loc);
+        TEST_ASSERT(rc == 0);
+    }
+
+    var_cnt = 0;
+    rc = fcb_walk(fcb, 0, fcb_test_data_walk_cb, &var_cnt);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(var_cnt == sizeof(test_data));
+    TEST_ASSERT(fcb_crc_err_cnt(fcb) == 0);
+
+    /*
+     * Append an element with bad CRC. Verifying walk skips it and counts
+     * the failure, walk without CRC check reports it.
+     */
+    rc = fcb_append(fcb, 4, &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fcb_write(fcb, &loc, 0, test_data, 4);
+    TEST_ASSERT(rc == 0);
+    crc8 = ~loc.fe_crc8;
+    rc = flash_area_write(loc.fe_area,
+      loc.fe_data_off + fcb_len_in_flash(fcb, 4), &crc8, sizeof(crc8));
+    TEST_ASSERT(rc == 0);
+
+    memset(elem_cnts, 0, sizeof(elem_cnts));
+    rc = fcb_walk(fcb, NULL, fcb_test_cnt_elems_cb, &aa);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(elem_cnts[0] + elem_cnts[1] == sizeof(test_data));
+    TEST_ASSERT(fcb_crc_err_cnt(fcb) == 1);
+
+    memset(elem_cnts, 0, sizeof(elem_cnts));
+    rc = fcb_walk_flags(fcb, NULL, fcb_test_cnt_elems_cb, &aa,
+      FCB_WALK_F_NOCRC);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(elem_cnts[0] + elem_cnts[1] == sizeof(test_data) + 1);
+    TEST_ASSERT(fcb_crc_err_cnt(fcb) == 1);
+}
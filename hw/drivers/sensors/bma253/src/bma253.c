@@ -4656,6 +4656,129 @@ sensor_driver_handle_interrupt(struct sensor * sensor)
 #endif
 }
 
+/**
+ * Reads all frames in the FIFO with a single burst read of FIFO_DATA.
+ * Reads the current sample when the FIFO is bypassed.
+ */
+static int
+sensor_driver_read_batch(struct sensor * sensor,
+                         sensor_type_t sensor_type,
+                         void * data,
+                         uint16_t max,
+                         uint16_t * cnt,
+                         uint32_t * sample_us)
+{
+    struct bma253 *bma253;
+    struct sensor_accel_data *sad;
+    enum bma253_power_mode request_power[3];
+    struct fifo_cfg fifo_cfg;
+    struct accel_data accel_data[AXIS_ALL];
+    float accel_scale;
+    uint8_t raw[32 * (AXIS_ALL << 1)];
+    uint8_t frames;
+    bool overrun;
+    int rc;
+    int i;
+    int j;
+
+    if (sensor_type != SENSOR_TYPE_ACCELEROMETER) {
+        return SYS_EINVAL;
+    }
+
+    bma253 = (struct bma253 *)SENSOR_GET_DEVICE(sensor);
+
+    switch (bma253->cfg.g_range) {
+    case BMA253_G_RANGE_2:
+        accel_scale = 0.00098;
+        break;
+    case BMA253_G_RANGE_4:
+        accel_scale = 0.00195;
+        break;
+    case BMA253_G_RANGE_8:
+        accel_scale = 0.00391;
+        break;
+    case BMA253_G_RANGE_16:
+        accel_scale = 0.00781;
+        break;
+    default:
+        return SYS_EINVAL;
+    }
+
+    if (bma253->cfg.filter_bandwidth <= BMA253_FILTER_BANDWIDTH_1000_HZ) {
+        *sample_us = 64000 >> bma253->cfg.filter_bandwidth;
+    }
+
+    request_power[0] = BMA253_POWER_MODE_LPM_1;
+    request_power[1] = BMA253_POWER_MODE_LPM_2;
+    request_power[2] = BMA253_POWER_MODE_NORMAL;
+
+    rc = interim_power(bma253,
+                       request_power,
+                       sizeof(request_power) / sizeof(*request_power));
+    if (rc != 0) {
+        return rc;
+    }
+
+    rc = bma253_get_fifo_cfg(bma253, &fifo_cfg);
+    if (rc != 0) {
+        goto done;
+    }
+    if (fifo_cfg.fifo_data != FIFO_DATA_X_AND_Y_AND_Z) {
+        rc = SYS_ENOTSUP;
+        goto done;
+    }
+
+    if (fifo_cfg.fifo_mode == FIFO_MODE_BYPASS) {
+        frames = 1;
+    } else {
+        rc = bma253_get_fifo_status(bma253, &overrun, &frames);
+        if (rc != 0) {
+            goto done;
+        }
+    }
+    if (frames > max) {
+        frames = max;
+    }
+    if (frames > sizeof(raw) / (AXIS_ALL << 1)) {
+        frames = sizeof(raw) / (AXIS_ALL << 1);
+    }
+
+    *cnt = 0;
+    if (frames == 0) {
+        goto done;
+    }
+
+    rc = get_registers(bma253, REG_ADDR_FIFO_DATA, raw,
+                       frames * (AXIS_ALL << 1));
+    if (rc != 0) {
+        goto done;
+    }
+
+    sad = data;
+    for (i = 0; i < frames; i++) {
+        for (j = 0; j < AXIS_ALL; j++) {
+            compute_accel_data(accel_data + j,
+                               raw + (i * AXIS_ALL + j) * 2,
+                               accel_scale);
+        }
+
+        sad[i].sad_x = accel_data[AXIS_X].accel_g;
+        sad[i].sad_y = accel_data[AXIS_Y].accel_g;
+        sad[i].sad_z = accel_data[AXIS_Z].accel_g;
+        sad[i].sad_x_is_valid = 1;
+        sad[i].sad_y_is_valid = 1;
+        sad[i].sad_z_is_valid = 1;
+    }
+    *cnt = frames;
+
+done:
+    if (default_power(bma253) != 0 && rc == 0) {
+        rc = SYS_EIO;
+    }
+
+    return rc;
+}
+
 static struct sensor_driver bma253_sensor_driver = {
     .sd_read               = sensor_driver_read,
     .sd_set_config         = sensor_driver_set_config,
@@ -4664,6 +4787,7 @@ static struct sensor_driver bma253_sensor_driver = {
     .sd_set_notification   = sensor_driver_set_notification,
     .sd_unset_notification = sensor_driver_unset_notification,
     .sd_handle_interrupt   = sensor_driver_handle_interrupt,
+    .sd_read_batch         = sensor_driver_read_batch,
 };
 
 int
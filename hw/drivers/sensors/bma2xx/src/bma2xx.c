@@ -4811,6 +4811,120 @@ sensor_driver_handle_interrupt(struct sensor * sensor)
 #endif
 }
 
+/**
+ * Reads all frames in the FIFO with a single burst read of FIFO_DATA.
+ * Reads the current sample when the FIFO is bypassed.
+ */
+static int
+sensor_driver_read_batch(struct sensor * sensor,
+                         sensor_type_t sensor_type,
+                         void * data,
+                         uint16_t max,
+                         uint16_t * cnt,
+                         uint32_t * sample_us)
+{
+    struct bma2xx *bma2xx;
+    struct sensor_accel_data *sad;
+    enum bma2xx_power_mode request_power[3];
+    struct fifo_cfg fifo_cfg;
+    struct accel_data accel_data[AXIS_ALL];
+    float accel_scale;
+    uint8_t raw[32 * (AXIS_ALL << 1)];
+    uint8_t frames;
+    bool overrun;
+    int rc;
+    int i;
+    int j;
+
+    if (sensor_type != SENSOR_TYPE_ACCELEROMETER) {
+        return SYS_EINVAL;
+    }
+
+    bma2xx = (struct bma2xx *)SENSOR_GET_DEVICE(sensor);
+
+    rc = get_accel_scale(bma2xx->cfg.model, bma2xx->cfg.g_range,
+                         &accel_scale);
+    if (rc != 0) {
+        return SYS_EINVAL;
+    }
+
+    if (bma2xx->cfg.filter_bandwidth <= BMA2XX_FILTER_BANDWIDTH_1000_HZ) {
+        *sample_us = 64000 >> bma2xx->cfg.filter_bandwidth;
+    } else if (bma2xx->cfg.filter_bandwidth ==
+               BMA2XX_FILTER_BANDWIDTH_ODR_MAX) {
+        *sample_us = 500;
+    }
+
+    request_power[0] = BMA2XX_POWER_MODE_LPM_1;
+    request_power[1] = BMA2XX_POWER_MODE_LPM_2;
+    request_power[2] = BMA2XX_POWER_MODE_NORMAL;
+
+    rc = interim_power(bma2xx,
+                       request_power,
+                       sizeof(request_power) / sizeof(*request_power));
+    if (rc != 0) {
+        return rc;
+    }
+
+    rc = bma2xx_get_fifo_cfg(bma2xx, &fifo_cfg);
+    if (rc != 0) {
+        goto done;
+    }
+    if (fifo_cfg.fifo_data != FIFO_DATA_X_AND_Y_AND_Z) {
+        rc = SYS_ENOTSUP;
+        goto done;
+    }
+
+    if (fifo_cfg.fifo_mode == FIFO_MODE_BYPASS) {
+        frames = 1;
+    } else {
+        rc = bma2xx_get_fifo_status(bma2xx, &overrun, &frames);
+        if (rc != 0) {
+            goto done;
+        }
+    }
+    if (frames > max) {
+        frames = max;
+    }
+    if (frames > sizeof(raw) / (AXIS_ALL << 1)) {
+        frames = sizeof(raw) / (AXIS_ALL << 1);
+    }
+
+    *cnt = 0;
+    if (frames == 0) {
+        goto done;
+    }
+
+    rc = get_registers(bma2xx, REG_ADDR_FIFO_DATA, raw,
+                       frames * (AXIS_ALL << 1));
+    if (rc != 0) {
+        goto done;
+    }
+
+    sad = data;
+    for (i = 0; i < frames; i++) {
+        for (j = 0; j < AXIS_ALL; j++) {
+            compute_accel_data(accel_data + j, bma2xx->cfg.model,
+                               raw + (i * AXIS_ALL + j) * 2, accel_scale);
+        }
+
+        sad[i].sad_x = accel_data[AXIS_X].accel_g;
+        sad[i].sad_y = accel_data[AXIS_Y].accel_g;
+        sad[i].sad_z = accel_data[AXIS_Z].accel_g;
+        sad[i].sad_x_is_valid = 1;
+        sad[i].sad_y_is_valid = 1;
+        sad[i].sad_z_is_valid = 1;
+    }
+    *cnt = frames;
+
+done:
+    if (default_power(bma2xx) != 0 && rc == 0) {
+        rc = SYS_EIO;
+    }
+
+    return rc;
+}
+
 static struct sensor_driver bma2xx_sensor_driver = {
     .sd_read               = sensor_driver_read,
     .sd_get_config         = sensor_driver_get_config,
@@ -4818,6 +4932,7 @@ static struct sensor_driver bma2xx_sensor_driver = {
     .sd_set_notification   = sensor_driver_set_notification,
     .sd_unset_notification = sensor_driver_unset_notification,
     .sd_handle_interrupt   = sensor_driver_handle_interrupt,
+    .sd_read_batch         = sensor_driver_read_batch,
 };
 
 int
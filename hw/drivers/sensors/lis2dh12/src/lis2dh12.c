@@ -72,6 +72,9 @@ lis2dh12_sensor_clear_low_thresh(struct sensor *, sensor_type_t);
 
 static int
 lis2dh12_sensor_clear_high_thresh(struct sensor *, sensor_type_t);
+static int
+lis2dh12_sensor_read_batch(struct sensor *, sensor_type_t, void *, uint16_t,
+                           uint16_t *, uint32_t *);
 
 static const struct sensor_driver g_lis2dh12_sensor_driver = {
     .sd_read = lis2dh12_sensor_read,
@@ -79,7 +82,8 @@ static const struct sensor_driver g_lis2dh12_sensor_driver = {
     /* Setting trigger threshold is optional */
     .sd_set_trigger_thresh = lis2dh12_sensor_set_trigger_thresh,
     .sd_clear_low_trigger_thresh = lis2dh12_sensor_clear_low_thresh,
-    .sd_clear_high_trigger_thresh = lis2dh12_sensor_clear_high_thresh
+    .sd_clear_high_trigger_thresh = lis2dh12_sensor_clear_high_thresh,
+    .sd_read_batch = lis2dh12_sensor_read_batch,
 };
 
 /**
@@ -97,16 +101,21 @@ lis2dh12_i2c_readlen(struct sensor_itf *itf, uint8_t addr, uint8_t *buffer,
                      uint8_t len)
 {
     int rc;
-    uint8_t payload[20] = { addr, 0, 0, 0, 0, 0, 0, 0,
-                              0, 0, 0, 0, 0, 0, 0, 0,
-                              0, 0, 0, 0};
 
     struct hal_i2c_master_data data_struct = {
         .address = itf->si_addr,
         .len = 1,
-        .buffer = payload
+        .buffer = &addr
     };
 
+    /*
+     * Auto register address increment is needed if the length
+     * requested is more than 1
+     */
+    if (len > 1) {
+        addr |= LIS2DH12_I2C_ADR_INC;
+    }
+
     /* Clear the supplied buffer */
     memset(buffer, 0, len);
 
@@ -119,9 +128,9 @@ lis2dh12_i2c_readlen(struct sensor_itf *itf, uint8_t addr, uint8_t *buffer,
         goto err;
     }
 
-    /* Read len bytes back */
-    memset(payload, 0, sizeof(payload));
+    /* Read len bytes back into the supplied buffer */
     data_struct.len = len;
+    data_struct.buffer = buffer;
     rc = hal_i2c_master_read(itf->si_num, &data_struct, OS_TICKS_PER_SEC / 10, 1);
     if (rc) {
         LIS2DH12_LOG(ERROR, "Failed to read from 0x%02X:0x%02X\n",
@@ -130,9 +139,6 @@ lis2dh12_i2c_readlen(struct sensor_itf *itf, uint8_t addr, uint8_t *buffer,
         goto err;
     }
 
-    /* Copy the I2C results into the supplied buffer */
-    memcpy(buffer, payload, len);
-
     return 0;
 err:
 
@@ -1049,6 +1055,128 @@ err:
     return rc;
 }
 
+/* Sample periods in microseconds, indexed by CTRL_REG1 ODR >> 4 */
+static const uint32_t lis2dh12_rate_us[] = {
+    0, 1000000, 100000, 40000, 20000, 10000, 5000, 2500, 617, 744
+};
+
+/**
+ * Reads all samples in the FIFO with a single burst read; the address
+ * rolls back from OUT_Z_H to OUT_X_L while the FIFO is enabled.  Reads the
+ * current sample when the FIFO is bypassed.
+ */
+static int
+lis2dh12_sensor_read_batch(struct sensor *sensor, sensor_type_t type,
+                           void *data, uint16_t max, uint16_t *cnt,
+                           uint32_t *sample_us)
+{
+    struct sensor_accel_data *sad;
+    struct sensor_itf *itf;
+    uint8_t payload[32 * 6];
+    uint8_t samples;
+    uint8_t reg;
+    uint8_t fs;
+    int16_t x, y, z;
+    float fx, fy, fz;
+    int rc;
+    int i;
+
+    if (type != SENSOR_TYPE_ACCELEROMETER) {
+        return SYS_EINVAL;
+    }
+
+    itf = SENSOR_GET_ITF(sensor);
+
+    if (itf->si_type == SENSOR_ITF_SPI) {
+        rc = hal_spi_disable(sensor->s_itf.si_num);
+        if (rc) {
+            return rc;
+        }
+
+        rc = hal_spi_config(sensor->s_itf.si_num, &spi_lis2dh12_settings);
+        if (rc == EINVAL) {
+            return rc;
+        }
+
+        rc = hal_spi_enable(sensor->s_itf.si_num);
+        if (rc) {
+            return rc;
+        }
+    }
+
+    rc = lis2dh12_get_rate(itf, &reg);
+    if (rc) {
+        return rc;
+    }
+    reg >>= 4;
+    if (reg < sizeof(lis2dh12_rate_us) / sizeof(lis2dh12_rate_us[0])) {
+        *sample_us = lis2dh12_rate_us[reg];
+    }
+
+    rc = lis2dh12_get_full_scale(itf, &fs);
+    if (rc) {
+        return rc;
+    }
+    fs = 2 << fs;
+
+    rc = lis2dh12_readlen(itf, LIS2DH12_REG_FIFO_CTRL_REG, &reg, 1);
+    if (rc) {
+        return rc;
+    }
+    if ((reg & LIS2DH12_FIFO_CTRL_REG_FM) == LIS2DH12_FIFO_M_BYPASS) {
+        samples = 1;
+    } else {
+        rc = lis2dh12_readlen(itf, LIS2DH12_REG_FIFO_SRC_REG, &reg, 1);
+        if (rc) {
+            return rc;
+        }
+        if (reg & LIS2DH12_FIFO_SRC_OVRN_FIFO) {
+            samples = 32;
+        } else {
+            samples = reg & LIS2DH12_FIFO_SRC_FSS;
+        }
+    }
+    if (samples > max) {
+        samples = max;
+    }
+
+    *cnt = 0;
+    if (samples == 0) {
+        return 0;
+    }
+
+    rc = lis2dh12_readlen(itf, LIS2DH12_REG_OUT_X_L, payload, samples * 6);
+    if (rc) {
+        return rc;
+    }
+
+    sad = data;
+    for (i = 0; i < samples; i++) {
+        x = payload[i * 6] | (payload[i * 6 + 1] << 8);
+        y = payload[i * 6 + 2] | (payload[i * 6 + 3] << 8);
+        z = payload[i * 6 + 4] | (payload[i * 6 + 5] << 8);
+
+        /* Same scaling as lis2dh12_get_data() */
+        x = (fs * 2 * 1000 * x)/UINT16_MAX;
+        y = (fs * 2 * 1000 * y)/UINT16_MAX;
+        z = (fs * 2 * 1000 * z)/UINT16_MAX;
+
+        lis2dh12_calc_acc_ms2(x, &fx);
+        lis2dh12_calc_acc_ms2(y, &fy);
+        lis2dh12_calc_acc_ms2(z, &fz);
+
+        sad[i].sad_x = fx;
+        sad[i].sad_y = fy;
+        sad[i].sad_z = fz;
+        sad[i].sad_x_is_valid = 1;
+        sad[i].sad_y_is_valid = 1;
+        sad[i].sad_z_is_valid = 1;
+    }
+    *cnt = samples;
+
+    return 0;
+}
+
 static int
 lis2dh12_sensor_get_config(struct sensor *sensor, sensor_type_t type,
         struct sensor_cfg *cfg)
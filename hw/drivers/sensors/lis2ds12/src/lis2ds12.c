@@ -95,6 +95,8 @@ static int lis2ds12_sensor_unset_notification(struct sensor *,
                                               sensor_event_type_t);
 static int lis2ds12_sensor_handle_interrupt(struct sensor *);
 static int lis2ds12_sensor_set_config(struct sensor *, void *);
+static int lis2ds12_sensor_read_batch(struct sensor *, sensor_type_t, void *,
+                                      uint16_t, uint16_t *, uint32_t *);
 
 static const struct sensor_driver g_lis2ds12_sensor_driver = {
     .sd_read = lis2ds12_sensor_read,
@@ -102,8 +104,8 @@ static const struct sensor_driver g_lis2ds12_sensor_driver = {
     .sd_get_config = lis2ds12_sensor_get_config,
     .sd_set_notification = lis2ds12_sensor_set_notification,
     .sd_unset_notification = lis2ds12_sensor_unset_notification,
-    .sd_handle_interrupt = lis2ds12_sensor_handle_interrupt
-
+    .sd_handle_interrupt = lis2ds12_sensor_handle_interrupt,
+    .sd_read_batch = lis2ds12_sensor_read_batch,
 };
 
 /**
@@ -2435,6 +2437,157 @@ lis2ds12_sensor_handle_interrupt(struct sensor *sensor)
     return 0;
 }
 
+/**
+ * Sample period in microseconds for a CTRL_REG1 rate, 0 if off
+ */
+static uint32_t
+lis2ds12_rate_us(uint8_t rate)
+{
+    switch (rate) {
+    case LIS2DS12_DATA_RATE_LP_10BIT_1HZ:
+        return 1000000;
+    case LIS2DS12_DATA_RATE_LP_10BIT_12_5HZ:
+    case LIS2DS12_DATA_RATE_HR_14BIT_12_5HZ:
+        return 80000;
+    case LIS2DS12_DATA_RATE_LP_10BIT_25HZ:
+    case LIS2DS12_DATA_RATE_HR_14BIT_25HZ:
+        return 40000;
+    case LIS2DS12_DATA_RATE_LP_10BIT_50HZ:
+    case LIS2DS12_DATA_RATE_HR_14BIT_50HZ:
+        return 20000;
+    case LIS2DS12_DATA_RATE_LP_10BIT_100HZ:
+    case LIS2DS12_DATA_RATE_HR_14BIT_100HZ:
+        return 10000;
+    case LIS2DS12_DATA_RATE_LP_10BIT_200HZ:
+    case LIS2DS12_DATA_RATE_HR_14BIT_200HZ:
+        return 5000;
+    case LIS2DS12_DATA_RATE_LP_10BIT_400HZ:
+    case LIS2DS12_DATA_RATE_HR_14BIT_400HZ:
+        return 2500;
+    case LIS2DS12_DATA_RATE_HR_14BIT_800HZ:
+        return 1250;
+    case LIS2DS12_DATA_RATE_HR_12BIT_1600HZ:
+        return 625;
+    case LIS2DS12_DATA_RATE_HR_12BIT_3200HZ:
+        return 313;
+    case LIS2DS12_DATA_RATE_HR_12BIT_6400HZ:
+        return 156;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Reads all samples in the FIFO, oldest first.  The FIFO holds up to 256
+ * samples, more than one bus read can return; they are burst read 32 at a
+ * time.  Reads the current sample when the FIFO is bypassed.
+ */
+static int
+lis2ds12_sensor_read_batch(struct sensor *sensor, sensor_type_t type,
+                           void *data, uint16_t max, uint16_t *cnt,
+                           uint32_t *sample_us)
+{
+    struct sensor_accel_data *sad;
+    struct lis2ds12 *lis2ds12;
+    struct sensor_itf *itf;
+    uint8_t payload[32 * 6];
+    uint16_t samples;
+    uint16_t chunk;
+    uint8_t rate;
+    uint8_t fs;
+    int16_t x, y, z;
+    float fx, fy, fz;
+    int rc;
+    int i;
+
+    if (type != SENSOR_TYPE_ACCELEROMETER) {
+        return SYS_EINVAL;
+    }
+
+    lis2ds12 = (struct lis2ds12 *)SENSOR_GET_DEVICE(sensor);
+    itf = SENSOR_GET_ITF(sensor);
+
+    if (itf->si_type == SENSOR_ITF_SPI) {
+        rc = hal_spi_disable(sensor->s_itf.si_num);
+        if (rc) {
+            return rc;
+        }
+
+        rc = hal_spi_config(sensor->s_itf.si_num, &spi_lis2ds12_settings);
+        if (rc == EINVAL) {
+            return rc;
+        }
+
+        rc = hal_spi_enable(sensor->s_itf.si_num);
+        if (rc) {
+            return rc;
+        }
+    }
+
+    rc = lis2ds12_get_rate(itf, &rate);
+    if (rc) {
+        return rc;
+    }
+    *sample_us = lis2ds12_rate_us(rate);
+
+    rc = lis2ds12_get_fs(itf, &fs);
+    if (rc) {
+        return rc;
+    }
+
+    if (lis2ds12->cfg.fifo_mode == LIS2DS12_FIFO_M_BYPASS) {
+        samples = 1;
+    } else {
+        rc = lis2ds12_get_fifo_samples(itf, &samples);
+        if (rc) {
+            return rc;
+        }
+    }
+    if (samples > max) {
+        samples = max;
+    }
+
+    sad = data;
+    *cnt = 0;
+    while (*cnt < samples) {
+        chunk = samples - *cnt;
+        if (chunk > sizeof(payload) / 6) {
+            chunk = sizeof(payload) / 6;
+        }
+
+        rc = lis2ds12_readlen(itf, LIS2DS12_REG_OUT_X_L, payload, chunk * 6);
+        if (rc) {
+            return rc;
+        }
+
+        for (i = 0; i < chunk; i++) {
+            x = payload[i * 6] | (payload[i * 6 + 1] << 8);
+            y = payload[i * 6 + 2] | (payload[i * 6 + 3] << 8);
+            z = payload[i * 6 + 4] | (payload[i * 6 + 5] << 8);
+
+            /* Same scaling as lis2ds12_get_data() */
+            x = (fs * 2 * 1000 * x)/UINT16_MAX;
+            y = (fs * 2 * 1000 * y)/UINT16_MAX;
+            z = (fs * 2 * 1000 * z)/UINT16_MAX;
+
+            lis2ds12_calc_acc_ms2(x, &fx);
+            lis2ds12_calc_acc_ms2(y, &fy);
+            lis2ds12_calc_acc_ms2(z, &fz);
+
+            sad->sad_x = fx;
+            sad->sad_y = fy;
+            sad->sad_z = fz;
+            sad->sad_x_is_valid = 1;
+            sad->sad_y_is_valid = 1;
+            sad->sad_z_is_valid = 1;
+            sad++;
+        }
+        *cnt += chunk;
+    }
+
+    return 0;
+}
+
 static int
 lis2ds12_sensor_get_config(struct sensor *sensor, sensor_type_t type,
         struct sensor_cfg *cfg)
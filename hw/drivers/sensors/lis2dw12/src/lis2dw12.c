@@ -162,6 +162,8 @@ static int lis2dw12_sensor_unset_notification(struct sensor *,
                                               sensor_event_type_t);
 static int lis2dw12_sensor_handle_interrupt(struct sensor *);
 static int lis2dw12_sensor_set_config(struct sensor *, void *);
+static int lis2dw12_sensor_read_batch(struct sensor *, sensor_type_t, void *,
+                                      uint16_t, uint16_t *, uint32_t *);
 
 static const struct sensor_driver g_lis2dw12_sensor_driver = {
     .sd_read               = lis2dw12_sensor_read,
@@ -169,8 +171,8 @@ static const struct sensor_driver g_lis2dw12_sensor_driver = {
     .sd_get_config         = lis2dw12_sensor_get_config,
     .sd_set_notification   = lis2dw12_sensor_set_notification,
     .sd_unset_notification = lis2dw12_sensor_unset_notification,
-    .sd_handle_interrupt   = lis2dw12_sensor_handle_interrupt
-
+    .sd_handle_interrupt   = lis2dw12_sensor_handle_interrupt,
+    .sd_read_batch         = lis2dw12_sensor_read_batch,
 };
 
 /**
@@ -3014,6 +3016,123 @@ err:
     return rc;
 }
 
+/* Sample periods in microseconds, indexed by CTRL_REG1 ODR >> 4 */
+static const uint32_t lis2dw12_rate_us[] = {
+    0, 625000, 80000, 40000, 20000, 10000, 5000, 2500, 1250, 625
+};
+
+/**
+ * Reads all samples in the FIFO with a single burst read; the address
+ * rolls back from OUT_Z_H to OUT_X_L while the FIFO is enabled.  Reads the
+ * current sample when the FIFO is bypassed.
+ */
+static int
+lis2dw12_sensor_read_batch(struct sensor *sensor, sensor_type_t type,
+                           void *data, uint16_t max, uint16_t *cnt,
+                           uint32_t *sample_us)
+{
+    struct sensor_accel_data *sad;
+    struct lis2dw12 *lis2dw12;
+    struct sensor_itf *itf;
+    uint8_t payload[32 * 6];
+    uint8_t samples;
+    uint8_t rate;
+    uint8_t fs;
+    int16_t x, y, z;
+    float fx, fy, fz;
+    int rc;
+    int i;
+
+    if (type != SENSOR_TYPE_ACCELEROMETER) {
+        return SYS_EINVAL;
+    }
+
+    lis2dw12 = (struct lis2dw12 *)SENSOR_GET_DEVICE(sensor);
+    itf = SENSOR_GET_ITF(sensor);
+
+    if (itf->si_type == SENSOR_ITF_SPI) {
+        rc = hal_spi_disable(sensor->s_itf.si_num);
+        if (rc) {
+            return rc;
+        }
+
+        rc = hal_spi_config(sensor->s_itf.si_num, &spi_lis2dw12_settings);
+        if (rc == EINVAL) {
+            return rc;
+        }
+
+        rc = hal_spi_enable(sensor->s_itf.si_num);
+        if (rc) {
+            return rc;
+        }
+    }
+
+    rc = lis2dw12_get_rate(itf, &rate);
+    if (rc) {
+        return rc;
+    }
+    rate >>= 4;
+    if (rate < sizeof(lis2dw12_rate_us) / sizeof(lis2dw12_rate_us[0])) {
+        *sample_us = lis2dw12_rate_us[rate];
+    }
+
+    rc = lis2dw12_get_fs(itf, &fs);
+    if (rc) {
+        return rc;
+    }
+
+    if (lis2dw12->cfg.fifo_mode == LIS2DW12_FIFO_M_BYPASS) {
+        samples = 1;
+    } else {
+        rc = lis2dw12_get_fifo_samples(itf, &samples);
+        if (rc) {
+            return rc;
+        }
+    }
+    if (samples > max) {
+        samples = max;
+    }
+    if (samples > sizeof(payload) / 6) {
+        samples = sizeof(payload) / 6;
+    }
+
+    *cnt = 0;
+    if (samples == 0) {
+        return 0;
+    }
+
+    rc = lis2dw12_readlen(itf, LIS2DW12_REG_OUT_X_L, payload, samples * 6);
+    if (rc) {
+        return rc;
+    }
+
+    sad = data;
+    for (i = 0; i < samples; i++) {
+        x = payload[i * 6] | (payload[i * 6 + 1] << 8);
+        y = payload[i * 6 + 2] | (payload[i * 6 + 3] << 8);
+        z = payload[i * 6 + 4] | (payload[i * 6 + 5] << 8);
+
+        /* Same scaling as lis2dw12_get_data() */
+        x = (fs * 2 * 1000 * x)/UINT16_MAX;
+        y = (fs * 2 * 1000 * y)/UINT16_MAX;
+        z = (fs * 2 * 1000 * z)/UINT16_MAX;
+
+        lis2dw12_calc_acc_ms2(x, &fx);
+        lis2dw12_calc_acc_ms2(y, &fy);
+        lis2dw12_calc_acc_ms2(z, &fz);
+
+        sad[i].sad_x = fx;
+        sad[i].sad_y = fy;
+        sad[i].sad_z = fz;
+        sad[i].sad_x_is_valid = 1;
+        sad[i].sad_y_is_valid = 1;
+        sad[i].sad_z_is_valid = 1;
+    }
+    *cnt = samples;
+
+    return 0;
+}
+
 static int
 lis2dw12_sensor_get_config(struct sensor *sensor, sensor_type_t type,
         struct sensor_cfg *cfg)
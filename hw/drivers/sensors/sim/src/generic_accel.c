@@ -34,10 +34,13 @@ static int sim_accel_sensor_read(struct sensor *, sensor_type_t,
         sensor_data_func_t, void *, uint32_t);
 static int sim_accel_sensor_get_config(struct sensor *, sensor_type_t,
         struct sensor_cfg *);
+static int sim_accel_sensor_read_batch(struct sensor *, sensor_type_t, void *,
+        uint16_t, uint16_t *, uint32_t *);
 
 static const struct sensor_driver g_sim_accel_sensor_driver = {
-    sim_accel_sensor_read,
-    sim_accel_sensor_get_config
+    .sd_read = sim_accel_sensor_read,
+    .sd_get_config = sim_accel_sensor_get_config,
+    .sd_read_batch = sim_accel_sensor_read_batch,
 };
 
 /**
@@ -150,6 +153,58 @@ err:
     return (rc);
 }
 
+/**
+ * Returns the samples generated since the last batch read, like a FIFO
+ * holding up to the configured number of samples.
+ */
+static int
+sim_accel_sensor_read_batch(struct sensor *sensor, sensor_type_t type,
+        void *data, uint16_t max, uint16_t *cnt, uint32_t *sample_us)
+{
+    struct sim_accel *sa;
+    struct sensor_accel_data *sad;
+    os_time_t now;
+    uint32_t num_samples;
+    int i;
+
+    if (type != SENSOR_TYPE_ACCELEROMETER) {
+        return (SYS_EINVAL);
+    }
+
+    sa = (struct sim_accel *) SENSOR_GET_DEVICE(sensor);
+    if (sa->sa_cfg.sac_sample_itvl == 0) {
+        return (SYS_EINVAL);
+    }
+
+    now = os_time_get();
+
+    num_samples = (now - sa->sa_last_read_time) / sa->sa_cfg.sac_sample_itvl;
+    if (num_samples > sa->sa_cfg.sac_nr_samples) {
+        /* The oldest samples were overwritten. */
+        num_samples = sa->sa_cfg.sac_nr_samples;
+        sa->sa_last_read_time = now - num_samples * sa->sa_cfg.sac_sample_itvl;
+    }
+    num_samples = min(num_samples, max);
+    sa->sa_last_read_time += num_samples * sa->sa_cfg.sac_sample_itvl;
+
+    sad = data;
+    for (i = 0; i < num_samples; i++) {
+        sad[i].sad_x = 0.0;
+        sad[i].sad_y = 0.0;
+        sad[i].sad_z = 0.0;
+
+        sad[i].sad_x_is_valid = 1;
+        sad[i].sad_y_is_valid = sa->sa_cfg.sac_nr_axises > 1;
+        sad[i].sad_z_is_valid = sa->sa_cfg.sac_nr_axises > 2;
+    }
+
+    *cnt = num_samples;
+    *sample_us = (uint32_t)sa->sa_cfg.sac_sample_itvl * 1000000 /
+                 OS_TICKS_PER_SEC;
+
+    return (0);
+}
+
 static int
 sim_accel_sensor_get_config(struct sensor *sensor, sensor_type_t type,
         struct sensor_cfg *cfg)
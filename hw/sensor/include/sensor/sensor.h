@@ -278,6 +278,192 @@ struct sensor_listener {
     SLIST_ENTRY(sensor_listener) sl_next;
 };
 
+/**
+ * Samples read with sensor_read_batch()
+ */
+struct sensor_batch {
+    /* The type of sensor data */
+    sensor_type_t sb_type;
+
+    /* Array of sb_cnt samples, oldest first, of the data structure for
+     * sb_type (e.g. struct sensor_accel_data)
+     */
+    void *sb_data;
+
+    /* Number of samples */
+    uint16_t sb_cnt;
+
+    /* Time of the first sample, in cputime */
+    uint32_t sb_cputime;
+
+    /* Time between samples, in cputime ticks. Interpolated from the times
+     * the samples were read at.
+     */
+    uint32_t sb_interval;
+};
+
+/**
+ * Cputime of a sample in a batch.
+ *
+ * @param sb The batch
+ * @param idx Index of the sample
+ */
+#define SENSOR_BATCH_CPUTIME(__sb, __idx) \
+    ((__sb)->sb_cputime + (uint32_t)(__idx) * (__sb)->sb_interval)
+
+/**
+ * Callback for handling a batch of sensor samples.
+ *
+ * @param sensor The sensor for which data is being returned
+ * @param arg The argument provided with the callback
+ * @param batch The samples
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*sensor_batch_func_t)(struct sensor *sensor, void *arg,
+                                   const struct sensor_batch *batch);
+
+/**
+ * Listener for batches of sensor data, see sensor_read_batch()
+ */
+struct sensor_batch_listener {
+    /* The type of sensor data to listen for, interpreted as a mask */
+    sensor_type_t sbl_sensor_type;
+
+    /* Sensor batch handler function */
+    sensor_batch_func_t sbl_func;
+
+    /* Argument for the sensor batch listener */
+    void *sbl_arg;
+
+    /* Next item in the sensor batch listener list.  The head of this list
+     * is contained within the sensor object.
+     */
+    SLIST_ENTRY(sensor_batch_listener) sbl_next;
+};
+
+/*
+ * Sensor data bus
+ *
+ * Samples of the sensors attached to a bus are published into a ring shared
+ * by all subscribers of the bus, copied once.  Synchronous subscribers are
+ * called from sensor_read(), like listeners, with the bus locked.
+ * Asynchronous subscribers are called from their own event queue, each
+ * reading the ring from its own cursor, so that a slow subscriber doesn't
+ * hold up the sensor reads or the other subscribers.  Subscribers get a
+ * pointer to the data in the ring; they must not keep it after returning.
+ */
+
+/* Entries older than the subscriber depth are dropped */
+#define SENSOR_BUS_DROP_OLDEST      0
+/* Entries published while the subscriber is full are dropped, until it has
+ * caught up.  Entries the ring wraps over are dropped all the same.
+ */
+#define SENSOR_BUS_DROP_NEWEST      1
+
+/**
+ * A sample in the ring of a sensor bus, followed by its data.
+ */
+struct sensor_bus_entry {
+    struct sensor *sbe_sensor;
+    sensor_type_t sbe_type;
+
+    /* Time the sample was taken at, in cputime */
+    uint32_t sbe_cputime;
+};
+
+/* Size of a ring entry holding data_size bytes of data */
+#define SENSOR_BUS_ENTRY_SIZE(__data_size) \
+    (sizeof(struct sensor_bus_entry) + (__data_size))
+
+/* The entry holding data passed to a subscriber */
+#define SENSOR_BUS_DATA_ENTRY(__data) \
+    ((struct sensor_bus_entry *)(__data) - 1)
+
+struct sensor_bus;
+
+/**
+ * Subscriber of a sensor bus.  The fields up to sbs_policy are set by the
+ * caller before subscribing.
+ */
+struct sensor_bus_sub {
+    /* The type of sensor data to subscribe to, interpreted as a mask */
+    sensor_type_t sbs_sensor_type;
+
+    /* Only subscribe to this sensor; NULL for all the sensors of the bus */
+    struct sensor *sbs_sensor;
+
+    /* Handler of the data, which points into the ring */
+    sensor_data_func_t sbs_func;
+    void *sbs_arg;
+
+    /* Event queue to call the handler from; NULL to call it synchronously
+     * when the data is published
+     */
+    struct os_eventq *sbs_evq;
+
+    /* Max number of subscribed entries waiting to be handled, 0 for the
+     * ring size.  Entries of other types or sensors take no room.
+     */
+    uint16_t sbs_depth;
+
+    /* SENSOR_BUS_DROP_OLDEST or SENSOR_BUS_DROP_NEWEST */
+    uint8_t sbs_policy;
+
+    /* Set when handling the entry at sbs_busy_seq */
+    uint8_t sbs_busy;
+
+    /* Set while dropping newest entries, until the subscriber has caught up */
+    uint8_t sbs_dropping;
+
+    /* Number of subscribed entries from sbs_cursor to sbs_end */
+    uint16_t sbs_pending;
+
+    /* Sequence numbers of the next entry to handle, and of the one after
+     * the last one
+     */
+    uint32_t sbs_cursor;
+    uint32_t sbs_end;
+    uint32_t sbs_busy_seq;
+
+    /* Number of subscribed entries dropped for this subscriber */
+    uint32_t sbs_dropped;
+
+    struct os_event sbs_ev;
+    struct sensor_bus *sbs_bus;
+
+    SLIST_ENTRY(sensor_bus_sub) sbs_next;
+};
+
+/**
+ * Sensor data bus
+ */
+struct sensor_bus {
+    /* Serializes publishers */
+    struct os_mutex sbus_lock;
+
+    /* Ring of sbus_cnt (a power of two) entries, sbus_entry_size apart */
+    uint8_t *sbus_buf;
+    uint16_t sbus_cnt;
+    uint16_t sbus_entry_size;
+
+    /* Max data size of an entry */
+    uint16_t sbus_data_size;
+
+    /* Sequence number of the next entry */
+    uint32_t sbus_head;
+
+    /* Set once every entry of the ring has been written */
+    uint8_t sbus_wrapped;
+
+    /* Samples not published, because a subscriber was still handling the
+     * entry they would have overwritten, or they didn't fit in an entry
+     */
+    uint32_t sbus_dropped;
+
+    SLIST_HEAD(, sensor_bus_sub) sbus_subs;
+};
+
 /**
  * Registration for sensor event notifications
  */
@@ -312,6 +498,35 @@ struct sensor_read_ev_ctx {
     sensor_type_t srec_type;
 };
 
+/* Max number of fields compared by a trigger threshold */
+#define SENSOR_TRIG_MAX_FIELDS  7
+
+/* A threshold field, in the representation of the data it applies to */
+union sensor_trig_val {
+    float stv_f;
+    int32_t stv_i;
+};
+
+struct sensor_trig_desc;
+
+/**
+ * Trigger thresholds of a sensor type, as loaded by sensor_set_thresh()
+ * for evaluation.
+ */
+struct sensor_trig {
+    /* Fields compared for this sensor type, NULL if not supported */
+    const struct sensor_trig_desc *st_desc;
+
+    /* Fields with thresholds to compare, bit n for field n */
+    uint8_t st_fields;
+
+    /* Thresholds of the current state: to enter the triggered state, or,
+     * moved by the hysteresis, to stay in it
+     */
+    union sensor_trig_val st_low[SENSOR_TRIG_MAX_FIELDS];
+    union sensor_trig_val st_high[SENSOR_TRIG_MAX_FIELDS];
+};
+
 /**
  * Sensor type traits list
  */
@@ -328,6 +543,24 @@ struct sensor_type_traits {
     /* field for selecting algorithm */
     uint8_t stt_algo;
 
+    /* Number of consecutive samples past the thresholds needed to trigger;
+     * 0 and 1 trigger on the first one
+     */
+    uint8_t stt_debounce;
+
+    /* Hysteresis of the window and watermark algos, in units of the data:
+     * once triggered, a sample has to be this far back within the
+     * thresholds to untrigger.
+     */
+    float stt_hysteresis;
+
+    /* Trigger state, and samples past the thresholds so far */
+    uint8_t stt_trig_active;
+    uint8_t stt_trig_cnt;
+
+    /* Thresholds loaded by sensor_set_thresh() */
+    struct sensor_trig stt_trig;
+
     /* Poll rate multiple */
     uint16_t stt_poll_n;
 
@@ -468,6 +701,26 @@ typedef int (*sensor_unset_notification_t)(struct sensor *,
  */
 typedef int (*sensor_handle_interrupt_t)(struct sensor *sensor);
 
+/**
+ * Read all samples buffered by the sensor (e.g. in a hardware FIFO), oldest
+ * first, preferably with a single bus transaction.
+ *
+ * @param sensor Ptr to the sensor
+ * @param type The type of sensor data to read; a single type
+ * @param data Array to fill with samples, of the data structure for type
+ *        (e.g. struct sensor_accel_data)
+ * @param max Number of samples which fit in data
+ * @param cnt Number of samples read
+ * @param sample_us Nominal time between samples in microseconds, 0 if
+ *        unknown
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*sensor_read_batch_func_t)(struct sensor *sensor,
+                                        sensor_type_t type, void *data,
+                                        uint16_t max, uint16_t *cnt,
+                                        uint32_t *sample_us);
+
 struct sensor_driver {
     sensor_read_func_t sd_read;
     sensor_get_config_func_t sd_get_config;
@@ -478,6 +731,7 @@ struct sensor_driver {
     sensor_set_notification_t sd_set_notification;
     sensor_unset_notification_t sd_unset_notification;
     sensor_handle_interrupt_t sd_handle_interrupt;
+    sensor_read_batch_func_t sd_read_batch;
 };
 
 struct sensor_timestamp {
@@ -571,6 +825,9 @@ struct sensor {
     /* The next time at which we want to poll data from this sensor */
     os_time_t s_next_run;
 
+    /* Position in the sensor manager's poll heap, while polled */
+    uint8_t s_poll_idx;
+
     /* Sensor driver specific functions, created by the device registering the
      * sensor.
      */
@@ -602,6 +859,16 @@ struct sensor {
     /* A list of sensor thresholds that are registered */
     SLIST_HEAD(, sensor_type_traits) s_type_traits_list;
 
+    /* A list of listeners for batches of data off of this sensor */
+    SLIST_HEAD(, sensor_batch_listener) s_batch_listener_list;
+
+    /* Cputime of the last batch read, and whether there was one */
+    uint32_t s_batch_cputime;
+    uint8_t s_batch_valid;
+
+    /* The bus the data off of this sensor is published to, if any */
+    struct sensor_bus *s_bus;
+
     /* The next sensor in the global sensor list. */
     SLIST_ENTRY(sensor) s_next;
 };
@@ -700,6 +967,104 @@ int sensor_unregister_listener(struct sensor *sensor, struct sensor_listener *li
 int sensor_register_err_func(struct sensor *sensor,
         sensor_error_func_t err_fn, void *arg);
 
+/**
+ * Register a listener for batches of data from a sensor, read with
+ * sensor_read_batch().
+ *
+ * @param sensor The sensor to register a listener on
+ * @param listener The listener to register onto the sensor
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_register_batch_listener(struct sensor *sensor,
+                                   struct sensor_batch_listener *listener);
+
+/**
+ * Un-register a sensor batch listener.
+ *
+ * @param sensor The sensor object
+ * @param listener The listener to remove from the sensor batch listener list
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_unregister_batch_listener(struct sensor *sensor,
+                                     struct sensor_batch_listener *listener);
+
+/**
+ * Initialize a sensor data bus.
+ *
+ * @param bus The bus to initialize
+ * @param buf Memory for the ring, of
+ *        OS_MEMPOOL_SIZE(cnt, SENSOR_BUS_ENTRY_SIZE(data_size)) os_membuf_t
+ * @param cnt Number of entries in the ring, a power of two
+ * @param data_size Max size of the data of an entry, e.g. the size of the
+ *        largest sensor data structure published
+ *
+ * @return 0 on success, SYS_EINVAL if cnt is not a power of two, non-zero
+ *         error code on other failures.
+ */
+int sensor_bus_init(struct sensor_bus *bus, void *buf, uint16_t cnt,
+                    uint16_t data_size);
+
+/**
+ * Publish the data off of a sensor to a bus, i.e. attach the sensor to the
+ * bus.  The data is published before the sensor listeners are called.
+ *
+ * The sensor can only be attached if the data of each of its types has a
+ * known size (so not user defined types), which fits in a bus entry.
+ *
+ * @param sensor The sensor
+ * @param bus The bus, NULL to detach the sensor
+ *
+ * @return 0 on success, SYS_EINVAL if the data of one of the sensor types
+ *         can't be published to the bus, non-zero error code on other
+ *         failures.
+ */
+int sensor_set_bus(struct sensor *sensor, struct sensor_bus *bus);
+
+/**
+ * Subscribe to a sensor bus.  Asynchronous subscribers get the entries
+ * published from now on.
+ *
+ * @param bus The bus
+ * @param sub The subscriber
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_bus_subscribe(struct sensor_bus *bus, struct sensor_bus_sub *sub);
+
+/**
+ * Unsubscribe from a sensor bus.  An asynchronous subscriber must not be
+ * handling data at this time.
+ *
+ * @param bus The bus
+ * @param sub The subscriber
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int sensor_bus_unsubscribe(struct sensor_bus *bus,
+                           struct sensor_bus_sub *sub);
+
+/**
+ * Publish a sample to a sensor bus.  Called by the sensor framework for
+ * attached sensors.
+ *
+ * @param bus The bus
+ * @param sensor The sensor the sample is off of
+ * @param type The type of the sample
+ * @param data The sample
+ * @param size Size of the sample
+ * @param cputime Time the sample was taken at
+ *
+ * @return 0 on success, SYS_EINVAL if the sample is empty or doesn't fit in
+ *         an entry, SYS_EBUSY if the entry to overwrite is being handled.
+ *         Samples not published for either reason are counted in
+ *         sbus_dropped.
+ */
+int sensor_bus_publish(struct sensor_bus *bus, struct sensor *sensor,
+                       sensor_type_t type, const void *data, uint16_t size,
+                       uint32_t cputime);
+
 /**
  * @} SensorListenerAPI
  */
@@ -757,6 +1122,27 @@ int sensor_read(struct sensor *sensor, sensor_type_t type,
                 sensor_data_func_t data_func, void *arg,
                 uint32_t timeout);
 
+/**
+ * Read all samples the sensor has buffered, e.g. in its FIFO, and deliver
+ * them as one batch to the batch listeners and then to batch_func.  The
+ * samples are assumed to be evenly spaced since the previous batch read,
+ * and the newest to have been taken at the time of this read.
+ *
+ * @param sensor The sensor to read data from
+ * @param type The type of sensor data to read; a single type
+ * @param data Array for the samples, of the data structure for type (e.g.
+ *        struct sensor_accel_data)
+ * @param max Number of samples which fit in data
+ * @param batch_func The callback to call with the batch, or NULL
+ * @param arg The argument to pass to this callback.
+ *
+ * @return 0 on success, SYS_ENOTSUP if the sensor can't read batches,
+ *         other non-zero on failure.
+ */
+int sensor_read_batch(struct sensor *sensor, sensor_type_t type, void *data,
+                      uint16_t max, sensor_batch_func_t batch_func,
+                      void *arg);
+
 /**
  * Set the driver functions for this sensor, along with the type of sensor
  * data available for the given sensor.
@@ -946,7 +1332,10 @@ int sensor_mgr_match_bytype(struct sensor *sensor, void *);
  * Set the sensor poll rate
  *
  * @param devname Name of the sensor
- * @param poll_rate The poll rate in milli seconds
+ * @param poll_rate The poll rate in milli seconds, 0 to stop polling
+ *
+ * @return 0 on success, SYS_ENOMEM if SENSOR_POLL_MAX sensors are already
+ *         polled, non-zero on other failure.
  */
 int
 sensor_set_poll_rate_ms(char *devname, uint32_t poll_rate);
@@ -1011,6 +1400,10 @@ sensor_get_type_traits_byname(char *, struct sensor_type_traits **,
 /**
  * Set the thresholds along with the comparison algo for a sensor
  *
+ * The thresholds are read at this time; call again after changing them.
+ * Samples have to be past the thresholds stt_debounce times in a row to
+ * trigger, and then trigger until they get stt_hysteresis back within them.
+ *
  * @param devname Name of the sensor
  * @param stt Ptr to sensor type traits containing thresholds
  *
@@ -58,6 +58,10 @@ struct {
     struct os_eventq *mgr_eventq;
 
     SLIST_HEAD(, sensor) mgr_sensor_list;
+
+    /* Polled sensors, a min-heap on the next run time */
+    struct sensor *mgr_poll_heap[MYNEWT_VAL(SENSOR_POLL_MAX)];
+    uint8_t mgr_poll_cnt;
 } sensor_mgr;
 
 struct sensor_read_ctx {
@@ -106,42 +110,97 @@ sensor_mgr_unlock(void)
 }
 
 static void
-sensor_mgr_remove(struct sensor *sensor)
+sensor_mgr_insert(struct sensor *sensor)
 {
-    SLIST_REMOVE(&sensor_mgr.mgr_sensor_list, sensor, sensor, s_next);
+    struct sensor *cursor, *prev;
+
+    prev = NULL;
+    SLIST_FOREACH(cursor, &sensor_mgr.mgr_sensor_list, s_next) {
+        prev = cursor;
+    }
+
+    if (prev == NULL) {
+        SLIST_INSERT_HEAD(&sensor_mgr.mgr_sensor_list, sensor, s_next);
+    } else {
+        SLIST_INSERT_AFTER(prev, sensor, s_next);
+    }
 }
 
 static void
-sensor_mgr_insert(struct sensor *sensor)
+sensor_poll_heap_set(int idx, struct sensor *sensor)
 {
-    struct sensor *cursor, *prev;
+    sensor_mgr.mgr_poll_heap[idx] = sensor;
+    sensor->s_poll_idx = idx;
+}
 
-    prev = cursor = NULL;
-    if (!sensor->s_poll_rate) {
-        SLIST_FOREACH(cursor, &sensor_mgr.mgr_sensor_list, s_next) {
-            prev = cursor;
+/**
+ * Moves the sensor at idx up or down the poll heap to where its next run
+ * time belongs.  Must be called with the sensor manager locked.
+ */
+static void
+sensor_poll_heap_fix(int idx)
+{
+    struct sensor **heap;
+    struct sensor *sensor;
+    int child;
+    int parent;
+
+    heap = sensor_mgr.mgr_poll_heap;
+    sensor = heap[idx];
+
+    while (idx > 0) {
+        parent = (idx - 1) / 2;
+        if (!OS_TIME_TICK_LT(sensor->s_next_run, heap[parent]->s_next_run)) {
+            break;
         }
-        goto insert;
+        sensor_poll_heap_set(idx, heap[parent]);
+        idx = parent;
     }
 
-    prev = cursor = NULL;
-    SLIST_FOREACH(cursor, &sensor_mgr.mgr_sensor_list, s_next) {
-        if (!cursor->s_poll_rate) {
+    while (1) {
+        child = 2 * idx + 1;
+        if (child >= sensor_mgr.mgr_poll_cnt) {
             break;
         }
-
-        if (OS_TIME_TICK_LT(sensor->s_next_run, cursor->s_next_run)) {
+        if (child + 1 < sensor_mgr.mgr_poll_cnt &&
+            OS_TIME_TICK_LT(heap[child + 1]->s_next_run,
+                            heap[child]->s_next_run)) {
+            child++;
+        }
+        if (!OS_TIME_TICK_LT(heap[child]->s_next_run, sensor->s_next_run)) {
             break;
         }
+        sensor_poll_heap_set(idx, heap[child]);
+        idx = child;
+    }
 
-        prev = cursor;
+    sensor_poll_heap_set(idx, sensor);
+}
+
+static int
+sensor_poll_heap_add(struct sensor *sensor)
+{
+    if (sensor_mgr.mgr_poll_cnt >= MYNEWT_VAL(SENSOR_POLL_MAX)) {
+        return SYS_ENOMEM;
     }
 
-insert:
-    if (prev == NULL) {
-        SLIST_INSERT_HEAD(&sensor_mgr.mgr_sensor_list, sensor, s_next);
-    } else {
-        SLIST_INSERT_AFTER(prev, sensor, s_next);
+    sensor_poll_heap_set(sensor_mgr.mgr_poll_cnt++, sensor);
+    sensor_poll_heap_fix(sensor->s_poll_idx);
+
+    return 0;
+}
+
+static void
+sensor_poll_heap_remove(struct sensor *sensor)
+{
+    int idx;
+
+    idx = sensor->s_poll_idx;
+    sensor_mgr.mgr_poll_cnt--;
+    if (idx != sensor_mgr.mgr_poll_cnt) {
+        sensor_poll_heap_set(idx,
+                             sensor_mgr.mgr_poll_heap[sensor_mgr.mgr_poll_cnt]);
+        sensor_poll_heap_fix(idx);
     }
 }
 
@@ -294,54 +353,27 @@ err:
     return rc;
 }
 
+/**
+ * Schedules the sensor manager wakeup for the first sensor due.  Must be
+ * called with the sensor manager locked.
+ */
 static void
-sensor_update_poll_rate(struct sensor *sensor, uint32_t poll_rate)
-{
-    sensor_lock(sensor);
-
-    sensor->s_poll_rate = poll_rate;
-
-    sensor_unlock(sensor);
-}
-
-static os_time_t
-sensor_calc_nextrun_delta(struct sensor *sensor, os_time_t now)
+sensor_mgr_schedule(os_time_t now)
 {
-    os_time_t sensor_ticks;
-    int delta;
+    os_stime_t delta;
 
-    sensor_lock(sensor);
+    if (sensor_mgr.mgr_poll_cnt == 0) {
+        os_callout_stop(&sensor_mgr.mgr_wakeup_callout);
+        return;
+    }
 
-    delta = (int32_t)(sensor->s_next_run - now);
+    delta = (os_stime_t)(sensor_mgr.mgr_poll_heap[0]->s_next_run - now);
     if (delta < 0) {
         /* This fires the callout right away */
-        sensor_ticks = 0;
-    } else {
-        sensor_ticks = delta;
+        delta = 0;
     }
 
-    sensor_unlock(sensor);
-
-    return sensor_ticks;
-}
-
-static struct sensor *
-sensor_find_min_nextrun_sensor(os_time_t now, os_time_t *min_nextrun)
-{
-    struct sensor *head;
-
-    head = NULL;
-
-    sensor_mgr_lock();
-
-    head = SLIST_FIRST(&sensor_mgr.mgr_sensor_list);
-
-    *min_nextrun = sensor_calc_nextrun_delta(head, now);
-
-    sensor_mgr_unlock();
-
-    return head;
-
+    os_callout_reset(&sensor_mgr.mgr_wakeup_callout, delta);
 }
 
 static void
@@ -351,59 +383,60 @@ sensor_update_nextrun(struct sensor *sensor, os_time_t now)
 
     os_time_ms_to_ticks(sensor->s_poll_rate, &sensor_ticks);
 
-    sensor_lock(sensor);
-
-    /* Remove the sensor from the sensor list for insert. */
-    sensor_mgr_remove(sensor);
-
-    /* Set next wakeup, and insert the sensor back into the
-     * list.
-     */
     sensor->s_next_run = sensor_ticks + now;
 
-    /* Re-insert the sensor manager, with the new wakeup time. */
-    sensor_mgr_insert(sensor);
-
-    sensor_unlock(sensor);
+    sensor_poll_heap_fix(sensor->s_poll_idx);
 }
 
 /**
  * Set the sensor poll rate based on the device name
  *
  * @param The devname
- * @param The poll rate in milli seconds
+ * @param The poll rate in milli seconds, 0 to stop polling
+ *
+ * @return 0 on success, SYS_ENOMEM if SENSOR_POLL_MAX sensors are already
+ *         polled, other non-zero on failure.
  */
 int
 sensor_set_poll_rate_ms(char *devname, uint32_t poll_rate)
 {
     struct sensor *sensor;
-    os_time_t next_wakeup;
     os_time_t now;
     int rc;
 
-    os_callout_stop(&sensor_mgr.mgr_wakeup_callout);
-
     sensor = sensor_mgr_find_next_bydevname(devname, NULL);
     if (!sensor) {
         rc = SYS_EINVAL;
         goto err;
     }
 
-    sensor_lock(sensor);
-
-    now = os_time_get();
-
-    os_time_ms_to_ticks(poll_rate, &next_wakeup);
-
-    sensor_update_poll_rate(sensor, poll_rate);
+    rc = sensor_mgr_lock();
+    if (rc) {
+        goto err;
+    }
 
-    sensor_update_nextrun(sensor, now);
+    if (!sensor->s_poll_rate && poll_rate) {
+        rc = sensor_poll_heap_add(sensor);
+        if (rc) {
+            sensor_mgr_unlock();
+            goto err;
+        }
+    } else if (sensor->s_poll_rate && !poll_rate) {
+        sensor_poll_heap_remove(sensor);
+    }
 
+    sensor_lock(sensor);
+    sensor->s_poll_rate = poll_rate;
     sensor_unlock(sensor);
 
-    sensor = sensor_find_min_nextrun_sensor(now, &next_wakeup);
+    now = os_time_get();
+    if (poll_rate) {
+        sensor_update_nextrun(sensor, now);
+    }
 
-    os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
+    sensor_mgr_schedule(now);
+
+    sensor_mgr_unlock();
 
     return 0;
 err:
@@ -444,61 +477,22 @@ err:
     return (rc);
 }
 
-/* Sensor poll one completes the poll, updates the sensor's "next
- * run," and re-inserts it into the list
- */
-static void
-sensor_mgr_poll_bytype(struct sensor *sensor, sensor_type_t type,
-                       struct sensor_type_traits *stt, os_time_t now)
-{
-    if (!stt || !stt->stt_polls_left) {
-        /* Sensor read results. Every time a sensor is read, all of its
-         * listeners are called by default. Specify NULL as a callback,
-         * because we just want to run all the listeners.
-         */
-
-        sensor_read(sensor, type, NULL, NULL, OS_TIMEOUT_NEVER);
-
-        sensor_lock(sensor);
-
-        if (stt) {
-            if (!stt->stt_polls_left && stt->stt_poll_n) {
-                stt->stt_polls_left = stt->stt_poll_n;
-                stt->stt_polls_left--;
-            }
-#if MYNEWT_VAL(SENSOR_POLL_TEST_LOG)
-            test_log[test_log_idx].delta = (uint32_t)(now - stt->prev_now);
-            test_log[test_log_idx].polls_left = stt->stt_polls_left;
-            test_log[test_log_idx].now = now;
-            test_log[test_log_idx].os_now = os_time_get();
-            test_log[test_log_idx].name[0] = sensor->s_dev->od_name[0];
-            test_log[test_log_idx].name[1] = type == 1 ? 'a' : type == 32 ? 't' : type == 64 ? 'p' : 'x';
-            test_log[test_log_idx].poll_multiple = stt->stt_poll_n;
-            test_log_idx++;
-            test_log_idx %= 100;
-            stt->prev_now = now;
-#endif
-        }
-
-        /* Unlock the sensor to allow other access */
-        sensor_unlock(sensor);
-
-    } else {
-        stt->stt_polls_left--;
-    }
-}
-
 static uint8_t
 sensor_type_traits_empty(struct sensor *sensor)
 {
     return SLIST_EMPTY(&sensor->s_type_traits_list);
 }
 
+/**
+ * Polls the types of a sensor which are due, with a single read.
+ */
 static void
-sensor_poll_per_type_trait(struct sensor *sensor, os_time_t now,
-                           os_time_t next_wakeup)
+sensor_poll_per_type_trait(struct sensor *sensor, os_time_t now)
 {
     struct sensor_type_traits *stt;
+    sensor_type_t type;
+
+    type = 0;
 
     /* Lock the sensor */
     sensor_lock(sensor);
@@ -512,9 +506,31 @@ sensor_poll_per_type_trait(struct sensor *sensor, os_time_t now,
          * If a multiple is specified, the sensor would get polled
          * at the poll multiple
          */
+        if (stt->stt_polls_left) {
+            stt->stt_polls_left--;
+            continue;
+        }
 
-        sensor_mgr_poll_bytype(sensor, stt->stt_sensor_type, stt,
-                               now);
+        type |= stt->stt_sensor_type;
+        if (stt->stt_poll_n) {
+            stt->stt_polls_left = stt->stt_poll_n - 1;
+        }
+#if MYNEWT_VAL(SENSOR_POLL_TEST_LOG)
+        test_log[test_log_idx].delta = (uint32_t)(now - stt->prev_now);
+        test_log[test_log_idx].polls_left = stt->stt_polls_left;
+        test_log[test_log_idx].now = now;
+        test_log[test_log_idx].os_now = os_time_get();
+        test_log[test_log_idx].name[0] = sensor->s_dev->od_name[0];
+        test_log[test_log_idx].name[1] = stt->stt_sensor_type == 1 ? 'a' : stt->stt_sensor_type == 32 ? 't' : stt->stt_sensor_type == 64 ? 'p' : 'x';
+        test_log[test_log_idx].poll_multiple = stt->stt_poll_n;
+        test_log_idx++;
+        test_log_idx %= 100;
+        stt->prev_now = now;
+#endif
+    }
+
+    if (type) {
+        sensor_read(sensor, type, NULL, NULL, OS_TIMEOUT_NEVER);
     }
 
     /* Unlock the sensor to allow other access */
@@ -522,8 +538,9 @@ sensor_poll_per_type_trait(struct sensor *sensor, os_time_t now,
 }
 
 /**
- * Event that wakes up the sensor manager, this goes through the sensor
- * list and polls any active sensors.
+ * Event that wakes up the sensor manager, this polls the sensors which are
+ * due, along with those due within SENSOR_POLL_MERGE_MS so that they share
+ * this wakeup.
  *
  * @param OS event
  */
@@ -531,8 +548,9 @@ static void
 sensor_mgr_wakeup_event(struct os_event *ev)
 {
     struct sensor *cursor;
+    os_time_t merge;
     os_time_t now;
-    os_time_t next_wakeup;
+    int cnt;
 
     now = os_time_get();
 
@@ -540,45 +558,31 @@ sensor_mgr_wakeup_event(struct os_event *ev)
     smgr_wakeup[smgr_wakeup_idx++%500] = now;
 #endif
 
-    sensor_mgr_lock();
-
-    cursor = NULL;
-    while (1) {
+    os_time_ms_to_ticks(MYNEWT_VAL(SENSOR_POLL_MERGE_MS), &merge);
 
-        cursor = sensor_find_min_nextrun_sensor(now, &next_wakeup);
-
-        sensor_lock(cursor);
-        /* Sensors that are not periodic are inserted at the end of the sensor
-         * list.
-         */
-        if (!cursor->s_poll_rate) {
-            sensor_unlock(cursor);
-            sensor_mgr_unlock();
-            return;
-        }
+    sensor_mgr_lock();
 
-        /* List is sorted by what runs first.  If we reached the first element that
-         * doesn't run, break out.
-         */
-        if (next_wakeup > 0) {
+    /* Poll each sensor at most once, even if its poll rate is within the
+     * merge window.
+     */
+    for (cnt = sensor_mgr.mgr_poll_cnt; cnt > 0; cnt--) {
+        cursor = sensor_mgr.mgr_poll_heap[0];
+        if (OS_TIME_TICK_GT(cursor->s_next_run, now + merge)) {
             break;
         }
 
         if (sensor_type_traits_empty(cursor)) {
-
-            sensor_mgr_poll_bytype(cursor, cursor->s_mask, NULL, now);
+            sensor_read(cursor, cursor->s_mask, NULL, NULL, OS_TIMEOUT_NEVER);
         } else {
-            sensor_poll_per_type_trait(cursor, now, next_wakeup);
+            sensor_poll_per_type_trait(cursor, now);
         }
 
         sensor_update_nextrun(cursor, now);
-
-        sensor_unlock(cursor);
     }
 
-    sensor_mgr_unlock();
+    sensor_mgr_schedule(os_time_get());
 
-    os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
+    sensor_mgr_unlock();
 }
 
 /**
@@ -1028,6 +1032,49 @@ err:
     return (rc);
 }
 
+int
+sensor_register_batch_listener(struct sensor *sensor,
+                               struct sensor_batch_listener *listener)
+{
+    int rc;
+
+    rc = sensor_lock(sensor);
+    if (rc != 0) {
+        return (rc);
+    }
+
+    SLIST_INSERT_HEAD(&sensor->s_batch_listener_list, listener, sbl_next);
+
+    sensor_unlock(sensor);
+
+    return (0);
+}
+
+int
+sensor_unregister_batch_listener(struct sensor *sensor,
+                                 struct sensor_batch_listener *listener)
+{
+    struct sensor_batch_listener *tmp;
+    int rc;
+
+    rc = sensor_lock(sensor);
+    if (rc != 0) {
+        return (rc);
+    }
+
+    SLIST_FOREACH(tmp, &sensor->s_batch_listener_list, sbl_next) {
+        if (listener == tmp) {
+            SLIST_REMOVE(&sensor->s_batch_listener_list, listener,
+                         sensor_batch_listener, sbl_next);
+            break;
+        }
+    }
+
+    sensor_unlock(sensor);
+
+    return (0);
+}
+
 int
 sensor_register_err_func(struct sensor *sensor, sensor_error_func_t err_fn,
                          void *arg)
@@ -1163,6 +1210,12 @@ sensor_read_data_func(struct sensor *sensor, void *arg, void *data,
     ctx = (struct sensor_read_ctx *) arg;
 
     if ((uint8_t)(uintptr_t)(ctx->user_arg) != SENSOR_IGN_LISTENER) {
+        if (sensor->s_bus) {
+            sensor_bus_publish(sensor->s_bus, sensor, type, data,
+                               sensor_trig_type_size(type),
+                               sensor->s_sts.st_cputime);
+        }
+
         /* Notify all listeners first */
         SLIST_FOREACH(listener, &sensor->s_listener_list, sl_next) {
             if (listener->sl_sensor_type & type) {
@@ -1331,618 +1384,6 @@ err:
     return sensor;
 }
 
-static uint8_t
-sensor_window_cmp_quat(struct sensor_quat_data *d_sqd,
-                       struct sensor_quat_data *h_sqd,
-                       struct sensor_quat_data *l_sqd)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_sqd, h_sqd, sqd_x) &&
-         SENSOR_DATA_CMP_GT(d_sqd, l_sqd, sqd_x));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sqd, h_sqd, sqd_y) &&
-         SENSOR_DATA_CMP_GT(d_sqd, l_sqd, sqd_y));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sqd, h_sqd, sqd_z) &&
-         SENSOR_DATA_CMP_GT(d_sqd, l_sqd, sqd_z));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_window_cmp_accel(struct sensor_accel_data *d_sad,
-                        struct sensor_accel_data *h_sad,
-                        struct sensor_accel_data *l_sad)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_sad, h_sad, sad_x) &&
-         SENSOR_DATA_CMP_GT(d_sad, l_sad, sad_x));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sad, h_sad, sad_y) &&
-         SENSOR_DATA_CMP_GT(d_sad, l_sad, sad_y));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sad, h_sad, sad_z) &&
-         SENSOR_DATA_CMP_GT(d_sad, l_sad, sad_z));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_window_cmp_euler(struct sensor_euler_data *d_sed,
-                        struct sensor_euler_data *h_sed,
-                        struct sensor_euler_data *l_sed)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_sed, h_sed, sed_h) &&
-         SENSOR_DATA_CMP_GT(d_sed, l_sed, sed_h));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sed, h_sed, sed_r) &&
-         SENSOR_DATA_CMP_GT(d_sed, l_sed, sed_r));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sed, h_sed, sed_p) &&
-         SENSOR_DATA_CMP_GT(d_sed, l_sed, sed_p));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_window_cmp_gyro(struct sensor_gyro_data *d_sgd,
-                       struct sensor_gyro_data *h_sgd,
-                       struct sensor_gyro_data *l_sgd)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_sgd, h_sgd, sgd_x) &&
-         SENSOR_DATA_CMP_GT(d_sgd, l_sgd, sgd_x));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sgd, h_sgd, sgd_y) &&
-         SENSOR_DATA_CMP_GT(d_sgd, l_sgd, sgd_y));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sgd, h_sgd, sgd_z) &&
-         SENSOR_DATA_CMP_GT(d_sgd, l_sgd, sgd_z));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_window_cmp_mag(struct sensor_mag_data *d_smd,
-                      struct sensor_mag_data *h_smd,
-                      struct sensor_mag_data *l_smd)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-         (SENSOR_DATA_CMP_LT(d_smd, h_smd, smd_x) &&
-          SENSOR_DATA_CMP_GT(d_smd, l_smd, smd_x));
-    trigger |=
-         (SENSOR_DATA_CMP_LT(d_smd, h_smd, smd_y) &&
-          SENSOR_DATA_CMP_GT(d_smd, l_smd, smd_y));
-    trigger |=
-         (SENSOR_DATA_CMP_LT(d_smd, h_smd, smd_z) &&
-          SENSOR_DATA_CMP_GT(d_smd, l_smd, smd_z));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_window_cmp_temp(struct sensor_temp_data *d_std,
-                       struct sensor_temp_data *h_std,
-                       struct sensor_temp_data *l_std)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_std, h_std, std_temp) &&
-         SENSOR_DATA_CMP_GT(d_std, l_std, std_temp));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_window_cmp_light(struct sensor_light_data *d_sld,
-                        struct sensor_light_data *h_sld,
-                        struct sensor_light_data *l_sld)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_sld, h_sld, sld_full) &&
-         SENSOR_DATA_CMP_GT(d_sld, l_sld, sld_full));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sld, h_sld, sld_ir) &&
-         SENSOR_DATA_CMP_GT(d_sld, l_sld, sld_ir));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sld, h_sld, sld_lux) &&
-         SENSOR_DATA_CMP_GT(d_sld, l_sld, sld_lux));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_window_cmp_color(struct sensor_color_data *d_scd,
-                        struct sensor_color_data *h_scd,
-                        struct sensor_color_data *l_scd)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_scd, h_scd, scd_r) &&
-         SENSOR_DATA_CMP_GT(d_scd, l_scd, scd_r));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_scd, h_scd, scd_g) &&
-         SENSOR_DATA_CMP_GT(d_scd, l_scd, scd_g));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_scd, h_scd, scd_b) &&
-         SENSOR_DATA_CMP_GT(d_scd, l_scd, scd_b));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_scd, h_scd, scd_c) &&
-         SENSOR_DATA_CMP_GT(d_scd, l_scd, scd_c));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_scd, h_scd, scd_lux) &&
-         SENSOR_DATA_CMP_GT(d_scd, l_scd, scd_lux));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_scd, h_scd, scd_colortemp) &&
-         SENSOR_DATA_CMP_GT(d_scd, l_scd, scd_colortemp));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_scd, h_scd, scd_ir) &&
-         SENSOR_DATA_CMP_GT(d_scd, l_scd, scd_ir));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_window_cmp_press(struct sensor_press_data *d_spd,
-                        struct sensor_press_data *h_spd,
-                        struct sensor_press_data *l_spd)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_spd, h_spd, spd_press) &&
-         SENSOR_DATA_CMP_GT(d_spd, l_spd, spd_press));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_window_cmp_humid(struct sensor_humid_data *d_shd,
-                        struct sensor_humid_data *h_shd,
-                        struct sensor_humid_data *l_shd)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_shd, h_shd, shd_humid) &&
-         SENSOR_DATA_CMP_GT(d_shd, l_shd, shd_humid));
-
-    return trigger;
-}
-
-static int
-sensor_window_cmp(sensor_type_t type, sensor_data_t *low, sensor_data_t *high,
-                  void *data)
-{
-    uint8_t trigger;
-    sensor_data_t dptr;
-
-    trigger = 0;
-
-    switch(type) {
-        case SENSOR_TYPE_ROTATION_VECTOR:
-            dptr.sqd = data;
-            trigger = sensor_window_cmp_quat(dptr.sqd, high->sqd, low->sqd);
-            break;
-        case SENSOR_TYPE_ACCELEROMETER:
-            dptr.sad = data;
-            trigger = sensor_window_cmp_accel(dptr.sad, high->sad, low->sad);
-            break;
-        case SENSOR_TYPE_LINEAR_ACCEL:
-            dptr.slad = data;
-            trigger = sensor_window_cmp_accel(dptr.slad, high->slad, low->slad);
-            break;
-        case SENSOR_TYPE_EULER:
-            dptr.sed = data;
-            trigger = sensor_window_cmp_euler(dptr.sed, high->sed, low->sed);
-            break;
-        case SENSOR_TYPE_GYROSCOPE:
-            dptr.sgd = data;
-            trigger = sensor_window_cmp_gyro(dptr.sgd, high->sgd, low->sgd);
-            break;
-        case SENSOR_TYPE_GRAVITY:
-            dptr.sgrd = data;
-            trigger = sensor_window_cmp_accel(dptr.sgrd, high->sgrd, low->sgrd);
-            break;
-        case SENSOR_TYPE_MAGNETIC_FIELD:
-            dptr.smd = data;
-            trigger = sensor_window_cmp_mag(dptr.smd, high->smd, low->smd);
-            break;
-        case SENSOR_TYPE_TEMPERATURE:
-            dptr.std = data;
-            trigger = sensor_window_cmp_temp(dptr.std, high->std, low->std);
-            break;
-        case SENSOR_TYPE_AMBIENT_TEMPERATURE:
-            dptr.satd = data;
-            trigger = sensor_window_cmp_temp(dptr.satd, high->satd, low->satd);
-            break;
-        case SENSOR_TYPE_LIGHT:
-            dptr.sld = data;
-            trigger = sensor_window_cmp_light(dptr.sld, high->sld, low->sld);
-            break;
-        case SENSOR_TYPE_COLOR:
-            dptr.scd = data;
-            trigger = sensor_window_cmp_color(dptr.scd, high->scd, low->scd);
-            break;
-        case SENSOR_TYPE_PRESSURE:
-            dptr.spd = data;
-            trigger = sensor_window_cmp_press(dptr.spd, high->spd, low->spd);
-            break;
-        case SENSOR_TYPE_RELATIVE_HUMIDITY:
-            dptr.srhd = data;
-            trigger = sensor_window_cmp_humid(dptr.srhd, high->srhd, low->srhd);
-            break;
-        case SENSOR_TYPE_PROXIMITY:
-            /* Falls Through */
-        case SENSOR_TYPE_WEIGHT:
-            /* Falls Through */
-        case SENSOR_TYPE_ALTITUDE:
-            /* Falls Through */
-        case SENSOR_TYPE_NONE:
-            /* Falls Through */
-        default:
-            break;
-    }
-
-    return trigger;
-}
-
-static uint8_t
-sensor_watermark_cmp_quat(struct sensor_quat_data *d_sqd,
-                          struct sensor_quat_data *h_sqd,
-                          struct sensor_quat_data *l_sqd)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_sqd, l_sqd, sqd_x) ||
-         SENSOR_DATA_CMP_GT(d_sqd, h_sqd, sqd_x));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sqd, l_sqd, sqd_y) ||
-         SENSOR_DATA_CMP_GT(d_sqd, h_sqd, sqd_y));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sqd, l_sqd, sqd_z) ||
-         SENSOR_DATA_CMP_GT(d_sqd, h_sqd, sqd_z));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_watermark_cmp_accel(struct sensor_accel_data *d_sad,
-                           struct sensor_accel_data *h_sad,
-                           struct sensor_accel_data *l_sad)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_sad, l_sad, sad_x) ||
-         SENSOR_DATA_CMP_GT(d_sad, h_sad, sad_x));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sad, l_sad, sad_y) ||
-         SENSOR_DATA_CMP_GT(d_sad, h_sad, sad_y));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sad, l_sad, sad_z) ||
-         SENSOR_DATA_CMP_GT(d_sad, h_sad, sad_z));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_watermark_cmp_euler(struct sensor_euler_data *d_sed,
-                           struct sensor_euler_data *h_sed,
-                           struct sensor_euler_data *l_sed)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_sed, l_sed, sed_h) ||
-         SENSOR_DATA_CMP_GT(d_sed, h_sed, sed_h));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sed, l_sed, sed_r) ||
-         SENSOR_DATA_CMP_GT(d_sed, h_sed, sed_r));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sed, l_sed, sed_p) ||
-         SENSOR_DATA_CMP_GT(d_sed, h_sed, sed_p));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_watermark_cmp_gyro(struct sensor_gyro_data *d_sgd,
-                          struct sensor_gyro_data *h_sgd,
-                          struct sensor_gyro_data *l_sgd)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_sgd, l_sgd, sgd_x) ||
-         SENSOR_DATA_CMP_GT(d_sgd, h_sgd, sgd_x));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sgd, l_sgd, sgd_y) ||
-         SENSOR_DATA_CMP_GT(d_sgd, h_sgd, sgd_y));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sgd, l_sgd, sgd_z) ||
-         SENSOR_DATA_CMP_GT(d_sgd, h_sgd, sgd_z));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_watermark_cmp_mag(struct sensor_mag_data *d_smd,
-                         struct sensor_mag_data *h_smd,
-                         struct sensor_mag_data *l_smd)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-         (SENSOR_DATA_CMP_LT(d_smd, l_smd, smd_x) ||
-          SENSOR_DATA_CMP_GT(d_smd, h_smd, smd_x));
-    trigger |=
-         (SENSOR_DATA_CMP_LT(d_smd, l_smd, smd_y) ||
-          SENSOR_DATA_CMP_GT(d_smd, h_smd, smd_y));
-    trigger |=
-         (SENSOR_DATA_CMP_LT(d_smd, l_smd, smd_z) ||
-          SENSOR_DATA_CMP_GT(d_smd, h_smd, smd_z));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_watermark_cmp_temp(struct sensor_temp_data *d_std,
-                          struct sensor_temp_data *h_std,
-                          struct sensor_temp_data *l_std)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_std, l_std, std_temp) ||
-         SENSOR_DATA_CMP_GT(d_std, h_std, std_temp));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_watermark_cmp_light(struct sensor_light_data *d_sld,
-                           struct sensor_light_data *h_sld,
-                           struct sensor_light_data *l_sld)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_sld, l_sld, sld_full) ||
-         SENSOR_DATA_CMP_GT(d_sld, h_sld, sld_full));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sld, l_sld, sld_ir) ||
-         SENSOR_DATA_CMP_GT(d_sld, h_sld, sld_ir));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_sld, l_sld, sld_lux) ||
-         SENSOR_DATA_CMP_GT(d_sld, h_sld, sld_lux));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_watermark_cmp_color(struct sensor_color_data *d_scd,
-                           struct sensor_color_data *h_scd,
-                           struct sensor_color_data *l_scd)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_scd, l_scd, scd_r) ||
-         SENSOR_DATA_CMP_GT(d_scd, h_scd, scd_r));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_scd, l_scd, scd_g) ||
-         SENSOR_DATA_CMP_GT(d_scd, h_scd, scd_g));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_scd, l_scd, scd_b) ||
-         SENSOR_DATA_CMP_GT(d_scd, h_scd, scd_b));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_scd, l_scd, scd_c) ||
-         SENSOR_DATA_CMP_GT(d_scd, h_scd, scd_c));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_scd, l_scd, scd_lux) ||
-         SENSOR_DATA_CMP_GT(d_scd, h_scd, scd_lux));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_scd, l_scd, scd_colortemp) ||
-         SENSOR_DATA_CMP_GT(d_scd, h_scd, scd_colortemp));
-    trigger |=
-        (SENSOR_DATA_CMP_LT(d_scd, l_scd, scd_ir) ||
-         SENSOR_DATA_CMP_GT(d_scd, h_scd, scd_ir));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_watermark_cmp_press(struct sensor_press_data *d_spd,
-                           struct sensor_press_data *h_spd,
-                           struct sensor_press_data *l_spd)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_spd, l_spd, spd_press) ||
-         SENSOR_DATA_CMP_GT(d_spd, h_spd, spd_press));
-
-    return trigger;
-}
-
-static uint8_t
-sensor_watermark_cmp_humid(struct sensor_humid_data *d_shd,
-                           struct sensor_humid_data *h_shd,
-                           struct sensor_humid_data *l_shd)
-{
-    uint8_t trigger;
-
-    trigger = 0;
-
-    trigger =
-        (SENSOR_DATA_CMP_LT(d_shd, l_shd, shd_humid) ||
-         SENSOR_DATA_CMP_GT(d_shd, h_shd, shd_humid));
-
-    return trigger;
-}
-
-static int
-sensor_watermark_cmp(sensor_type_t type, sensor_data_t *low, sensor_data_t *high,
-                     void *data)
-{
-    uint8_t trigger;
-    sensor_data_t dptr;
-
-    trigger = 0;
-
-    switch(type) {
-        case SENSOR_TYPE_ROTATION_VECTOR:
-            dptr.sqd = data;
-            trigger = sensor_watermark_cmp_quat(dptr.sqd, high->sqd,
-                                                low->sqd);
-            break;
-        case SENSOR_TYPE_ACCELEROMETER:
-            dptr.sad = data;
-            trigger = sensor_watermark_cmp_accel(dptr.sad, high->sad,
-                                                 low->sad);
-            break;
-        case SENSOR_TYPE_LINEAR_ACCEL:
-            dptr.slad = data;
-            trigger = sensor_watermark_cmp_accel(dptr.slad, high->slad,
-                                                 low->slad);
-            break;
-        case SENSOR_TYPE_EULER:
-            dptr.sed = data;
-            trigger = sensor_watermark_cmp_euler(dptr.sed, high->sed,
-                                                 low->sed);
-            break;
-        case SENSOR_TYPE_GYROSCOPE:
-            dptr.sgd = data;
-            trigger = sensor_watermark_cmp_gyro(dptr.sgd, high->sgd,
-                                                low->sgd);
-            break;
-        case SENSOR_TYPE_GRAVITY:
-            dptr.sgrd = data;
-            trigger = sensor_watermark_cmp_accel(dptr.sgrd, high->sgrd,
-                                                 low->sgrd);
-            break;
-        case SENSOR_TYPE_MAGNETIC_FIELD:
-            dptr.smd = data;
-            trigger = sensor_watermark_cmp_mag(dptr.smd, high->smd,
-                                               low->smd);
-            break;
-        case SENSOR_TYPE_TEMPERATURE:
-            dptr.std = data;
-            trigger = sensor_watermark_cmp_temp(dptr.std, high->std,
-                                                low->std);
-            break;
-        case SENSOR_TYPE_AMBIENT_TEMPERATURE:
-            dptr.satd = data;
-            trigger = sensor_watermark_cmp_temp(dptr.satd, high->satd,
-                                                low->satd);
-            break;
-        case SENSOR_TYPE_LIGHT:
-            dptr.sld = data;
-            trigger = sensor_watermark_cmp_light(dptr.sld, high->sld,
-                                                 low->sld);
-            break;
-        case SENSOR_TYPE_COLOR:
-            dptr.scd = data;
-            trigger = sensor_watermark_cmp_color(dptr.scd, high->scd,
-                                                 low->scd);
-            break;
-        case SENSOR_TYPE_PRESSURE:
-            dptr.spd = data;
-            trigger = sensor_watermark_cmp_press(dptr.spd, high->spd,
-                                                 low->spd);
-            break;
-        case SENSOR_TYPE_RELATIVE_HUMIDITY:
-            dptr.srhd = data;
-            trigger = sensor_watermark_cmp_humid(dptr.srhd, high->srhd,
-                                                 low->srhd);
-            break;
-        case SENSOR_TYPE_PROXIMITY:
-            /* Falls Through */
-        case SENSOR_TYPE_WEIGHT:
-            /* Falls Through */
-        case SENSOR_TYPE_ALTITUDE:
-            /* Falls Through */
-        case SENSOR_TYPE_NONE:
-            /* Falls Through */
-        default:
-            break;
-    }
-
-    return trigger;
-}
-
-static void
-sensor_set_trigger_cmp_algo(struct sensor *sensor, struct sensor_type_traits *stt)
-{
-    sensor_lock(sensor);
-    if (stt->stt_algo == SENSOR_THRESH_ALGO_WATERMARK) {
-        /* select watermark comparison algo */
-        stt->stt_trigger_cmp_algo = sensor_watermark_cmp;
-    } else if (stt->stt_algo == SENSOR_THRESH_ALGO_WINDOW) {
-        /* select window comparison algo */
-        stt->stt_trigger_cmp_algo = sensor_window_cmp;
-    } else if (stt->stt_algo == SENSOR_THRESH_ALGO_USERDEF) {
-        /* select user defined comparison algo if any */
-        stt->stt_trigger_cmp_algo = stt->stt_trigger_cmp_algo;
-    }
-    sensor_unlock(sensor);
-}
-
 /**
  * Set the thresholds along with comparison algo for a sensor
  *
@@ -1976,6 +1417,11 @@ sensor_set_thresh(char *devname, struct sensor_type_traits *stt)
         stt_tmp->stt_low_thresh = stt->stt_low_thresh;
         stt_tmp->stt_high_thresh = stt->stt_high_thresh;
         stt_tmp->stt_algo = stt->stt_algo;
+        stt_tmp->stt_debounce = stt->stt_debounce;
+        stt_tmp->stt_hysteresis = stt->stt_hysteresis;
+        if (stt->stt_algo == SENSOR_THRESH_ALGO_USERDEF) {
+            stt_tmp->stt_trigger_cmp_algo = stt->stt_trigger_cmp_algo;
+        }
         stt_tmp->stt_sensor = sensor;
         sensor_unlock(sensor);
     } else {
@@ -1983,13 +1429,13 @@ sensor_set_thresh(char *devname, struct sensor_type_traits *stt)
         goto err;
     }
 
-    sensor_set_trigger_cmp_algo(sensor, stt_tmp);
-
     rc = sensor_lock(sensor);
     if (rc) {
         goto err;
     }
 
+    sensor_trig_compile(stt_tmp);
+
     if (sensor->s_funcs->sd_set_trigger_thresh) {
         rc = sensor->s_funcs->sd_set_trigger_thresh(sensor,
                                                     stt_tmp->stt_sensor_type,
@@ -2095,9 +1541,6 @@ sensor_generate_trig(struct sensor *sensor,
                      sensor_type_t type)
 {
     struct sensor_type_traits *stt;
-    sensor_data_t low_thresh;
-    sensor_data_t high_thresh;
-    uint8_t tx_trigger;
     sensor_trigger_notify_func_t notify;
 
     if (!arg) {
@@ -2106,23 +1549,54 @@ sensor_generate_trig(struct sensor *sensor,
 
     notify = arg;
     stt = sensor_get_type_traits_bytype(type, sensor);
+    if (!stt) {
+        return 0;
+    }
+
+    return sensor_trig_eval(stt, data) ? notify(sensor, data, type) : 0;
+}
+
+/*
+ * Evaluates all samples of a batch in one pass, notifying for each sample
+ * which triggers.
+ */
+static int
+sensor_generate_batch_trig(struct sensor *sensor, void *arg,
+                           const struct sensor_batch *sb)
+{
+    struct sensor_type_traits *stt;
+    sensor_trigger_notify_func_t notify;
+    uint8_t *data;
+    int size;
+    int i;
 
-    tx_trigger = 0;
+    notify = arg;
+    stt = sensor_get_type_traits_bytype(sb->sb_type, sensor);
+    if (!stt) {
+        return 0;
+    }
 
-    memcpy(&low_thresh, &stt->stt_low_thresh, sizeof(low_thresh));
-    memcpy(&high_thresh, &stt->stt_high_thresh, sizeof(high_thresh));
+    size = sensor_trig_sample_size(stt);
+    if (!size) {
+        return 0;
+    }
 
-    if (stt->stt_trigger_cmp_algo) {
-        tx_trigger = stt->stt_trigger_cmp_algo(type, &low_thresh,
-                                               &high_thresh, data);
+    data = sb->sb_data;
+    for (i = 0; i < sb->sb_cnt; i++, data += size) {
+        if (sensor_trig_eval(stt, data)) {
+            notify(sensor, data, sb->sb_type);
+        }
     }
 
-    return tx_trigger ? notify(sensor, data, type): 0;
+    return 0;
 }
 
 /**
  * Sensor trigger initialization
  *
+ * Samples read one at a time and samples read in batches are both
+ * evaluated against the thresholds.
+ *
  * @param ptr to the sensor sturucture
  * @param sensor type to enable trigger for
  * @param the function to call if the trigger condition is satisfied
@@ -2133,6 +1607,7 @@ sensor_trigger_init(struct sensor *sensor, sensor_type_t type,
 {
     int rc;
     struct sensor_listener *sensor_trig_lner;
+    struct sensor_batch_listener *sensor_trig_batch_lner;
 
     sensor_trig_lner = malloc(sizeof(struct sensor_listener));
     assert(sensor_trig_lner != NULL);
@@ -2145,6 +1620,18 @@ sensor_trigger_init(struct sensor *sensor, sensor_type_t type,
     if (rc) {
         return;
     }
+
+    sensor_trig_batch_lner = malloc(sizeof(struct sensor_batch_listener));
+    assert(sensor_trig_batch_lner != NULL);
+
+    sensor_trig_batch_lner->sbl_func = sensor_generate_batch_trig;
+    sensor_trig_batch_lner->sbl_sensor_type = type;
+    sensor_trig_batch_lner->sbl_arg = (void *)notify;
+
+    rc = sensor_register_batch_listener(sensor, sensor_trig_batch_lner);
+    if (rc) {
+        return;
+    }
 }
 
 /**
@@ -2195,3 +1682,119 @@ err:
     return (rc);
 }
 
+/**
+ * Spaces the samples of a batch evenly between the previous batch read and
+ * now.  Falls back to the nominal sample period for the first batch, and
+ * when the sensor wasn't read for a while; a FIFO which overflowed only
+ * holds the newest samples.
+ */
+static void
+sensor_batch_time(struct sensor *sensor, struct sensor_batch *sb,
+                  uint32_t sample_us)
+{
+    uint32_t nominal;
+    uint32_t now;
+    uint32_t interval;
+
+    now = sensor->s_sts.st_cputime;
+    nominal = os_cputime_usecs_to_ticks(sample_us);
+    interval = nominal;
+    if (sensor->s_batch_valid && sb->sb_cnt) {
+        interval = (now - sensor->s_batch_cputime) / sb->sb_cnt;
+        if (nominal && interval > 2 * nominal) {
+            interval = nominal;
+        }
+    }
+
+    sb->sb_interval = interval;
+    sb->sb_cputime = now;
+    if (sb->sb_cnt) {
+        sb->sb_cputime -= (sb->sb_cnt - 1) * interval;
+    }
+
+    sensor->s_batch_cputime = now;
+    sensor->s_batch_valid = 1;
+}
+
+static void
+sensor_publish_batch(struct sensor *sensor, const struct sensor_batch *sb)
+{
+    uint8_t *data;
+    int size;
+    int i;
+
+    size = sensor_trig_type_size(sb->sb_type);
+    if (!size) {
+        return;
+    }
+
+    data = sb->sb_data;
+    for (i = 0; i < sb->sb_cnt; i++, data += size) {
+        sensor_bus_publish(sensor->s_bus, sensor, sb->sb_type, data, size,
+                           SENSOR_BATCH_CPUTIME(sb, i));
+    }
+}
+
+int
+sensor_read_batch(struct sensor *sensor, sensor_type_t type, void *data,
+                  uint16_t max, sensor_batch_func_t batch_func, void *arg)
+{
+    struct sensor_batch_listener *listener;
+    struct sensor_batch sb;
+    uint32_t sample_us;
+    int rc;
+
+    if (!sensor->s_funcs->sd_read_batch) {
+        return (SYS_ENOTSUP);
+    }
+
+    rc = sensor_lock(sensor);
+    if (rc) {
+        return (rc);
+    }
+
+    if (!sensor_mgr_match_bytype(sensor, (void *)&type)) {
+        rc = SYS_ENOENT;
+        goto err;
+    }
+
+    sample_us = 0;
+    sb.sb_cnt = 0;
+    rc = sensor->s_funcs->sd_read_batch(sensor, type, data, max, &sb.sb_cnt,
+                                        &sample_us);
+    if (rc) {
+        if (sensor->s_err_fn != NULL) {
+            sensor->s_err_fn(sensor, sensor->s_err_arg, rc);
+        }
+        goto err;
+    }
+
+    sensor_up_timestamp(sensor);
+
+    sb.sb_type = type;
+    sb.sb_data = data;
+    sensor_batch_time(sensor, &sb, sample_us);
+
+    if (sb.sb_cnt == 0) {
+        goto err;
+    }
+
+    if (sensor->s_bus) {
+        sensor_publish_batch(sensor, &sb);
+    }
+
+    SLIST_FOREACH(listener, &sensor->s_batch_listener_list, sbl_next) {
+        if (listener->sbl_sensor_type & type) {
+            listener->sbl_func(sensor, listener->sbl_arg, &sb);
+        }
+    }
+
+    if (batch_func) {
+        rc = batch_func(sensor, arg, &sb);
+    }
+
+err:
+    sensor_unlock(sensor);
+    return (rc);
+}
+
@@ -0,0 +1,369 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor_priv.h"
+
+/* Sequence number a is before b */
+#define SENSOR_BUS_SEQ_LT(__a, __b) ((int32_t)((__a) - (__b)) < 0)
+
+static int
+sensor_bus_lock(struct sensor_bus *bus)
+{
+    int rc;
+
+    rc = os_mutex_pend(&bus->sbus_lock, OS_TIMEOUT_NEVER);
+    if (rc == 0 || rc == OS_NOT_STARTED) {
+        return (0);
+    }
+    return (rc);
+}
+
+static void
+sensor_bus_unlock(struct sensor_bus *bus)
+{
+    os_mutex_release(&bus->sbus_lock);
+}
+
+static struct sensor_bus_entry *
+sensor_bus_entry(struct sensor_bus *bus, uint32_t seq)
+{
+    return (struct sensor_bus_entry *)
+        (bus->sbus_buf + (seq & (bus->sbus_cnt - 1)) * bus->sbus_entry_size);
+}
+
+static int
+sensor_bus_sub_match(const struct sensor_bus_sub *sub,
+                     const struct sensor_bus_entry *entry)
+{
+    return (sub->sbs_sensor_type & entry->sbe_type) &&
+           (!sub->sbs_sensor || sub->sbs_sensor == entry->sbe_sensor);
+}
+
+/*
+ * Handles the entries of an asynchronous subscriber.  The cursor moves past
+ * an entry before it is handled, and the publisher won't overwrite the
+ * entry while it is busy.
+ */
+static void
+sensor_bus_sub_ev_cb(struct os_event *ev)
+{
+    struct sensor_bus_sub *sub;
+    struct sensor_bus_entry *entry;
+    uint32_t seq;
+    os_sr_t sr;
+    int match;
+
+    sub = ev->ev_arg;
+
+    while (1) {
+        OS_ENTER_CRITICAL(sr);
+        if (sub->sbs_cursor == sub->sbs_end) {
+            OS_EXIT_CRITICAL(sr);
+            break;
+        }
+        seq = sub->sbs_cursor++;
+        entry = sensor_bus_entry(sub->sbs_bus, seq);
+        match = sensor_bus_sub_match(sub, entry);
+        if (match) {
+            sub->sbs_pending--;
+        }
+        sub->sbs_busy_seq = seq;
+        sub->sbs_busy = 1;
+        OS_EXIT_CRITICAL(sr);
+
+        if (match) {
+            sub->sbs_func(entry->sbe_sensor, sub->sbs_arg, entry + 1,
+                          entry->sbe_type);
+        }
+
+        sub->sbs_busy = 0;
+    }
+}
+
+int
+sensor_bus_init(struct sensor_bus *bus, void *buf, uint16_t cnt,
+                uint16_t data_size)
+{
+    /* The slot of an entry is its sequence number modulo cnt, which has to
+     * stay consistent when the sequence numbers wrap.
+     */
+    if (!cnt || (cnt & (cnt - 1))) {
+        return SYS_EINVAL;
+    }
+
+    memset(bus, 0, sizeof(*bus));
+    bus->sbus_buf = buf;
+    bus->sbus_cnt = cnt;
+    bus->sbus_data_size = data_size;
+    bus->sbus_entry_size = OS_ALIGN(SENSOR_BUS_ENTRY_SIZE(data_size),
+                                    sizeof(os_membuf_t));
+    SLIST_INIT(&bus->sbus_subs);
+
+    return os_mutex_init(&bus->sbus_lock);
+}
+
+int
+sensor_set_bus(struct sensor *sensor, struct sensor_bus *bus)
+{
+    sensor_type_t type;
+    int size;
+    int rc;
+
+    /* Every sample of the sensor has to fit in an entry */
+    if (bus) {
+        for (type = 1; type; type <<= 1) {
+            if (!(sensor->s_types & type)) {
+                continue;
+            }
+            size = sensor_trig_type_size(type);
+            if (!size || size > bus->sbus_data_size) {
+                return SYS_EINVAL;
+            }
+        }
+    }
+
+    rc = sensor_lock(sensor);
+    if (rc) {
+        return rc;
+    }
+    sensor->s_bus = bus;
+    sensor_unlock(sensor);
+
+    return 0;
+}
+
+int
+sensor_bus_subscribe(struct sensor_bus *bus, struct sensor_bus_sub *sub)
+{
+    os_sr_t sr;
+    int rc;
+
+    if (!sub->sbs_func) {
+        return SYS_EINVAL;
+    }
+
+    rc = sensor_bus_lock(bus);
+    if (rc) {
+        return rc;
+    }
+
+    if (!sub->sbs_depth || sub->sbs_depth > bus->sbus_cnt) {
+        sub->sbs_depth = bus->sbus_cnt;
+    }
+    sub->sbs_bus = bus;
+    sub->sbs_busy = 0;
+    sub->sbs_dropping = 0;
+    sub->sbs_pending = 0;
+    sub->sbs_dropped = 0;
+    sub->sbs_ev.ev_cb = sensor_bus_sub_ev_cb;
+    sub->sbs_ev.ev_arg = sub;
+    sub->sbs_ev.ev_queued = 0;
+
+    OS_ENTER_CRITICAL(sr);
+    sub->sbs_cursor = bus->sbus_head;
+    sub->sbs_end = bus->sbus_head;
+    SLIST_INSERT_HEAD(&bus->sbus_subs, sub, sbs_next);
+    OS_EXIT_CRITICAL(sr);
+
+    sensor_bus_unlock(bus);
+
+    return 0;
+}
+
+int
+sensor_bus_unsubscribe(struct sensor_bus *bus, struct sensor_bus_sub *sub)
+{
+    struct sensor_bus_sub *cursor;
+    os_sr_t sr;
+    int rc;
+
+    rc = sensor_bus_lock(bus);
+    if (rc) {
+        return rc;
+    }
+
+    rc = SYS_ENOENT;
+    OS_ENTER_CRITICAL(sr);
+    SLIST_FOREACH(cursor, &bus->sbus_subs, sbs_next) {
+        if (cursor == sub) {
+            SLIST_REMOVE(&bus->sbus_subs, sub, sensor_bus_sub, sbs_next);
+            rc = 0;
+            break;
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (!rc && sub->sbs_evq) {
+        os_eventq_remove(sub->sbs_evq, &sub->sbs_ev);
+    }
+
+    sensor_bus_unlock(bus);
+
+    return rc;
+}
+
+/*
+ * Moves the cursor of an asynchronous subscriber past an entry, dropping it
+ * if subscribed.  Called with interrupts disabled.
+ */
+static void
+sensor_bus_sub_drop(struct sensor_bus_sub *sub)
+{
+    struct sensor_bus_entry *entry;
+
+    entry = sensor_bus_entry(sub->sbs_bus, sub->sbs_cursor++);
+    if (sensor_bus_sub_match(sub, entry)) {
+        sub->sbs_pending--;
+        sub->sbs_dropped++;
+    }
+}
+
+/*
+ * Adds entry seq, which the subscriber subscribes to, to the entries of an
+ * asynchronous subscriber, applying its overflow policy.  Called with
+ * interrupts disabled.
+ */
+static void
+sensor_bus_sub_add(struct sensor_bus_sub *sub, uint32_t seq)
+{
+    if (sub->sbs_policy == SENSOR_BUS_DROP_NEWEST) {
+        /* Dropping, until the subscriber has caught up */
+        if (sub->sbs_dropping && sub->sbs_cursor != sub->sbs_end) {
+            sub->sbs_dropped++;
+            return;
+        }
+        sub->sbs_dropping = 0;
+        if (sub->sbs_pending >= sub->sbs_depth) {
+            sub->sbs_dropping = 1;
+            sub->sbs_dropped++;
+            return;
+        }
+    }
+
+    /* With nothing pending, skip the entries of other types published since
+     * the last one
+     */
+    if (sub->sbs_cursor == sub->sbs_end) {
+        sub->sbs_cursor = seq;
+    }
+    sub->sbs_end = seq + 1;
+    sub->sbs_pending++;
+
+    /* SENSOR_BUS_DROP_OLDEST */
+    while (sub->sbs_pending > sub->sbs_depth) {
+        sensor_bus_sub_drop(sub);
+    }
+}
+
+int
+sensor_bus_publish(struct sensor_bus *bus, struct sensor *sensor,
+                   sensor_type_t type, const void *data, uint16_t size,
+                   uint32_t cputime)
+{
+    struct sensor_bus_entry *entry;
+    struct sensor_bus_sub *sub;
+    uint32_t oldest;
+    uint32_t seq;
+    os_sr_t sr;
+    int rc;
+
+    rc = sensor_bus_lock(bus);
+    if (rc) {
+        return rc;
+    }
+
+    if (!size || size > bus->sbus_data_size) {
+        rc = SYS_EINVAL;
+        bus->sbus_dropped++;
+        goto done;
+    }
+
+    seq = bus->sbus_head;
+
+    /*
+     * Once the ring has wrapped, the entry for seq replaces the one for
+     * seq - cnt.  Subscribers are moved past that one first, so that none
+     * starts handling it while it is overwritten.
+     */
+    oldest = seq - bus->sbus_cnt + 1;
+    OS_ENTER_CRITICAL(sr);
+    SLIST_FOREACH(sub, &bus->sbus_subs, sbs_next) {
+        if (bus->sbus_wrapped && sub->sbs_busy &&
+            sub->sbs_busy_seq == oldest - 1) {
+            rc = SYS_EBUSY;
+            break;
+        }
+        if (sub->sbs_evq && SENSOR_BUS_SEQ_LT(sub->sbs_cursor, oldest)) {
+            if (SENSOR_BUS_SEQ_LT(sub->sbs_end, oldest)) {
+                sub->sbs_dropped += sub->sbs_pending;
+                sub->sbs_pending = 0;
+                sub->sbs_cursor = oldest;
+                sub->sbs_end = oldest;
+            } else {
+                while (sub->sbs_cursor != oldest) {
+                    sensor_bus_sub_drop(sub);
+                }
+            }
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (rc) {
+        bus->sbus_dropped++;
+        goto done;
+    }
+
+    entry = sensor_bus_entry(bus, seq);
+    entry->sbe_sensor = sensor;
+    entry->sbe_type = type;
+    entry->sbe_cputime = cputime;
+    memcpy(entry + 1, data, size);
+
+    OS_ENTER_CRITICAL(sr);
+    bus->sbus_head = seq + 1;
+    if (!(bus->sbus_head & (bus->sbus_cnt - 1))) {
+        bus->sbus_wrapped = 1;
+    }
+    SLIST_FOREACH(sub, &bus->sbus_subs, sbs_next) {
+        if (sub->sbs_evq && sensor_bus_sub_match(sub, entry)) {
+            sensor_bus_sub_add(sub, seq);
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    SLIST_FOREACH(sub, &bus->sbus_subs, sbs_next) {
+        if (!sensor_bus_sub_match(sub, entry)) {
+            continue;
+        }
+        if (sub->sbs_evq) {
+            if (sub->sbs_cursor != sub->sbs_end) {
+                os_eventq_put(sub->sbs_evq, &sub->sbs_ev);
+            }
+        } else {
+            sub->sbs_func(sensor, sub->sbs_arg, entry + 1, type);
+        }
+    }
+
+done:
+    sensor_bus_unlock(bus);
+    return rc;
+}
@@ -22,6 +22,20 @@
 
 #include "os/mynewt.h"
 
+struct sensor_type_traits;
+
+/* Loads the thresholds of a sensor type for evaluation */
+void sensor_trig_compile(struct sensor_type_traits *stt);
+
+/* Evaluates a sample against the thresholds, returns 1 to notify */
+int sensor_trig_eval(struct sensor_type_traits *stt, void *data);
+
+/* Size of a sample of the type, 0 if the type has no trigger support */
+int sensor_trig_sample_size(const struct sensor_type_traits *stt);
+
+/* Size of the data structure of a sensor type, 0 if unknown */
+int sensor_trig_type_size(sensor_type_t type);
+
 #if MYNEWT_VAL(SENSOR_CLI)
 int sensor_shell_register(void);
 #endif
@@ -0,0 +1,641 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor_priv.h"
+#include "sensor/accel.h"
+#include "sensor/mag.h"
+#include "sensor/light.h"
+#include "sensor/quat.h"
+#include "sensor/euler.h"
+#include "sensor/color.h"
+#include "sensor/temperature.h"
+#include "sensor/pressure.h"
+#include "sensor/humidity.h"
+#include "sensor/gyro.h"
+
+/*
+ * Trigger thresholds are evaluated from a table describing, per sensor type,
+ * the fields to compare and how to load them.  Integer fields are compared
+ * as integers, so sensors reporting raw counts (light, color) never go
+ * through floating point.
+ */
+
+/* How a compared field is stored */
+#define SENSOR_TRIG_F32     0
+#define SENSOR_TRIG_U16     1
+#define SENSOR_TRIG_U32     2
+
+struct sensor_trig_field {
+    uint8_t stf_off;
+    uint8_t stf_kind;
+};
+
+struct sensor_trig_desc {
+    sensor_type_t std_type;
+    /* Size of one sample, the stride of batches */
+    uint8_t std_size;
+    uint8_t std_nfields;
+    /* Returns the valid flags of the fields, bit n for field n */
+    uint8_t (*std_valid)(const void *data);
+    /* Compares a sample with the thresholds */
+    int (*std_cmp)(const struct sensor_trig *st, uint8_t algo,
+                   const uint8_t *data);
+    struct sensor_trig_field std_fields[SENSOR_TRIG_MAX_FIELDS];
+};
+
+#define STF(__s, __f, __k) { offsetof(struct __s, __f), SENSOR_TRIG_##__k }
+
+static uint8_t
+sensor_trig_valid_quat(const void *data)
+{
+    const struct sensor_quat_data *sqd = data;
+
+    return sqd->sqd_x_is_valid | sqd->sqd_y_is_valid << 1 |
+           sqd->sqd_z_is_valid << 2;
+}
+
+static uint8_t
+sensor_trig_valid_accel(const void *data)
+{
+    const struct sensor_accel_data *sad = data;
+
+    return sad->sad_x_is_valid | sad->sad_y_is_valid << 1 |
+           sad->sad_z_is_valid << 2;
+}
+
+static uint8_t
+sensor_trig_valid_euler(const void *data)
+{
+    const struct sensor_euler_data *sed = data;
+
+    return sed->sed_h_is_valid | sed->sed_r_is_valid << 1 |
+           sed->sed_p_is_valid << 2;
+}
+
+static uint8_t
+sensor_trig_valid_gyro(const void *data)
+{
+    const struct sensor_gyro_data *sgd = data;
+
+    return sgd->sgd_x_is_valid | sgd->sgd_y_is_valid << 1 |
+           sgd->sgd_z_is_valid << 2;
+}
+
+static uint8_t
+sensor_trig_valid_mag(const void *data)
+{
+    const struct sensor_mag_data *smd = data;
+
+    return smd->smd_x_is_valid | smd->smd_y_is_valid << 1 |
+           smd->smd_z_is_valid << 2;
+}
+
+static uint8_t
+sensor_trig_valid_temp(const void *data)
+{
+    const struct sensor_temp_data *std = data;
+
+    return std->std_temp_is_valid;
+}
+
+static uint8_t
+sensor_trig_valid_light(const void *data)
+{
+    const struct sensor_light_data *sld = data;
+
+    return sld->sld_full_is_valid | sld->sld_ir_is_valid << 1 |
+           sld->sld_lux_is_valid << 2;
+}
+
+static uint8_t
+sensor_trig_valid_color(const void *data)
+{
+    const struct sensor_color_data *scd = data;
+
+    return scd->scd_r_is_valid | scd->scd_g_is_valid << 1 |
+           scd->scd_b_is_valid << 2 | scd->scd_c_is_valid << 3 |
+           scd->scd_lux_is_valid << 4 | scd->scd_colortemp_is_valid << 5 |
+           scd->scd_ir_is_valid << 6;
+}
+
+static uint8_t
+sensor_trig_valid_press(const void *data)
+{
+    const struct sensor_press_data *spd = data;
+
+    return spd->spd_press_is_valid;
+}
+
+static uint8_t
+sensor_trig_valid_humid(const void *data)
+{
+    const struct sensor_humid_data *shd = data;
+
+    return shd->shd_humid_is_valid;
+}
+
+static int sensor_trig_cmp(const struct sensor_trig *st, uint8_t algo,
+                           const uint8_t *data);
+
+/*
+ * Same as sensor_trig_cmp(), for types whose fields are all floats.  Each
+ * of these types gets a compare function of its own, see STD_CMP_F32(), so
+ * that the valid flags are read inline and the field kind isn't checked per
+ * field.
+ */
+static inline int
+sensor_trig_cmp_f32(const struct sensor_trig *st, uint8_t algo,
+                    uint8_t fields, const uint8_t *data)
+{
+    const struct sensor_trig_field *f;
+    const union sensor_trig_val *low;
+    const union sensor_trig_val *high;
+    float v;
+    int i;
+
+    fields &= st->st_fields;
+    f = st->st_desc->std_fields;
+    low = st->st_low;
+    high = st->st_high;
+
+    if (algo == SENSOR_THRESH_ALGO_WINDOW) {
+        for (i = 0; fields; i++, fields >>= 1) {
+            if (fields & 1) {
+                memcpy(&v, data + f[i].stf_off, sizeof(v));
+                if (v > low[i].stv_f && v < high[i].stv_f) {
+                    return 1;
+                }
+            }
+        }
+    } else {
+        for (i = 0; fields; i++, fields >>= 1) {
+            if (fields & 1) {
+                memcpy(&v, data + f[i].stf_off, sizeof(v));
+                if (v < low[i].stv_f || v > high[i].stv_f) {
+                    return 1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+#define STD_CMP_F32(__name)                                             \
+static int                                                              \
+sensor_trig_cmp_##__name(const struct sensor_trig *st, uint8_t algo,    \
+                         const uint8_t *data)                           \
+{                                                                       \
+    return sensor_trig_cmp_f32(st, algo, sensor_trig_valid_##__name(data), \
+                               data);                                   \
+}
+
+STD_CMP_F32(quat)
+STD_CMP_F32(accel)
+STD_CMP_F32(euler)
+STD_CMP_F32(gyro)
+STD_CMP_F32(mag)
+STD_CMP_F32(temp)
+STD_CMP_F32(press)
+STD_CMP_F32(humid)
+
+#define STD_ACCEL(__t) {                                                \
+    .std_type = (__t),                                                  \
+    .std_size = sizeof(struct sensor_accel_data),                       \
+    .std_nfields = 3,                                                   \
+    .std_valid = sensor_trig_valid_accel,                               \
+    .std_cmp = sensor_trig_cmp_accel,                                   \
+    .std_fields = {                                                     \
+        STF(sensor_accel_data, sad_x, F32),                             \
+        STF(sensor_accel_data, sad_y, F32),                             \
+        STF(sensor_accel_data, sad_z, F32),                             \
+    },                                                                  \
+}
+
+#define STD_TEMP(__t) {                                                 \
+    .std_type = (__t),                                                  \
+    .std_size = sizeof(struct sensor_temp_data),                        \
+    .std_nfields = 1,                                                   \
+    .std_valid = sensor_trig_valid_temp,                                \
+    .std_cmp = sensor_trig_cmp_temp,                                    \
+    .std_fields = {                                                     \
+        STF(sensor_temp_data, std_temp, F32),                           \
+    },                                                                  \
+}
+
+static const struct sensor_trig_desc sensor_trig_descs[] = {
+    {
+        .std_type = SENSOR_TYPE_ROTATION_VECTOR,
+        .std_size = sizeof(struct sensor_quat_data),
+        .std_nfields = 3,
+        .std_valid = sensor_trig_valid_quat,
+        .std_cmp = sensor_trig_cmp_quat,
+        .std_fields = {
+            STF(sensor_quat_data, sqd_x, F32),
+            STF(sensor_quat_data, sqd_y, F32),
+            STF(sensor_quat_data, sqd_z, F32),
+        },
+    },
+    STD_ACCEL(SENSOR_TYPE_ACCELEROMETER),
+    STD_ACCEL(SENSOR_TYPE_LINEAR_ACCEL),
+    STD_ACCEL(SENSOR_TYPE_GRAVITY),
+    {
+        .std_type = SENSOR_TYPE_EULER,
+        .std_size = sizeof(struct sensor_euler_data),
+        .std_nfields = 3,
+        .std_valid = sensor_trig_valid_euler,
+        .std_cmp = sensor_trig_cmp_euler,
+        .std_fields = {
+            STF(sensor_euler_data, sed_h, F32),
+            STF(sensor_euler_data, sed_r, F32),
+            STF(sensor_euler_data, sed_p, F32),
+        },
+    },
+    {
+        .std_type = SENSOR_TYPE_GYROSCOPE,
+        .std_size = sizeof(struct sensor_gyro_data),
+        .std_nfields = 3,
+        .std_valid = sensor_trig_valid_gyro,
+        .std_cmp = sensor_trig_cmp_gyro,
+        .std_fields = {
+            STF(sensor_gyro_data, sgd_x, F32),
+            STF(sensor_gyro_data, sgd_y, F32),
+            STF(sensor_gyro_data, sgd_z, F32),
+        },
+    },
+    {
+        .std_type = SENSOR_TYPE_MAGNETIC_FIELD,
+        .std_size = sizeof(struct sensor_mag_data),
+        .std_nfields = 3,
+        .std_valid = sensor_trig_valid_mag,
+        .std_cmp = sensor_trig_cmp_mag,
+        .std_fields = {
+            STF(sensor_mag_data, smd_x, F32),
+            STF(sensor_mag_data, smd_y, F32),
+            STF(sensor_mag_data, smd_z, F32),
+        },
+    },
+    STD_TEMP(SENSOR_TYPE_TEMPERATURE),
+    STD_TEMP(SENSOR_TYPE_AMBIENT_TEMPERATURE),
+    {
+        .std_type = SENSOR_TYPE_LIGHT,
+        .std_size = sizeof(struct sensor_light_data),
+        .std_nfields = 3,
+        .std_valid = sensor_trig_valid_light,
+        .std_cmp = sensor_trig_cmp,
+        .std_fields = {
+            STF(sensor_light_data, sld_full, U16),
+            STF(sensor_light_data, sld_ir, U16),
+            STF(sensor_light_data, sld_lux, U32),
+        },
+    },
+    {
+        .std_type = SENSOR_TYPE_COLOR,
+        .std_size = sizeof(struct sensor_color_data),
+        .std_nfields = 7,
+        .std_valid = sensor_trig_valid_color,
+        .std_cmp = sensor_trig_cmp,
+        .std_fields = {
+            STF(sensor_color_data, scd_r, U16),
+            STF(sensor_color_data, scd_g, U16),
+            STF(sensor_color_data, scd_b, U16),
+            STF(sensor_color_data, scd_c, U16),
+            STF(sensor_color_data, scd_lux, U16),
+            STF(sensor_color_data, scd_colortemp, U16),
+            STF(sensor_color_data, scd_ir, U16),
+        },
+    },
+    {
+        .std_type = SENSOR_TYPE_PRESSURE,
+        .std_size = sizeof(struct sensor_press_data),
+        .std_nfields = 1,
+        .std_valid = sensor_trig_valid_press,
+        .std_cmp = sensor_trig_cmp_press,
+        .std_fields = {
+            STF(sensor_press_data, spd_press, F32),
+        },
+    },
+    {
+        .std_type = SENSOR_TYPE_RELATIVE_HUMIDITY,
+        .std_size = sizeof(struct sensor_humid_data),
+        .std_nfields = 1,
+        .std_valid = sensor_trig_valid_humid,
+        .std_cmp = sensor_trig_cmp_humid,
+        .std_fields = {
+            STF(sensor_humid_data, shd_humid, F32),
+        },
+    },
+};
+
+static const struct sensor_trig_desc *
+sensor_trig_find_desc(sensor_type_t type)
+{
+    int i;
+
+    for (i = 0; i < sizeof(sensor_trig_descs) / sizeof(sensor_trig_descs[0]);
+         i++) {
+        if (sensor_trig_descs[i].std_type == type) {
+            return &sensor_trig_descs[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Samples are packed, so fields are loaded with memcpy() to stay clear of
+ * unaligned accesses.
+ */
+static union sensor_trig_val
+sensor_trig_load(const struct sensor_trig_field *f, const uint8_t *data)
+{
+    union sensor_trig_val v;
+    uint16_t u16;
+    uint32_t u32;
+
+    switch (f->stf_kind) {
+    case SENSOR_TRIG_U16:
+        memcpy(&u16, data + f->stf_off, sizeof(u16));
+        v.stv_i = u16;
+        break;
+    case SENSOR_TRIG_U32:
+        memcpy(&u32, data + f->stf_off, sizeof(u32));
+        v.stv_i = u32 > INT32_MAX ? INT32_MAX : u32;
+        break;
+    default:
+        memcpy(&v.stv_f, data + f->stf_off, sizeof(v.stv_f));
+        break;
+    }
+
+    return v;
+}
+
+/* Loads the fields of a threshold, returns their valid flags */
+static uint8_t
+sensor_trig_load_thresh(const struct sensor_trig_desc *desc, const void *thresh,
+                        union sensor_trig_val *vals)
+{
+    int i;
+
+    if (!thresh) {
+        return 0;
+    }
+
+    for (i = 0; i < desc->std_nfields; i++) {
+        vals[i] = sensor_trig_load(&desc->std_fields[i], thresh);
+    }
+
+    return desc->std_valid(thresh);
+}
+
+/* Moves a threshold by d, rounding and saturating integer ones */
+static union sensor_trig_val
+sensor_trig_move(const struct sensor_trig_field *f, union sensor_trig_val t,
+                 float d)
+{
+    int64_t i;
+
+    if (f->stf_kind == SENSOR_TRIG_F32) {
+        t.stv_f += d;
+    } else {
+        i = (int64_t)t.stv_i + (int32_t)(d < 0 ? d - 0.5f : d + 0.5f);
+        if (i > INT32_MAX) {
+            i = INT32_MAX;
+        } else if (i < INT32_MIN) {
+            i = INT32_MIN;
+        }
+        t.stv_i = i;
+    }
+
+    return t;
+}
+
+/*
+ * Loads the thresholds for the current trigger state: as given, to enter
+ * the triggered state, or moved by the hysteresis, to stay in it.  A window
+ * widens and watermarks move in, so that a sample has to get clear of them
+ * to untrigger.  Missing watermarks are set to values no sample can pass.
+ * Only the set for the current state is kept; it is reloaded when the state
+ * changes.
+ */
+static void
+sensor_trig_load_state(struct sensor_type_traits *stt)
+{
+    struct sensor_trig *st;
+    const struct sensor_trig_desc *desc;
+    const struct sensor_trig_field *f;
+    union sensor_trig_val low[SENSOR_TRIG_MAX_FIELDS];
+    union sensor_trig_val high[SENSOR_TRIG_MAX_FIELDS];
+    uint8_t low_valid;
+    uint8_t high_valid;
+    float hyst;
+    int i;
+
+    st = &stt->stt_trig;
+    desc = st->st_desc;
+    low_valid = sensor_trig_load_thresh(desc, stt->stt_low_thresh.sad, low);
+    high_valid = sensor_trig_load_thresh(desc, stt->stt_high_thresh.sad, high);
+
+    if (stt->stt_algo == SENSOR_THRESH_ALGO_WINDOW) {
+        st->st_fields = low_valid & high_valid;
+        hyst = -stt->stt_hysteresis;
+    } else {
+        st->st_fields = low_valid | high_valid;
+        hyst = stt->stt_hysteresis;
+    }
+
+    for (i = 0; i < desc->std_nfields; i++) {
+        f = &desc->std_fields[i];
+        if (low_valid & (1 << i)) {
+            st->st_low[i] = stt->stt_trig_active ?
+                            sensor_trig_move(f, low[i], hyst) : low[i];
+        } else if (f->stf_kind == SENSOR_TRIG_F32) {
+            st->st_low[i].stv_f = -INFINITY;
+        } else {
+            st->st_low[i].stv_i = INT32_MIN;
+        }
+
+        if (high_valid & (1 << i)) {
+            st->st_high[i] = stt->stt_trig_active ?
+                             sensor_trig_move(f, high[i], -hyst) : high[i];
+        } else if (f->stf_kind == SENSOR_TRIG_F32) {
+            st->st_high[i].stv_f = INFINITY;
+        } else {
+            st->st_high[i].stv_i = INT32_MAX;
+        }
+    }
+}
+
+void
+sensor_trig_compile(struct sensor_type_traits *stt)
+{
+    struct sensor_trig *st;
+
+    st = &stt->stt_trig;
+    memset(st, 0, sizeof(*st));
+    stt->stt_trig_active = 0;
+    stt->stt_trig_cnt = 0;
+
+    st->st_desc = sensor_trig_find_desc(stt->stt_sensor_type);
+    if (!st->st_desc) {
+        return;
+    }
+
+    sensor_trig_load_state(stt);
+}
+
+/*
+ * Compares the valid fields of a sample with the thresholds; any field
+ * within the window, or past a watermark, triggers.
+ */
+static int
+sensor_trig_cmp(const struct sensor_trig *st, uint8_t algo,
+                const uint8_t *data)
+{
+    const struct sensor_trig_desc *desc;
+    const struct sensor_trig_field *f;
+    const union sensor_trig_val *low;
+    const union sensor_trig_val *high;
+    union sensor_trig_val v;
+    uint8_t fields;
+    int window;
+    int i;
+
+    desc = st->st_desc;
+    fields = desc->std_valid(data) & st->st_fields;
+    if (!fields) {
+        return 0;
+    }
+
+    low = st->st_low;
+    high = st->st_high;
+    window = algo == SENSOR_THRESH_ALGO_WINDOW;
+
+    for (i = 0; fields; i++, fields >>= 1) {
+        if (!(fields & 1)) {
+            continue;
+        }
+
+        f = &desc->std_fields[i];
+        if (f->stf_kind == SENSOR_TRIG_F32) {
+            memcpy(&v.stv_f, data + f->stf_off, sizeof(v.stv_f));
+            if (window ? v.stv_f > low[i].stv_f && v.stv_f < high[i].stv_f :
+                         v.stv_f < low[i].stv_f || v.stv_f > high[i].stv_f) {
+                return 1;
+            }
+        } else {
+            v = sensor_trig_load(f, data);
+            if (window ? v.stv_i > low[i].stv_i && v.stv_i < high[i].stv_i :
+                         v.stv_i < low[i].stv_i || v.stv_i > high[i].stv_i) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Enters or leaves the triggered state, with the thresholds of the state */
+static void
+sensor_trig_set_active(struct sensor_type_traits *stt, uint8_t active)
+{
+    stt->stt_trig_active = active;
+    if (stt->stt_trig.st_desc && stt->stt_hysteresis != 0 &&
+        (stt->stt_algo == SENSOR_THRESH_ALGO_WINDOW ||
+         stt->stt_algo == SENSOR_THRESH_ALGO_WATERMARK)) {
+        sensor_trig_load_state(stt);
+    }
+}
+
+int
+sensor_trig_eval(struct sensor_type_traits *stt, void *data)
+{
+    const struct sensor_trig *st;
+    sensor_data_t low;
+    sensor_data_t high;
+    int hit;
+
+    st = &stt->stt_trig;
+    hit = 0;
+    switch (stt->stt_algo) {
+    case SENSOR_THRESH_ALGO_WINDOW:
+    case SENSOR_THRESH_ALGO_WATERMARK:
+        if (st->st_desc) {
+            hit = st->st_desc->std_cmp(st, stt->stt_algo, data);
+        }
+        break;
+    case SENSOR_THRESH_ALGO_USERDEF:
+        if (stt->stt_trigger_cmp_algo) {
+            memcpy(&low, &stt->stt_low_thresh, sizeof(low));
+            memcpy(&high, &stt->stt_high_thresh, sizeof(high));
+            hit = stt->stt_trigger_cmp_algo(stt->stt_sensor_type, &low, &high,
+                                            data);
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (!hit) {
+        stt->stt_trig_cnt = 0;
+        if (stt->stt_trig_active) {
+            sensor_trig_set_active(stt, 0);
+        }
+        return 0;
+    }
+
+    /* The stt_debounce'th sample in a row triggers; 0 acts as 1 */
+    if (!stt->stt_trig_active) {
+        if (stt->stt_trig_cnt + 1 < stt->stt_debounce) {
+            stt->stt_trig_cnt++;
+            return 0;
+        }
+        sensor_trig_set_active(stt, 1);
+    }
+
+    return 1;
+}
+
+int
+sensor_trig_type_size(sensor_type_t type)
+{
+    const struct sensor_trig_desc *desc;
+
+    desc = sensor_trig_find_desc(type);
+    if (!desc) {
+        return 0;
+    }
+
+    return desc->std_size;
+}
+
+int
+sensor_trig_sample_size(const struct sensor_type_traits *stt)
+{
+    if (!stt->stt_trig.st_desc) {
+        return 0;
+    }
+
+    return stt->stt_trig.st_desc->std_size;
+}
@@ -23,12 +23,36 @@ TEST_SUITE(sensor_test_suite_poll)
     sensor_test_case_poll_err();
 }
 
+TEST_SUITE(sensor_test_suite_batch)
+{
+    sensor_test_case_batch();
+}
+
+TEST_SUITE(sensor_test_suite_trig)
+{
+    sensor_test_case_trig();
+}
+
+TEST_SUITE(sensor_test_suite_bus)
+{
+    sensor_test_case_bus();
+}
+
+TEST_SUITE(sensor_test_suite_sched)
+{
+    sensor_test_case_sched();
+}
+
 #if MYNEWT_VAL(SELFTEST)
 
 int
 main(int argc, char **argv)
 {
     sensor_test_suite_poll();
+    sensor_test_suite_batch();
+    sensor_test_suite_trig();
+    sensor_test_suite_bus();
+    sensor_test_suite_sched();
 
     return tu_any_failed;
 }
@@ -26,4 +26,16 @@
 TEST_SUITE_DECL(sensor_test_suite_poll);
 TEST_CASE_DECL(sensor_test_case_poll_err);
 
+TEST_SUITE_DECL(sensor_test_suite_batch);
+TEST_CASE_DECL(sensor_test_case_batch);
+
+TEST_SUITE_DECL(sensor_test_suite_trig);
+TEST_CASE_DECL(sensor_test_case_trig);
+
+TEST_SUITE_DECL(sensor_test_suite_bus);
+TEST_CASE_DECL(sensor_test_case_bus);
+
+TEST_SUITE_DECL(sensor_test_suite_sched);
+TEST_CASE_DECL(sensor_test_case_sched);
+
 #endif
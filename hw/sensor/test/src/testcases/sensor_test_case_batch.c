@@ -0,0 +1,163 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor_test.h"
+
+#define STCB_SAMPLE_US  10000
+
+static uint16_t stcb_fifo_cnt;
+static struct sensor_batch stcb_listener_batch;
+static int stcb_listener_calls;
+static struct sensor_batch stcb_batch;
+static int stcb_calls;
+
+static int
+stcb_sensor_read(struct sensor *sensor, sensor_type_t type,
+                 sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    return 0;
+}
+
+static int
+stcb_sensor_read_batch(struct sensor *sensor, sensor_type_t type, void *data,
+                       uint16_t max, uint16_t *cnt, uint32_t *sample_us)
+{
+    struct sensor_accel_data *sad;
+    int i;
+
+    sad = data;
+    for (i = 0; i < stcb_fifo_cnt && i < max; i++) {
+        sad[i].sad_x = i;
+        sad[i].sad_x_is_valid = 1;
+    }
+    *cnt = i;
+    *sample_us = STCB_SAMPLE_US;
+    stcb_fifo_cnt -= i;
+
+    return 0;
+}
+
+static int
+stcb_listener(struct sensor *sensor, void *arg, const struct sensor_batch *sb)
+{
+    stcb_listener_batch = *sb;
+    stcb_listener_calls++;
+    return 0;
+}
+
+static int
+stcb_func(struct sensor *sensor, void *arg, const struct sensor_batch *sb)
+{
+    TEST_ASSERT(arg == &stcb_batch);
+    stcb_batch = *sb;
+    stcb_calls++;
+    return 0;
+}
+
+TEST_CASE(sensor_test_case_batch)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcb_sensor_read,
+        .sd_read_batch = stcb_sensor_read_batch,
+    };
+    static struct sensor_driver no_batch_driver = {
+        .sd_read = stcb_sensor_read,
+    };
+    static struct os_dev dev = {
+        .od_name = "stcb",
+    };
+    static struct sensor sn;
+
+    struct sensor_batch_listener listener;
+    struct sensor_accel_data sad[8];
+    uint32_t last;
+    int rc;
+
+    sysinit();
+
+    rc = sensor_init(&sn, &dev);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_ACCELEROMETER, &driver);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    sensor_set_type_mask(&sn, SENSOR_TYPE_ALL);
+
+    rc = sensor_mgr_register(&sn);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    listener.sbl_sensor_type = SENSOR_TYPE_ACCELEROMETER;
+    listener.sbl_func = stcb_listener;
+    listener.sbl_arg = NULL;
+    rc = sensor_register_batch_listener(&sn, &listener);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** First batch; samples are spaced by the nominal period. */
+    stcb_fifo_cnt = 5;
+    rc = sensor_read_batch(&sn, SENSOR_TYPE_ACCELEROMETER, sad, 8, stcb_func,
+                           &stcb_batch);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(stcb_calls == 1);
+    TEST_ASSERT_FATAL(stcb_listener_calls == 1);
+    TEST_ASSERT(stcb_batch.sb_cnt == 5);
+    TEST_ASSERT(stcb_batch.sb_data == sad);
+    TEST_ASSERT(stcb_batch.sb_type == SENSOR_TYPE_ACCELEROMETER);
+    TEST_ASSERT(stcb_batch.sb_interval ==
+                os_cputime_usecs_to_ticks(STCB_SAMPLE_US));
+    TEST_ASSERT(SENSOR_BATCH_CPUTIME(&stcb_batch, 4) == sn.s_batch_cputime);
+    TEST_ASSERT(memcmp(&stcb_batch, &stcb_listener_batch,
+                       sizeof stcb_batch) == 0);
+    TEST_ASSERT(sad[4].sad_x == 4);
+
+    /*** Only as many samples as fit are read; the rest stay buffered. */
+    last = sn.s_batch_cputime;
+    stcb_fifo_cnt = 10;
+    rc = sensor_read_batch(&sn, SENSOR_TYPE_ACCELEROMETER, sad, 8, stcb_func,
+                           &stcb_batch);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcb_batch.sb_cnt == 8);
+    TEST_ASSERT(stcb_fifo_cnt == 2);
+
+    /* The samples are spread since the previous batch. */
+    TEST_ASSERT(stcb_batch.sb_interval ==
+                (sn.s_batch_cputime - last) / 8);
+    TEST_ASSERT(SENSOR_BATCH_CPUTIME(&stcb_batch, 7) == sn.s_batch_cputime);
+
+    /*** An empty FIFO doesn't call anyone. */
+    stcb_fifo_cnt = 0;
+    sensor_read_batch(&sn, SENSOR_TYPE_ACCELEROMETER, sad, 8, stcb_func,
+                      &stcb_batch);
+    TEST_ASSERT(stcb_calls == 2);
+
+    /*** Unregistered listeners aren't called. */
+    rc = sensor_unregister_batch_listener(&sn, &listener);
+    TEST_ASSERT_FATAL(rc == 0);
+    stcb_fifo_cnt = 1;
+    rc = sensor_read_batch(&sn, SENSOR_TYPE_ACCELEROMETER, sad, 8, stcb_func,
+                           &stcb_batch);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcb_calls == 3);
+    TEST_ASSERT(stcb_listener_calls == 2);
+
+    /*** Drivers without batch reads. */
+    sn.s_funcs = &no_batch_driver;
+    rc = sensor_read_batch(&sn, SENSOR_TYPE_ACCELEROMETER, sad, 8, NULL, NULL);
+    TEST_ASSERT(rc == SYS_ENOTSUP);
+}
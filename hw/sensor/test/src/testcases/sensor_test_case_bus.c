@@ -0,0 +1,318 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor_test.h"
+
+#define STCBUS_CNT  4
+
+struct stcbus_rec {
+    void *data[8];
+    int cnt;
+};
+
+static float stcbus_x;
+static struct stcbus_rec stcbus_sync_rec;
+static struct stcbus_rec stcbus_async_rec;
+
+static int
+stcbus_sensor_read(struct sensor *sensor, sensor_type_t type,
+                   sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    struct sensor_accel_data sad;
+
+    memset(&sad, 0, sizeof(sad));
+    sad.sad_x = stcbus_x;
+    sad.sad_x_is_valid = 1;
+    return data_func(sensor, arg, &sad, SENSOR_TYPE_ACCELEROMETER);
+}
+
+static int
+stcbus_func(struct sensor *sensor, void *arg, void *data, sensor_type_t type)
+{
+    struct stcbus_rec *rec;
+
+    rec = arg;
+    TEST_ASSERT_FATAL(rec->cnt < 8);
+    rec->data[rec->cnt++] = data;
+    return 0;
+}
+
+static void
+stcbus_read(struct sensor *sn, float x)
+{
+    int rc;
+
+    stcbus_x = x;
+    rc = sensor_read(sn, SENSOR_TYPE_ACCELEROMETER, NULL, NULL,
+                     OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+static void
+stcbus_run(struct os_eventq *evq)
+{
+    struct os_event *ev;
+
+    while ((ev = os_eventq_get_no_wait(evq)) != NULL) {
+        ev->ev_cb(ev);
+    }
+}
+
+static int stcbus_reentered;
+
+/* Publishes a whole ring of entries while handling the first one */
+static int
+stcbus_reenter_func(struct sensor *sensor, void *arg, void *data,
+                    sensor_type_t type)
+{
+    struct sensor_bus *bus;
+    struct sensor_accel_data sad;
+    int rc;
+    int i;
+
+    if (stcbus_reentered++) {
+        return 0;
+    }
+
+    bus = arg;
+    memset(&sad, 0, sizeof(sad));
+    for (i = 0; i < STCBUS_CNT; i++) {
+        rc = sensor_bus_publish(bus, sensor, SENSOR_TYPE_ACCELEROMETER, &sad,
+                                sizeof(sad), 0);
+        TEST_ASSERT(rc == (i < STCBUS_CNT - 1 ? 0 : SYS_EBUSY));
+    }
+    return 0;
+}
+
+static float
+stcbus_x_at(const struct stcbus_rec *rec, int idx)
+{
+    return ((struct sensor_accel_data *)rec->data[idx])->sad_x;
+}
+
+TEST_CASE(sensor_test_case_bus)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcbus_sensor_read,
+    };
+    static struct os_dev dev = {
+        .od_name = "stcbus",
+    };
+    static os_membuf_t buf[OS_MEMPOOL_SIZE(STCBUS_CNT,
+        SENSOR_BUS_ENTRY_SIZE(sizeof(struct sensor_accel_data)))];
+    static struct sensor sn;
+    static struct sensor_bus bus;
+    static struct os_eventq evq;
+
+    struct sensor_bus_sub sync_sub;
+    struct sensor_bus_sub async_sub;
+    struct sensor_bus_sub light_sub;
+    struct sensor_bus_sub reenter_sub;
+    struct sensor_accel_data sad;
+    int rc;
+
+    sysinit();
+
+    os_eventq_init(&evq);
+
+    rc = sensor_init(&sn, &dev);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_ACCELEROMETER, &driver);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    sensor_set_type_mask(&sn, SENSOR_TYPE_ALL);
+
+    rc = sensor_mgr_register(&sn);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_bus_init(&bus, buf, STCBUS_CNT - 1,
+                         sizeof(struct sensor_accel_data));
+    TEST_ASSERT(rc == SYS_EINVAL);
+    rc = sensor_bus_init(&bus, buf, STCBUS_CNT,
+                         sizeof(struct sensor_accel_data));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Data of user defined types has no known size. */
+    sn.s_types |= SENSOR_TYPE_USER_DEFINED_1;
+    rc = sensor_set_bus(&sn, &bus);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    sn.s_types &= ~SENSOR_TYPE_USER_DEFINED_1;
+
+    rc = sensor_set_bus(&sn, &bus);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memset(&sync_sub, 0, sizeof(sync_sub));
+    sync_sub.sbs_sensor_type = SENSOR_TYPE_ALL;
+    sync_sub.sbs_func = stcbus_func;
+    sync_sub.sbs_arg = &stcbus_sync_rec;
+    rc = sensor_bus_subscribe(&bus, &sync_sub);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memset(&async_sub, 0, sizeof(async_sub));
+    async_sub.sbs_sensor_type = SENSOR_TYPE_ACCELEROMETER;
+    async_sub.sbs_func = stcbus_func;
+    async_sub.sbs_arg = &stcbus_async_rec;
+    async_sub.sbs_evq = &evq;
+    async_sub.sbs_depth = 2;
+    rc = sensor_bus_subscribe(&bus, &async_sub);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memset(&light_sub, 0, sizeof(light_sub));
+    light_sub.sbs_sensor_type = SENSOR_TYPE_LIGHT;
+    light_sub.sbs_func = stcbus_func;
+    light_sub.sbs_arg = NULL;
+    light_sub.sbs_evq = &evq;
+    rc = sensor_bus_subscribe(&bus, &light_sub);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Synchronous subscribers get the data as it is read. */
+    stcbus_read(&sn, 1.0f);
+    stcbus_read(&sn, 2.0f);
+    stcbus_read(&sn, 3.0f);
+    TEST_ASSERT_FATAL(stcbus_sync_rec.cnt == 3);
+    TEST_ASSERT(stcbus_x_at(&stcbus_sync_rec, 2) == 3.0f);
+    TEST_ASSERT(SENSOR_BUS_DATA_ENTRY(stcbus_sync_rec.data[0])->sbe_sensor ==
+                &sn);
+
+    /*** Asynchronous subscribers only keep the newest entries. */
+    TEST_ASSERT(stcbus_async_rec.cnt == 0);
+    stcbus_run(&evq);
+    TEST_ASSERT_FATAL(stcbus_async_rec.cnt == 2);
+    TEST_ASSERT(stcbus_x_at(&stcbus_async_rec, 0) == 2.0f);
+    TEST_ASSERT(stcbus_x_at(&stcbus_async_rec, 1) == 3.0f);
+    TEST_ASSERT(async_sub.sbs_dropped == 1);
+
+    /* Everyone gets the same copy, in the ring. */
+    TEST_ASSERT(stcbus_async_rec.data[0] == stcbus_sync_rec.data[1]);
+    TEST_ASSERT((uint8_t *)stcbus_sync_rec.data[0] >= (uint8_t *)buf &&
+                (uint8_t *)stcbus_sync_rec.data[0] <
+                (uint8_t *)buf + sizeof(buf));
+
+    /*** Drop newest entries instead. */
+    async_sub.sbs_policy = SENSOR_BUS_DROP_NEWEST;
+    stcbus_async_rec.cnt = 0;
+    stcbus_read(&sn, 4.0f);
+    stcbus_read(&sn, 5.0f);
+    stcbus_read(&sn, 6.0f);
+    stcbus_run(&evq);
+    TEST_ASSERT_FATAL(stcbus_async_rec.cnt == 2);
+    TEST_ASSERT(stcbus_x_at(&stcbus_async_rec, 0) == 4.0f);
+    TEST_ASSERT(stcbus_x_at(&stcbus_async_rec, 1) == 5.0f);
+
+    /* Caught up; delivering again. */
+    stcbus_read(&sn, 7.0f);
+    stcbus_run(&evq);
+    TEST_ASSERT_FATAL(stcbus_async_rec.cnt == 3);
+    TEST_ASSERT(stcbus_x_at(&stcbus_async_rec, 2) == 7.0f);
+
+    /*** Unsubscribed and detached. */
+    rc = sensor_bus_unsubscribe(&bus, &async_sub);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_bus_unsubscribe(&bus, &async_sub);
+    TEST_ASSERT(rc == SYS_ENOENT);
+
+    rc = sensor_set_bus(&sn, NULL);
+    TEST_ASSERT(rc == 0);
+    stcbus_read(&sn, 8.0f);
+    stcbus_run(&evq);
+    TEST_ASSERT(stcbus_sync_rec.cnt == 7);
+    TEST_ASSERT(stcbus_async_rec.cnt == 3);
+
+    /*** Samples which don't fit are counted as dropped. */
+    memset(&sad, 0, sizeof(sad));
+    TEST_ASSERT(bus.sbus_dropped == 0);
+    rc = sensor_bus_publish(&bus, &sn, SENSOR_TYPE_ACCELEROMETER, &sad, 0, 0);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    rc = sensor_bus_publish(&bus, &sn, SENSOR_TYPE_ACCELEROMETER, &sad,
+                            sizeof(sad) + 1, 0);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    TEST_ASSERT(bus.sbus_dropped == 2);
+
+    /*** The entry being handled is not overwritten, also once the sequence
+     * numbers have wrapped.
+     */
+    rc = sensor_bus_unsubscribe(&bus, &sync_sub);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_bus_unsubscribe(&bus, &light_sub);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    bus.sbus_head = UINT32_MAX - 1;
+
+    memset(&reenter_sub, 0, sizeof(reenter_sub));
+    reenter_sub.sbs_sensor_type = SENSOR_TYPE_ACCELEROMETER;
+    reenter_sub.sbs_func = stcbus_reenter_func;
+    reenter_sub.sbs_arg = &bus;
+    reenter_sub.sbs_evq = &evq;
+    reenter_sub.sbs_depth = 1;
+    rc = sensor_bus_subscribe(&bus, &reenter_sub);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* While handling UINT32_MAX - 1, UINT32_MAX, 0 and 1 are published, but
+     * not 2, which would overwrite it.
+     */
+    rc = sensor_bus_publish(&bus, &sn, SENSOR_TYPE_ACCELEROMETER, &sad,
+                            sizeof(sad), 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    stcbus_run(&evq);
+
+    TEST_ASSERT(stcbus_reentered == 2);
+    TEST_ASSERT(bus.sbus_head == 2);
+    TEST_ASSERT(bus.sbus_dropped == 3);
+    TEST_ASSERT(reenter_sub.sbs_dropped == 2);
+
+    rc = sensor_bus_unsubscribe(&bus, &reenter_sub);
+    TEST_ASSERT(rc == 0);
+
+    /*** Entries of other types take no room in an asynchronous subscriber,
+     * and aren't counted as dropped.
+     */
+    async_sub.sbs_policy = SENSOR_BUS_DROP_OLDEST;
+    async_sub.sbs_depth = 2;
+    rc = sensor_bus_subscribe(&bus, &async_sub);
+    TEST_ASSERT_FATAL(rc == 0);
+    stcbus_async_rec.cnt = 0;
+
+    sad.sad_x = 1.0f;
+    rc = sensor_bus_publish(&bus, &sn, SENSOR_TYPE_ACCELEROMETER, &sad,
+                            sizeof(sad), 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_bus_publish(&bus, &sn, SENSOR_TYPE_GYROSCOPE, &sad,
+                            sizeof(sad), 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_bus_publish(&bus, &sn, SENSOR_TYPE_GYROSCOPE, &sad,
+                            sizeof(sad), 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    sad.sad_x = 2.0f;
+    rc = sensor_bus_publish(&bus, &sn, SENSOR_TYPE_ACCELEROMETER, &sad,
+                            sizeof(sad), 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    stcbus_run(&evq);
+
+    TEST_ASSERT_FATAL(stcbus_async_rec.cnt == 2);
+    TEST_ASSERT(stcbus_x_at(&stcbus_async_rec, 0) == 1.0f);
+    TEST_ASSERT(stcbus_x_at(&stcbus_async_rec, 1) == 2.0f);
+    TEST_ASSERT(async_sub.sbs_dropped == 0);
+
+    rc = sensor_bus_unsubscribe(&bus, &async_sub);
+    TEST_ASSERT(rc == 0);
+}
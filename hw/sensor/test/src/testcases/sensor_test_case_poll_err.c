@@ -67,7 +67,10 @@ TEST_CASE(sensor_test_case_poll_err)
         .sd_read = stcpe_sensor_read,
     };
 
-    struct sensor sn;
+    static struct os_dev dev = {
+        .od_name = "stcpe",
+    };
+    static struct sensor sn;
     int rc;
 
     sysinit();
@@ -78,7 +81,7 @@ TEST_CASE(sensor_test_case_poll_err)
      * test that the argument is properly passed.
      */
 
-    rc = sensor_init(&sn, NULL);
+    rc = sensor_init(&sn, &dev);
     TEST_ASSERT_FATAL(rc == 0);
 
     rc = sensor_set_driver(&sn,
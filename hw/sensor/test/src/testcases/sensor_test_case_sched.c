@@ -0,0 +1,165 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor_test.h"
+
+#define STCS_CNT        4
+#define STCS_READS_MAX  16
+
+struct stcs_read {
+    struct sensor *sensor;
+    os_time_t ticks;
+};
+
+static struct sensor stcs_sensors[STCS_CNT];
+static struct stcs_read stcs_reads[STCS_READS_MAX];
+static int stcs_num_reads;
+static os_time_t stcs_start;
+
+static int
+stcs_sensor_read(struct sensor *sensor, sensor_type_t type,
+                 sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    struct stcs_read *rd;
+
+    TEST_ASSERT_FATAL(stcs_num_reads < STCS_READS_MAX);
+
+    rd = &stcs_reads[stcs_num_reads++];
+    rd->sensor = sensor;
+    rd->ticks = os_time_get() - stcs_start;
+
+    return 0;
+}
+
+/**
+ * Advances the OS time tick by tick, so that the sensor manager wakes up
+ * (from the default task) when it asked to.
+ */
+static void
+stcs_advance_to(os_time_t ticks)
+{
+    while (os_time_get() - stcs_start < ticks) {
+        os_time_advance(1);
+    }
+}
+
+static int
+stcs_set_rate(int idx, uint32_t poll_rate)
+{
+    return sensor_set_poll_rate_ms(stcs_sensors[idx].s_dev->od_name,
+                                   poll_rate);
+}
+
+/**
+ * Checks that the read at idx is of the sensor at sensor_idx, done the
+ * specified number of ticks after the start of the test.
+ */
+static void
+stcs_expect_read(int idx, int sensor_idx, os_time_t ticks)
+{
+    TEST_ASSERT_FATAL(idx < stcs_num_reads);
+    TEST_ASSERT(stcs_reads[idx].sensor == &stcs_sensors[sensor_idx]);
+    TEST_ASSERT(stcs_reads[idx].ticks == ticks);
+}
+
+/* Poll rates in milliseconds; OS ticks in the sim are 10 ms. */
+#define STCS_TICKS(__ms)    ((__ms) * OS_TICKS_PER_SEC / 1000)
+
+TEST_CASE_TASK(sensor_test_case_sched)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcs_sensor_read,
+    };
+    static struct os_dev devs[STCS_CNT] = {
+        { .od_name = "stcs0" },
+        { .od_name = "stcs1" },
+        { .od_name = "stcs2" },
+        { .od_name = "stcs3" },
+    };
+    uint8_t seen;
+    int rc;
+    int i;
+
+    for (i = 0; i < STCS_CNT; i++) {
+        rc = sensor_init(&stcs_sensors[i], &devs[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        rc = sensor_set_driver(&stcs_sensors[i], SENSOR_TYPE_ACCELEROMETER,
+                               &driver);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        sensor_set_type_mask(&stcs_sensors[i], SENSOR_TYPE_ALL);
+
+        rc = sensor_mgr_register(&stcs_sensors[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    stcs_start = os_time_get();
+
+    /*** Sensors are polled in order of their next run time. */
+    TEST_ASSERT_FATAL(stcs_set_rate(0, 300) == 0);
+    TEST_ASSERT_FATAL(stcs_set_rate(1, 200) == 0);
+    TEST_ASSERT_FATAL(stcs_set_rate(2, 580) == 0);
+
+    stcs_advance_to(STCS_TICKS(570));
+    TEST_ASSERT_FATAL(stcs_num_reads == 3);
+    stcs_expect_read(0, 1, STCS_TICKS(200));
+    stcs_expect_read(1, 0, STCS_TICKS(300));
+    stcs_expect_read(2, 1, STCS_TICKS(400));
+
+    /***
+     * Sensors due within SENSOR_POLL_MERGE_MS (50 ms) of a wakeup are polled
+     * in it: sensors 0 and 1 are due at 600 ms, along with sensor 2 at 580.
+     */
+    stcs_advance_to(STCS_TICKS(600));
+    TEST_ASSERT_FATAL(stcs_num_reads == 6);
+    seen = 0;
+    for (i = 3; i < 6; i++) {
+        TEST_ASSERT(stcs_reads[i].ticks == STCS_TICKS(580));
+        seen |= 1 << (stcs_reads[i].sensor - stcs_sensors);
+    }
+    TEST_ASSERT(seen == 0x07);
+
+    /*** A poll rate of 0 stops polling the sensor. */
+    TEST_ASSERT_FATAL(stcs_set_rate(1, 0) == 0);
+
+    stcs_advance_to(STCS_TICKS(1100));
+    TEST_ASSERT_FATAL(stcs_num_reads == 7);
+    stcs_expect_read(6, 0, STCS_TICKS(880));
+
+    /* Removing a sensor which isn't polled does nothing. */
+    TEST_ASSERT_FATAL(stcs_set_rate(1, 0) == 0);
+
+    /*** At most SENSOR_POLL_MAX (3) sensors are polled. */
+    TEST_ASSERT_FATAL(stcs_set_rate(1, 1000) == 0);
+    TEST_ASSERT(stcs_set_rate(3, 1000) == SYS_ENOMEM);
+
+    /* Changing the rate of a polled sensor still works when full. */
+    TEST_ASSERT(stcs_set_rate(0, 1000) == 0);
+
+    TEST_ASSERT_FATAL(stcs_set_rate(2, 0) == 0);
+    TEST_ASSERT(stcs_set_rate(3, 1000) == 0);
+
+    /* Stop polling, other test cases don't expect it. */
+    for (i = 0; i < STCS_CNT; i++) {
+        TEST_ASSERT(stcs_set_rate(i, 0) == 0);
+    }
+}
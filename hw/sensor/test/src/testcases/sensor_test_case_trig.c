@@ -0,0 +1,185 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor_test.h"
+
+static float stct_x[8];
+static int stct_cnt;
+static struct sensor_accel_data *stct_notified[8];
+static int stct_notify_cnt;
+
+static void
+stct_fill(struct sensor_accel_data *sad, float x)
+{
+    memset(sad, 0, sizeof(*sad));
+    sad->sad_x = x;
+    sad->sad_x_is_valid = 1;
+}
+
+static int
+stct_sensor_read(struct sensor *sensor, sensor_type_t type,
+                 sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    struct sensor_accel_data sad;
+
+    stct_fill(&sad, stct_x[0]);
+    return data_func(sensor, arg, &sad, SENSOR_TYPE_ACCELEROMETER);
+}
+
+static int
+stct_sensor_read_batch(struct sensor *sensor, sensor_type_t type, void *data,
+                       uint16_t max, uint16_t *cnt, uint32_t *sample_us)
+{
+    struct sensor_accel_data *sad;
+    int i;
+
+    sad = data;
+    for (i = 0; i < stct_cnt && i < max; i++) {
+        stct_fill(&sad[i], stct_x[i]);
+    }
+    *cnt = i;
+    *sample_us = 10000;
+
+    return 0;
+}
+
+static int
+stct_notify(struct sensor *sensor, void *data, sensor_type_t type)
+{
+    TEST_ASSERT_FATAL(type == SENSOR_TYPE_ACCELEROMETER);
+    TEST_ASSERT_FATAL(stct_notify_cnt < 8);
+    stct_notified[stct_notify_cnt++] = data;
+    return 0;
+}
+
+/* Reads one sample, returns whether it triggered */
+static int
+stct_read(struct sensor *sn, float x)
+{
+    int cnt;
+    int rc;
+
+    cnt = stct_notify_cnt;
+    stct_x[0] = x;
+    rc = sensor_read(sn, SENSOR_TYPE_ACCELEROMETER, NULL, NULL,
+                     OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    return stct_notify_cnt != cnt;
+}
+
+TEST_CASE(sensor_test_case_trig)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stct_sensor_read,
+        .sd_read_batch = stct_sensor_read_batch,
+    };
+    static struct os_dev dev = {
+        .od_name = "stct",
+    };
+    static struct sensor sn;
+    static struct sensor_type_traits stt;
+
+    struct sensor_accel_data low;
+    struct sensor_accel_data high;
+    struct sensor_accel_data sad[8];
+    int rc;
+
+    sysinit();
+
+    rc = sensor_init(&sn, &dev);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_ACCELEROMETER, &driver);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    sensor_set_type_mask(&sn, SENSOR_TYPE_ALL);
+
+    rc = sensor_mgr_register(&sn);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Watermark at 1.0, 0.25 hysteresis, two samples debounce. */
+    stct_fill(&high, 1.0f);
+    stt.stt_sensor_type = SENSOR_TYPE_ACCELEROMETER;
+    stt.stt_algo = SENSOR_THRESH_ALGO_WATERMARK;
+    stt.stt_high_thresh.sad = &high;
+    stt.stt_hysteresis = 0.25f;
+    stt.stt_debounce = 2;
+    rc = sensor_set_thresh("stct", &stt);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    sensor_trigger_init(&sn, SENSOR_TYPE_ACCELEROMETER, stct_notify);
+
+    /* A glitch doesn't trigger. */
+    TEST_ASSERT(!stct_read(&sn, 1.5f));
+    TEST_ASSERT(!stct_read(&sn, 0.5f));
+
+    /* The second sample in a row does. */
+    TEST_ASSERT(!stct_read(&sn, 1.5f));
+    TEST_ASSERT(stct_read(&sn, 1.5f));
+
+    /* Samples within the hysteresis keep triggering. */
+    TEST_ASSERT(stct_read(&sn, 0.9f));
+    TEST_ASSERT(stct_read(&sn, 0.8f));
+    TEST_ASSERT(!stct_read(&sn, 0.7f));
+
+    /* Debounced again after untriggering. */
+    TEST_ASSERT(!stct_read(&sn, 1.1f));
+
+    /*** Batches are evaluated sample by sample. */
+    stct_notify_cnt = 0;
+    stct_x[0] = 0.5f;
+    stct_x[1] = 1.5f;
+    stct_x[2] = 1.5f;
+    stct_x[3] = 1.5f;
+    stct_x[4] = 0.9f;
+    stct_x[5] = 0.5f;
+    stct_x[6] = 1.5f;
+    stct_cnt = 7;
+    rc = sensor_read_batch(&sn, SENSOR_TYPE_ACCELEROMETER, sad, 8, NULL,
+                           NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(stct_notify_cnt == 3);
+    TEST_ASSERT(stct_notified[0] == &sad[2]);
+    TEST_ASSERT(stct_notified[1] == &sad[3]);
+    TEST_ASSERT(stct_notified[2] == &sad[4]);
+
+    /*** Window between -1.0 and 1.0, without hysteresis. */
+    stct_fill(&low, -1.0f);
+    stt.stt_algo = SENSOR_THRESH_ALGO_WINDOW;
+    stt.stt_low_thresh.sad = &low;
+    stt.stt_hysteresis = 0;
+    stt.stt_debounce = 0;
+    rc = sensor_set_thresh("stct", &stt);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    TEST_ASSERT(stct_read(&sn, 0.5f));
+    TEST_ASSERT(!stct_read(&sn, 1.0f));
+    TEST_ASSERT(!stct_read(&sn, -1.5f));
+    TEST_ASSERT(stct_read(&sn, -0.5f));
+
+    /* Only fields valid in both the thresholds and the data are compared. */
+    high.sad_x_is_valid = 0;
+    rc = sensor_set_thresh("stct", &stt);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(!stct_read(&sn, 0.5f));
+}
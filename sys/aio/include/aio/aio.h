@@ -0,0 +1,216 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#ifndef __SYS_AIO_H_
+#define __SYS_AIO_H_
+
+#include <inttypes.h>
+#include "os/mynewt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \defgroup AIO Asynchronous flash and disk I/O.
+ * @{
+ */
+
+/*
+ * Requests are queued per device, and started in order by a worker running
+ * from the device's event queue. Submitter gets an event when the request
+ * completes. The worker runs from the aio task (AIO_TASK), or from an event
+ * queue served by a dedicated task of its own, so flash latency overlaps
+ * with work done by the submitter.
+ *
+ * Devices with synchronous operations execute one request at a time.
+ * Drivers which can have several requests outstanding implement
+ * adf_start(), and report each result with aio_req_done().
+ */
+
+#define AIO_OP_READ     1
+#define AIO_OP_WRITE    2
+#define AIO_OP_ERASE    3
+
+struct aio_dev;
+
+struct aio_req {
+    uint8_t ar_op;
+    uint32_t ar_addr;
+    void *ar_buf;               /* Destination for read, source for write */
+    uint32_t ar_len;
+    int ar_rc;                  /* Result of the operation */
+
+    /*
+     * Completion event. Put to ar_evq, or if that is NULL, callback is
+     * called directly from the worker. Request can be submitted again once
+     * this has been delivered.
+     */
+    struct os_event ar_ev;
+    struct os_eventq *ar_evq;
+
+    STAILQ_ENTRY(aio_req) ar_next;
+};
+
+/*
+ * Synchronous operations, executed by the worker.
+ */
+struct aio_dev_funcs {
+    int (*adf_read)(struct aio_dev *dev, uint32_t addr, void *buf,
+                    uint32_t len);
+    int (*adf_write)(struct aio_dev *dev, uint32_t addr, const void *buf,
+                     uint32_t len);
+    int (*adf_erase)(struct aio_dev *dev, uint32_t addr, uint32_t len);
+
+    /*
+     * Optional; used instead of the above if set. Starts the request and
+     * returns without waiting for it. Driver reports the result with
+     * aio_req_done(). Non-zero return completes the request with that code.
+     */
+    int (*adf_start)(struct aio_dev *dev, struct aio_req *req);
+};
+
+struct aio_dev {
+    const struct aio_dev_funcs *ad_funcs;
+    void *ad_arg;
+    uint8_t ad_id;
+    uint8_t ad_depth;           /* Max number of requests started */
+    uint8_t ad_active;          /* Number of requests started */
+    uint16_t ad_pending;        /* Number of requests not completed */
+
+    struct os_eventq *ad_evq;   /* Worker runs from this */
+    struct os_event ad_work_ev;
+    STAILQ_HEAD(, aio_req) ad_reqs;     /* Not started yet */
+    STAILQ_HEAD(, aio_req) ad_busy;     /* Started */
+    STAILQ_HEAD(, aio_req) ad_done;     /* Completion not delivered yet */
+};
+
+/**
+ * Initialize a device with given operations. Worker runs from the aio task,
+ * until changed with aio_dev_evq_set(). Without AIO_TASK, event queue must
+ * be set before requests can be submitted.
+ */
+void aio_dev_init(struct aio_dev *dev, const struct aio_dev_funcs *funcs,
+                  void *arg, uint8_t id);
+
+/**
+ * Initialize device for queued I/O on hal_flash device flash_id.
+ */
+void aio_flash_init(struct aio_dev *dev, uint8_t flash_id);
+
+#if MYNEWT_VAL(AIO_DISK)
+struct disk_ops;
+
+/**
+ * Initialize device for queued I/O on a disk. Erase is not supported.
+ */
+void aio_disk_init(struct aio_dev *dev, struct disk_ops *dops,
+                   uint8_t disk_dev);
+#endif
+
+/**
+ * RAM backed flash, erased to 0xff, with fixed latency injected to every
+ * operation. Useful for testing, and simulation of slow flash.
+ */
+struct aio_ram {
+    uint8_t *ar_mem;
+    uint32_t ar_size;
+    os_time_t ar_latency;       /* Ticks to delay each operation */
+};
+
+void aio_ram_init(struct aio_dev *dev, struct aio_ram *ram);
+
+/**
+ * Set the event queue from which the worker of a device runs. Must not be
+ * called while requests are queued. The queue should be served by a task
+ * which can block for as long as device operations take; not the default
+ * event queue.
+ */
+void aio_dev_evq_set(struct aio_dev *dev, struct os_eventq *evq);
+
+/**
+ * Set how many requests a device with adf_start() can have started at
+ * the same time. Default is 1.
+ */
+void aio_dev_depth_set(struct aio_dev *dev, uint8_t depth);
+
+/**
+ * Report the result of a request started with adf_start(). Can be called
+ * from an interrupt.
+ *
+ * @param dev                   Device request was started on.
+ * @param req                   Request.
+ * @param rc                    Result of the operation.
+ */
+void aio_req_done(struct aio_dev *dev, struct aio_req *req, int rc);
+
+/**
+ * Fill in a request.
+ *
+ * @param req                   Request to initialize.
+ * @param op                    AIO_OP_[...]
+ * @param addr                  Device address.
+ * @param buf                   Data buffer; must stay valid until request
+ *                                  completes.
+ * @param len                   Number of bytes.
+ * @param cb                    Completion callback; event argument is arg.
+ * @param arg                   Argument for callback.
+ * @param evq                   Queue to post completion to, or NULL to
+ *                                  call cb from the worker.
+ *
+ * Must not be called for a request which has been submitted, and not
+ * completed yet.
+ */
+void aio_req_init(struct aio_req *req, uint8_t op, uint32_t addr, void *buf,
+                  uint32_t len, os_event_fn *cb, void *arg,
+                  struct os_eventq *evq);
+
+/**
+ * Queue a request to device. Returns immediately.
+ *
+ * @return                      0 on success; SYS_EINVAL on bad request, or
+ *                                  if device has no event queue;
+ *                                  SYS_EBUSY if request is already queued.
+ */
+int aio_submit(struct aio_dev *dev, struct aio_req *req);
+
+/**
+ * Helpers to initialize and submit a request in one call. Return SYS_EBUSY,
+ * leaving the request untouched, if it is already queued to dev.
+ */
+int aio_read(struct aio_dev *dev, struct aio_req *req, uint32_t addr,
+             void *buf, uint32_t len, os_event_fn *cb, void *arg,
+             struct os_eventq *evq);
+int aio_write(struct aio_dev *dev, struct aio_req *req, uint32_t addr,
+              const void *buf, uint32_t len, os_event_fn *cb, void *arg,
+              struct os_eventq *evq);
+int aio_erase(struct aio_dev *dev, struct aio_req *req, uint32_t addr,
+              uint32_t len, os_event_fn *cb, void *arg,
+              struct os_eventq *evq);
+
+/**
+ * @} AIO
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SYS_AIO_H_ */
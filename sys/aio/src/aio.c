@@ -0,0 +1,520 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <assert.h>
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "hal/hal_flash.h"
+#include "aio/aio.h"
+#if MYNEWT_VAL(AIO_DISK)
+#include "disk/disk.h"
+#endif
+
+#if MYNEWT_VAL(AIO_TASK)
+static struct os_task aio_task;
+static struct os_eventq aio_evq;
+static os_stack_t aio_stack[MYNEWT_VAL(AIO_TASK_STACK_SIZE)];
+
+static void
+aio_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&aio_evq);
+    }
+}
+#endif
+
+static void
+aio_req_exec(struct aio_dev *dev, struct aio_req *req)
+{
+    const struct aio_dev_funcs *funcs;
+
+    funcs = dev->ad_funcs;
+    switch (req->ar_op) {
+    case AIO_OP_READ:
+        req->ar_rc = funcs->adf_read(dev, req->ar_addr, req->ar_buf,
+                                     req->ar_len);
+        break;
+    case AIO_OP_WRITE:
+        req->ar_rc = funcs->adf_write(dev, req->ar_addr, req->ar_buf,
+                                      req->ar_len);
+        break;
+    case AIO_OP_ERASE:
+        if (funcs->adf_erase) {
+            req->ar_rc = funcs->adf_erase(dev, req->ar_addr, req->ar_len);
+        } else {
+            req->ar_rc = SYS_ENOTSUP;
+        }
+        break;
+    default:
+        assert(0);
+        break;
+    }
+}
+
+static void
+aio_req_complete(struct aio_req *req)
+{
+    if (req->ar_evq) {
+        os_eventq_put(req->ar_evq, &req->ar_ev);
+    } else if (req->ar_ev.ev_cb) {
+        req->ar_ev.ev_cb(&req->ar_ev);
+    }
+}
+
+/*
+ * Synchronous operations block the worker, so it executes one request at a
+ * time, and requeues itself if there are more. This way other users of the
+ * same event queue are not starved.
+ */
+static void
+aio_worker_sync(struct aio_dev *dev)
+{
+    struct aio_req *req;
+    int more;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    req = STAILQ_FIRST(&dev->ad_reqs);
+    if (req) {
+        STAILQ_REMOVE_HEAD(&dev->ad_reqs, ar_next);
+        STAILQ_INSERT_TAIL(&dev->ad_busy, req, ar_next);
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (!req) {
+        return;
+    }
+
+    aio_req_exec(dev, req);
+
+    OS_ENTER_CRITICAL(sr);
+    STAILQ_REMOVE_HEAD(&dev->ad_busy, ar_next);
+    dev->ad_pending--;
+    more = !STAILQ_EMPTY(&dev->ad_reqs);
+    OS_EXIT_CRITICAL(sr);
+
+    if (more) {
+        os_eventq_put(dev->ad_evq, &dev->ad_work_ev);
+    }
+
+    aio_req_complete(req);
+}
+
+/*
+ * Start requests until the driver has ad_depth of them outstanding.
+ */
+static void
+aio_worker_start(struct aio_dev *dev)
+{
+    struct aio_req *req;
+    os_sr_t sr;
+    int rc;
+
+    while (1) {
+        OS_ENTER_CRITICAL(sr);
+        req = NULL;
+        if (dev->ad_active < dev->ad_depth) {
+            req = STAILQ_FIRST(&dev->ad_reqs);
+            if (req) {
+                STAILQ_REMOVE_HEAD(&dev->ad_reqs, ar_next);
+                STAILQ_INSERT_TAIL(&dev->ad_busy, req, ar_next);
+                dev->ad_active++;
+            }
+        }
+        OS_EXIT_CRITICAL(sr);
+
+        if (!req) {
+            break;
+        }
+
+        rc = dev->ad_funcs->adf_start(dev, req);
+        if (rc) {
+            aio_req_done(dev, req, rc);
+        }
+    }
+}
+
+static void
+aio_worker(struct os_event *ev)
+{
+    struct aio_dev *dev;
+    struct aio_req *req;
+    os_sr_t sr;
+
+    dev = ev->ev_arg;
+
+    /* Deliver completions reported by the driver. */
+    while (1) {
+        OS_ENTER_CRITICAL(sr);
+        req = STAILQ_FIRST(&dev->ad_done);
+        if (req) {
+            STAILQ_REMOVE_HEAD(&dev->ad_done, ar_next);
+            dev->ad_pending--;
+        }
+        OS_EXIT_CRITICAL(sr);
+
+        if (!req) {
+            break;
+        }
+        aio_req_complete(req);
+    }
+
+    if (dev->ad_funcs->adf_start) {
+        aio_worker_start(dev);
+    } else {
+        aio_worker_sync(dev);
+    }
+}
+
+void
+aio_req_done(struct aio_dev *dev, struct aio_req *req, int rc)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    req->ar_rc = rc;
+    STAILQ_REMOVE(&dev->ad_busy, req, aio_req, ar_next);
+    STAILQ_INSERT_TAIL(&dev->ad_done, req, ar_next);
+    dev->ad_active--;
+    OS_EXIT_CRITICAL(sr);
+
+    os_eventq_put(dev->ad_evq, &dev->ad_work_ev);
+}
+
+/*
+ * Whether request is on one of device's queues. Must be called with
+ * interrupts disabled.
+ */
+static int
+aio_req_queued(struct aio_dev *dev, struct aio_req *req)
+{
+    struct aio_req *cur;
+
+    STAILQ_FOREACH(cur, &dev->ad_reqs, ar_next) {
+        if (cur == req) {
+            return 1;
+        }
+    }
+    STAILQ_FOREACH(cur, &dev->ad_busy, ar_next) {
+        if (cur == req) {
+            return 1;
+        }
+    }
+    STAILQ_FOREACH(cur, &dev->ad_done, ar_next) {
+        if (cur == req) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void
+aio_dev_init(struct aio_dev *dev, const struct aio_dev_funcs *funcs,
+             void *arg, uint8_t id)
+{
+    memset(dev, 0, sizeof(*dev));
+    dev->ad_funcs = funcs;
+    dev->ad_arg = arg;
+    dev->ad_id = id;
+    dev->ad_depth = 1;
+#if MYNEWT_VAL(AIO_TASK)
+    dev->ad_evq = &aio_evq;
+#endif
+    dev->ad_work_ev.ev_cb = aio_worker;
+    dev->ad_work_ev.ev_arg = dev;
+    STAILQ_INIT(&dev->ad_reqs);
+    STAILQ_INIT(&dev->ad_busy);
+    STAILQ_INIT(&dev->ad_done);
+}
+
+void
+aio_dev_evq_set(struct aio_dev *dev, struct os_eventq *evq)
+{
+    assert(dev->ad_pending == 0);
+    dev->ad_evq = evq;
+}
+
+void
+aio_dev_depth_set(struct aio_dev *dev, uint8_t depth)
+{
+    assert(depth > 0);
+    dev->ad_depth = depth;
+}
+
+void
+aio_req_init(struct aio_req *req, uint8_t op, uint32_t addr, void *buf,
+             uint32_t len, os_event_fn *cb, void *arg, struct os_eventq *evq)
+{
+    memset(req, 0, sizeof(*req));
+    req->ar_op = op;
+    req->ar_addr = addr;
+    req->ar_buf = buf;
+    req->ar_len = len;
+    req->ar_ev.ev_cb = cb;
+    req->ar_ev.ev_arg = arg;
+    req->ar_evq = evq;
+}
+
+int
+aio_submit(struct aio_dev *dev, struct aio_req *req)
+{
+    os_sr_t sr;
+
+    if (req->ar_op < AIO_OP_READ || req->ar_op > AIO_OP_ERASE) {
+        return SYS_EINVAL;
+    }
+    if (req->ar_op != AIO_OP_ERASE && !req->ar_buf) {
+        return SYS_EINVAL;
+    }
+    if (!dev->ad_evq) {
+        return SYS_EINVAL;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    if (aio_req_queued(dev, req)) {
+        OS_EXIT_CRITICAL(sr);
+        return SYS_EBUSY;
+    }
+    req->ar_rc = SYS_EBUSY;
+    STAILQ_INSERT_TAIL(&dev->ad_reqs, req, ar_next);
+    dev->ad_pending++;
+    OS_EXIT_CRITICAL(sr);
+
+    os_eventq_put(dev->ad_evq, &dev->ad_work_ev);
+    return 0;
+}
+
+/*
+ * Helpers check before initializing the request; that would corrupt the
+ * queue it is on.
+ */
+static int
+aio_req_busy(struct aio_dev *dev, struct aio_req *req)
+{
+    os_sr_t sr;
+    int rc;
+
+    OS_ENTER_CRITICAL(sr);
+    rc = aio_req_queued(dev, req);
+    OS_EXIT_CRITICAL(sr);
+
+    return rc;
+}
+
+int
+aio_read(struct aio_dev *dev, struct aio_req *req, uint32_t addr, void *buf,
+         uint32_t len, os_event_fn *cb, void *arg, struct os_eventq *evq)
+{
+    if (aio_req_busy(dev, req)) {
+        return SYS_EBUSY;
+    }
+    aio_req_init(req, AIO_OP_READ, addr, buf, len, cb, arg, evq);
+    return aio_submit(dev, req);
+}
+
+int
+aio_write(struct aio_dev *dev, struct aio_req *req, uint32_t addr,
+          const void *buf, uint32_t len, os_event_fn *cb, void *arg,
+          struct os_eventq *evq)
+{
+    if (aio_req_busy(dev, req)) {
+        return SYS_EBUSY;
+    }
+    aio_req_init(req, AIO_OP_WRITE, addr, (void *)buf, len, cb, arg, evq);
+    return aio_submit(dev, req);
+}
+
+int
+aio_erase(struct aio_dev *dev, struct aio_req *req, uint32_t addr,
+          uint32_t len, os_event_fn *cb, void *arg, struct os_eventq *evq)
+{
+    if (aio_req_busy(dev, req)) {
+        return SYS_EBUSY;
+    }
+    aio_req_init(req, AIO_OP_ERASE, addr, NULL, len, cb, arg, evq);
+    return aio_submit(dev, req);
+}
+
+/*
+ * hal_flash backend.
+ */
+static int
+aio_flash_read(struct aio_dev *dev, uint32_t addr, void *buf, uint32_t len)
+{
+    return hal_flash_read(dev->ad_id, addr, buf, len) ? SYS_EIO : 0;
+}
+
+static int
+aio_flash_write(struct aio_dev *dev, uint32_t addr, const void *buf,
+                uint32_t len)
+{
+    return hal_flash_write(dev->ad_id, addr, buf, len) ? SYS_EIO : 0;
+}
+
+static int
+aio_flash_erase(struct aio_dev *dev, uint32_t addr, uint32_t len)
+{
+    return hal_flash_erase(dev->ad_id, addr, len) ? SYS_EIO : 0;
+}
+
+static const struct aio_dev_funcs aio_flash_funcs = {
+    .adf_read = aio_flash_read,
+    .adf_write = aio_flash_write,
+    .adf_erase = aio_flash_erase,
+};
+
+void
+aio_flash_init(struct aio_dev *dev, uint8_t flash_id)
+{
+    aio_dev_init(dev, &aio_flash_funcs, NULL, flash_id);
+}
+
+#if MYNEWT_VAL(AIO_DISK)
+/*
+ * fs/disk backend.
+ */
+static int
+aio_disk_read(struct aio_dev *dev, uint32_t addr, void *buf, uint32_t len)
+{
+    struct disk_ops *dops;
+
+    dops = dev->ad_arg;
+    return dops->read(dev->ad_id, addr, buf, len) ? SYS_EIO : 0;
+}
+
+static int
+aio_disk_write(struct aio_dev *dev, uint32_t addr, const void *buf,
+               uint32_t len)
+{
+    struct disk_ops *dops;
+
+    dops = dev->ad_arg;
+    return dops->write(dev->ad_id, addr, buf, len) ? SYS_EIO : 0;
+}
+
+static const struct aio_dev_funcs aio_disk_funcs = {
+    .adf_read = aio_disk_read,
+    .adf_write = aio_disk_write,
+};
+
+void
+aio_disk_init(struct aio_dev *dev, struct disk_ops *dops, uint8_t disk_dev)
+{
+    aio_dev_init(dev, &aio_disk_funcs, dops, disk_dev);
+}
+#endif
+
+/*
+ * RAM backend with injected latency.
+ */
+static int
+aio_ram_check(struct aio_ram *ram, uint32_t addr, uint32_t len)
+{
+    if (addr > ram->ar_size || len > ram->ar_size - addr) {
+        return SYS_EINVAL;
+    }
+    if (ram->ar_latency) {
+        os_time_delay(ram->ar_latency);
+    }
+    return 0;
+}
+
+static int
+aio_ram_read(struct aio_dev *dev, uint32_t addr, void *buf, uint32_t len)
+{
+    struct aio_ram *ram;
+    int rc;
+
+    ram = dev->ad_arg;
+    rc = aio_ram_check(ram, addr, len);
+    if (rc) {
+        return rc;
+    }
+    memcpy(buf, ram->ar_mem + addr, len);
+    return 0;
+}
+
+static int
+aio_ram_write(struct aio_dev *dev, uint32_t addr, const void *buf,
+              uint32_t len)
+{
+    struct aio_ram *ram;
+    const uint8_t *u8p;
+    uint32_t i;
+    int rc;
+
+    ram = dev->ad_arg;
+    rc = aio_ram_check(ram, addr, len);
+    if (rc) {
+        return rc;
+    }
+    /* Like flash, writing can only clear bits. */
+    u8p = buf;
+    for (i = 0; i < len; i++) {
+        ram->ar_mem[addr + i] &= u8p[i];
+    }
+    return 0;
+}
+
+static int
+aio_ram_erase(struct aio_dev *dev, uint32_t addr, uint32_t len)
+{
+    struct aio_ram *ram;
+    int rc;
+
+    ram = dev->ad_arg;
+    rc = aio_ram_check(ram, addr, len);
+    if (rc) {
+        return rc;
+    }
+    memset(ram->ar_mem + addr, 0xff, len);
+    return 0;
+}
+
+static const struct aio_dev_funcs aio_ram_funcs = {
+    .adf_read = aio_ram_read,
+    .adf_write = aio_ram_write,
+    .adf_erase = aio_ram_erase,
+};
+
+void
+aio_ram_init(struct aio_dev *dev, struct aio_ram *ram)
+{
+    aio_dev_init(dev, &aio_ram_funcs, ram, 0);
+}
+
+void
+aio_pkg_init(void)
+{
+#if MYNEWT_VAL(AIO_TASK)
+    int rc;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    os_eventq_init(&aio_evq);
+    rc = os_task_init(&aio_task, "aio", aio_task_handler, NULL,
+                      MYNEWT_VAL(AIO_TASK_PRIO), OS_WAIT_FOREVER, aio_stack,
+                      MYNEWT_VAL(AIO_TASK_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+#endif
+}
@@ -0,0 +1,99 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#include "aio_test.h"
+
+uint8_t aio_test_mem[AIO_TEST_RAM_SZ];
+struct aio_ram aio_test_ram;
+struct aio_dev aio_test_dev;
+
+struct os_eventq aio_test_work_evq;
+struct os_eventq aio_test_done_evq;
+
+void
+aio_test_setup(void)
+{
+    memset(aio_test_mem, 0, sizeof(aio_test_mem));
+    aio_test_ram.ar_mem = aio_test_mem;
+    aio_test_ram.ar_size = sizeof(aio_test_mem);
+    aio_test_ram.ar_latency = 0;
+
+    os_eventq_init(&aio_test_work_evq);
+    os_eventq_init(&aio_test_done_evq);
+
+    aio_ram_init(&aio_test_dev, &aio_test_ram);
+    aio_dev_evq_set(&aio_test_dev, &aio_test_work_evq);
+}
+
+/*
+ * Run one event from evq, if there is one. Returns 1 if an event was run.
+ */
+int
+aio_test_run_one(struct os_eventq *evq)
+{
+    struct os_event *ev;
+
+    ev = os_eventq_get_no_wait(evq);
+    if (!ev) {
+        return 0;
+    }
+    ev->ev_cb(ev);
+    return 1;
+}
+
+/*
+ * Completion callback; records the order in which requests complete.
+ */
+void
+aio_test_done_cb(struct os_event *ev)
+{
+    int *order;
+
+    order = ev->ev_arg;
+    *order = *order + 1;
+}
+
+TEST_CASE_DECL(aio_test_queue)
+TEST_CASE_DECL(aio_test_errors)
+TEST_CASE_DECL(aio_test_depth)
+
+TEST_SUITE(aio_test_all)
+{
+    aio_test_queue();
+    aio_test_errors();
+    aio_test_depth();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    aio_test_all();
+
+    return tu_any_failed;
+}
+#endif
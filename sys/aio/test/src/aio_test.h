@@ -0,0 +1,52 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _AIO_TEST_H
+#define _AIO_TEST_H
+
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#include "aio/aio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AIO_TEST_RAM_SZ         1024
+
+extern uint8_t aio_test_mem[AIO_TEST_RAM_SZ];
+extern struct aio_ram aio_test_ram;
+extern struct aio_dev aio_test_dev;
+
+/* Worker runs from this queue; completions are posted to the other one. */
+extern struct os_eventq aio_test_work_evq;
+extern struct os_eventq aio_test_done_evq;
+
+void aio_test_setup(void);
+int aio_test_run_one(struct os_eventq *evq);
+void aio_test_done_cb(struct os_event *ev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AIO_TEST_H */
@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "aio_test.h"
+
+/*
+ * Driver which starts requests and completes them later; requests started
+ * but not done yet are kept here.
+ */
+static struct aio_req *aio_test_started[4];
+static int aio_test_started_cnt;
+
+static int
+aio_test_depth_start(struct aio_dev *dev, struct aio_req *req)
+{
+    if (req->ar_op == AIO_OP_ERASE) {
+        return SYS_ENOTSUP;
+    }
+    aio_test_started[aio_test_started_cnt++] = req;
+    return 0;
+}
+
+static const struct aio_dev_funcs aio_test_depth_funcs = {
+    .adf_start = aio_test_depth_start,
+};
+
+TEST_CASE(aio_test_depth)
+{
+    struct aio_req reqs[4];
+    struct aio_dev dev;
+    uint8_t buf[16];
+    int done[4];
+    int rc;
+    int i;
+
+    aio_test_setup();
+    memset(done, 0, sizeof(done));
+    aio_test_started_cnt = 0;
+
+    aio_dev_init(&dev, &aio_test_depth_funcs, NULL, 0);
+    aio_dev_evq_set(&dev, &aio_test_work_evq);
+    aio_dev_depth_set(&dev, 2);
+
+    for (i = 0; i < 3; i++) {
+        rc = aio_read(&dev, &reqs[i], i * sizeof(buf), buf, sizeof(buf),
+                      aio_test_done_cb, &done[i], NULL);
+        TEST_ASSERT(rc == 0);
+    }
+
+    /* Worker starts as many requests as the driver takes. */
+    TEST_ASSERT(aio_test_run_one(&aio_test_work_evq) == 1);
+    TEST_ASSERT(aio_test_started_cnt == 2);
+    TEST_ASSERT(aio_test_started[0] == &reqs[0]);
+    TEST_ASSERT(aio_test_started[1] == &reqs[1]);
+    TEST_ASSERT(dev.ad_active == 2);
+    TEST_ASSERT(dev.ad_pending == 3);
+
+    /* Requests can complete out of order; that makes room for the next. */
+    aio_req_done(&dev, &reqs[1], SYS_EIO);
+    TEST_ASSERT(done[1] == 0);
+    TEST_ASSERT(aio_test_run_one(&aio_test_work_evq) == 1);
+    TEST_ASSERT(done[1] == 1);
+    TEST_ASSERT(reqs[1].ar_rc == SYS_EIO);
+    TEST_ASSERT(aio_test_started_cnt == 3);
+    TEST_ASSERT(aio_test_started[2] == &reqs[2]);
+    TEST_ASSERT(dev.ad_pending == 2);
+
+    /* Started requests can't be submitted again, completed ones can. */
+    rc = aio_submit(&dev, &reqs[0]);
+    TEST_ASSERT(rc == SYS_EBUSY);
+    rc = aio_read(&dev, &reqs[0], 0, buf, sizeof(buf), aio_test_done_cb,
+                  &done[0], NULL);
+    TEST_ASSERT(rc == SYS_EBUSY);
+    rc = aio_read(&dev, &reqs[1], 0, buf, sizeof(buf), aio_test_done_cb,
+                  &done[1], NULL);
+    TEST_ASSERT(rc == 0);
+
+    aio_req_done(&dev, &reqs[0], 0);
+    aio_req_done(&dev, &reqs[2], 0);
+    TEST_ASSERT(aio_test_run_one(&aio_test_work_evq) == 1);
+    TEST_ASSERT(done[0] == 1 && done[2] == 1);
+    TEST_ASSERT(reqs[0].ar_rc == 0);
+    TEST_ASSERT(aio_test_started_cnt == 4);
+    TEST_ASSERT(aio_test_started[3] == &reqs[1]);
+
+    /* Request the driver does not start completes with its error. */
+    rc = aio_erase(&dev, &reqs[3], 0, sizeof(buf), aio_test_done_cb,
+                   &done[3], NULL);
+    TEST_ASSERT(rc == 0);
+    while (aio_test_run_one(&aio_test_work_evq)) {
+    }
+    TEST_ASSERT(done[3] == 1);
+    TEST_ASSERT(reqs[3].ar_rc == SYS_ENOTSUP);
+    TEST_ASSERT(aio_test_started_cnt == 4);
+
+    aio_req_done(&dev, &reqs[1], 0);
+    TEST_ASSERT(aio_test_run_one(&aio_test_work_evq) == 1);
+    TEST_ASSERT(done[1] == 2);
+    TEST_ASSERT(dev.ad_active == 0);
+    TEST_ASSERT(dev.ad_pending == 0);
+}
@@ -0,0 +1,104 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "aio_test.h"
+
+static int
+aio_test_noerase_read(struct aio_dev *dev, uint32_t addr, void *buf,
+                      uint32_t len)
+{
+    return 0;
+}
+
+static int
+aio_test_noerase_write(struct aio_dev *dev, uint32_t addr, const void *buf,
+                       uint32_t len)
+{
+    return 0;
+}
+
+static const struct aio_dev_funcs aio_test_noerase_funcs = {
+    .adf_read = aio_test_noerase_read,
+    .adf_write = aio_test_noerase_write,
+};
+
+TEST_CASE(aio_test_errors)
+{
+    struct aio_dev dev;
+    struct aio_req req;
+    uint8_t buf[16];
+    int done;
+    int rc;
+
+    aio_test_setup();
+    done = 0;
+
+    /* Bad requests are rejected at submit. */
+    aio_req_init(&req, 0, 0, buf, sizeof(buf), aio_test_done_cb, &done,
+                 &aio_test_done_evq);
+    rc = aio_submit(&aio_test_dev, &req);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    rc = aio_read(&aio_test_dev, &req, 0, NULL, sizeof(buf),
+                  aio_test_done_cb, &done, &aio_test_done_evq);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    TEST_ASSERT(aio_test_dev.ad_pending == 0);
+
+    /* Queued request can't be submitted again. */
+    rc = aio_read(&aio_test_dev, &req, 0, buf, sizeof(buf),
+                  aio_test_done_cb, &done, &aio_test_done_evq);
+    TEST_ASSERT(rc == 0);
+    rc = aio_submit(&aio_test_dev, &req);
+    TEST_ASSERT(rc == SYS_EBUSY);
+    rc = aio_write(&aio_test_dev, &req, 0, buf, sizeof(buf),
+                   aio_test_done_cb, &done, &aio_test_done_evq);
+    TEST_ASSERT(rc == SYS_EBUSY);
+    TEST_ASSERT(aio_test_dev.ad_pending == 1);
+    TEST_ASSERT(aio_test_run_one(&aio_test_work_evq) == 1);
+    TEST_ASSERT(aio_test_run_one(&aio_test_work_evq) == 0);
+    TEST_ASSERT(aio_test_run_one(&aio_test_done_evq) == 1);
+    TEST_ASSERT(req.ar_rc == 0);
+    done = 0;
+
+    /* Device without an event queue can't take requests. */
+    aio_dev_init(&dev, &aio_test_noerase_funcs, NULL, 0);
+    aio_dev_evq_set(&dev, NULL);
+    rc = aio_read(&dev, &req, 0, buf, sizeof(buf), aio_test_done_cb, &done,
+                  &aio_test_done_evq);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    /* Device errors are reported in completion. */
+    rc = aio_read(&aio_test_dev, &req, AIO_TEST_RAM_SZ - 8, buf, sizeof(buf),
+                  aio_test_done_cb, &done, &aio_test_done_evq);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(aio_test_run_one(&aio_test_work_evq) == 1);
+    TEST_ASSERT(aio_test_run_one(&aio_test_done_evq) == 1);
+    TEST_ASSERT(done == 1);
+    TEST_ASSERT(req.ar_rc == SYS_EINVAL);
+
+    /* Erase on a device which does not support it. */
+    aio_dev_init(&dev, &aio_test_noerase_funcs, NULL, 0);
+    aio_dev_evq_set(&dev, &aio_test_work_evq);
+    rc = aio_erase(&dev, &req, 0, sizeof(buf), aio_test_done_cb, &done,
+                   &aio_test_done_evq);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(aio_test_run_one(&aio_test_work_evq) == 1);
+    TEST_ASSERT(aio_test_run_one(&aio_test_done_evq) == 1);
+    TEST_ASSERT(done == 2);
+    TEST_ASSERT(req.ar_rc == SYS_ENOTSUP);
+}
@@ -0,0 +1,77 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "aio_test.h"
+
+TEST_CASE(aio_test_queue)
+{
+    struct aio_req reqs[3];
+    uint8_t wbuf[16];
+    uint8_t rbuf[16];
+    int done[3];
+    int rc;
+    int i;
+
+    aio_test_setup();
+
+    memset(done, 0, sizeof(done));
+    memset(wbuf, 0x5a, sizeof(wbuf));
+    memset(rbuf, 0, sizeof(rbuf));
+
+    /* Erase, write and read back; all in flight at the same time. */
+    rc = aio_erase(&aio_test_dev, &reqs[0], 0, 256, aio_test_done_cb,
+                   &done[0], &aio_test_done_evq);
+    TEST_ASSERT(rc == 0);
+    rc = aio_write(&aio_test_dev, &reqs[1], 32, wbuf, sizeof(wbuf),
+                   aio_test_done_cb, &done[1], &aio_test_done_evq);
+    TEST_ASSERT(rc == 0);
+    rc = aio_read(&aio_test_dev, &reqs[2], 32, rbuf, sizeof(rbuf),
+                  aio_test_done_cb, &done[2], &aio_test_done_evq);
+    TEST_ASSERT(rc == 0);
+
+    TEST_ASSERT(aio_test_dev.ad_pending == 3);
+    for (i = 0; i < 3; i++) {
+        TEST_ASSERT(reqs[i].ar_rc == SYS_EBUSY);
+    }
+    TEST_ASSERT(aio_test_run_one(&aio_test_done_evq) == 0);
+
+    /* Worker completes requests one at a time, in order. */
+    for (i = 0; i < 3; i++) {
+        TEST_ASSERT(aio_test_run_one(&aio_test_work_evq) == 1);
+        TEST_ASSERT(reqs[i].ar_rc == 0);
+        TEST_ASSERT(aio_test_dev.ad_pending == 2 - i);
+
+        TEST_ASSERT(aio_test_run_one(&aio_test_done_evq) == 1);
+        TEST_ASSERT(done[i] == 1);
+    }
+    TEST_ASSERT(aio_test_run_one(&aio_test_work_evq) == 0);
+    TEST_ASSERT(aio_test_run_one(&aio_test_done_evq) == 0);
+
+    TEST_ASSERT(aio_test_mem[0] == 0xff && aio_test_mem[255] == 0xff);
+    TEST_ASSERT(aio_test_mem[256] == 0);
+    TEST_ASSERT(!memcmp(rbuf, wbuf, sizeof(wbuf)));
+
+    /* Without completion queue, callback is called by the worker. */
+    rc = aio_read(&aio_test_dev, &reqs[0], 0, rbuf, sizeof(rbuf),
+                  aio_test_done_cb, &done[0], NULL);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(aio_test_run_one(&aio_test_work_evq) == 1);
+    TEST_ASSERT(done[0] == 2);
+    TEST_ASSERT(aio_test_run_one(&aio_test_done_evq) == 0);
+}
@@ -153,6 +153,9 @@ typedef int (*conf_export_handler_t)(conf_export_func_t export_func,
  */
 struct conf_handler {
     SLIST_ENTRY(conf_handler) ch_list;
+    /** @cond INTERNAL_HIDDEN */
+    SLIST_ENTRY(conf_handler) ch_hash_next;
+    /** @endcond */
     /**
      * The name of the conifguration item/subtree
      */
@@ -167,6 +170,45 @@ struct conf_handler {
     conf_export_handler_t ch_export;
 };
 
+/**
+ * A configuration name split into its sections.  The sections are copied,
+ * the name being parsed is left intact.
+ */
+struct conf_name {
+    /** Number of sections */
+    int cn_argc;
+    /** The sections, pointing into cn_buf */
+    char *cn_argv[CONF_MAX_DIR_DEPTH];
+    /** @cond INTERNAL_HIDDEN */
+    uint32_t cn_hash;
+    char cn_buf[CONF_MAX_NAME_LEN + 1];
+    /** @endcond */
+};
+
+/**
+ * Values to persist together, see conf_txn_begin().
+ */
+struct conf_txn {
+    /** @cond INTERNAL_HIDDEN */
+    uint8_t *ct_buf;
+    uint16_t ct_size;
+    uint16_t ct_len;
+    /** @endcond */
+};
+
+/**
+ * A configuration item resolved ahead of time, for repeated access with
+ * conf_set_value_key() and conf_get_value_key() without parsing the name
+ * and looking up its handler every time.
+ */
+struct conf_key {
+    /** @cond INTERNAL_HIDDEN */
+    struct conf_handler *ck_handler;
+    uint32_t ck_gen;
+    struct conf_name ck_name;
+    /** @endcond */
+};
+
 void conf_init(void);
 void conf_store_init(void);
 
@@ -259,6 +301,68 @@ int conf_set_value(char *name, char *val_str);
  */
 char *conf_get_value(char *name, char *buf, int buf_len);
 
+/**
+ * Starts a transaction: a set of values to persist together.  Values are
+ * staged in buf, each taking 4 bytes plus the length of its name and value,
+ * and written by conf_txn_commit().  With FCB storage they go out in one
+ * element, so after a reset either all or none of them are loaded; buf
+ * must then fit in a flash sector.
+ *
+ * @param txn The transaction to start.
+ * @param buf Buffer for staging the values.
+ * @param buf_len Size of the buffer.
+ *
+ * @return 0 on success, OS_INVALID_PARM if the buffer is too small.
+ */
+int conf_txn_begin(struct conf_txn *txn, void *buf, int buf_len);
+
+/**
+ * Stages a value to persist, replacing any value staged earlier for the
+ * same name.  NULL or empty value deletes the item.
+ *
+ * @param txn The transaction.
+ * @param name Name/key of the configuration item.
+ * @param val Value of the configuration item.
+ *
+ * @return 0 on success, OS_ENOMEM if the buffer is full, OS_INVALID_PARM
+ *         if the name or value is too long.
+ */
+int conf_txn_set(struct conf_txn *txn, const char *name, const char *val);
+
+/**
+ * Persists the staged values which have changed.  On success the
+ * transaction is empty again and can be reused.  To abandon the
+ * transaction, don't commit it.
+ *
+ * @param txn The transaction.
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int conf_txn_commit(struct conf_txn *txn);
+
+/**
+ * Resolves the name of a configuration item into a key.  The handler does
+ * not need to be registered yet; it is looked up again on first use after
+ * new handlers get registered.
+ *
+ * @param key The key to fill in.
+ * @param name Name of the configuration item; not modified.
+ *
+ * @return 0 on success, OS_INVALID_PARM if the name is too long or too
+ *         deep.
+ */
+int conf_key_init(struct conf_key *key, const char *name);
+
+/**
+ * Same as conf_set_value(), for a key set up with conf_key_init().
+ */
+int conf_set_value_key(struct conf_key *key, char *val_str);
+
+/**
+ * Same as conf_get_value(), for a key set up with conf_key_init().
+ */
+char *conf_get_value_key(struct conf_key *key, char *buf, int buf_len);
+
 /**
  * Call commit for all configuration handler. This should apply all
  * configuration which has been set, but not applied yet.
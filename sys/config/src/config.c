@@ -28,6 +28,16 @@
 
 struct conf_handler_head conf_handlers;
 
+/*
+ * Handlers are also kept in hash buckets by name, for the lookups done on
+ * every get/set.  conf_handler_gen changes whenever handlers are added, so
+ * that resolved keys get looked up again.
+ */
+#define CONF_HANDLER_BUCKETS    MYNEWT_VAL(CONFIG_HANDLER_BUCKETS)
+
+static struct conf_handler_head conf_handler_buckets[CONF_HANDLER_BUCKETS];
+static uint32_t conf_handler_gen;
+
 static os_event_fn conf_ev_fn_load;
 
 static struct os_mutex conf_mtx;
@@ -41,10 +51,15 @@ void
 conf_init(void)
 {
     int rc;
+    int i;
 
     os_mutex_init(&conf_mtx);
 
     SLIST_INIT(&conf_handlers);
+    for (i = 0; i < CONF_HANDLER_BUCKETS; i++) {
+        SLIST_INIT(&conf_handler_buckets[i]);
+    }
+    conf_handler_gen++;
     conf_store_init();
 
     (void)rc;
@@ -77,11 +92,33 @@ conf_unlock(void)
     os_mutex_release(&conf_mtx);
 }
 
+/*
+ * FNV-1a hash of a handler name, which ends at a separator or NUL.
+ */
+static uint32_t
+conf_name_hash(const char *name)
+{
+    uint32_t hash;
+
+    hash = 2166136261UL;
+    while (*name != '\0' && *name != CONF_NAME_SEPARATOR[0]) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
 int
 conf_register(struct conf_handler *handler)
 {
+    struct conf_handler_head *bucket;
+
+    bucket = &conf_handler_buckets[conf_name_hash(handler->ch_name) %
+                                   CONF_HANDLER_BUCKETS];
     conf_lock();
     SLIST_INSERT_HEAD(&conf_handlers, handler, ch_list);
+    SLIST_INSERT_HEAD(bucket, handler, ch_hash_next);
+    conf_handler_gen++;
     conf_unlock();
     return 0;
 }
@@ -92,15 +129,13 @@ conf_ev_fn_load(struct os_event *ev)
     conf_ensure_loaded();
 }
 
-/*
- * Find conf_handler based on name.
- */
-struct conf_handler *
-conf_handler_lookup(char *name)
+static struct conf_handler *
+conf_handler_lookup_hash(const char *name, uint32_t hash)
 {
     struct conf_handler *ch;
 
-    SLIST_FOREACH(ch, &conf_handlers, ch_list) {
+    SLIST_FOREACH(ch, &conf_handler_buckets[hash % CONF_HANDLER_BUCKETS],
+                  ch_hash_next) {
         if (!strcmp(name, ch->ch_name)) {
             return ch;
         }
@@ -109,38 +144,68 @@ conf_handler_lookup(char *name)
 }
 
 /*
- * Separate string into argv array.
+ * Find conf_handler based on name.
  */
-int
-conf_parse_name(char *name, int *name_argc, char *name_argv[])
+struct conf_handler *
+conf_handler_lookup(const char *name)
 {
-    char *tok;
-    char *tok_ptr;
-    char *sep = CONF_NAME_SEPARATOR;
-    int i;
-
-    tok = strtok_r(name, sep, &tok_ptr);
+    return conf_handler_lookup_hash(name, conf_name_hash(name));
+}
 
-    i = 0;
-    while (tok) {
-        name_argv[i++] = tok;
-        tok = strtok_r(NULL, sep, &tok_ptr);
+/*
+ * Separate name into sections, copying them to cn.  Empty sections are
+ * skipped.  Also computes the hash of the first section, for the handler
+ * lookup.
+ */
+int
+conf_name_parse(struct conf_name *cn, const char *name)
+{
+    char sep = CONF_NAME_SEPARATOR[0];
+    char *dst;
+    char *end;
+
+    cn->cn_argc = 0;
+    dst = cn->cn_buf;
+    end = cn->cn_buf + sizeof(cn->cn_buf);
+    while (1) {
+        while (*name == sep) {
+            name++;
+        }
+        if (*name == '\0') {
+            break;
+        }
+        if (cn->cn_argc >= CONF_MAX_DIR_DEPTH) {
+            return OS_INVALID_PARM;
+        }
+        if (cn->cn_argc == 0) {
+            cn->cn_hash = conf_name_hash(name);
+        }
+        cn->cn_argv[cn->cn_argc++] = dst;
+        while (*name != '\0' && *name != sep) {
+            if (dst >= end - 1) {
+                return OS_INVALID_PARM;
+            }
+            *dst++ = *name++;
+        }
+        *dst++ = '\0';
+    }
+    if (cn->cn_argc == 0) {
+        return OS_INVALID_PARM;
     }
-    *name_argc = i;
 
     return 0;
 }
 
 struct conf_handler *
-conf_parse_and_lookup(char *name, int *name_argc, char *name_argv[])
+conf_parse_and_lookup(const char *name, struct conf_name *cn)
 {
     int rc;
 
-    rc = conf_parse_name(name, name_argc, name_argv);
+    rc = conf_name_parse(cn, name);
     if (rc) {
         return NULL;
     }
-    return conf_handler_lookup(name_argv[0]);
+    return conf_handler_lookup_hash(cn->cn_argv[0], cn->cn_hash);
 }
 
 int
@@ -264,18 +329,17 @@ conf_str_from_bytes(void *vp, int vp_len, char *buf, int buf_len)
 int
 conf_set_value(char *name, char *val_str)
 {
-    int name_argc;
-    char *name_argv[CONF_MAX_DIR_DEPTH];
+    struct conf_name cn;
     struct conf_handler *ch;
     int rc;
 
     conf_lock();
-    ch = conf_parse_and_lookup(name, &name_argc, name_argv);
+    ch = conf_parse_and_lookup(name, &cn);
     if (!ch) {
         rc = OS_INVALID_PARM;
         goto out;
     }
-    rc = ch->ch_set(name_argc - 1, &name_argv[1], val_str);
+    rc = ch->ch_set(cn.cn_argc - 1, &cn.cn_argv[1], val_str);
 out:
     conf_unlock();
     return rc;
@@ -290,13 +354,12 @@ out:
 char *
 conf_get_value(char *name, char *buf, int buf_len)
 {
-    int name_argc;
-    char *name_argv[CONF_MAX_DIR_DEPTH];
+    struct conf_name cn;
     struct conf_handler *ch;
     char *rval = NULL;
 
     conf_lock();
-    ch = conf_parse_and_lookup(name, &name_argc, name_argv);
+    ch = conf_parse_and_lookup(name, &cn);
     if (!ch) {
         goto out;
     }
@@ -304,7 +367,73 @@ conf_get_value(char *name, char *buf, int buf_len)
     if (!ch->ch_get) {
         goto out;
     }
-    rval = ch->ch_get(name_argc - 1, &name_argv[1], buf, buf_len);
+    rval = ch->ch_get(cn.cn_argc - 1, &cn.cn_argv[1], buf, buf_len);
+out:
+    conf_unlock();
+    return rval;
+}
+
+int
+conf_key_init(struct conf_key *key, const char *name)
+{
+    int rc;
+
+    rc = conf_name_parse(&key->ck_name, name);
+    if (rc) {
+        return rc;
+    }
+    key->ck_handler = NULL;
+    key->ck_gen = conf_handler_gen - 1;
+    return 0;
+}
+
+/*
+ * Returns the handler of a key, looking it up again if handlers were
+ * registered since the last time.
+ */
+static struct conf_handler *
+conf_key_handler(struct conf_key *key)
+{
+    if (key->ck_gen != conf_handler_gen) {
+        key->ck_handler = conf_handler_lookup_hash(key->ck_name.cn_argv[0],
+                                                   key->ck_name.cn_hash);
+        key->ck_gen = conf_handler_gen;
+    }
+    return key->ck_handler;
+}
+
+int
+conf_set_value_key(struct conf_key *key, char *val_str)
+{
+    struct conf_handler *ch;
+    int rc;
+
+    conf_lock();
+    ch = conf_key_handler(key);
+    if (!ch) {
+        rc = OS_INVALID_PARM;
+        goto out;
+    }
+    rc = ch->ch_set(key->ck_name.cn_argc - 1, &key->ck_name.cn_argv[1],
+                    val_str);
+out:
+    conf_unlock();
+    return rc;
+}
+
+char *
+conf_get_value_key(struct conf_key *key, char *buf, int buf_len)
+{
+    struct conf_handler *ch;
+    char *rval = NULL;
+
+    conf_lock();
+    ch = conf_key_handler(key);
+    if (!ch || !ch->ch_get) {
+        goto out;
+    }
+    rval = ch->ch_get(key->ck_name.cn_argc - 1, &key->ck_name.cn_argv[1],
+                      buf, buf_len);
 out:
     conf_unlock();
     return rval;
@@ -313,15 +442,14 @@ out:
 int
 conf_commit(char *name)
 {
-    int name_argc;
-    char *name_argv[CONF_MAX_DIR_DEPTH];
+    struct conf_name cn;
     struct conf_handler *ch;
     int rc;
     int rc2;
 
     conf_lock();
     if (name) {
-        ch = conf_parse_and_lookup(name, &name_argc, name_argv);
+        ch = conf_parse_and_lookup(name, &cn);
         if (!ch) {
             rc = OS_INVALID_PARM;
             goto out;
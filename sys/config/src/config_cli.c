@@ -58,7 +58,7 @@ conf_dump_running(void)
 
 #if MYNEWT_VAL(CONFIG_CLI_DEBUG)
 static void
-conf_saved_one(char *name, char *val, void *cb_arg)
+conf_saved_one(char *name, char *val, uint32_t loc, void *cb_arg)
 {
     int *ip = cb_arg;
 
@@ -30,7 +30,16 @@
 
 #define CONF_FCB_VERS		1
 
+/*
+ * Location of a record, for the index of persisted values.
+ */
+#define CONF_FCB_LOC(cf, loc)                                               \
+    ((((loc)->fe_area - (cf)->cf_fcb.f_sectors) << 24) | (loc)->fe_elem_off)
+
+#define CONF_FCB_BUF_LEN	(CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32)
+
 struct conf_fcb_load_cb_arg {
+    struct conf_fcb *cf;
     load_cb cb;
     void *cb_arg;
 };
@@ -38,10 +47,16 @@ struct conf_fcb_load_cb_arg {
 static int conf_fcb_load(struct conf_store *, load_cb cb, void *cb_arg);
 static int conf_fcb_save(struct conf_store *, const char *name,
   const char *value);
+static int conf_fcb_save_txn(struct conf_store *, const uint8_t *buf,
+  int len);
+static int conf_fcb_load_one(struct conf_store *, uint32_t loc, load_cb cb,
+  void *cb_arg);
 
 static struct conf_store_itf conf_fcb_itf = {
     .csi_load = conf_fcb_load,
     .csi_save = conf_fcb_save,
+    .csi_save_txn = conf_fcb_save_txn,
+    .csi_load_one = conf_fcb_load_one,
 };
 
 int
@@ -89,34 +104,90 @@ conf_fcb_dst(struct conf_fcb *cf)
     return OS_OK;
 }
 
+/*
+ * Reads and parses the record at *offp within element loc, and moves *offp
+ * to the next one.  An element holds a single record, or all the records
+ * of a transaction.
+ *
+ * @return 0 if a record was read, non-zero if there's nothing to use at
+ *         *offp.
+ */
 static int
-conf_fcb_load_cb(struct fcb_entry *loc, void *arg)
+conf_fcb_rec_read(struct fcb_entry *loc, int *offp, char *buf, char *vbuf,
+                  char **name, char **val)
 {
-    struct conf_fcb_load_cb_arg *argp;
-    char buf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
-    char *name_str;
-    char *val_str;
-    int rc;
+    uint8_t hdr[CONF_REC_HDR_LEN + CONF_REC_VLEN_LEN];
     int len;
+    int rc;
 
-    argp = (struct conf_fcb_load_cb_arg *)arg;
-
-    len = loc->fe_data_len;
-    if (len >= sizeof(buf)) {
-        len = sizeof(buf) - 1;
+    if (*offp == 0) {
+        rc = flash_area_read(loc->fe_area, loc->fe_data_off, hdr, 1);
+        if (rc) {
+            *offp = loc->fe_data_len;
+            return rc;
+        }
+        if (hdr[0] != (CONF_REC_BIN | CONF_REC_TXN)) {
+            *offp = loc->fe_data_len;
+            len = loc->fe_data_len;
+            if (len >= CONF_FCB_BUF_LEN) {
+                if (hdr[0] & CONF_REC_BIN) {
+                    /* Truncated binary record. */
+                    return -1;
+                }
+                len = CONF_FCB_BUF_LEN - 1;
+            }
+            rc = flash_area_read(loc->fe_area, loc->fe_data_off, buf, len);
+            if (rc) {
+                return rc;
+            }
+            return conf_rec_parse(buf, len, 0, vbuf, name, val);
+        }
+        *offp = CONF_REC_HDR_LEN;
     }
 
-    rc = flash_area_read(loc->fe_area, loc->fe_data_off, buf, len);
+    if (*offp + sizeof(hdr) > loc->fe_data_len) {
+        *offp = loc->fe_data_len;
+        return -1;
+    }
+    rc = flash_area_read(loc->fe_area, loc->fe_data_off + *offp, hdr,
+                         sizeof(hdr));
     if (rc) {
-        return 0;
+        *offp = loc->fe_data_len;
+        return rc;
     }
-    buf[len] = '\0';
-
-    rc = conf_line_parse(buf, &name_str, &val_str);
+    len = conf_rec_len(hdr);
+    if (len > CONF_REC_MAX_LEN || *offp + len > loc->fe_data_len) {
+        *offp = loc->fe_data_len;
+        return -1;
+    }
+    rc = flash_area_read(loc->fe_area, loc->fe_data_off + *offp, buf, len);
+    *offp += len;
     if (rc) {
-        return 0;
+        return rc;
+    }
+    return conf_rec_parse(buf, len, 1, vbuf, name, val);
+}
+
+static int
+conf_fcb_load_cb(struct fcb_entry *loc, void *arg)
+{
+    struct conf_fcb_load_cb_arg *argp;
+    char buf[CONF_FCB_BUF_LEN];
+    char vbuf[CONF_MAX_VAL_LEN + 1];
+    char *name_str;
+    char *val_str;
+    int off;
+
+    argp = (struct conf_fcb_load_cb_arg *)arg;
+
+    off = 0;
+    while (off < loc->fe_data_len) {
+        if (conf_fcb_rec_read(loc, &off, buf, vbuf, &name_str, &val_str)) {
+            continue;
+        }
+        argp->cb(name_str, val_str, CONF_FCB_LOC(argp->cf, loc),
+                 argp->cb_arg);
     }
-    argp->cb(name_str, val_str, argp->cb_arg);
     return 0;
 }
 
@@ -127,6 +198,7 @@ conf_fcb_load(struct conf_store *cs, load_cb cb, void *cb_arg)
     struct conf_fcb_load_cb_arg arg;
     int rc;
 
+    arg.cf = cf;
     arg.cb = cb;
     arg.cb_arg = cb_arg;
     rc = fcb_walk(&cf->cf_fcb, 0, conf_fcb_load_cb, &arg);
@@ -137,17 +209,53 @@ conf_fcb_load(struct conf_store *cs, load_cb cb, void *cb_arg)
 }
 
 static int
-conf_fcb_var_read(struct fcb_entry *loc, char *buf, char **name, char **val)
+conf_fcb_load_one(struct conf_store *cs, uint32_t loc, load_cb cb,
+                  void *cb_arg)
 {
-    int rc;
+    struct conf_fcb *cf = (struct conf_fcb *)cs;
+    struct conf_fcb_load_cb_arg arg;
+    struct fcb_entry entry;
 
-    rc = flash_area_read(loc->fe_area, loc->fe_data_off, buf, loc->fe_data_len);
-    if (rc) {
-        return rc;
+    if ((loc >> 24) >= cf->cf_fcb.f_sector_cnt) {
+        return OS_EINVAL;
     }
-    buf[loc->fe_data_len] = '\0';
-    rc = conf_line_parse(buf, name, val);
-    return rc;
+    entry.fe_area = &cf->cf_fcb.f_sectors[loc >> 24];
+    entry.fe_elem_off = loc & 0xffffff;
+    if (fcb_elem_info(&cf->cf_fcb, &entry)) {
+        return OS_ENOENT;
+    }
+
+    arg.cf = cf;
+    arg.cb = cb;
+    arg.cb_arg = cb_arg;
+    return conf_fcb_load_cb(&entry, &arg);
+}
+
+/*
+ * Tells whether there's another record of name after element loc.
+ */
+static int
+conf_fcb_superseded(struct conf_fcb *cf, struct fcb_entry *loc,
+                    const char *name, char *buf)
+{
+    struct fcb_entry loc2;
+    char *name2;
+    char *val2;
+    int off;
+
+    loc2 = *loc;
+    while (fcb_getnext(&cf->cf_fcb, &loc2) == 0) {
+        off = 0;
+        while (off < loc2.fe_data_len) {
+            if (conf_fcb_rec_read(&loc2, &off, buf, NULL, &name2, &val2)) {
+                continue;
+            }
+            if (!strcmp(name, name2)) {
+                return 1;
+            }
+        }
+    }
+    return 0;
 }
 
 void
@@ -157,13 +265,16 @@ conf_fcb_compress(struct conf_fcb *cf,
                   void *cn_arg)
 {
     int rc;
-    char buf1[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
-    char buf2[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    char buf1[CONF_FCB_BUF_LEN];
+    char buf2[CONF_FCB_BUF_LEN];
+    char vbuf[CONF_MAX_VAL_LEN + 1];
     struct fcb_entry loc1;
     struct fcb_entry loc2;
     char *name1, *val1;
-    char *name2, *val2;
+    uint32_t last_loc;
     int copy;
+    int off;
+    int len;
 
     rc = fcb_append_to_scratch(&cf->cf_fcb);
     if (rc) {
@@ -176,53 +287,61 @@ conf_fcb_compress(struct conf_fcb *cf,
         if (loc1.fe_area != cf->cf_fcb.f_oldest) {
             break;
         }
-        rc = conf_fcb_var_read(&loc1, buf1, &name1, &val1);
-        if (rc) {
-            continue;
-        }
-        if (!val1) {
-            continue;
-        }
-        loc2 = loc1;
-        copy = 1;
-        while (fcb_getnext(&cf->cf_fcb, &loc2) == 0) {
-            rc = conf_fcb_var_read(&loc2, buf2, &name2, &val2);
+        off = 0;
+        while (off < loc1.fe_data_len) {
+            rc = conf_fcb_rec_read(&loc1, &off, buf1, vbuf, &name1, &val1);
             if (rc) {
                 continue;
             }
-            if (!strcmp(name1, name2)) {
-                copy = 0;
-                break;
+            if (!val1) {
+                continue;
+            }
+            if (!conf_index_loc(&cf->cf_store, name1, &last_loc)) {
+                /*
+                 * The index knows where the last record of this name is.
+                 */
+                copy = (last_loc == CONF_FCB_LOC(cf, &loc1));
+            } else {
+                copy = !conf_fcb_superseded(cf, &loc1, name1, buf2);
+            }
+            if (!copy) {
+                continue;
             }
-        }
-        if (!copy) {
-            continue;
-        }
 
-        if (copy_or_not) {
-            if (copy_or_not(name1, val1, cn_arg)) {
-                /* Copy rejected */
+            if (copy_or_not) {
+                if (copy_or_not(name1, val1, cn_arg)) {
+                    /* Copy rejected */
+                    conf_index_forget(name1);
+                    continue;
+                }
+            }
+            /*
+             * Can't find one. Must copy.  Records of transactions are copied
+             * one by one; they were already all written.  Text records get
+             * converted while at it.
+             */
+#if MYNEWT_VAL(CONFIG_BINARY_FORMAT)
+            len = conf_rec_make((uint8_t *)buf2, sizeof(buf2), name1, val1, 0);
+#else
+            len = conf_line_make(buf2, sizeof(buf2), name1, val1);
+#endif
+            if (len < 0) {
+                conf_index_forget(name1);
                 continue;
             }
+            rc = fcb_append(&cf->cf_fcb, len, &loc2);
+            if (rc) {
+                conf_index_forget(name1);
+                continue;
+            }
+            rc = fcb_write(&cf->cf_fcb, &loc2, 0, buf2, len);
+            if (rc) {
+                conf_index_forget(name1);
+                continue;
+            }
+            fcb_append_finish(&cf->cf_fcb, &loc2);
+            conf_index_move(&cf->cf_store, name1, CONF_FCB_LOC(cf, &loc2));
         }
-        /*
-         * Can't find one. Must copy.
-         */
-        rc = flash_area_read(loc1.fe_area, loc1.fe_data_off, buf1,
-          loc1.fe_data_len);
-        if (rc) {
-            continue;
-        }
-        rc = fcb_append(&cf->cf_fcb, loc1.fe_data_len, &loc2);
-        if (rc) {
-            continue;
-        }
-        rc = flash_area_write(loc2.fe_area, loc2.fe_data_off, buf1,
-          loc1.fe_data_len);
-        if (rc) {
-            continue;
-        }
-        fcb_append_finish(&cf->cf_fcb, &loc2);
     }
     rc = fcb_rotate(&cf->cf_fcb);
     if (rc) {
@@ -232,7 +351,7 @@ conf_fcb_compress(struct conf_fcb *cf,
 }
 
 static int
-conf_fcb_append(struct conf_fcb *cf, char *buf, int len)
+conf_fcb_append(struct conf_fcb *cf, char *buf, int len, uint32_t *locp)
 {
     int rc;
     int i;
@@ -251,11 +370,12 @@ conf_fcb_append(struct conf_fcb *cf, char *buf, int len)
     if (rc) {
         return OS_EINVAL;
     }
-    rc = flash_area_write(loc.fe_area, loc.fe_data_off, buf, len);
+    rc = fcb_write(&cf->cf_fcb, &loc, 0, buf, len);
     if (rc) {
         return OS_EINVAL;
     }
     fcb_append_finish(&cf->cf_fcb, &loc);
+    *locp = CONF_FCB_LOC(cf, &loc);
     return OS_OK;
 }
 
@@ -263,18 +383,62 @@ static int
 conf_fcb_save(struct conf_store *cs, const char *name, const char *value)
 {
     struct conf_fcb *cf = (struct conf_fcb *)cs;
-    char buf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    char buf[CONF_FCB_BUF_LEN];
+    uint32_t loc;
     int len;
+    int rc;
 
     if (!name) {
         return OS_INVALID_PARM;
     }
 
+#if MYNEWT_VAL(CONFIG_BINARY_FORMAT)
+    len = conf_rec_make((uint8_t *)buf, sizeof(buf), name, value, 0);
+#else
     len = conf_line_make(buf, sizeof(buf), name, value);
+#endif
     if (len < 0 || len + 2 > sizeof(buf)) {
         return OS_INVALID_PARM;
     }
-    return conf_fcb_append(cf, buf, len);
+    rc = conf_fcb_append(cf, buf, len, &loc);
+    if (rc == OS_OK) {
+        conf_index_note(cs, name, value, loc);
+    }
+    return rc;
+}
+
+/*
+ * The whole transaction goes in one element; its CRC makes sure it's either
+ * all there or skipped.
+ */
+static int
+conf_fcb_save_txn(struct conf_store *cs, const uint8_t *buf, int len)
+{
+    struct conf_fcb *cf = (struct conf_fcb *)cs;
+    char rbuf[CONF_REC_MAX_LEN + 1];
+    char vbuf[CONF_MAX_VAL_LEN + 1];
+    char *name;
+    char *val;
+    uint32_t loc;
+    int off;
+    int rc;
+
+    if (len >= FCB_MAX_LEN) {
+        return OS_ENOMEM;
+    }
+    rc = conf_fcb_append(cf, (char *)buf, len, &loc);
+    if (rc) {
+        return rc;
+    }
+
+    off = CONF_REC_HDR_LEN;
+    while (off < len) {
+        if (conf_rec_next(buf, len, &off, rbuf, vbuf, &name, &val)) {
+            break;
+        }
+        conf_index_note(cs, name, val, loc);
+    }
+    return OS_OK;
 }
 
 #endif
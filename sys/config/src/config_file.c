@@ -33,10 +33,13 @@
 static int conf_file_load(struct conf_store *, load_cb cb, void *cb_arg);
 static int conf_file_save(struct conf_store *, const char *name,
   const char *value);
+static int conf_file_load_one(struct conf_store *, uint32_t loc, load_cb cb,
+  void *cb_arg);
 
 static struct conf_store_itf conf_file_itf = {
     .csi_load = conf_file_load,
     .csi_save = conf_file_save,
+    .csi_load_one = conf_file_load_one,
 };
 
 /*
@@ -72,6 +75,7 @@ conf_getnext_line(struct fs_file *file, char *buf, int blen, uint32_t *loc)
     int rc;
     char *end;
     uint32_t len;
+    int rlen;
 
     rc = fs_seek(file, *loc);
     if (rc < 0) {
@@ -83,6 +87,36 @@ conf_getnext_line(struct fs_file *file, char *buf, int blen, uint32_t *loc)
         *loc = 0;
         return -1;
     }
+
+    if ((uint8_t)buf[0] & CONF_REC_BIN) {
+        /*
+         * Binary record, length comes from the header.
+         */
+        if (len < CONF_REC_HDR_LEN + CONF_REC_VLEN_LEN) {
+            *loc = 0;
+            return -1;
+        }
+        rlen = CONF_REC_HDR_LEN + CONF_REC_VLEN_LEN + (uint8_t)buf[1] +
+          ((uint8_t)buf[2] | ((uint8_t)buf[3] << 8));
+        if (rlen > len) {
+            if (len < blen) {
+                /* Cut short by end of file. */
+                *loc = 0;
+                return -1;
+            }
+            /* Doesn't fit in buf; skip it. */
+            *loc += rlen;
+            return -1;
+        }
+        if (rlen == blen) {
+            /* No room for terminating the value. */
+            *loc += rlen;
+            return -1;
+        }
+        *loc += rlen;
+        return rlen;
+    }
+
     if (len == blen) {
         len--;
     }
@@ -109,7 +143,9 @@ conf_file_load(struct conf_store *cs, load_cb cb, void *cb_arg)
     struct conf_file *cf = (struct conf_file *)cs;
     struct fs_file *file;
     uint32_t loc;
+    uint32_t line_loc;
     char tmpbuf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    char vbuf[CONF_MAX_VAL_LEN + 1];
     char *name_str;
     char *val_str;
     int rc;
@@ -123,6 +159,7 @@ conf_file_load(struct conf_store *cs, load_cb cb, void *cb_arg)
     loc = 0;
     lines = 0;
     while (1) {
+        line_loc = loc;
         rc = conf_getnext_line(file, tmpbuf, sizeof(tmpbuf), &loc);
         if (loc == 0) {
             break;
@@ -130,18 +167,50 @@ conf_file_load(struct conf_store *cs, load_cb cb, void *cb_arg)
         if (rc < 0) {
             continue;
         }
-        rc = conf_line_parse(tmpbuf, &name_str, &val_str);
+        rc = conf_rec_parse(tmpbuf, rc, 1, vbuf, &name_str, &val_str);
         if (rc != 0) {
             continue;
         }
         lines++;
-        cb(name_str, val_str, cb_arg);
+        cb(name_str, val_str, line_loc, cb_arg);
     }
     fs_close(file);
     cf->cf_lines = lines;
     return OS_OK;
 }
 
+static int
+conf_file_load_one(struct conf_store *cs, uint32_t loc, load_cb cb,
+                   void *cb_arg)
+{
+    struct conf_file *cf = (struct conf_file *)cs;
+    struct fs_file *file;
+    uint32_t line_loc;
+    char tmpbuf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    char vbuf[CONF_MAX_VAL_LEN + 1];
+    char *name_str;
+    char *val_str;
+    int rc;
+
+    rc = fs_open(cf->cf_name, FS_ACCESS_READ, &file);
+    if (rc != FS_EOK) {
+        return OS_EINVAL;
+    }
+
+    line_loc = loc;
+    rc = conf_getnext_line(file, tmpbuf, sizeof(tmpbuf), &loc);
+    fs_close(file);
+    if (rc < 0) {
+        return OS_ENOENT;
+    }
+    rc = conf_rec_parse(tmpbuf, rc, 1, vbuf, &name_str, &val_str);
+    if (rc != 0) {
+        return OS_ENOENT;
+    }
+    cb(name_str, val_str, line_loc, cb_arg);
+    return OS_OK;
+}
+
 static void
 conf_tmpfile(char *dst, const char *src, char *pfx)
 {
@@ -158,6 +227,31 @@ conf_tmpfile(char *dst, const char *src, char *pfx)
     dst[len + pfx_len] = '\0';
 }
 
+/*
+ * Formats a record to be written to the file.
+ *
+ * @return The length of the record; -1 if it doesn't fit.
+ */
+static int
+conf_file_rec_make(char *buf, int blen, const char *name, const char *value)
+{
+    int len;
+
+#if MYNEWT_VAL(CONFIG_BINARY_FORMAT)
+    len = conf_rec_make((uint8_t *)buf, blen, name, value, 1);
+    if (len < 0 || len + 1 > blen) {
+        return -1;
+    }
+#else
+    len = conf_line_make(buf, blen, name, value);
+    if (len < 0 || len + 2 > blen) {
+        return -1;
+    }
+    buf[len++] = '\n';
+#endif
+    return len;
+}
+
 /*
  * Try to compress configuration file by keeping unique names only.
  */
@@ -170,7 +264,11 @@ conf_file_compress(struct conf_file *cf)
     char tmp_file[CONF_FILE_NAME_MAX];
     char buf1[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
     char buf2[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    char vbuf[CONF_MAX_VAL_LEN + 1];
     uint32_t loc1, loc2;
+    uint32_t line_loc;
+    uint32_t last_loc;
+    uint32_t wr_loc;
     char *name1, *val1;
     char *name2, *val2;
     int copy;
@@ -187,29 +285,42 @@ conf_file_compress(struct conf_file *cf)
     }
 
     loc1 = 0;
+    wr_loc = 0;
     lines = 0;
     while (1) {
+        line_loc = loc1;
         len = conf_getnext_line(rf, buf1, sizeof(buf1), &loc1);
-        if (loc1 == 0 || len < 0) {
+        if (loc1 == 0) {
             break;
         }
-        rc = conf_line_parse(buf1, &name1, &val1);
+        if (len < 0) {
+            continue;
+        }
+        rc = conf_rec_parse(buf1, len, 1, vbuf, &name1, &val1);
         if (rc) {
             continue;
         }
         if (!val1) {
             continue;
         }
-        loc2 = loc1;
-        copy = 1;
-        while ((len2 = conf_getnext_line(rf, buf2, sizeof(buf2), &loc2)) > 0) {
-            rc = conf_line_parse(buf2, &name2, &val2);
-            if (rc) {
-                continue;
-            }
-            if (!strcmp(name1, name2)) {
-                copy = 0;
-                break;
+        if (!conf_index_loc(&cf->cf_store, name1, &last_loc)) {
+            /*
+             * The index knows where the last line of this name is.
+             */
+            copy = (last_loc == line_loc);
+        } else {
+            loc2 = loc1;
+            copy = 1;
+            while ((len2 = conf_getnext_line(rf, buf2, sizeof(buf2),
+                                             &loc2)) > 0) {
+                rc = conf_rec_parse(buf2, len2, 1, NULL, &name2, &val2);
+                if (rc) {
+                    continue;
+                }
+                if (!strcmp(name1, name2)) {
+                    copy = 0;
+                    break;
+                }
             }
         }
         if (!copy) {
@@ -219,12 +330,17 @@ conf_file_compress(struct conf_file *cf)
         /*
          * Can't find one. Must copy.
          */
-        len = conf_line_make(buf2, sizeof(buf2), name1, val1);
-        if (len < 0 || len + 2 > sizeof(buf2)) {
+        len = conf_file_rec_make(buf2, sizeof(buf2), name1, val1);
+        if (len < 0) {
+            conf_index_forget(name1);
+            continue;
+        }
+        if (fs_write(wf, buf2, len)) {
+            conf_index_forget(name1);
             continue;
         }
-        buf2[len++] = '\n';
-        fs_write(wf, buf2, len);
+        conf_index_move(&cf->cf_store, name1, wr_loc);
+        wr_loc += len;
 	lines++;
     }
     fs_close(wf);
@@ -247,6 +363,7 @@ conf_file_save(struct conf_store *cs, const char *name, const char *value)
     struct conf_file *cf = (struct conf_file *)cs;
     struct fs_file *file;
     char buf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    uint32_t loc;
     int len;
     int rc;
 
@@ -260,11 +377,10 @@ conf_file_save(struct conf_store *cs, const char *name, const char *value)
          */
         conf_file_compress(cf);
     }
-    len = conf_line_make(buf, sizeof(buf), name, value);
-    if (len < 0 || len + 2 > sizeof(buf)) {
+    len = conf_file_rec_make(buf, sizeof(buf), name, value);
+    if (len < 0) {
         return OS_INVALID_PARM;
     }
-    buf[len++] = '\n';
 
     /*
      * Open the file to add this one value.
@@ -272,11 +388,12 @@ conf_file_save(struct conf_store *cs, const char *name, const char *value)
     if (fs_open(cf->cf_name, FS_ACCESS_WRITE | FS_ACCESS_APPEND, &file)) {
         return OS_EINVAL;
     }
-    if (fs_write(file, buf, len)) {
+    if (fs_filelen(file, &loc) || fs_write(file, buf, len)) {
         rc = OS_EINVAL;
     } else {
         rc = 0;
         cf->cf_lines++;
+        conf_index_note(cs, name, value, loc);
     }
     fs_close(file);
     return rc;
@@ -0,0 +1,266 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(CONFIG_INDEX_CNT) > 0
+
+#include <string.h>
+
+#include "config/config.h"
+#include "config_priv.h"
+
+/*
+ * In-RAM index of the persisted configuration.  For every name found in
+ * the load sources it holds a hash of the last persisted value, and the
+ * location of the name's last record in the save destination.  This lets
+ * conf_save_one() detect duplicates, and the storage backends decide which
+ * records survive compression, without re-reading the storage.
+ *
+ * Names are kept in full, so each lookup is exact.  Values are only hashed;
+ * a differing hash means the value changed, but a matching one is confirmed
+ * by reading the record at the recorded location.  If the table fills up,
+ * the index is abandoned until the next conf_load(), and the callers fall
+ * back to reading the storage.
+ */
+struct conf_index_entry {
+    uint32_t cie_hash;      /* Hash of the name. */
+    uint32_t cie_val;       /* Hash of the value; 0 if not known. */
+    uint32_t cie_loc;       /* CONF_INDEX_LOC_NONE if not known. */
+    uint8_t cie_val_at_loc; /* The value is in the record at cie_loc. */
+    char cie_name[CONF_MAX_NAME_LEN + 1];   /* Empty if the slot is free. */
+};
+
+#define CONF_INDEX_CNT      MYNEWT_VAL(CONFIG_INDEX_CNT)
+
+enum {
+    CONF_INDEX_INVALID,     /* Not built, or stores changed since. */
+    CONF_INDEX_BUILDING,
+    CONF_INDEX_VALID,
+    CONF_INDEX_OVERFLOW,    /* Too many names; don't try to rebuild. */
+};
+
+static struct conf_index_entry conf_index[CONF_INDEX_CNT];
+static uint8_t conf_index_state;
+
+static uint32_t
+conf_index_hash(const char *str)
+{
+    uint32_t hash;
+
+    /* FNV-1a.  0 is reserved for free/unknown. */
+    hash = 2166136261UL;
+    if (str) {
+        while (*str) {
+            hash ^= (uint8_t)*str++;
+            hash *= 16777619UL;
+        }
+    }
+    if (hash == 0) {
+        hash = 1;
+    }
+    return hash;
+}
+
+/**
+ * Finds the slot of a name, or the free slot where it would go.
+ *
+ * @return The slot; NULL if the name is not present and the table is full.
+ */
+static struct conf_index_entry *
+conf_index_slot(const char *name, uint32_t name_hash)
+{
+    struct conf_index_entry *cie;
+    uint16_t idx;
+    uint16_t i;
+
+    idx = name_hash % CONF_INDEX_CNT;
+    for (i = 0; i < CONF_INDEX_CNT; i++) {
+        cie = &conf_index[idx];
+        if (cie->cie_name[0] == '\0') {
+            return cie;
+        }
+        if (cie->cie_hash == name_hash && !strcmp(cie->cie_name, name)) {
+            return cie;
+        }
+        if (++idx == CONF_INDEX_CNT) {
+            idx = 0;
+        }
+    }
+    return NULL;
+}
+
+static struct conf_index_entry *
+conf_index_find(const char *name)
+{
+    struct conf_index_entry *cie;
+
+    if (conf_index_state != CONF_INDEX_VALID) {
+        return NULL;
+    }
+    cie = conf_index_slot(name, conf_index_hash(name));
+    if (!cie || cie->cie_name[0] == '\0') {
+        return NULL;
+    }
+    return cie;
+}
+
+void
+conf_index_invalidate(void)
+{
+    conf_index_state = CONF_INDEX_INVALID;
+}
+
+int
+conf_index_needs_build(void)
+{
+    return conf_index_state == CONF_INDEX_INVALID;
+}
+
+void
+conf_index_build_start(void)
+{
+    memset(conf_index, 0, sizeof(conf_index));
+    conf_index_state = CONF_INDEX_BUILDING;
+}
+
+void
+conf_index_build_end(void)
+{
+    if (conf_index_state == CONF_INDEX_BUILDING) {
+        conf_index_state = CONF_INDEX_VALID;
+    }
+}
+
+void
+conf_index_note(struct conf_store *cs, const char *name, const char *val,
+                uint32_t loc)
+{
+    struct conf_index_entry *cie;
+    uint32_t name_hash;
+    int len;
+
+    if (conf_index_state != CONF_INDEX_BUILDING &&
+        conf_index_state != CONF_INDEX_VALID) {
+        return;
+    }
+
+    len = strlen(name);
+    if (len == 0 || len > CONF_MAX_NAME_LEN) {
+        conf_index_state = CONF_INDEX_OVERFLOW;
+        return;
+    }
+    name_hash = conf_index_hash(name);
+    cie = conf_index_slot(name, name_hash);
+    if (!cie) {
+        conf_index_state = CONF_INDEX_OVERFLOW;
+        return;
+    }
+    if (cie->cie_name[0] == '\0') {
+        memcpy(cie->cie_name, name, len + 1);
+        cie->cie_hash = name_hash;
+        cie->cie_loc = CONF_INDEX_LOC_NONE;
+    }
+
+    /* A deletion is stored as an empty value; compare them as equal. */
+    cie->cie_val = conf_index_hash(val);
+    if (cs == conf_save_dst) {
+        cie->cie_loc = loc;
+        cie->cie_val_at_loc = 1;
+    } else {
+        cie->cie_val_at_loc = 0;
+    }
+}
+
+void
+conf_index_move(struct conf_store *cs, const char *name, uint32_t loc)
+{
+    struct conf_index_entry *cie;
+
+    if (cs != conf_save_dst) {
+        return;
+    }
+    cie = conf_index_find(name);
+    if (cie) {
+        cie->cie_loc = loc;
+    }
+}
+
+void
+conf_index_forget(const char *name)
+{
+    struct conf_index_entry *cie;
+
+    cie = conf_index_find(name);
+    if (cie) {
+        cie->cie_val = 0;
+        cie->cie_loc = CONF_INDEX_LOC_NONE;
+        cie->cie_val_at_loc = 0;
+    }
+}
+
+int
+conf_index_is_dup(const char *name, const char *val)
+{
+    struct conf_index_entry *cie;
+    struct conf_dup_check_arg cdca;
+    struct conf_store *cs;
+
+    if (conf_index_state != CONF_INDEX_VALID) {
+        return -1;
+    }
+    cie = conf_index_find(name);
+    if (!cie || cie->cie_val != conf_index_hash(val)) {
+        return 0;
+    }
+
+    /*
+     * Same hash; it's only a duplicate if the stored value is the same.
+     */
+    cs = conf_save_dst;
+    if (!cie->cie_val_at_loc || !cs->cs_itf->csi_load_one) {
+        return -1;
+    }
+    cdca.name = name;
+    cdca.val = val;
+    cdca.is_dup = -1;
+    if (cs->cs_itf->csi_load_one(cs, cie->cie_loc, conf_dup_check_cb,
+                                 &cdca)) {
+        return -1;
+    }
+    return cdca.is_dup;
+}
+
+int
+conf_index_loc(struct conf_store *cs, const char *name, uint32_t *loc)
+{
+    struct conf_index_entry *cie;
+
+    if (cs != conf_save_dst) {
+        return OS_ENOENT;
+    }
+    cie = conf_index_find(name);
+    if (!cie || cie->cie_loc == CONF_INDEX_LOC_NONE) {
+        return OS_ENOENT;
+    }
+    *loc = cie->cie_loc;
+    return 0;
+}
+
+#endif
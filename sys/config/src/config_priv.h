@@ -20,6 +20,8 @@
 #ifndef __CONFIG_PRIV_H_
 #define __CONFIG_PRIV_H_
 
+#include "os/mynewt.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -37,18 +39,73 @@ struct mgmt_cbuf;
 int conf_line_parse(char *buf, char **namep, char **valp);
 int conf_line_make(char *dst, int dlen, const char *name, const char *val);
 int conf_line_make2(char *dst, int dlen, const char *name, const char *value);
-struct conf_handler *conf_parse_and_lookup(char *name, int *name_argc,
-                                           char *name_argv[]);
+
+/*
+ * Binary records, see config_rec.c.
+ */
+#define CONF_REC_BIN            0x80
+#define CONF_REC_HDR_LEN        2
+#define CONF_REC_VLEN_LEN       2
+#define CONF_REC_MAX_LEN                                                    \
+    (CONF_REC_HDR_LEN + CONF_REC_VLEN_LEN + CONF_MAX_NAME_LEN +             \
+     CONF_MAX_VAL_LEN)
+
+/*
+ * Type of an element holding the records of a transaction, each with its
+ * value length.  Readers which don't know it skip the whole element.
+ */
+#define CONF_REC_TXN            0x40
+
+int conf_rec_make(uint8_t *dst, int dlen, const char *name, const char *value,
+                  int with_vlen);
+
+/*
+ * Parses a binary or text record of len bytes.  buf must have room for one
+ * more byte.  Decoded byte values are encoded into vbuf, which must hold
+ * CONF_MAX_VAL_LEN + 1 bytes; if vbuf is NULL, they are returned as NULL.
+ */
+int conf_rec_parse(char *buf, int len, int with_vlen, char *vbuf,
+                   char **namep, char **valp);
+
+/*
+ * Length of a record with value length, given its header.
+ */
+int conf_rec_len(const uint8_t *hdr);
+
+/*
+ * Parses the record at *offp within len bytes of records with value
+ * lengths, and moves *offp past it.  The record is copied to rbuf, which
+ * must hold CONF_REC_MAX_LEN + 1 bytes, so buf is left intact.
+ */
+int conf_rec_next(const uint8_t *buf, int len, int *offp, char *rbuf,
+                  char *vbuf, char **namep, char **valp);
+int conf_name_parse(struct conf_name *cn, const char *name);
+struct conf_handler *conf_handler_lookup(const char *name);
+struct conf_handler *conf_parse_and_lookup(const char *name,
+                                           struct conf_name *cn);
 
 /*
  * API for config storage.
  */
-typedef void (*load_cb)(char *name, char *val, void *cb_arg);
+/*
+ * loc identifies the record within the store, see conf_index_note().
+ */
+typedef void (*load_cb)(char *name, char *val, uint32_t loc, void *cb_arg);
 struct conf_store_itf {
     int (*csi_load)(struct conf_store *cs, load_cb cb, void *cb_arg);
     int (*csi_save_start)(struct conf_store *cs);
     int (*csi_save)(struct conf_store *cs, const char *name, const char *value);
     int (*csi_save_end)(struct conf_store *cs);
+    /*
+     * Optional.  Persists the records staged by a transaction, starting
+     * with its CONF_REC_TXN header, so that they're loaded all or none.
+     */
+    int (*csi_save_txn)(struct conf_store *cs, const uint8_t *buf, int len);
+    /*
+     * Optional.  Calls cb for the record(s) at loc, as passed to a load_cb.
+     */
+    int (*csi_load_one)(struct conf_store *cs, uint32_t loc, load_cb cb,
+                        void *cb_arg);
 };
 
 void conf_src_register(struct conf_store *cs);
@@ -60,6 +117,62 @@ SLIST_HEAD(conf_handler_head, conf_handler);
 extern struct conf_handler_head conf_handlers;
 extern struct conf_store *conf_save_dst;
 
+/*
+ * load_cb which sets is_dup to whether a record of name has value val.
+ */
+struct conf_dup_check_arg {
+    const char *name;
+    const char *val;
+    int is_dup;
+};
+void conf_dup_check_cb(char *name, char *val, uint32_t loc, void *cb_arg);
+
+/*
+ * Index of persisted values.
+ */
+#define CONF_INDEX_LOC_NONE     0xffffffff
+
+#if MYNEWT_VAL(CONFIG_INDEX_CNT) > 0
+void conf_index_invalidate(void);
+int conf_index_needs_build(void);
+void conf_index_build_start(void);
+void conf_index_build_end(void);
+
+/*
+ * Records that the last persisted value of name is val.  If cs is the save
+ * destination, loc is where its record is; the encoding is up to the store.
+ */
+void conf_index_note(struct conf_store *cs, const char *name, const char *val,
+                     uint32_t loc);
+/*
+ * Records that the last record of name in cs was copied to loc.
+ */
+void conf_index_move(struct conf_store *cs, const char *name, uint32_t loc);
+void conf_index_forget(const char *name);
+
+/*
+ * Returns 1 if val is the last persisted value of name, 0 if not, -1 if
+ * the index can't tell.  A matching hash is confirmed by reading the record
+ * from the save destination.
+ */
+int conf_index_is_dup(const char *name, const char *val);
+
+/*
+ * Retrieves the location of the last record of name in cs.
+ */
+int conf_index_loc(struct conf_store *cs, const char *name, uint32_t *loc);
+#else
+#define conf_index_invalidate()
+#define conf_index_needs_build() 0
+#define conf_index_build_start()
+#define conf_index_build_end()
+#define conf_index_note(cs, name, val, loc)
+#define conf_index_move(cs, name, loc)
+#define conf_index_forget(name)
+#define conf_index_is_dup(name, val) (-1)
+#define conf_index_loc(cs, name, loc) OS_ENOENT
+#endif
+
 #ifdef __cplusplus
 }
 #endif
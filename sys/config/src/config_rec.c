@@ -0,0 +1,206 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "base64/base64.h"
+
+#include "config/config.h"
+#include "config_priv.h"
+
+/*
+ * Binary config records.
+ *
+ *     +------+------+------------+-------+-------+
+ *     | type | nlen | [vlen (2)] | name  | value |
+ *     +------+------+------------+-------+-------+
+ *
+ * type is CONF_REC_BIN | conf_type; the high bit tells binary records apart
+ * from text "name=value" records, whose names are ASCII.  nlen is the name
+ * length.  vlen, little endian, is only present in stores which don't
+ * frame records themselves.  Neither the name nor the value is NUL
+ * terminated.
+ *
+ * Values are stored as CONF_NONE (deleted), CONF_BYTES (a base64 string
+ * stored decoded) or CONF_STRING.
+ *
+ * A transaction is written as one element: a CONF_REC_TXN header with
+ * zero nlen, followed by its records, each with vlen.
+ */
+
+#define CONF_REC_MAX_BYTES      (CONF_MAX_VAL_LEN / 4 * 3)
+
+/*
+ * Decodes val into dst if it is a base64 string which encodes back to the
+ * exact same string, so that nothing is lost by storing it decoded.
+ *
+ * @return Number of decoded bytes; -1 if val must be stored as a string.
+ */
+static int
+conf_rec_bytes(const char *val, int vlen, uint8_t *dst, int dlen)
+{
+    char tmp[CONF_MAX_VAL_LEN + 1];
+    int len;
+
+    /* Short strings don't get any smaller. */
+    if (vlen < 8 || vlen > CONF_MAX_VAL_LEN || (vlen % 4) != 0 ||
+        vlen / 4 * 3 > dlen) {
+        return -1;
+    }
+    len = base64_decode(val, dst);
+    if (len <= 0 || len > CONF_REC_MAX_BYTES) {
+        return -1;
+    }
+    if (base64_encode(dst, len, tmp, 1) != vlen || memcmp(tmp, val, vlen)) {
+        return -1;
+    }
+    return len;
+}
+
+int
+conf_rec_make(uint8_t *dst, int dlen, const char *name, const char *value,
+              int with_vlen)
+{
+    uint8_t type;
+    int nlen;
+    int vlen;
+    int off;
+    int len;
+
+    nlen = strlen(name);
+    off = CONF_REC_HDR_LEN + (with_vlen ? CONF_REC_VLEN_LEN : 0);
+    if (nlen > UINT8_MAX || off + nlen > dlen) {
+        return -1;
+    }
+    memcpy(dst + off, name, nlen);
+    off += nlen;
+
+    if (!value || value[0] == '\0') {
+        type = CONF_NONE;
+        vlen = 0;
+    } else {
+        vlen = strlen(value);
+        len = conf_rec_bytes(value, vlen, dst + off, dlen - off);
+        if (len >= 0) {
+            type = CONF_BYTES;
+            vlen = len;
+        } else {
+            if (off + vlen > dlen) {
+                return -1;
+            }
+            type = CONF_STRING;
+            memcpy(dst + off, value, vlen);
+        }
+    }
+
+    dst[0] = CONF_REC_BIN | type;
+    dst[1] = nlen;
+    if (with_vlen) {
+        dst[2] = vlen;
+        dst[3] = vlen >> 8;
+    }
+    return off + vlen;
+}
+
+int
+conf_rec_parse(char *buf, int len, int with_vlen, char *vbuf,
+               char **namep, char **valp)
+{
+    uint8_t *rec;
+    uint8_t type;
+    int nlen;
+    int vlen;
+    int off;
+
+    rec = (uint8_t *)buf;
+    if (!(rec[0] & CONF_REC_BIN)) {
+        buf[len] = '\0';
+        return conf_line_parse(buf, namep, valp);
+    }
+
+    off = CONF_REC_HDR_LEN + (with_vlen ? CONF_REC_VLEN_LEN : 0);
+    if (len < off) {
+        return -1;
+    }
+    type = rec[0] & ~CONF_REC_BIN;
+    nlen = rec[1];
+    vlen = len - off - nlen;
+    if (nlen == 0 || vlen < 0) {
+        return -1;
+    }
+    if (with_vlen && (rec[2] | (rec[3] << 8)) != vlen) {
+        return -1;
+    }
+
+    /*
+     * Shift the name over the header to make room for its terminator.
+     */
+    memmove(buf + off - 1, buf + off, nlen);
+    buf[off - 1 + nlen] = '\0';
+    *namep = buf + off - 1;
+    off += nlen;
+
+    switch (type) {
+    case CONF_NONE:
+        *valp = NULL;
+        break;
+    case CONF_STRING:
+        buf[len] = '\0';
+        *valp = buf + off;
+        break;
+    case CONF_BYTES:
+        if (vlen > CONF_REC_MAX_BYTES) {
+            return -1;
+        }
+        if (vbuf) {
+            base64_encode(buf + off, vlen, vbuf, 1);
+        }
+        *valp = vbuf;
+        break;
+    default:
+        return -1;
+    }
+    return 0;
+}
+
+int
+conf_rec_len(const uint8_t *hdr)
+{
+    return CONF_REC_HDR_LEN + CONF_REC_VLEN_LEN + hdr[1] +
+      (hdr[2] | (hdr[3] << 8));
+}
+
+int
+conf_rec_next(const uint8_t *buf, int len, int *offp, char *rbuf, char *vbuf,
+              char **namep, char **valp)
+{
+    int rlen;
+
+    if (*offp + CONF_REC_HDR_LEN + CONF_REC_VLEN_LEN > len) {
+        return -1;
+    }
+    rlen = conf_rec_len(buf + *offp);
+    if (rlen > CONF_REC_MAX_LEN || *offp + rlen > len) {
+        return -1;
+    }
+    memcpy(rbuf, buf + *offp, rlen);
+    *offp += rlen;
+    return conf_rec_parse(rbuf, rlen, 1, vbuf, namep, valp);
+}
@@ -24,12 +24,6 @@
 #include "config/config.h"
 #include "config_priv.h"
 
-struct conf_dup_check_arg {
-    const char *name;
-    const char *val;
-    int is_dup;
-};
-
 struct conf_store_head conf_load_srcs;
 struct conf_store *conf_save_dst;
 static bool conf_loading;
@@ -49,17 +43,20 @@ conf_src_register(struct conf_store *cs)
     } else {
         SLIST_INSERT_AFTER(prev, cs, cs_next);
     }
+    conf_index_invalidate();
 }
 
 void
 conf_dst_register(struct conf_store *cs)
 {
     conf_save_dst = cs;
+    conf_index_invalidate();
 }
 
 static void
-conf_load_cb(char *name, char *val, void *cb_arg)
+conf_load_cb(char *name, char *val, uint32_t loc, void *cb_arg)
 {
+    conf_index_note(cb_arg, name, val, loc);
     conf_set_value(name, val);
 }
 
@@ -77,12 +74,14 @@ conf_load(void)
     conf_lock();
     conf_loaded = true;
     conf_loading = true;
+    conf_index_build_start();
     SLIST_FOREACH(cs, &conf_load_srcs, cs_next) {
-        cs->cs_itf->csi_load(cs, conf_load_cb, NULL);
+        cs->cs_itf->csi_load(cs, conf_load_cb, cs);
         if (SLIST_NEXT(cs, cs_next)) {
             conf_commit(NULL);
         }
     }
+    conf_index_build_end();
     conf_loading = false;
     conf_unlock();
     return conf_commit(NULL);
@@ -104,8 +103,35 @@ conf_set_from_storage(void)
     return conf_loading;
 }
 
+#if MYNEWT_VAL(CONFIG_INDEX_CNT) > 0
+static void
+conf_index_load_cb(char *name, char *val, uint32_t loc, void *cb_arg)
+{
+    conf_index_note(cb_arg, name, val, loc);
+}
+
+/*
+ * Builds the index of persisted values, if stores were registered since
+ * the last conf_load().
+ */
 static void
-conf_dup_check_cb(char *name, char *val, void *cb_arg)
+conf_index_ensure_built(void)
+{
+    struct conf_store *cs;
+
+    if (!conf_index_needs_build()) {
+        return;
+    }
+    conf_index_build_start();
+    SLIST_FOREACH(cs, &conf_load_srcs, cs_next) {
+        cs->cs_itf->csi_load(cs, conf_index_load_cb, cs);
+    }
+    conf_index_build_end();
+}
+#endif
+
+void
+conf_dup_check_cb(char *name, char *val, uint32_t loc, void *cb_arg)
 {
     struct conf_dup_check_arg *cdca = (struct conf_dup_check_arg *)cb_arg;
 
@@ -144,13 +170,20 @@ conf_save_one(const char *name, char *value)
     }
 
     /*
-     * Check if we're writing the same value again.
+     * Check if we're writing the same value again.  Only read the stores if
+     * the index can't tell.
      */
-    cdca.name = name;
-    cdca.val = value;
-    cdca.is_dup = 0;
-    SLIST_FOREACH(cs, &conf_load_srcs, cs_next) {
-        cs->cs_itf->csi_load(cs, conf_dup_check_cb, &cdca);
+#if MYNEWT_VAL(CONFIG_INDEX_CNT) > 0
+    conf_index_ensure_built();
+#endif
+    cdca.is_dup = conf_index_is_dup(name, value);
+    if (cdca.is_dup < 0) {
+        cdca.name = name;
+        cdca.val = value;
+        cdca.is_dup = 0;
+        SLIST_FOREACH(cs, &conf_load_srcs, cs_next) {
+            cs->cs_itf->csi_load(cs, conf_dup_check_cb, &cdca);
+        }
     }
     if (cdca.is_dup == 1) {
         rc = 0;
@@ -163,6 +196,150 @@ out:
     return rc;
 }
 
+int
+conf_txn_begin(struct conf_txn *txn, void *buf, int buf_len)
+{
+    if (buf_len < CONF_REC_HDR_LEN) {
+        return OS_INVALID_PARM;
+    }
+    if (buf_len > UINT16_MAX) {
+        buf_len = UINT16_MAX;
+    }
+    txn->ct_buf = buf;
+    txn->ct_size = buf_len;
+    txn->ct_len = CONF_REC_HDR_LEN;
+    txn->ct_buf[0] = CONF_REC_BIN | CONF_REC_TXN;
+    txn->ct_buf[1] = 0;
+    return 0;
+}
+
+int
+conf_txn_set(struct conf_txn *txn, const char *name, const char *val)
+{
+    uint8_t nrec[CONF_REC_MAX_LEN];
+    uint8_t *rec;
+    int old_rlen;
+    int nlen;
+    int rlen;
+    int off;
+
+    nlen = strlen(name);
+    if (nlen == 0 || nlen > CONF_MAX_NAME_LEN ||
+        (val && strlen(val) > CONF_MAX_VAL_LEN)) {
+        return OS_INVALID_PARM;
+    }
+
+    rlen = conf_rec_make(nrec, sizeof(nrec), name, val, 1);
+    if (rlen < 0) {
+        return OS_INVALID_PARM;
+    }
+
+    /*
+     * Only the last value set for a name is kept.
+     */
+    old_rlen = 0;
+    for (off = CONF_REC_HDR_LEN; off < txn->ct_len; off += old_rlen) {
+        rec = txn->ct_buf + off;
+        old_rlen = conf_rec_len(rec);
+        if (rec[1] == nlen &&
+            !memcmp(rec + CONF_REC_HDR_LEN + CONF_REC_VLEN_LEN, name, nlen)) {
+            break;
+        }
+    }
+    if (off >= txn->ct_len) {
+        old_rlen = 0;
+    }
+
+    /*
+     * Leave the transaction as it was if the new value doesn't fit.
+     */
+    if (txn->ct_len - old_rlen + rlen > txn->ct_size) {
+        return OS_ENOMEM;
+    }
+
+    if (old_rlen) {
+        rec = txn->ct_buf + off;
+        memmove(rec, rec + old_rlen, txn->ct_len - off - old_rlen);
+        txn->ct_len -= old_rlen;
+    }
+    memcpy(txn->ct_buf + txn->ct_len, nrec, rlen);
+    txn->ct_len += rlen;
+    return 0;
+}
+
+int
+conf_txn_commit(struct conf_txn *txn)
+{
+    struct conf_store *cs;
+    char rbuf[CONF_REC_MAX_LEN + 1];
+    char vbuf[CONF_MAX_VAL_LEN + 1];
+    char *name;
+    char *val;
+    int prev;
+    int off;
+    int rc;
+
+    conf_lock();
+    cs = conf_save_dst;
+    if (!cs) {
+        rc = OS_ENOENT;
+        goto out;
+    }
+
+    /*
+     * Leave out values which are persisted already.  Without the index,
+     * they're written again rather than reading the stores for each one.
+     */
+#if MYNEWT_VAL(CONFIG_INDEX_CNT) > 0
+    conf_index_ensure_built();
+#endif
+    off = CONF_REC_HDR_LEN;
+    while (off < txn->ct_len) {
+        prev = off;
+        rc = conf_rec_next(txn->ct_buf, txn->ct_len, &off, rbuf, vbuf,
+                           &name, &val);
+        if (rc) {
+            rc = OS_EINVAL;
+            goto out;
+        }
+        if (conf_index_is_dup(name, val) == 1) {
+            memmove(txn->ct_buf + prev, txn->ct_buf + off, txn->ct_len - off);
+            txn->ct_len -= off - prev;
+            off = prev;
+        }
+    }
+    if (txn->ct_len == CONF_REC_HDR_LEN) {
+        rc = 0;
+        goto out;
+    }
+
+    if (cs->cs_itf->csi_save_txn) {
+        rc = cs->cs_itf->csi_save_txn(cs, txn->ct_buf, txn->ct_len);
+    } else {
+        if (cs->cs_itf->csi_save_start) {
+            cs->cs_itf->csi_save_start(cs);
+        }
+        off = CONF_REC_HDR_LEN;
+        rc = 0;
+        while (!rc && off < txn->ct_len) {
+            rc = conf_rec_next(txn->ct_buf, txn->ct_len, &off, rbuf, vbuf,
+                               &name, &val);
+            if (!rc) {
+                rc = cs->cs_itf->csi_save(cs, name, val);
+            }
+        }
+        if (cs->cs_itf->csi_save_end) {
+            cs->cs_itf->csi_save_end(cs);
+        }
+    }
+    if (!rc) {
+        txn->ct_len = CONF_REC_HDR_LEN;
+    }
+out:
+    conf_unlock();
+    return rc;
+}
+
 /*
  * Walk through all registered subsystems, and ask them to export their
  * config variables. Persist these settings.
@@ -176,13 +353,12 @@ conf_store_one(char *name, char *value)
 int
 conf_save_tree(char *name)
 {
-    int name_argc;
-    char *name_argv[CONF_MAX_DIR_DEPTH];
+    struct conf_name cn;
     struct conf_handler *ch;
     int rc;
 
     conf_lock();
-    ch = conf_parse_and_lookup(name, &name_argc, name_argv);
+    ch = conf_parse_and_lookup(name, &cn);
     if (!ch) {
         rc = OS_INVALID_PARM;
         goto out;
@@ -238,4 +414,5 @@ conf_store_init(void)
 {
     conf_loaded = false;
     SLIST_INIT(&conf_load_srcs);
+    conf_index_invalidate();
 }
@@ -323,6 +323,7 @@ TEST_CASE_DECL(config_test_getset_unknown)
 TEST_CASE_DECL(config_test_getset_int)
 TEST_CASE_DECL(config_test_getset_bytes)
 TEST_CASE_DECL(config_test_getset_int64)
+TEST_CASE_DECL(config_test_getset_key)
 TEST_CASE_DECL(config_test_commit)
 TEST_CASE_DECL(config_test_empty_fcb)
 TEST_CASE_DECL(config_test_save_1_fcb)
@@ -333,6 +334,9 @@ TEST_CASE_DECL(config_test_save_3_fcb)
 TEST_CASE_DECL(config_test_compress_reset)
 TEST_CASE_DECL(config_test_save_one_fcb)
 TEST_CASE_DECL(config_test_custom_compress)
+TEST_CASE_DECL(config_test_save_index_fcb)
+TEST_CASE_DECL(config_test_binary_fcb)
+TEST_CASE_DECL(config_test_txn_fcb)
 
 TEST_SUITE(config_test_all)
 {
@@ -345,6 +349,7 @@ TEST_SUITE(config_test_all)
     config_test_getset_int();
     config_test_getset_bytes();
     config_test_getset_int64();
+    config_test_getset_key();
 
     config_test_commit();
 
@@ -365,6 +370,11 @@ TEST_SUITE(config_test_all)
     config_test_custom_compress();
 
     config_test_save_one_fcb();
+    config_test_save_index_fcb();
+#if MYNEWT_VAL(CONFIG_BINARY_FORMAT)
+    config_test_binary_fcb();
+#endif
+    config_test_txn_fcb();
 }
 
 #if MYNEWT_VAL(SELFTEST)
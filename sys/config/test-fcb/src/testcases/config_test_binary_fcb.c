@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "conf_test_fcb.h"
+
+static int
+config_test_last_entry(struct fcb_entry *loc, void *arg)
+{
+    *(struct fcb_entry *)arg = *loc;
+    return 0;
+}
+
+TEST_CASE(config_test_binary_fcb)
+{
+    int rc;
+    struct conf_fcb cf;
+    struct fcb_entry loc;
+    const char *legacy = "myfoo/mybar=17";
+    const char *bytes = "AAECAwQFBgcICQoL";
+    uint8_t type;
+
+    config_wipe_srcs();
+    config_wipe_fcb(fcb_areas, sizeof(fcb_areas) / sizeof(fcb_areas[0]));
+
+    cf.cf_fcb.f_magic = MYNEWT_VAL(CONFIG_FCB_MAGIC);
+    cf.cf_fcb.f_sectors = fcb_areas;
+    cf.cf_fcb.f_sector_cnt = sizeof(fcb_areas) / sizeof(fcb_areas[0]);
+
+    rc = conf_fcb_src(&cf);
+    TEST_ASSERT(rc == 0);
+
+    rc = conf_fcb_dst(&cf);
+    TEST_ASSERT(rc == 0);
+
+    /*
+     * Text records written by older images are still read.
+     */
+    rc = fcb_append(&cf.cf_fcb, strlen(legacy), &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fcb_write(&cf.cf_fcb, &loc, 0, legacy, strlen(legacy));
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fcb_append_finish(&cf.cf_fcb, &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    val8 = 0;
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(val8 == 17);
+
+    /*
+     * Strings are stored verbatim, base64 strings as raw bytes.
+     */
+    c2_var_count = 2;
+    test_export_block = 1;
+    rc = conf_save_one("2nd/string0", "with spaces = kept");
+    TEST_ASSERT(rc == 0);
+
+    rc = conf_save_one("2nd/string1", (char *)bytes);
+    TEST_ASSERT(rc == 0);
+    rc = fcb_walk(&cf.cf_fcb, NULL, config_test_last_entry, &loc);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(loc.fe_data_len ==
+                CONF_REC_HDR_LEN + strlen("2nd/string1") + 12);
+    rc = flash_area_read(loc.fe_area, loc.fe_data_off, &type, 1);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(type == (CONF_REC_BIN | CONF_BYTES));
+
+    memset(val_string, 0, sizeof(val_string));
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!strcmp(val_string[0], "with spaces = kept"));
+    TEST_ASSERT(!strcmp(val_string[1], bytes));
+
+    /*
+     * Deleted values.
+     */
+    rc = conf_save_one("2nd/string0", NULL);
+    TEST_ASSERT(rc == 0);
+    memset(val_string, 0, sizeof(val_string));
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(val_string[0][0] == '\0');
+    TEST_ASSERT(!strcmp(val_string[1], bytes));
+
+    test_export_block = 0;
+    c2_var_count = 0;
+}
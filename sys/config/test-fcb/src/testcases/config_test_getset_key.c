@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "conf_test_fcb.h"
+
+TEST_CASE(config_test_getset_key)
+{
+    const char *name = "/myfoo//mybar";
+    struct conf_key key;
+    char tmp[64], *str;
+    char long_name[CONF_MAX_NAME_LEN + 2];
+    int rc;
+
+    /*
+     * The name is not modified while parsing; empty sections are skipped.
+     */
+    rc = conf_set_value((char *)name, "43");
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(val8 == 43);
+    TEST_ASSERT(!strcmp(name, "/myfoo//mybar"));
+    ctest_clear_call_state();
+
+    rc = conf_key_init(&key, name);
+    TEST_ASSERT(rc == 0);
+
+    rc = conf_set_value_key(&key, "44");
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(test_set_called == 1);
+    TEST_ASSERT(val8 == 44);
+    ctest_clear_call_state();
+
+    str = conf_get_value_key(&key, tmp, sizeof(tmp));
+    TEST_ASSERT(str);
+    TEST_ASSERT(test_get_called == 1);
+    TEST_ASSERT(!strcmp("44", tmp));
+    ctest_clear_call_state();
+
+    /*
+     * Unknown handler, too many sections and too long names.
+     */
+    rc = conf_key_init(&key, "nonexistent/mybar");
+    TEST_ASSERT(rc == 0);
+    rc = conf_set_value_key(&key, "1");
+    TEST_ASSERT(rc == OS_INVALID_PARM);
+    TEST_ASSERT(conf_get_value_key(&key, tmp, sizeof(tmp)) == NULL);
+    TEST_ASSERT(ctest_get_call_state() == 0);
+
+    rc = conf_key_init(&key, "myfoo/1/2/3/4/5/6/7/8");
+    TEST_ASSERT(rc == OS_INVALID_PARM);
+
+    memset(long_name, 'a', sizeof(long_name) - 1);
+    long_name[sizeof(long_name) - 1] = '\0';
+    rc = conf_key_init(&key, long_name);
+    TEST_ASSERT(rc == OS_INVALID_PARM);
+    rc = conf_set_value(long_name, "1");
+    TEST_ASSERT(rc == OS_INVALID_PARM);
+}
@@ -0,0 +1,170 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "conf_test_fcb.h"
+
+static int
+config_test_cnt_entries(struct fcb_entry *loc, void *arg)
+{
+    int *cnt = arg;
+
+    (*cnt)++;
+    return 0;
+}
+
+static int
+config_test_fcb_entries(struct conf_fcb *cf)
+{
+    int cnt;
+    int rc;
+
+    cnt = 0;
+    rc = fcb_walk(&cf->cf_fcb, NULL, config_test_cnt_entries, &cnt);
+    TEST_ASSERT(rc == 0);
+    return cnt;
+}
+
+struct config_test_collide_arg {
+    char costarring[16];
+    char liquid[16];
+};
+
+static void
+config_test_collide_cb(char *name, char *val, uint32_t loc, void *cb_arg)
+{
+    struct config_test_collide_arg *arg = cb_arg;
+
+    if (!strcmp(name, "costarring")) {
+        strcpy(arg->costarring, val ? val : "");
+    } else if (!strcmp(name, "liquid")) {
+        strcpy(arg->liquid, val ? val : "");
+    }
+}
+
+TEST_CASE(config_test_save_index_fcb)
+{
+    int rc;
+    struct conf_fcb cf;
+    struct config_test_collide_arg cta;
+    char test_value[CONF_TEST_FCB_VAL_STR_CNT][CONF_MAX_VAL_LEN];
+    int cnt;
+    int i;
+
+    config_wipe_srcs();
+    config_wipe_fcb(fcb_areas, sizeof(fcb_areas) / sizeof(fcb_areas[0]));
+
+    cf.cf_fcb.f_magic = MYNEWT_VAL(CONFIG_FCB_MAGIC);
+    cf.cf_fcb.f_sectors = fcb_areas;
+    cf.cf_fcb.f_sector_cnt = sizeof(fcb_areas) / sizeof(fcb_areas[0]);
+
+    rc = conf_fcb_src(&cf);
+    TEST_ASSERT(rc == 0);
+
+    rc = conf_fcb_dst(&cf);
+    TEST_ASSERT(rc == 0);
+
+    c2_var_count = 8;
+    test_export_block = 0;
+    val8 = 12;
+    config_test_fill_area(test_value, 0);
+    memcpy(val_string, test_value, sizeof(val_string));
+
+    /*
+     * Saving without a preceding load; only new values get written.
+     */
+    rc = conf_save();
+    TEST_ASSERT(rc == 0);
+    cnt = config_test_fcb_entries(&cf);
+    TEST_ASSERT(cnt > 0);
+
+    rc = conf_save();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(config_test_fcb_entries(&cf) == cnt);
+
+    /*
+     * One changed value, one record.
+     */
+    val8 = 13;
+    rc = conf_save();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(config_test_fcb_entries(&cf) == cnt + 1);
+
+    rc = conf_save_one("myfoo/mybar", "13");
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(config_test_fcb_entries(&cf) == cnt + 1);
+
+    /*
+     * Same after the index is rebuilt by a load.
+     */
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(val8 == 13);
+    rc = conf_save();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(config_test_fcb_entries(&cf) == cnt + 1);
+
+    /*
+     * Names and values which share a hash are told apart; "costarring"
+     * and "liquid" hash the same, as do "declinate" and "macallums".
+     */
+    cnt = config_test_fcb_entries(&cf);
+    rc = conf_save_one("costarring", "1");
+    TEST_ASSERT(rc == 0);
+    rc = conf_save_one("liquid", "1");
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(config_test_fcb_entries(&cf) == cnt + 2);
+
+    rc = conf_save_one("costarring", "declinate");
+    TEST_ASSERT(rc == 0);
+    rc = conf_save_one("costarring", "macallums");
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(config_test_fcb_entries(&cf) == cnt + 4);
+    rc = conf_save_one("costarring", "macallums");
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(config_test_fcb_entries(&cf) == cnt + 4);
+
+    /*
+     * Fill the FCB so it gets compressed; the latest values must survive.
+     */
+    for (i = 1; cf.cf_fcb.f_active.fe_area != &fcb_areas[3]; i++) {
+        config_test_fill_area(test_value, i);
+        memcpy(val_string, test_value, sizeof(val_string));
+        val8 = i;
+
+        rc = conf_save();
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT_FATAL(i < 1000);
+    }
+
+    memset(val_string, 0, sizeof(val_string));
+    val8 = 0;
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!memcmp(val_string, test_value,
+                        c2_var_count * sizeof(val_string[0])));
+    TEST_ASSERT(val8 == (uint8_t)(i - 1));
+
+    memset(&cta, 0, sizeof(cta));
+    rc = cf.cf_store.cs_itf->csi_load(&cf.cf_store, config_test_collide_cb,
+                                      &cta);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!strcmp(cta.costarring, "macallums"));
+    TEST_ASSERT(!strcmp(cta.liquid, "1"));
+
+    c2_var_count = 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "conf_test_fcb.h"
+
+static int
+config_test_txn_cnt(struct fcb_entry *loc, void *arg)
+{
+    int *cnt = arg;
+
+    (*cnt)++;
+    return 0;
+}
+
+static int
+config_test_txn_entries(struct conf_fcb *cf)
+{
+    int cnt;
+    int rc;
+
+    cnt = 0;
+    rc = fcb_walk(&cf->cf_fcb, NULL, config_test_txn_cnt, &cnt);
+    TEST_ASSERT(rc == 0);
+    return cnt;
+}
+
+TEST_CASE(config_test_txn_fcb)
+{
+    int rc;
+    struct conf_fcb cf;
+    struct conf_txn txn;
+    struct fcb_entry loc;
+    uint8_t buf[128];
+    int cnt;
+    int len;
+    int i;
+
+    config_wipe_srcs();
+    config_wipe_fcb(fcb_areas, sizeof(fcb_areas) / sizeof(fcb_areas[0]));
+
+    cf.cf_fcb.f_magic = MYNEWT_VAL(CONFIG_FCB_MAGIC);
+    cf.cf_fcb.f_sectors = fcb_areas;
+    cf.cf_fcb.f_sector_cnt = sizeof(fcb_areas) / sizeof(fcb_areas[0]);
+
+    rc = conf_fcb_src(&cf);
+    TEST_ASSERT(rc == 0);
+
+    rc = conf_fcb_dst(&cf);
+    TEST_ASSERT(rc == 0);
+
+    c2_var_count = 2;
+    test_export_block = 1;
+    rc = conf_save_one("myfoo/mybar", "1");
+    TEST_ASSERT(rc == 0);
+    cnt = config_test_txn_entries(&cf);
+
+    /*
+     * All values go out in one element; only the last one set for a name
+     * is kept.
+     */
+    rc = conf_txn_begin(&txn, buf, sizeof(buf));
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = conf_txn_set(&txn, "myfoo/mybar", "5");
+    TEST_ASSERT(rc == 0);
+    rc = conf_txn_set(&txn, "2nd/string0", "first");
+    TEST_ASSERT(rc == 0);
+    rc = conf_txn_set(&txn, "2nd/string1", "other");
+    TEST_ASSERT(rc == 0);
+    rc = conf_txn_set(&txn, "2nd/string0", "second");
+    TEST_ASSERT(rc == 0);
+    rc = conf_txn_commit(&txn);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(config_test_txn_entries(&cf) == cnt + 1);
+
+    val8 = 0;
+    memset(val_string, 0, sizeof(val_string));
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(val8 == 5);
+    TEST_ASSERT(!strcmp(val_string[0], "second"));
+    TEST_ASSERT(!strcmp(val_string[1], "other"));
+
+    /*
+     * Values which are persisted already are not written again.
+     */
+#if MYNEWT_VAL(CONFIG_INDEX_CNT) > 0
+    rc = conf_txn_set(&txn, "myfoo/mybar", "5");
+    TEST_ASSERT(rc == 0);
+    rc = conf_txn_commit(&txn);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(config_test_txn_entries(&cf) == cnt + 1);
+#endif
+
+    /*
+     * Values which don't fit are refused.
+     */
+    memset(val_string[2], '.', sizeof(buf));
+    val_string[2][sizeof(buf)] = '\0';
+    rc = conf_txn_set(&txn, "2nd/string1", val_string[2]);
+    TEST_ASSERT(rc == OS_ENOMEM);
+
+    /*
+     * A value which doesn't fit leaves the one staged for the name.
+     */
+    rc = conf_txn_begin(&txn, buf, sizeof(buf));
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = conf_txn_set(&txn, "2nd/string1", "kept");
+    TEST_ASSERT(rc == 0);
+    len = txn.ct_len;
+    rc = conf_txn_set(&txn, "2nd/string1", val_string[2]);
+    TEST_ASSERT(rc == OS_ENOMEM);
+    TEST_ASSERT(txn.ct_len == len);
+    rc = conf_txn_commit(&txn);
+    TEST_ASSERT(rc == 0);
+
+    memset(val_string, 0, sizeof(val_string));
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!strcmp(val_string[1], "kept"));
+
+    /*
+     * A transaction which was not written completely is not loaded.
+     */
+    rc = conf_txn_begin(&txn, buf, sizeof(buf));
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = conf_txn_set(&txn, "myfoo/mybar", "7");
+    TEST_ASSERT(rc == 0);
+    rc = conf_txn_set(&txn, "2nd/string0", "torn");
+    TEST_ASSERT(rc == 0);
+    rc = fcb_append(&cf.cf_fcb, txn.ct_len, &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fcb_write(&cf.cf_fcb, &loc, 0, txn.ct_buf, txn.ct_len);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(val8 == 5);
+    TEST_ASSERT(!strcmp(val_string[0], "second"));
+
+    /*
+     * Values from transactions survive compression.
+     */
+    for (i = 0; i < cf.cf_fcb.f_sector_cnt; i++) {
+        conf_fcb_compress(&cf, NULL, NULL);
+    }
+    val8 = 0;
+    memset(val_string, 0, sizeof(val_string));
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(val8 == 5);
+    TEST_ASSERT(!strcmp(val_string[0], "second"));
+    TEST_ASSERT(!strcmp(val_string[1], "kept"));
+
+    test_export_block = 0;
+    c2_var_count = 0;
+}
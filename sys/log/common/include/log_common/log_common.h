@@ -68,6 +68,7 @@ extern "C" {
 #if MYNEWT_VAL(LOG_VERSION) > 2
 #define LOG_ETYPE_CBOR           (1)
 #define LOG_ETYPE_BINARY         (2)
+#define LOG_ETYPE_DEFERRED       (3)
 #endif
 
 /* Logging medium */
@@ -93,6 +94,7 @@ extern "C" {
 #define LOGS_NMGR_OP_MODULE_LIST  (3)
 #define LOGS_NMGR_OP_LEVEL_LIST   (4)
 #define LOGS_NMGR_OP_LOGS_LIST    (5)
+#define LOGS_NMGR_OP_CBOR_KEY_LIST (6)
 
 #define LOG_PRINTF_MAX_ENTRY_LEN (128)
 
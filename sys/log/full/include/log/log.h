@@ -50,6 +50,18 @@ struct log_offset {
     void *lo_arg;
 };
 
+/**
+ * Used for filtered walks; restricts a walk to the entries of one module
+ * and / or of a minimum level.  See `log_walk_filtered`.
+ */
+struct log_filter {
+    /* Only access entries from this module; -1: any module. */
+    int16_t lf_module;
+
+    /* Only access entries whose level >= lf_level. */
+    uint8_t lf_level;
+};
+
 typedef int (*log_walk_func_t)(struct log *, struct log_offset *log_offset,
         void *dptr, uint16_t len);
 
@@ -73,6 +85,9 @@ typedef int (*lh_walk_func_t)(struct log *,
         log_walk_func_t walk_func, struct log_offset *log_offset);
 typedef int (*lh_flush_func_t)(struct log *);
 typedef int (*lh_registered_func_t)(struct log *);
+typedef int (*lh_walk_seek_func_t)(struct log *log,
+        log_walk_func_t walk_func, struct log_offset *log_offset,
+        const struct log_filter *filter);
 
 struct log_handler {
     int log_type;
@@ -84,6 +99,12 @@ struct log_handler {
     lh_append_mbuf_body_func_t log_append_mbuf_body;
     lh_walk_func_t log_walk;
     lh_flush_func_t log_flush;
+    /* Optional.  Like log_walk, but may start at the first entry that can
+     * satisfy the offset and filter, and skip others without reading them.
+     * Entries which are visited are not filtered.  Never called with
+     * lo_ts < 0.
+     */
+    lh_walk_seek_func_t log_walk_seek;
     /* Functions called only internally (no API for apps) */
     lh_registered_func_t log_registered;
 };
@@ -112,36 +133,46 @@ struct log_entry_hdr {
 #define LOG_MODULE_STR(module)      log_module_get_name(module)
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_DEBUG
-#define LOG_DEBUG(__l, __mod, __msg, ...) log_printf(__l, __mod, \
-        LOG_LEVEL_DEBUG, __msg, ##__VA_ARGS__)
+#define LOG_DEBUG(__l, __mod, __msg, ...)                                   \
+    (log_level_enabled((__l), (__mod), LOG_LEVEL_DEBUG) ?                   \
+     log_printf(__l, __mod, LOG_LEVEL_DEBUG, __msg, ##__VA_ARGS__) :        \
+     (void)0)
 #else
 #define LOG_DEBUG(__l, __mod, ...) IGNORE(__VA_ARGS__)
 #endif
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_INFO
-#define LOG_INFO(__l, __mod, __msg, ...) log_printf(__l, __mod, \
-        LOG_LEVEL_INFO, __msg, ##__VA_ARGS__)
+#define LOG_INFO(__l, __mod, __msg, ...)                                    \
+    (log_level_enabled((__l), (__mod), LOG_LEVEL_INFO) ?                    \
+     log_printf(__l, __mod, LOG_LEVEL_INFO, __msg, ##__VA_ARGS__) :         \
+     (void)0)
 #else
 #define LOG_INFO(__l, __mod, ...) IGNORE(__VA_ARGS__)
 #endif
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_WARN
-#define LOG_WARN(__l, __mod, __msg, ...) log_printf(__l, __mod, \
-        LOG_LEVEL_WARN, __msg, ##__VA_ARGS__)
+#define LOG_WARN(__l, __mod, __msg, ...)                                    \
+    (log_level_enabled((__l), (__mod), LOG_LEVEL_WARN) ?                    \
+     log_printf(__l, __mod, LOG_LEVEL_WARN, __msg, ##__VA_ARGS__) :         \
+     (void)0)
 #else
 #define LOG_WARN(__l, __mod, ...) IGNORE(__VA_ARGS__)
 #endif
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_ERROR
-#define LOG_ERROR(__l, __mod, __msg, ...) log_printf(__l, __mod, \
-        LOG_LEVEL_ERROR, __msg, ##__VA_ARGS__)
+#define LOG_ERROR(__l, __mod, __msg, ...)                                   \
+    (log_level_enabled((__l), (__mod), LOG_LEVEL_ERROR) ?                   \
+     log_printf(__l, __mod, LOG_LEVEL_ERROR, __msg, ##__VA_ARGS__) :        \
+     (void)0)
 #else
 #define LOG_ERROR(__l, __mod, ...) IGNORE(__VA_ARGS__)
 #endif
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_CRITICAL
-#define LOG_CRITICAL(__l, __mod, __msg, ...) log_printf(__l, __mod, \
-        LOG_LEVEL_CRITICAL, __msg, ##__VA_ARGS__)
+#define LOG_CRITICAL(__l, __mod, __msg, ...)                                \
+    (log_level_enabled((__l), (__mod), LOG_LEVEL_CRITICAL) ?                \
+     log_printf(__l, __mod, LOG_LEVEL_CRITICAL, __msg, ##__VA_ARGS__) :     \
+     (void)0)
 #else
 #define LOG_CRITICAL(__l, __mod, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -152,6 +183,16 @@ struct log {
     void *l_arg;
     STAILQ_ENTRY(log) l_next;
     uint8_t l_level;
+#if MYNEWT_VAL(LOG_ASYNC)
+    /* Entries go through the asynchronous staging ring. */
+    uint8_t l_async;
+#endif
+#if MYNEWT_VAL(LOG_INDEX)
+    /* Backend read index; see log_fcb_index_init() and
+     * log_cbmem_index_init().  NULL if the log is not indexed.
+     */
+    void *l_idx;
+#endif
 };
 
 /* Log system level functions (for all logs.) */
@@ -428,6 +469,53 @@ log_append_mbuf(struct log *log, uint8_t module, uint8_t level,
 
 void log_printf(struct log *log, uint8_t module, uint8_t level,
         const char *msg, ...);
+
+#if MYNEWT_VAL(LOG_ASYNC)
+/**
+ * @brief Switches a log between synchronous and asynchronous writes.
+ *
+ * Writes to an asynchronous log are copied into a staging ring and written
+ * to the log's backend later, from the log task (or the event queue set with
+ * log_async_evq_set()).  Entries which do not fit in the ring are dropped;
+ * see log_async_drop_cnt().
+ *
+ * @param log                   The registered log to configure.
+ * @param on                    1 for asynchronous writes; 0 for synchronous.
+ */
+void log_set_async(struct log *log, int on);
+
+/**
+ * @brief Writes all pending asynchronous entries to their backends.
+ *
+ * Acts as a barrier: on return, every asynchronous entry reserved before
+ * the call has been handed to its backend.  An entry still being copied in
+ * by another task or an interrupt is waited for, sleeping a tick at a time,
+ * so this must be called from a task.  The entries are written from the
+ * calling task.
+ */
+void log_async_flush(void);
+
+/**
+ * @brief Returns the number of asynchronous entries dropped because the
+ * staging ring was full.
+ */
+uint32_t log_async_drop_cnt(void);
+
+/**
+ * @brief Sets the event queue the asynchronous entries are drained from.
+ *
+ * @param evq                   The event queue to use.
+ */
+void log_async_evq_set(struct os_eventq *evq);
+
+/* Internal; used by the log append functions. */
+int log_async_append_body(struct log *log, const struct log_entry_hdr *hdr,
+                          const void *body, int body_len);
+int log_async_append_mbuf_body(struct log *log,
+                               const struct log_entry_hdr *hdr,
+                               const struct os_mbuf *om, int off);
+void log_async_init(void);
+#endif
 int log_read(struct log *log, void *dptr, void *buf, uint16_t off,
         uint16_t len);
 
@@ -500,9 +588,43 @@ int log_walk(struct log *log, log_walk_func_t walk_func,
  */
 int log_walk_body(struct log *log, log_walk_body_func_t walk_body_func,
         struct log_offset *log_offset);
+
+/**
+ * @brief Applies a callback to each message in the specified log which
+ * satisfies the given offset and filter.
+ *
+ * Unlike `log_walk`, the offset criteria are applied before the callback is
+ * called: if lo_ts is 0, only entries whose index >= lo_index are visited;
+ * otherwise only entries whose (timestamp, index) >= (lo_ts, lo_index).
+ * Backends which implement `log_walk_seek` use their read index to skip
+ * entries which cannot match instead of reading them.
+ *
+ * @param log                   The log to iterate.
+ * @param walk_func             The function to apply to each matching entry.
+ * @param log_offset            Specifies the range of entries to process.
+ * @param filter                Module and level restrictions; NULL for none.
+ *
+ * @return                      0 if the walk completed successfully;
+ *                              nonzero on error or if the walk was aborted.
+ */
+int log_walk_filtered(struct log *log, log_walk_func_t walk_func,
+                      struct log_offset *log_offset,
+                      const struct log_filter *filter);
+
+/**
+ * @brief Like `log_walk_filtered`, except it passes the message header and
+ * body separately to the callback.
+ */
+int log_walk_body_filtered(struct log *log,
+                           log_walk_body_func_t walk_body_func,
+                           struct log_offset *log_offset,
+                           const struct log_filter *filter);
 int log_flush(struct log *log);
 
 #if MYNEWT_VAL(LOG_MODULE_LEVELS)
+/* Private; two module levels per byte.  Use log_level_get(). */
+extern uint8_t log_level_map[];
+
 /**
  * @brief Retrieves the globally configured minimum log level for the specified
  * module ID.
@@ -514,7 +636,18 @@ int log_flush(struct log *log);
  * @return                      The configured minimum level, or 0
  *                                  (LOG_LEVEL_DEBUG) if unconfigured.
  */
-uint8_t log_level_get(uint8_t module);
+static inline uint8_t
+log_level_get(uint8_t module)
+{
+    uint8_t byte;
+
+    byte = log_level_map[module / 2];
+    if (module % 2 == 0) {
+        return byte & 0x0f;
+    } else {
+        return byte >> 4;
+    }
+}
 
 /**
  * @brief Sets the globally configured minimum log level for the specified
@@ -542,6 +675,73 @@ log_level_set(uint8_t module, uint8_t level)
 }
 #endif
 
+/**
+ * @brief Indicates whether a write with the specified level would be accepted
+ * by the specified log and module.
+ *
+ * This only reads the log's level and the module level map; no lock is taken.
+ * The `LOG_[...]` macros check it before evaluating their arguments.
+ *
+ * @param log                   The log to be written to.
+ * @param module                The module ID of the entry.
+ * @param level                 The severity of the entry.
+ *
+ * @return                      1 if the write would be accepted; 0 otherwise.
+ */
+static inline int
+log_level_enabled(const struct log *log, uint8_t module, uint8_t level)
+{
+    return level >= log->l_level && level >= log_level_get(module);
+}
+
+
+#if MYNEWT_VAL(LOG_INDEX)
+/**
+ * Read index of a cbmem log.  Remembers where the last indexed walk left
+ * off, so that a reader polling for "entries since index N" resumes there
+ * instead of walking the whole buffer.
+ */
+struct log_cbmem_index {
+    struct cbmem_entry_hdr *lci_hdr;
+    uint32_t lci_gen;
+    uint32_t lci_index;
+};
+
+/**
+ * @brief Attaches a read index to a registered cbmem log.
+ *
+ * @return                      0 on success; SYS_EINVAL if the log is not a
+ *                                  cbmem log.
+ */
+int log_cbmem_index_init(struct log *log, struct log_cbmem_index *idx);
+
+#if MYNEWT_VAL(LOG_FCB)
+/**
+ * Sparse read index of an FCB log; one element per FCB sector summarizing
+ * the entries it holds.
+ */
+struct log_fcb_index {
+    int64_t lfi_max_ts;
+    uint32_t lfi_max_index;
+    uint16_t lfi_entries;
+    uint8_t lfi_max_level;
+};
+
+/**
+ * @brief Attaches a sparse read index to a registered FCB log, and builds it
+ * by reading the headers of the entries already in flash.
+ *
+ * @param log                   The FCB log to index.
+ * @param idx                   Array of index elements.
+ * @param idx_cnt               Number of elements in idx; must be at least
+ *                                  the number of FCB sectors.
+ *
+ * @return                      0 on success; SYS_EINVAL on bad arguments.
+ */
+int log_fcb_index_init(struct log *log, struct log_fcb_index *idx,
+                       int idx_cnt);
+#endif
+#endif
 
 /* Handler exports */
 #if MYNEWT_VAL(LOG_CONSOLE)
@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SYS_LOG_CBOR_H__
+#define __SYS_LOG_CBOR_H__
+
+#include "syscfg/syscfg.h"
+
+#if MYNEWT_VAL(LOG_CBOR)
+
+#include <inttypes.h>
+#include "os/mynewt.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_mbuf_writer.h"
+#include "log/log.h"
+
+#if MYNEWT_VAL(LOG_VERSION) < 3
+#error "Structured log entries require LOG_VERSION 3"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Structured log entries.
+ *
+ * The body of a structured (LOG_ETYPE_CBOR) entry is a CBOR map whose keys
+ * are small unsigned integers rather than strings.  Key names are registered
+ * once with log_cbor_key_register(); hosts retrieve the id-to-name mapping
+ * with the newtmgr "cbor key list" command and use it to decode entries.
+ * Key ids 1 to 23 are encoded in a single byte.
+ *
+ * An entry is built field by field, e.g.:
+ *
+ *     struct log_cbor_event ev;
+ *
+ *     log_cbor_event_start(&ev, &my_log, MY_MODULE, LOG_LEVEL_INFO);
+ *     log_cbor_event_uint(&ev, MY_KEY_CONN, conn_handle);
+ *     log_cbor_event_int(&ev, MY_KEY_RSSI, rssi);
+ *     log_cbor_event_end(&ev);
+ *
+ * If the entry is filtered out by the log level, log_cbor_event_start()
+ * fails and all subsequent calls do nothing, so the fields are never encoded.
+ */
+struct log_cbor_event {
+    struct log *lce_log;
+    struct os_mbuf *lce_om;
+    struct cbor_mbuf_writer lce_writer;
+    CborEncoder lce_enc;
+    CborEncoder lce_map;
+    CborError lce_err;
+    uint8_t lce_module;
+    uint8_t lce_level;
+};
+
+/**
+ * @brief Registers the name of a structured log key.
+ *
+ * @param id                    The key id to register, from 1 to
+ *                                  LOG_CBOR_MAX_KEYS; 0 to use the first free
+ *                                  id.
+ * @param name                  The key name.  Must remain valid; should be a
+ *                                  string literal.
+ *
+ * @return                      The registered key id on success; 0 if the id
+ *                                  is invalid or already in use, or if no
+ *                                  free id is left.
+ */
+uint16_t log_cbor_key_register(uint16_t id, const char *name);
+
+/**
+ * @brief Retrieves the name of a registered structured log key.
+ *
+ * @return                      The key name; NULL if the id is not
+ *                                  registered.
+ */
+const char *log_cbor_key_name(uint16_t id);
+
+/**
+ * @brief Starts building a structured log entry.
+ *
+ * @param ev                    The event to initialize.
+ * @param log                   The log to write to.
+ * @param module                The log module of the entry to write.
+ * @param level                 The severity of the entry to write.
+ *
+ * @return                      0 on success;
+ *                              SYS_ENOENT if the entry is filtered out by the
+ *                                  log level;
+ *                              SYS_ENOMEM on mbuf exhaustion.
+ */
+int log_cbor_event_start(struct log_cbor_event *ev, struct log *log,
+                         uint8_t module, uint8_t level);
+
+/**
+ * @brief Adds a field to a structured log entry.  Fields of an event whose
+ * start failed are ignored.
+ *
+ * @param ev                    The event being built.
+ * @param key                   The registered key id of the field.
+ */
+void log_cbor_event_int(struct log_cbor_event *ev, uint16_t key,
+                        int64_t val);
+void log_cbor_event_uint(struct log_cbor_event *ev, uint16_t key,
+                         uint64_t val);
+void log_cbor_event_bool(struct log_cbor_event *ev, uint16_t key, int val);
+void log_cbor_event_float(struct log_cbor_event *ev, uint16_t key,
+                          float val);
+void log_cbor_event_str(struct log_cbor_event *ev, uint16_t key,
+                        const char *val);
+void log_cbor_event_bytes(struct log_cbor_event *ev, uint16_t key,
+                          const void *val, uint16_t len);
+
+/**
+ * @brief Finishes a structured log entry and writes it to the log.  The event
+ * is released regardless of the outcome.
+ *
+ * @param ev                    The event to write.
+ *
+ * @return                      0 on success;
+ *                              SYS_ENOENT if the event was not started;
+ *                              SYS_ENOMEM if encoding ran out of mbufs;
+ *                              other nonzero on log write failure.
+ */
+int log_cbor_event_end(struct log_cbor_event *ev);
+
+/**
+ * @brief Releases a structured log entry without writing it.
+ */
+void log_cbor_event_abort(struct log_cbor_event *ev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SYS_LOG_DEFERRED_H__
+#define __SYS_LOG_DEFERRED_H__
+
+#include "syscfg/syscfg.h"
+
+#if MYNEWT_VAL(LOG_DEFERRED)
+
+#include <stdarg.h>
+#include <inttypes.h>
+#include "log/log.h"
+
+#if MYNEWT_VAL(LOG_VERSION) < 3
+#error "Deferred log entries require LOG_VERSION 3"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Body of a LOG_ETYPE_DEFERRED entry.
+ *
+ * The body starts with this header, followed by the raw printf arguments
+ * packed back to back in target byte order, without padding:
+ *     o Integer, floating point and pointer arguments are stored with the
+ *       size of the type they were passed as (after default promotion, so
+ *       %c / %hd are stored as int).
+ *     o '*' width and precision arguments are stored as int, before the
+ *       argument they apply to.
+ *     o %s arguments are copied inline as NUL-terminated strings.
+ *     o %n and %% store nothing.
+ * Arguments which do not fit in the entry are dropped; formatting stops at
+ * the first missing argument.
+ *
+ * The format string is identified both by its address (valid for the image
+ * which wrote the entry) and by an FNV-1a hash of its contents (stable
+ * across builds).
+ *
+ * Format strings are collected at build time: LOG_DEFERRED_FMT() places a
+ * pointer to each one in the "log_deferred_fmt" linker section, the format
+ * table of the image.  Entries are only ever formatted with a string from
+ * that table, so all of them can be read back on every boot, including
+ * entries written before a reset.  An entry is matched by address first,
+ * and by hash if the address is not in the table, e.g. for entries written
+ * by another image.  If different format strings of the table share the
+ * hash, the entry is not formatted.  Host tools build the same table from
+ * the section in the image's ELF file.
+ */
+struct log_deferred_hdr {
+    uintptr_t ldh_fmt;
+    uint32_t ldh_fmt_hash;
+} __attribute__((__packed__));
+
+/**
+ * @brief Computes the hash identifying a format string in deferred entries.
+ *
+ * @param fmt                   The format string.
+ *
+ * @return                      The 32-bit FNV-1a hash of the string.
+ */
+uint32_t log_deferred_hash(const char *fmt);
+
+#ifdef __APPLE__
+#define LOG_DEFERRED_FMT_SECT   "__DATA,log_deferred_fmt"
+#else
+#define LOG_DEFERRED_FMT_SECT   "log_deferred_fmt"
+#endif
+
+/**
+ * @brief Adds a format string to the format table of the image, and
+ * evaluates to it.
+ *
+ * @param fmt_                  The format string; must be a string literal.
+ */
+#define LOG_DEFERRED_FMT(fmt_) ({                                           \
+    static const char *const log_deferred_fmt_                              \
+        __attribute__((section(LOG_DEFERRED_FMT_SECT), used)) = (fmt_);     \
+    log_deferred_fmt_;                                                      \
+})
+
+/**
+ * @brief Packs a format string reference and its arguments into the body of
+ * a deferred log entry.
+ *
+ * Only the conversion specifiers of the format string are inspected; no
+ * argument is converted to text.
+ *
+ * @param buf                   The buffer to pack into.
+ * @param buf_len               The size of the buffer; must be at least
+ *                                  sizeof(struct log_deferred_hdr).
+ * @param fmt                   The format string.  Entries can only be
+ *                                  read back if it comes from
+ *                                  LOG_DEFERRED_FMT().
+ * @param ap                    The format arguments.
+ *
+ * @return                      The number of bytes packed on success;
+ *                              SYS_EINVAL if the buffer is too small.
+ */
+int log_deferred_vpack(void *buf, int buf_len, const char *fmt, va_list ap);
+
+/**
+ * @brief Formats the body of a deferred log entry as text.
+ *
+ * If the format string of the entry is not in the format table of the
+ * running image, or can't be told apart from another one with the same
+ * hash, a placeholder containing the hash is produced instead.
+ *
+ * @param body                  The entry body.
+ * @param body_len              The length of the entry body.
+ * @param out                   The destination buffer; always NUL-terminated.
+ * @param out_len               The size of the destination buffer.
+ *
+ * @return                      The length of the formatted text on success;
+ *                              SYS_EINVAL if the body is malformed.
+ */
+int log_deferred_format(const void *body, int body_len, char *out,
+                        int out_len);
+
+/**
+ * @brief Writes a deferred (binary) entry to the specified log.
+ *
+ * This is a cheaper replacement for log_printf(): the arguments are stored
+ * raw and formatting only happens when the entry is read.
+ *
+ * @param log                   The log to write to.
+ * @param module                The log module of the entry to write.
+ * @param level                 The severity of the log entry to write.
+ * @param fmt                   The format string; must be a string literal.
+ */
+#define log_printf_deferred(log_, module_, level_, fmt_, ...)              \
+    log_deferred_printf((log_), (module_), (level_),                        \
+                        LOG_DEFERRED_FMT(fmt_), ##__VA_ARGS__)
+
+/**
+ * @brief Writes a deferred entry with a format string from
+ * LOG_DEFERRED_FMT(); see log_printf_deferred().
+ */
+void log_deferred_printf(struct log *log, uint8_t module, uint8_t level,
+                         const char *fmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SYS_LOG_FCB_LZ_H__
+#define __SYS_LOG_FCB_LZ_H__
+
+#include "syscfg/syscfg.h"
+
+#if MYNEWT_VAL(LOG_FCB_LZ)
+
+#include "os/mynewt.h"
+#include "log/log.h"
+#include "fcb/fcb.h"
+#include "stats/stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_FCB_LZ_BATCH_SIZE   MYNEWT_VAL(LOG_FCB_LZ_BATCH_SIZE)
+
+/* Header of each FCB element written by log_fcb_lz. */
+struct log_fcb_lz_batch_hdr {
+    uint8_t lbh_type;
+    uint16_t lbh_raw_len;
+} __attribute__((packed));
+
+STATS_SECT_START(log_fcb_lz_stats)
+    STATS_SECT_ENTRY(entries)
+    STATS_SECT_ENTRY(batches)
+    STATS_SECT_ENTRY(batches_raw)
+    STATS_SECT_ENTRY(raw_bytes)
+    STATS_SECT_ENTRY(stored_bytes)
+    STATS_SECT_ENTRY(comp_ticks)
+    STATS_SECT_ENTRY(decomp_ticks)
+    STATS_SECT_ENTRY(too_big)
+    STATS_SECT_ENTRY(corrupt)
+    STATS_SECT_ENTRY(batches_dropped)
+STATS_SECT_END
+
+/*
+ * Argument for log_fcb_lz_handler
+ *
+ * Entries are collected in a RAM batch; when the batch is full, on
+ * log_fcb_lz_commit(), or LOG_FCB_LZ_COMMIT_TIMEOUT_MS after its first entry
+ * was added, it is compressed with an LZ77-class codec and written to the FCB
+ * as a single element.  Reads decompress one element at a time, so
+ * RAM use is bounded by the buffers below regardless of log size.  Entries
+ * still in the batch are visible to walks, but are lost on reset.
+ *
+ * Statistics: raw_bytes / stored_bytes is the compression ratio of the
+ * batches written so far; comp_ticks and decomp_ticks are the os_cputime
+ * ticks spent in the codec.  batches_dropped counts batches which could not
+ * be stored at all, being too big for an FCB element or sector.
+ */
+struct log_fcb_lz {
+    /* Filled in and initialized (fcb_init()) by the caller. */
+    struct fcb_log lz_fcb_log;
+
+    /* Private. */
+    struct os_mutex lz_mtx;
+    uint32_t lz_batch_gen;
+    uint16_t lz_batch_len;
+    uint8_t lz_batch[LOG_FCB_LZ_BATCH_SIZE];
+    uint8_t lz_work[sizeof(struct log_fcb_lz_batch_hdr) +
+                    LOG_FCB_LZ_BATCH_SIZE];
+    uint8_t lz_decode[LOG_FCB_LZ_BATCH_SIZE];
+    uint16_t lz_htab[1 << MYNEWT_VAL(LOG_FCB_LZ_HASH_BITS)];
+#if MYNEWT_VAL(LOG_FCB_LZ_COMMIT_TIMEOUT_MS) > 0
+    struct os_callout lz_commit_co;
+#endif
+
+    STATS_SECT_DECL(log_fcb_lz_stats) lz_stats;
+};
+
+/**
+ * @brief Initializes a compressed FCB log argument and registers its
+ * statistics.  The FCB in lz_fcb_log must already be initialized.  Call this
+ * before registering the log with log_fcb_lz_handler.
+ *
+ * @param lz                    The log argument to initialize.
+ * @param stats_name            Name of the statistics group.
+ *
+ * @return                      0 on success; SYS_E[...] error on failure.
+ */
+int log_fcb_lz_init(struct log_fcb_lz *lz, char *stats_name);
+
+/**
+ * @brief Compresses and writes the entries of the current batch to flash.
+ *
+ * @param log                   A log registered with log_fcb_lz_handler.
+ *
+ * @return                      0 on success; SYS_E[...] error on failure.
+ */
+int log_fcb_lz_commit(struct log *log);
+
+extern const struct log_handler log_fcb_lz_handler;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif
@@ -255,6 +255,12 @@ log_register(char *name, struct log *log, const struct log_handler *lh,
     log->l_log = lh;
     log->l_arg = arg;
     log->l_level = level;
+#if MYNEWT_VAL(LOG_ASYNC)
+    log->l_async = 0;
+#endif
+#if MYNEWT_VAL(LOG_INDEX)
+    log->l_idx = NULL;
+#endif
 
     if (!log_registered(log)) {
         STAILQ_INSERT_TAIL(&g_log_list, log, l_next);
@@ -299,24 +305,19 @@ log_append_prepare(struct log *log, uint8_t module, uint8_t level,
         goto err;
     }
 
-    if (log->l_log->log_type == LOG_TYPE_STORAGE) {
-        /* Remember that a log entry has been persisted since boot. */
-        log_written = 1;
-    }
-
     /*
      * If the log message is below what this log instance is
-     * configured to accept, then just drop it.
+     * configured to accept, or below the module's minimum level, then just
+     * drop it before doing any work.
      */
-    if (level < log->l_level) {
+    if (!log_level_enabled(log, module, level)) {
         rc = -1;
         goto err;
     }
 
-    /* Check if this module has a minimum level. */
-    if (level < log_level_get(module)) {
-        rc = -1;
-        goto err;
+    if (log->l_log->log_type == LOG_TYPE_STORAGE) {
+        /* Remember that a log entry has been persisted since boot. */
+        log_written = 1;
     }
 
     OS_ENTER_CRITICAL(sr);
@@ -356,6 +357,14 @@ log_append_typed(struct log *log, uint8_t module, uint8_t level, uint8_t etype,
         goto err;
     }
 
+#if MYNEWT_VAL(LOG_ASYNC)
+    if (log->l_async) {
+        return log_async_append_body(log, data,
+                                     (uint8_t *)data + LOG_ENTRY_HDR_SIZE,
+                                     len);
+    }
+#endif
+
     rc = log->l_log->log_append(log, data, len + LOG_ENTRY_HDR_SIZE);
     if (rc != 0) {
         goto err;
@@ -378,6 +387,12 @@ log_append_body(struct log *log, uint8_t module, uint8_t level, uint8_t etype,
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_ASYNC)
+    if (log->l_async) {
+        return log_async_append_body(log, &hdr, body, body_len);
+    }
+#endif
+
     rc = log->l_log->log_append_body(log, &hdr, body, body_len);
     if (rc != 0) {
         return rc;
@@ -413,6 +428,20 @@ log_append_mbuf_typed_no_free(struct log *log, uint8_t module, uint8_t level,
         goto err;
     }
 
+#if MYNEWT_VAL(LOG_ASYNC)
+    if (log->l_async) {
+        rc = log_async_append_mbuf_body(log,
+                                        (struct log_entry_hdr *)om->om_data,
+                                        om, LOG_ENTRY_HDR_SIZE);
+        if (rc != 0) {
+            goto err;
+        }
+
+        *om_ptr = om;
+        return 0;
+    }
+#endif
+
     rc = log->l_log->log_append_mbuf(log, om);
     if (rc != 0) {
         goto err;
@@ -462,6 +491,12 @@ log_append_mbuf_body_no_free(struct log *log, uint8_t module, uint8_t level,
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_ASYNC)
+    if (log->l_async) {
+        return log_async_append_mbuf_body(log, &hdr, om, 0);
+    }
+#endif
+
     rc = log->l_log->log_append_mbuf_body(log, &hdr, om);
     if (rc != 0) {
         return rc;
@@ -490,6 +525,11 @@ log_printf(struct log *log, uint8_t module, uint8_t level,
     char buf[LOG_PRINTF_MAX_ENTRY_LEN];
     int len;
 
+    /* Don't format messages that would be dropped anyway. */
+    if (!log_level_enabled(log, module, level)) {
+        return;
+    }
+
     va_start(args, msg);
     len = vsnprintf(buf, LOG_PRINTF_MAX_ENTRY_LEN, msg, args);
     va_end(args);
@@ -583,6 +623,130 @@ log_walk_body(struct log *log, log_walk_body_func_t walk_body_func,
     return rc;
 }
 
+struct log_walk_filter_arg {
+    /* The walk function to call on each matching entry; one of these. */
+    log_walk_func_t fn;
+    log_walk_body_func_t body_fn;
+
+    /* Module / level restrictions; may be NULL. */
+    const struct log_filter *filter;
+
+    /* The original argument passed to the filtered walk. */
+    void *arg;
+};
+
+/**
+ * Indicates whether a log entry satisfies the criteria of a filtered walk.
+ */
+static int
+log_walk_filter_match(const struct log_offset *log_offset,
+                      const struct log_filter *filter,
+                      const struct log_entry_hdr *ueh)
+{
+    if (log_offset->lo_ts == 0) {
+        if (ueh->ue_index < log_offset->lo_index) {
+            return 0;
+        }
+    } else if (log_offset->lo_ts > 0) {
+        if (ueh->ue_ts < log_offset->lo_ts ||
+            (ueh->ue_ts == log_offset->lo_ts &&
+             ueh->ue_index < log_offset->lo_index)) {
+            return 0;
+        }
+    }
+
+    if (filter != NULL) {
+        if (filter->lf_module >= 0 && ueh->ue_module != filter->lf_module) {
+            return 0;
+        }
+        if (ueh->ue_level < filter->lf_level) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Reads the header of a single log entry and forwards the entry to the walk
+ * callback if it matches.  Non-matching entries cost only the header read.
+ */
+static int
+log_walk_filter_fn(struct log *log, struct log_offset *log_offset,
+                   void *dptr, uint16_t len)
+{
+    struct log_walk_filter_arg *lwfa;
+    struct log_entry_hdr ueh;
+    int rc;
+
+    lwfa = log_offset->lo_arg;
+
+    rc = log_read_hdr(log, dptr, &ueh);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (!log_walk_filter_match(log_offset, lwfa->filter, &ueh)) {
+        return 0;
+    }
+
+    log_offset->lo_arg = lwfa->arg;
+    if (lwfa->body_fn != NULL) {
+        rc = lwfa->body_fn(log, log_offset, &ueh, dptr, len - sizeof ueh);
+    } else {
+        rc = lwfa->fn(log, log_offset, dptr, len);
+    }
+    log_offset->lo_arg = lwfa;
+
+    return rc;
+}
+
+static int
+log_walk_filtered_internal(struct log *log, struct log_offset *log_offset,
+                           struct log_walk_filter_arg *lwfa)
+{
+    int rc;
+
+    log_offset->lo_arg = lwfa;
+    if (log_offset->lo_ts >= 0 && log->l_log->log_walk_seek != NULL) {
+        rc = log->l_log->log_walk_seek(log, log_walk_filter_fn, log_offset,
+                                       lwfa->filter);
+    } else {
+        rc = log->l_log->log_walk(log, log_walk_filter_fn, log_offset);
+    }
+    log_offset->lo_arg = lwfa->arg;
+
+    return rc;
+}
+
+int
+log_walk_filtered(struct log *log, log_walk_func_t walk_func,
+                  struct log_offset *log_offset,
+                  const struct log_filter *filter)
+{
+    struct log_walk_filter_arg lwfa = {
+        .fn = walk_func,
+        .filter = filter,
+        .arg = log_offset->lo_arg,
+    };
+
+    return log_walk_filtered_internal(log, log_offset, &lwfa);
+}
+
+int
+log_walk_body_filtered(struct log *log, log_walk_body_func_t walk_body_func,
+                       struct log_offset *log_offset,
+                       const struct log_filter *filter)
+{
+    struct log_walk_filter_arg lwfa = {
+        .body_fn = walk_body_func,
+        .filter = filter,
+        .arg = log_offset->lo_arg,
+    };
+
+    return log_walk_filtered_internal(log, log_offset, &lwfa);
+}
+
 /**
  * Reads from the specified log.
  *
@@ -0,0 +1,347 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LOG_ASYNC)
+
+#include <stddef.h>
+#include <string.h>
+#include "log/log.h"
+
+/*
+ * Asynchronous log pipeline.
+ *
+ * Producers reserve space for an entry in a global staging ring, copy the
+ * entry in and mark it committed.  Only the reservation (a few pointer
+ * updates) is done with interrupts disabled; no lock is held while copying,
+ * so logging is allowed from any task or interrupt.  Entries are drained
+ * into the backends of their logs, in reservation order, from an event on the
+ * log event queue (by default serviced by a dedicated low priority task).
+ *
+ * An entry which does not fit in the ring is dropped and counted.
+ */
+
+/* Record states. */
+#define LOG_ASYNC_REC_RESERVED  0
+#define LOG_ASYNC_REC_COMMITTED 1
+#define LOG_ASYNC_REC_PAD       2   /* Unused space up to the end of ring. */
+
+struct log_async_rec {
+    /* Total record length, including this header; multiple of
+     * LOG_ASYNC_ALIGN.
+     */
+    uint16_t lar_len;
+    volatile uint8_t lar_state;
+    /* Alignment padding following the body. */
+    uint8_t lar_slack;
+    struct log *lar_log;
+    struct log_entry_hdr lar_hdr;
+};
+
+#define LOG_ASYNC_ALIGN         sizeof(uintptr_t)
+#define LOG_ASYNC_REC_HDR_SZ    (offsetof(struct log_async_rec, lar_hdr) + \
+                                 LOG_ENTRY_HDR_SIZE)
+#define LOG_ASYNC_BUF_SZ        \
+    ((int)(MYNEWT_VAL(LOG_ASYNC_BUF_SIZE) & ~(LOG_ASYNC_ALIGN - 1)))
+
+static uintptr_t log_async_buf[LOG_ASYNC_BUF_SZ / LOG_ASYNC_ALIGN];
+
+/* Ring state; protected by OS_ENTER_CRITICAL. */
+static uint16_t log_async_head;
+static uint16_t log_async_tail;
+static uint16_t log_async_used;
+
+static uint32_t log_async_dropped;
+
+/* Serializes consumers (drain task and log_async_flush() callers). */
+static struct os_mutex log_async_mtx;
+
+static void log_async_event_cb(struct os_event *ev);
+
+static struct os_event log_async_ev = {
+    .ev_cb = log_async_event_cb,
+};
+
+static struct os_eventq *log_async_evq;
+
+#if MYNEWT_VAL(LOG_ASYNC_TASK)
+static struct os_task log_async_task;
+static struct os_eventq log_async_task_evq;
+static os_stack_t log_async_stack[MYNEWT_VAL(LOG_ASYNC_TASK_STACK_SIZE)];
+
+static void
+log_async_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&log_async_task_evq);
+    }
+}
+#endif
+
+static struct log_async_rec *
+log_async_rec_at(uint16_t off)
+{
+    return (struct log_async_rec *)((uint8_t *)log_async_buf + off);
+}
+
+/**
+ * Reserves a record for an entry with a body of the specified length.
+ *
+ * @return                      The reserved record on success;
+ *                              NULL if the ring is full.
+ */
+static struct log_async_rec *
+log_async_reserve(struct log *log, const struct log_entry_hdr *hdr,
+                  int body_len)
+{
+    struct log_async_rec *rec;
+    struct log_async_rec *pad;
+    uint16_t contig;
+    int need;
+    int len;
+    os_sr_t sr;
+
+    len = (LOG_ASYNC_REC_HDR_SZ + body_len + LOG_ASYNC_ALIGN - 1) &
+          ~(LOG_ASYNC_ALIGN - 1);
+
+    OS_ENTER_CRITICAL(sr);
+
+    contig = LOG_ASYNC_BUF_SZ - log_async_head;
+    need = len;
+    if (contig < len) {
+        /* Doesn't fit before the end of the ring; skip the tail. */
+        need += contig;
+    }
+
+    if (need > LOG_ASYNC_BUF_SZ - log_async_used) {
+        log_async_dropped++;
+        OS_EXIT_CRITICAL(sr);
+        return NULL;
+    }
+
+    if (contig < len) {
+        pad = log_async_rec_at(log_async_head);
+        pad->lar_len = contig;
+        pad->lar_state = LOG_ASYNC_REC_PAD;
+        log_async_head = 0;
+    }
+
+    rec = log_async_rec_at(log_async_head);
+    rec->lar_len = len;
+    rec->lar_state = LOG_ASYNC_REC_RESERVED;
+    rec->lar_slack = len - LOG_ASYNC_REC_HDR_SZ - body_len;
+
+    log_async_head = (log_async_head + len) % LOG_ASYNC_BUF_SZ;
+    log_async_used += need;
+
+    OS_EXIT_CRITICAL(sr);
+
+    rec->lar_log = log;
+    memcpy(&rec->lar_hdr, hdr, LOG_ENTRY_HDR_SIZE);
+
+    return rec;
+}
+
+static void
+log_async_commit(struct log_async_rec *rec)
+{
+    /* Body must be visible to the consumer before the state changes. */
+    __asm__ volatile ("" ::: "memory");
+    rec->lar_state = LOG_ASYNC_REC_COMMITTED;
+
+    if (log_async_evq != NULL) {
+        os_eventq_put(log_async_evq, &log_async_ev);
+    }
+}
+
+int
+log_async_append_body(struct log *log, const struct log_entry_hdr *hdr,
+                      const void *body, int body_len)
+{
+    struct log_async_rec *rec;
+
+    rec = log_async_reserve(log, hdr, body_len);
+    if (rec == NULL) {
+        return SYS_ENOMEM;
+    }
+
+    memcpy((uint8_t *)rec + LOG_ASYNC_REC_HDR_SZ, body, body_len);
+    log_async_commit(rec);
+
+    return 0;
+}
+
+int
+log_async_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
+                           const struct os_mbuf *om, int off)
+{
+    struct log_async_rec *rec;
+    int body_len;
+
+    body_len = OS_MBUF_PKTLEN(om) - off;
+
+    rec = log_async_reserve(log, hdr, body_len);
+    if (rec == NULL) {
+        return SYS_ENOMEM;
+    }
+
+    os_mbuf_copydata(om, off, body_len,
+                     (uint8_t *)rec + LOG_ASYNC_REC_HDR_SZ);
+    log_async_commit(rec);
+
+    return 0;
+}
+
+/**
+ * Writes committed entries to their backends, in reservation order.
+ *
+ * @param wait_len              The number of ring bytes, from the tail, to
+ *                              drain even if their entries are still
+ *                              being copied in; the caller sleeps until
+ *                              they are committed.  Past those, draining
+ *                              stops at the first such entry.
+ */
+static void
+log_async_drain(int wait_len)
+{
+    struct log_async_rec *rec;
+    struct log *log;
+    os_sr_t sr;
+
+    os_mutex_pend(&log_async_mtx, OS_WAIT_FOREVER);
+
+    while (1) {
+        OS_ENTER_CRITICAL(sr);
+        if (log_async_used == 0) {
+            OS_EXIT_CRITICAL(sr);
+            break;
+        }
+        rec = log_async_rec_at(log_async_tail);
+        OS_EXIT_CRITICAL(sr);
+
+        if (rec->lar_state == LOG_ASYNC_REC_RESERVED) {
+            if (wait_len <= 0) {
+                /* The producer kicks the queue again when it commits. */
+                break;
+            }
+
+            /* Let a preempted producer finish its copy. */
+            os_time_delay(1);
+            continue;
+        }
+
+        if (rec->lar_state == LOG_ASYNC_REC_COMMITTED) {
+            log = rec->lar_log;
+            log->l_log->log_append_body(log, &rec->lar_hdr,
+                                        (uint8_t *)rec + LOG_ASYNC_REC_HDR_SZ,
+                                        rec->lar_len - rec->lar_slack -
+                                        LOG_ASYNC_REC_HDR_SZ);
+        }
+
+        OS_ENTER_CRITICAL(sr);
+        log_async_tail = (log_async_tail + rec->lar_len) % LOG_ASYNC_BUF_SZ;
+        log_async_used -= rec->lar_len;
+        OS_EXIT_CRITICAL(sr);
+
+        wait_len -= rec->lar_len;
+    }
+
+    os_mutex_release(&log_async_mtx);
+}
+
+static void
+log_async_event_cb(struct os_event *ev)
+{
+    log_async_drain(0);
+}
+
+void
+log_async_flush(void)
+{
+    os_sr_t sr;
+    int len;
+
+    if (!os_started()) {
+        /* Nothing can be preempted mid-copy; no need to wait. */
+        log_async_drain(0);
+        return;
+    }
+
+    /* Wait for the entries reserved so far, not for later ones. */
+    OS_ENTER_CRITICAL(sr);
+    len = log_async_used;
+    OS_EXIT_CRITICAL(sr);
+
+    log_async_drain(len);
+}
+
+uint32_t
+log_async_drop_cnt(void)
+{
+    return log_async_dropped;
+}
+
+void
+log_async_evq_set(struct os_eventq *evq)
+{
+    log_async_evq = evq;
+}
+
+void
+log_set_async(struct log *log, int on)
+{
+    if (!on && log->l_async) {
+        /* Don't let pending entries be overtaken by synchronous ones. */
+        log_async_flush();
+    }
+    log->l_async = !!on;
+}
+
+void
+log_async_init(void)
+{
+    int rc;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    log_async_head = 0;
+    log_async_tail = 0;
+    log_async_used = 0;
+    log_async_dropped = 0;
+
+    rc = os_mutex_init(&log_async_mtx);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+#if MYNEWT_VAL(LOG_ASYNC_TASK)
+    os_eventq_init(&log_async_task_evq);
+    rc = os_task_init(&log_async_task, "log", log_async_task_handler, NULL,
+                      MYNEWT_VAL(LOG_ASYNC_TASK_PRIO), OS_WAIT_FOREVER,
+                      log_async_stack,
+                      MYNEWT_VAL(LOG_ASYNC_TASK_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    log_async_evq_set(&log_async_task_evq);
+#else
+    log_async_evq_set(os_eventq_dflt_get());
+#endif
+}
+
+#endif
@@ -17,6 +17,7 @@
  * under the License.
  */
 
+#include <string.h>
 #include "os/mynewt.h"
 #include <cbmem/cbmem.h>
 #include "log/log.h"
@@ -107,18 +108,23 @@ log_cbmem_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
     return cbmem_append_scat_gath(cbmem, &sg);
 }
 
+/*
+ * Entries are handed to walk callbacks as a cursor rather than a raw entry
+ * pointer: the cbmem lock is not held while a callback runs, so reads must
+ * verify that the entry has not been overwritten in the meantime.
+ */
 static int
 log_cbmem_read(struct log *log, void *dptr, void *buf, uint16_t offset,
         uint16_t len)
 {
     struct cbmem *cbmem;
-    struct cbmem_entry_hdr *hdr;
+    struct cbmem_cursor *cur;
     int rc;
 
     cbmem = (struct cbmem *) log->l_arg;
-    hdr = (struct cbmem_entry_hdr *) dptr;
+    cur = (struct cbmem_cursor *) dptr;
 
-    rc = cbmem_read(cbmem, hdr, buf, offset, len);
+    rc = cbmem_cursor_read(cbmem, cur, buf, offset, len);
 
     return (rc);
 }
@@ -128,13 +134,13 @@ log_cbmem_read_mbuf(struct log *log, void *dptr, struct os_mbuf *om,
                     uint16_t offset, uint16_t len)
 {
     struct cbmem *cbmem;
-    struct cbmem_entry_hdr *hdr;
+    struct cbmem_cursor *cur;
     int rc;
 
     cbmem = (struct cbmem *) log->l_arg;
-    hdr = (struct cbmem_entry_hdr *) dptr;
+    cur = (struct cbmem_cursor *) dptr;
 
-    rc = cbmem_read_mbuf(cbmem, hdr, om, offset, len);
+    rc = cbmem_cursor_read_mbuf(cbmem, cur, om, offset, len);
 
     return (rc);
 }
@@ -143,51 +149,116 @@ static int
 log_cbmem_walk(struct log *log, log_walk_func_t walk_func,
                struct log_offset *log_offset)
 {
-    struct cbmem *cbmem;
     struct cbmem_entry_hdr *hdr;
-    struct cbmem_iter iter;
+    struct cbmem_cursor cur;
+    struct cbmem_span span;
+    struct cbmem *cbmem;
+    uint32_t gen;
     int rc;
 
     cbmem = (struct cbmem *) log->l_arg;
 
-    rc = cbmem_lock_acquire(cbmem);
-    if (rc != 0) {
-        goto err;
-    }
-
     /*
      * if timestamp for request is < 1, return last log entry
      */
     if (log_offset->lo_ts < 0) {
+        rc = cbmem_lock_acquire(cbmem);
+        if (rc != 0) {
+            goto err;
+        }
         hdr = cbmem->c_entry_end;
+        gen = cbmem->c_gen;
+        rc = cbmem_lock_release(cbmem);
+        if (rc != 0) {
+            goto err;
+        }
+
         if (hdr != NULL) {
-            rc = walk_func(log, log_offset, (void *)hdr, hdr->ceh_len);
+            cbmem_cursor_init_at(&cur, hdr, gen);
+            if (cbmem_cursor_next(cbmem, &cur, &span) == 0) {
+                walk_func(log, log_offset, &cur, span.cs_len);
+            }
         }
     } else {
-        cbmem_iter_start(cbmem, &iter);
-        while (1) {
-            hdr = cbmem_iter_next(cbmem, &iter);
-            if (!hdr) {
-                break;
-            }
-
-            rc = walk_func(log, log_offset, (void *)hdr, hdr->ceh_len);
+        cbmem_cursor_init(&cur);
+        while (cbmem_cursor_next(cbmem, &cur, &span) == 0) {
+            rc = walk_func(log, log_offset, &cur, span.cs_len);
             if (rc == 1) {
                 break;
             }
         }
     }
 
-    rc = cbmem_lock_release(cbmem);
-    if (rc != 0) {
-        goto err;
-    }
-
     return (0);
 err:
     return (rc);
 }
 
+#if MYNEWT_VAL(LOG_INDEX)
+int
+log_cbmem_index_init(struct log *log, struct log_cbmem_index *idx)
+{
+    if (log->l_log != &log_cbmem_handler) {
+        return SYS_EINVAL;
+    }
+
+    memset(idx, 0, sizeof *idx);
+    log->l_idx = idx;
+
+    return 0;
+}
+
+static int
+log_cbmem_walk_seek(struct log *log, log_walk_func_t walk_func,
+                    struct log_offset *log_offset,
+                    const struct log_filter *filter)
+{
+    struct log_cbmem_index *idx;
+    struct log_entry_hdr ueh;
+    struct cbmem_cursor cur;
+    struct cbmem_span span;
+    struct cbmem *cbmem;
+    int rc;
+
+    idx = log->l_idx;
+    if (idx == NULL) {
+        return log_cbmem_walk(log, walk_func, log_offset);
+    }
+
+    cbmem = (struct cbmem *) log->l_arg;
+
+    /* Indices increase in append order, so a reader asking for entries at or
+     * after the remembered one can resume there.  If the entry has been
+     * overwritten in the meantime, the cursor falls back to the oldest entry.
+     * Timestamps carry no such guarantee.
+     */
+    if (log_offset->lo_ts == 0 && idx->lci_hdr != NULL &&
+        idx->lci_index <= log_offset->lo_index) {
+
+        cbmem_cursor_init_at(&cur, idx->lci_hdr, idx->lci_gen);
+    } else {
+        cbmem_cursor_init(&cur);
+    }
+
+    while (cbmem_cursor_next(cbmem, &cur, &span) == 0) {
+        if (cbmem_cursor_read(cbmem, &cur, &ueh, 0, sizeof ueh) ==
+            sizeof ueh) {
+
+            idx->lci_hdr = cur.cc_hdr;
+            idx->lci_gen = cur.cc_gen;
+            idx->lci_index = ueh.ue_index;
+        }
+
+        rc = walk_func(log, log_offset, &cur, span.cs_len);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+#endif
+
 static int
 log_cbmem_flush(struct log *log)
 {
@@ -216,4 +287,7 @@ const struct log_handler log_cbmem_handler = {
     .log_append_mbuf_body = log_cbmem_append_mbuf_body,
     .log_walk = log_cbmem_walk,
     .log_flush = log_cbmem_flush,
+#if MYNEWT_VAL(LOG_INDEX)
+    .log_walk_seek = log_cbmem_walk_seek,
+#endif
 };
@@ -0,0 +1,190 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LOG_CBOR)
+
+#include <string.h>
+#include "log/log.h"
+#include "log/log_cbor.h"
+
+/* Key names, indexed by key id - 1. */
+static const char *g_log_cbor_keys[MYNEWT_VAL(LOG_CBOR_MAX_KEYS)];
+
+uint16_t
+log_cbor_key_register(uint16_t id, const char *name)
+{
+    uint16_t idx;
+
+    if (id == 0) {
+        /* Find free idx */
+        for (idx = 0;
+             idx < MYNEWT_VAL(LOG_CBOR_MAX_KEYS) && g_log_cbor_keys[idx];
+             idx++) {
+        }
+
+        if (idx == MYNEWT_VAL(LOG_CBOR_MAX_KEYS)) {
+            /* No free idx */
+            return 0;
+        }
+    } else {
+        if (id > MYNEWT_VAL(LOG_CBOR_MAX_KEYS)) {
+            /* Invalid id */
+            return 0;
+        }
+
+        idx = id - 1;
+    }
+
+    if (g_log_cbor_keys[idx]) {
+        /* Already registered with selected id */
+        return 0;
+    }
+
+    g_log_cbor_keys[idx] = name;
+
+    return idx + 1;
+}
+
+const char *
+log_cbor_key_name(uint16_t id)
+{
+    if (id == 0 || id > MYNEWT_VAL(LOG_CBOR_MAX_KEYS)) {
+        return NULL;
+    }
+
+    return g_log_cbor_keys[id - 1];
+}
+
+int
+log_cbor_event_start(struct log_cbor_event *ev, struct log *log,
+                     uint8_t module, uint8_t level)
+{
+    ev->lce_om = NULL;
+
+    /* Don't bother encoding entries that would be dropped anyway. */
+    if (!log_level_enabled(log, module, level)) {
+        return SYS_ENOENT;
+    }
+
+    ev->lce_om = os_msys_get_pkthdr(0, 0);
+    if (ev->lce_om == NULL) {
+        return SYS_ENOMEM;
+    }
+
+    ev->lce_log = log;
+    ev->lce_module = module;
+    ev->lce_level = level;
+
+    /* The number of fields is not known up front. */
+    cbor_mbuf_writer_init(&ev->lce_writer, ev->lce_om);
+    cbor_encoder_init(&ev->lce_enc, &ev->lce_writer.enc, 0);
+    ev->lce_err = cbor_encoder_create_map(&ev->lce_enc, &ev->lce_map,
+                                          CborIndefiniteLength);
+
+    return 0;
+}
+
+void
+log_cbor_event_int(struct log_cbor_event *ev, uint16_t key, int64_t val)
+{
+    if (ev->lce_om != NULL) {
+        ev->lce_err |= cbor_encode_uint(&ev->lce_map, key);
+        ev->lce_err |= cbor_encode_int(&ev->lce_map, val);
+    }
+}
+
+void
+log_cbor_event_uint(struct log_cbor_event *ev, uint16_t key, uint64_t val)
+{
+    if (ev->lce_om != NULL) {
+        ev->lce_err |= cbor_encode_uint(&ev->lce_map, key);
+        ev->lce_err |= cbor_encode_uint(&ev->lce_map, val);
+    }
+}
+
+void
+log_cbor_event_bool(struct log_cbor_event *ev, uint16_t key, int val)
+{
+    if (ev->lce_om != NULL) {
+        ev->lce_err |= cbor_encode_uint(&ev->lce_map, key);
+        ev->lce_err |= cbor_encode_boolean(&ev->lce_map, val != 0);
+    }
+}
+
+void
+log_cbor_event_float(struct log_cbor_event *ev, uint16_t key, float val)
+{
+    if (ev->lce_om != NULL) {
+        ev->lce_err |= cbor_encode_uint(&ev->lce_map, key);
+        ev->lce_err |= cbor_encode_float(&ev->lce_map, val);
+    }
+}
+
+void
+log_cbor_event_str(struct log_cbor_event *ev, uint16_t key, const char *val)
+{
+    if (ev->lce_om != NULL) {
+        ev->lce_err |= cbor_encode_uint(&ev->lce_map, key);
+        ev->lce_err |= cbor_encode_text_stringz(&ev->lce_map, val);
+    }
+}
+
+void
+log_cbor_event_bytes(struct log_cbor_event *ev, uint16_t key,
+                     const void *val, uint16_t len)
+{
+    if (ev->lce_om != NULL) {
+        ev->lce_err |= cbor_encode_uint(&ev->lce_map, key);
+        ev->lce_err |= cbor_encode_byte_string(&ev->lce_map, val, len);
+    }
+}
+
+int
+log_cbor_event_end(struct log_cbor_event *ev)
+{
+    struct os_mbuf *om;
+
+    om = ev->lce_om;
+    if (om == NULL) {
+        return SYS_ENOENT;
+    }
+    ev->lce_om = NULL;
+
+    ev->lce_err |= cbor_encoder_close_container(&ev->lce_enc, &ev->lce_map);
+    if (ev->lce_err != CborNoError) {
+        os_mbuf_free_chain(om);
+        return SYS_ENOMEM;
+    }
+
+    return log_append_mbuf_body(ev->lce_log, ev->lce_module, ev->lce_level,
+                                LOG_ETYPE_CBOR, om);
+}
+
+void
+log_cbor_event_abort(struct log_cbor_event *ev)
+{
+    if (ev->lce_om != NULL) {
+        os_mbuf_free_chain(ev->lce_om);
+        ev->lce_om = NULL;
+    }
+}
+
+#endif
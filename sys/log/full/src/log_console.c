@@ -24,6 +24,7 @@
 #include <cbmem/cbmem.h>
 #include <console/console.h>
 #include "log/log.h"
+#include "log/log_deferred.h"
 
 static struct log log_console;
 
@@ -63,6 +64,10 @@ static int
 log_console_append_body(struct log *log, const struct log_entry_hdr *hdr,
                         const void *body, int body_len)
 {
+#if MYNEWT_VAL(LOG_DEFERRED)
+    char text[LOG_PRINTF_MAX_ENTRY_LEN];
+#endif
+
     if (!console_is_init()) {
         return (0);
     }
@@ -71,6 +76,17 @@ log_console_append_body(struct log *log, const struct log_entry_hdr *hdr,
         log_console_print_hdr(hdr);
     }
 
+#if MYNEWT_VAL(LOG_DEFERRED)
+    /* Nothing is stored; the console is the reader. */
+    if (hdr->ue_etype == LOG_ETYPE_DEFERRED) {
+        body_len = log_deferred_format(body, body_len, text, sizeof(text));
+        if (body_len < 0) {
+            return (0);
+        }
+        body = text;
+    }
+#endif
+
     console_write(body, body_len);
 
     return (0);
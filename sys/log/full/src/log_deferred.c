@@ -0,0 +1,604 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LOG_DEFERRED)
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "log/log.h"
+#include "log/log_deferred.h"
+
+#define LOG_DEFERRED_FNV_BASIS      2166136261UL
+#define LOG_DEFERRED_FNV_PRIME      16777619UL
+
+/* Longest conversion specifier rebuilt for snprintf() on read. */
+#define LOG_DEFERRED_SPEC_MAX       24
+
+/* Argument types, as fetched with va_arg(). */
+#define LOG_DEFERRED_ARG_NONE       0   /* %% */
+#define LOG_DEFERRED_ARG_INT        1
+#define LOG_DEFERRED_ARG_LONG       2
+#define LOG_DEFERRED_ARG_LLONG      3
+#define LOG_DEFERRED_ARG_INTMAX     4
+#define LOG_DEFERRED_ARG_SIZE       5
+#define LOG_DEFERRED_ARG_PTRDIFF    6
+#define LOG_DEFERRED_ARG_DOUBLE     7
+#define LOG_DEFERRED_ARG_LDOUBLE    8
+#define LOG_DEFERRED_ARG_PTR        9
+#define LOG_DEFERRED_ARG_STR        10
+#define LOG_DEFERRED_ARG_COUNT      11  /* %n; consumed, never stored. */
+#define LOG_DEFERRED_ARG_INVALID    12
+
+static const uint8_t log_deferred_arg_size[] = {
+    [LOG_DEFERRED_ARG_NONE]     = 0,
+    [LOG_DEFERRED_ARG_INT]      = sizeof(int),
+    [LOG_DEFERRED_ARG_LONG]     = sizeof(long),
+    [LOG_DEFERRED_ARG_LLONG]    = sizeof(long long),
+    [LOG_DEFERRED_ARG_INTMAX]   = sizeof(intmax_t),
+    [LOG_DEFERRED_ARG_SIZE]     = sizeof(size_t),
+    [LOG_DEFERRED_ARG_PTRDIFF]  = sizeof(ptrdiff_t),
+    [LOG_DEFERRED_ARG_DOUBLE]   = sizeof(double),
+    [LOG_DEFERRED_ARG_LDOUBLE]  = sizeof(long double),
+    [LOG_DEFERRED_ARG_PTR]      = sizeof(void *),
+    [LOG_DEFERRED_ARG_STR]      = 0,
+    [LOG_DEFERRED_ARG_COUNT]    = 0,
+    [LOG_DEFERRED_ARG_INVALID]  = 0,
+};
+
+/*
+ * Format table of the image; the linker collects the LOG_DEFERRED_FMT()
+ * pointers between these.  Entries are only ever formatted with a string
+ * from this table: the address stored in an entry may come from another
+ * image, or from corrupted flash, and is never dereferenced.
+ */
+#ifdef __APPLE__
+extern const char *const log_deferred_fmt_start[]
+    __asm("section$start$__DATA$log_deferred_fmt");
+extern const char *const log_deferred_fmt_stop[]
+    __asm("section$end$__DATA$log_deferred_fmt");
+#else
+/* Weak; the section is missing if the image has no deferred entries. */
+extern const char *const __start_log_deferred_fmt[] __attribute__((weak));
+extern const char *const __stop_log_deferred_fmt[] __attribute__((weak));
+#define log_deferred_fmt_start      __start_log_deferred_fmt
+#define log_deferred_fmt_stop       __stop_log_deferred_fmt
+#endif
+
+struct log_deferred_spec {
+    /* Length of the conversion specifier, including the '%'. */
+    uint8_t lds_len;
+    /* One of the LOG_DEFERRED_ARG_[...] constants. */
+    uint8_t lds_type;
+    /* Number of '*' width / precision arguments. */
+    uint8_t lds_stars;
+};
+
+static inline uint32_t
+log_deferred_hash_char(uint32_t hash, char c)
+{
+    return (hash ^ (uint8_t)c) * LOG_DEFERRED_FNV_PRIME;
+}
+
+/**
+ * Parses the conversion specifier starting at the '%' pointed to by fmt.
+ */
+static void
+log_deferred_spec_parse(const char *fmt, struct log_deferred_spec *spec)
+{
+    const char *p;
+    int lmod;
+
+    p = fmt + 1;
+    spec->lds_stars = 0;
+
+    while (*p != '\0' && strchr("-+ #0", *p) != NULL) {
+        p++;
+    }
+
+    if (*p == '*') {
+        spec->lds_stars++;
+        p++;
+    } else {
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->lds_stars++;
+            p++;
+        } else {
+            while (*p >= '0' && *p <= '9') {
+                p++;
+            }
+        }
+    }
+
+    lmod = 0;
+    switch (*p) {
+    case 'h':
+        p++;
+        if (*p == 'h') {
+            p++;
+        }
+        break;
+    case 'l':
+        p++;
+        lmod = 'l';
+        if (*p == 'l') {
+            p++;
+            lmod = 'q';
+        }
+        break;
+    case 'q':
+    case 'L':
+    case 'j':
+    case 'z':
+    case 't':
+        lmod = *p++;
+        break;
+    }
+
+    switch (*p) {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+        switch (lmod) {
+        case 'l':
+            spec->lds_type = LOG_DEFERRED_ARG_LONG;
+            break;
+        case 'q':
+        case 'L':
+            spec->lds_type = LOG_DEFERRED_ARG_LLONG;
+            break;
+        case 'j':
+            spec->lds_type = LOG_DEFERRED_ARG_INTMAX;
+            break;
+        case 'z':
+            spec->lds_type = LOG_DEFERRED_ARG_SIZE;
+            break;
+        case 't':
+            spec->lds_type = LOG_DEFERRED_ARG_PTRDIFF;
+            break;
+        default:
+            spec->lds_type = LOG_DEFERRED_ARG_INT;
+            break;
+        }
+        break;
+
+    case 'c':
+        spec->lds_type = LOG_DEFERRED_ARG_INT;
+        break;
+
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        if (lmod == 'L') {
+            spec->lds_type = LOG_DEFERRED_ARG_LDOUBLE;
+        } else {
+            spec->lds_type = LOG_DEFERRED_ARG_DOUBLE;
+        }
+        break;
+
+    case 's':
+        spec->lds_type = LOG_DEFERRED_ARG_STR;
+        break;
+
+    case 'p':
+        spec->lds_type = LOG_DEFERRED_ARG_PTR;
+        break;
+
+    case 'n':
+        spec->lds_type = LOG_DEFERRED_ARG_COUNT;
+        break;
+
+    case '%':
+        spec->lds_type = LOG_DEFERRED_ARG_NONE;
+        break;
+
+    default:
+        spec->lds_type = LOG_DEFERRED_ARG_INVALID;
+        break;
+    }
+
+    if (*p != '\0') {
+        p++;
+    }
+    spec->lds_len = p - fmt;
+}
+
+uint32_t
+log_deferred_hash(const char *fmt)
+{
+    uint32_t hash;
+
+    hash = LOG_DEFERRED_FNV_BASIS;
+    while (*fmt != '\0') {
+        hash = log_deferred_hash_char(hash, *fmt++);
+    }
+
+    return hash;
+}
+
+/**
+ * Looks the format string of an entry up in the format table.  Returns NULL
+ * if it is not there, or if different strings of the table share its hash.
+ */
+static const char *
+log_deferred_fmt_find(const struct log_deferred_hdr *hdr)
+{
+    const char *const *fmtp;
+    const char *found;
+
+    for (fmtp = log_deferred_fmt_start; fmtp < log_deferred_fmt_stop;
+         fmtp++) {
+        if ((uintptr_t)*fmtp == hdr->ldh_fmt &&
+            log_deferred_hash(*fmtp) == hdr->ldh_fmt_hash) {
+            return *fmtp;
+        }
+    }
+
+    /* Not written by this image; the same string may be at another
+     * address.  Identical strings can appear more than once.
+     */
+    found = NULL;
+    for (fmtp = log_deferred_fmt_start; fmtp < log_deferred_fmt_stop;
+         fmtp++) {
+        if (log_deferred_hash(*fmtp) != hdr->ldh_fmt_hash) {
+            continue;
+        }
+        if (found != NULL && strcmp(found, *fmtp) != 0) {
+            return NULL;
+        }
+        found = *fmtp;
+    }
+
+    return found;
+}
+
+int
+log_deferred_vpack(void *buf, int buf_len, const char *fmt, va_list ap)
+{
+    struct log_deferred_spec spec;
+    struct log_deferred_hdr hdr;
+    const char *str;
+    uint8_t *u8p;
+    uint32_t hash;
+    int room;
+    int len;
+    int i;
+    union {
+        int i;
+        long l;
+        long long ll;
+        intmax_t im;
+        size_t sz;
+        ptrdiff_t pd;
+        double d;
+        long double ld;
+        void *p;
+    } val;
+
+    if (buf_len < (int)sizeof(hdr)) {
+        return SYS_EINVAL;
+    }
+
+    u8p = (uint8_t *)buf + sizeof(hdr);
+    room = buf_len - sizeof(hdr);
+
+    /* Hash the format string in the same pass that collects the arguments.
+     * Once the buffer is full the remaining arguments are not fetched, but
+     * the rest of the string still needs to be hashed.
+     */
+    hash = LOG_DEFERRED_FNV_BASIS;
+    hdr.ldh_fmt = (uintptr_t)fmt;
+
+    while (*fmt != '\0') {
+        if (*fmt != '%' || room < 0) {
+            hash = log_deferred_hash_char(hash, *fmt++);
+            continue;
+        }
+
+        log_deferred_spec_parse(fmt, &spec);
+        for (i = 0; i < spec.lds_len; i++) {
+            hash = log_deferred_hash_char(hash, fmt[i]);
+        }
+        fmt += spec.lds_len;
+
+        for (i = 0; i < spec.lds_stars; i++) {
+            val.i = va_arg(ap, int);
+            if (room < (int)sizeof(int)) {
+                room = -1;
+                break;
+            }
+            memcpy(u8p, &val.i, sizeof(int));
+            u8p += sizeof(int);
+            room -= sizeof(int);
+        }
+        if (room < 0) {
+            continue;
+        }
+
+        switch (spec.lds_type) {
+        case LOG_DEFERRED_ARG_INT:
+            val.i = va_arg(ap, int);
+            break;
+        case LOG_DEFERRED_ARG_LONG:
+            val.l = va_arg(ap, long);
+            break;
+        case LOG_DEFERRED_ARG_LLONG:
+            val.ll = va_arg(ap, long long);
+            break;
+        case LOG_DEFERRED_ARG_INTMAX:
+            val.im = va_arg(ap, intmax_t);
+            break;
+        case LOG_DEFERRED_ARG_SIZE:
+            val.sz = va_arg(ap, size_t);
+            break;
+        case LOG_DEFERRED_ARG_PTRDIFF:
+            val.pd = va_arg(ap, ptrdiff_t);
+            break;
+        case LOG_DEFERRED_ARG_DOUBLE:
+            val.d = va_arg(ap, double);
+            break;
+        case LOG_DEFERRED_ARG_LDOUBLE:
+            val.ld = va_arg(ap, long double);
+            break;
+        case LOG_DEFERRED_ARG_PTR:
+        case LOG_DEFERRED_ARG_COUNT:
+            val.p = va_arg(ap, void *);
+            break;
+
+        case LOG_DEFERRED_ARG_STR:
+            str = va_arg(ap, const char *);
+            if (str == NULL) {
+                str = "(null)";
+            }
+            if (room == 0) {
+                room = -1;
+                continue;
+            }
+            len = strlen(str);
+            if (len > room - 1) {
+                len = room - 1;
+            }
+            memcpy(u8p, str, len);
+            u8p[len] = '\0';
+            u8p += len + 1;
+            room -= len + 1;
+            continue;
+
+        case LOG_DEFERRED_ARG_NONE:
+            continue;
+
+        default:
+            /* Unknown conversion; the argument list can't be followed. */
+            room = -1;
+            continue;
+        }
+
+        len = log_deferred_arg_size[spec.lds_type];
+        if (len > room) {
+            room = -1;
+            continue;
+        }
+        memcpy(u8p, &val, len);
+        u8p += len;
+        room -= len;
+    }
+
+    hdr.ldh_fmt_hash = hash;
+    memcpy(buf, &hdr, sizeof(hdr));
+
+    return u8p - (uint8_t *)buf;
+}
+
+int
+log_deferred_format(const void *body, int body_len, char *out, int out_len)
+{
+    struct log_deferred_spec spec;
+    struct log_deferred_hdr hdr;
+    const uint8_t *u8p;
+    const char *fmt;
+    const char *end;
+    char sfmt[LOG_DEFERRED_SPEC_MAX];
+    int soff;
+    int star;
+    int room;
+    int off;
+    int len;
+    int rc;
+    int i;
+    union {
+        int i;
+        long l;
+        long long ll;
+        intmax_t im;
+        size_t sz;
+        ptrdiff_t pd;
+        double d;
+        long double ld;
+        void *p;
+    } val;
+
+    if (out_len <= 0 || body_len < (int)sizeof(hdr)) {
+        return SYS_EINVAL;
+    }
+
+    memcpy(&hdr, body, sizeof(hdr));
+    fmt = log_deferred_fmt_find(&hdr);
+    if (fmt == NULL) {
+        rc = snprintf(out, out_len, "<fmt 0x%08lx>",
+                      (unsigned long)hdr.ldh_fmt_hash);
+        return min(rc, out_len - 1);
+    }
+
+    u8p = (const uint8_t *)body + sizeof(hdr);
+    room = body_len - sizeof(hdr);
+    off = 0;
+
+    while (*fmt != '\0' && off < out_len - 1) {
+        if (*fmt != '%') {
+            out[off++] = *fmt++;
+            continue;
+        }
+
+        log_deferred_spec_parse(fmt, &spec);
+        if (spec.lds_type == LOG_DEFERRED_ARG_INVALID) {
+            break;
+        }
+
+        /* Rebuild the specifier with '*' replaced by the stored values. */
+        soff = 0;
+        for (i = 0; i < spec.lds_len; i++) {
+            if (fmt[i] != '*') {
+                if (soff >= (int)sizeof(sfmt) - 1) {
+                    break;
+                }
+                sfmt[soff++] = fmt[i];
+                continue;
+            }
+
+            if (room < (int)sizeof(int)) {
+                break;
+            }
+            memcpy(&star, u8p, sizeof(int));
+            u8p += sizeof(int);
+            room -= sizeof(int);
+
+            rc = snprintf(sfmt + soff, sizeof(sfmt) - soff, "%d", star);
+            if (rc >= (int)sizeof(sfmt) - soff) {
+                break;
+            }
+            soff += rc;
+        }
+        if (i < spec.lds_len) {
+            break;
+        }
+        sfmt[soff] = '\0';
+        fmt += spec.lds_len;
+
+        rc = 0;
+        switch (spec.lds_type) {
+        case LOG_DEFERRED_ARG_NONE:
+            out[off++] = '%';
+            continue;
+
+        case LOG_DEFERRED_ARG_COUNT:
+            continue;
+
+        case LOG_DEFERRED_ARG_STR:
+            end = memchr(u8p, '\0', room);
+            if (end == NULL) {
+                goto done;
+            }
+            rc = snprintf(out + off, out_len - off, sfmt, (const char *)u8p);
+            len = end - (const char *)u8p + 1;
+            u8p += len;
+            room -= len;
+            break;
+
+        default:
+            len = log_deferred_arg_size[spec.lds_type];
+            if (len > room) {
+                goto done;
+            }
+            memcpy(&val, u8p, len);
+            u8p += len;
+            room -= len;
+
+            switch (spec.lds_type) {
+            case LOG_DEFERRED_ARG_INT:
+                rc = snprintf(out + off, out_len - off, sfmt, val.i);
+                break;
+            case LOG_DEFERRED_ARG_LONG:
+                rc = snprintf(out + off, out_len - off, sfmt, val.l);
+                break;
+            case LOG_DEFERRED_ARG_LLONG:
+                rc = snprintf(out + off, out_len - off, sfmt, val.ll);
+                break;
+            case LOG_DEFERRED_ARG_INTMAX:
+                rc = snprintf(out + off, out_len - off, sfmt, val.im);
+                break;
+            case LOG_DEFERRED_ARG_SIZE:
+                rc = snprintf(out + off, out_len - off, sfmt, val.sz);
+                break;
+            case LOG_DEFERRED_ARG_PTRDIFF:
+                rc = snprintf(out + off, out_len - off, sfmt, val.pd);
+                break;
+            case LOG_DEFERRED_ARG_DOUBLE:
+                rc = snprintf(out + off, out_len - off, sfmt, val.d);
+                break;
+            case LOG_DEFERRED_ARG_LDOUBLE:
+                rc = snprintf(out + off, out_len - off, sfmt, val.ld);
+                break;
+            case LOG_DEFERRED_ARG_PTR:
+                rc = snprintf(out + off, out_len - off, sfmt, val.p);
+                break;
+            }
+            break;
+        }
+
+        if (rc > 0) {
+            off = min(off + rc, out_len - 1);
+        }
+    }
+
+done:
+    out[off] = '\0';
+    return off;
+}
+
+void
+log_deferred_printf(struct log *log, uint8_t module, uint8_t level,
+                    const char *fmt, ...)
+{
+    uint8_t buf[MYNEWT_VAL(LOG_DEFERRED_MAX_ENTRY_LEN)];
+    va_list args;
+    int len;
+
+    /* Don't bother packing entries that would be dropped anyway. */
+    if (!log_level_enabled(log, module, level)) {
+        return;
+    }
+
+    va_start(args, fmt);
+    len = log_deferred_vpack(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (len < 0) {
+        return;
+    }
+
+    log_append_body(log, module, level, LOG_ETYPE_DEFERRED, buf, len);
+}
+
+#endif
@@ -34,11 +34,106 @@ static struct flash_area sector;
 
 static int log_fcb_rtr_erase(struct log *log, void *arg);
 
+#if MYNEWT_VAL(LOG_INDEX)
+/**
+ * Retrieves the index element describing the given sector, or NULL if the log
+ * is not indexed.
+ */
+static struct log_fcb_index *
+log_fcb_index_get(struct log *log, const struct flash_area *fap)
+{
+    struct log_fcb_index *idx;
+    struct fcb *fcb;
+
+    idx = log->l_idx;
+    fcb = &((struct fcb_log *)log->l_arg)->fl_fcb;
+    if (idx == NULL ||
+        fap < fcb->f_sectors || fap >= fcb->f_sectors + fcb->f_sector_cnt) {
+        return NULL;
+    }
+
+    return &idx[fap - fcb->f_sectors];
+}
+
+static void
+log_fcb_index_update(struct log_fcb_index *lfi,
+                     const struct log_entry_hdr *hdr)
+{
+    if (lfi->lfi_entries == 0 || hdr->ue_ts > lfi->lfi_max_ts) {
+        lfi->lfi_max_ts = hdr->ue_ts;
+    }
+    if (lfi->lfi_entries == 0 || hdr->ue_index > lfi->lfi_max_index) {
+        lfi->lfi_max_index = hdr->ue_index;
+    }
+    if (lfi->lfi_entries == 0 || hdr->ue_level > lfi->lfi_max_level) {
+        lfi->lfi_max_level = hdr->ue_level;
+    }
+    if (lfi->lfi_entries < UINT16_MAX) {
+        lfi->lfi_entries++;
+    }
+}
+
+/**
+ * Records a newly appended entry in the index of the sector it went to.
+ */
+static void
+log_fcb_index_add(struct log *log, const struct fcb_entry *loc,
+                  const struct log_entry_hdr *hdr)
+{
+    struct log_fcb_index *lfi;
+
+    lfi = log_fcb_index_get(log, loc->fe_area);
+    if (lfi != NULL) {
+        log_fcb_index_update(lfi, hdr);
+    }
+}
+
+static void
+log_fcb_index_clear(struct log *log, const struct flash_area *fap)
+{
+    struct log_fcb_index *lfi;
+
+    lfi = log_fcb_index_get(log, fap);
+    if (lfi != NULL) {
+        memset(lfi, 0, sizeof *lfi);
+    }
+}
+
+/**
+ * Indicates whether none of the entries in a sector can satisfy the given
+ * offset and filter, based on the sector's index element.
+ */
+static int
+log_fcb_index_skip(const struct log_fcb_index *lfi,
+                   const struct log_offset *log_offset,
+                   const struct log_filter *filter)
+{
+    if (lfi->lfi_entries == 0) {
+        return 1;
+    }
+    if (log_offset->lo_ts == 0) {
+        if (lfi->lfi_max_index < log_offset->lo_index) {
+            return 1;
+        }
+    } else if (lfi->lfi_max_ts < log_offset->lo_ts) {
+        return 1;
+    }
+    if (filter != NULL && lfi->lfi_max_level < filter->lf_level) {
+        return 1;
+    }
+
+    return 0;
+}
+#endif
+
 static int
 log_fcb_start_append(struct log *log, int len, struct fcb_entry *loc)
 {
     struct fcb *fcb;
     struct fcb_log *fcb_log;
+#if MYNEWT_VAL(LOG_INDEX)
+    struct flash_area *oldest;
+#endif
     int rc = 0;
 
     fcb_log = (struct fcb_log *)log->l_arg;
@@ -62,10 +157,16 @@ log_fcb_start_append(struct log *log, int len, struct fcb_entry *loc)
             continue;
         }
 
+#if MYNEWT_VAL(LOG_INDEX)
+        oldest = fcb->f_oldest;
+#endif
         rc = fcb_rotate(fcb);
         if (rc) {
             goto err;
         }
+#if MYNEWT_VAL(LOG_INDEX)
+        log_fcb_index_clear(log, oldest);
+#endif
     }
 
 err:
@@ -88,12 +189,17 @@ log_fcb_append(struct log *log, void *buf, int len)
         goto err;
     }
 
-    rc = flash_area_write(loc.fe_area, loc.fe_data_off, buf, len);
+    rc = fcb_write(fcb, &loc, 0, buf, len);
     if (rc) {
         goto err;
     }
 
     rc = fcb_append_finish(fcb, &loc);
+#if MYNEWT_VAL(LOG_INDEX)
+    if (rc == 0 && len >= sizeof (struct log_entry_hdr)) {
+        log_fcb_index_add(log, &loc, buf);
+    }
+#endif
 
 err:
     return (rc);
@@ -161,7 +267,7 @@ log_fcb_append_body(struct log *log, const struct log_entry_hdr *hdr,
     memcpy(buf, hdr, sizeof *hdr);
     memcpy(buf + sizeof *hdr, u8p, hdr_alignment);
 
-    rc = flash_area_write(loc.fe_area, loc.fe_data_off, buf, chunk_sz);
+    rc = fcb_write(fcb, &loc, 0, buf, chunk_sz);
     if (rc != 0) {
         return rc;
     }
@@ -172,8 +278,7 @@ log_fcb_append_body(struct log *log, const struct log_entry_hdr *hdr,
     body_len -= hdr_alignment;
 
     if (body_len > 0) {
-        rc = flash_area_write(loc.fe_area, loc.fe_data_off + chunk_sz, u8p,
-                              body_len);
+        rc = fcb_write(fcb, &loc, chunk_sz, u8p, body_len);
         if (rc != 0) {
             return rc;
         }
@@ -183,23 +288,26 @@ log_fcb_append_body(struct log *log, const struct log_entry_hdr *hdr,
     if (rc != 0) {
         return rc;
     }
+#if MYNEWT_VAL(LOG_INDEX)
+    log_fcb_index_add(log, &loc, hdr);
+#endif
 
     return 0;
 }
 
 static int
-log_fcb_write_mbuf(struct fcb_entry *loc, const struct os_mbuf *om)
+log_fcb_write_mbuf(struct fcb *fcb, struct fcb_entry *loc, uint16_t off,
+                   const struct os_mbuf *om)
 {
     int rc;
 
     while (om) {
-        rc = flash_area_write(loc->fe_area, loc->fe_data_off,
-                              om->om_data, om->om_len);
+        rc = fcb_write(fcb, loc, off, om->om_data, om->om_len);
         if (rc != 0) {
             return SYS_EIO;
         }
 
-        loc->fe_data_off += om->om_len;
+        off += om->om_len;
         om = SLIST_NEXT(om, om_next);
     }
 
@@ -232,7 +340,7 @@ log_fcb_append_mbuf(struct log *log, const struct os_mbuf *om)
         return rc;
     }
 
-    rc = log_fcb_write_mbuf(&loc, om);
+    rc = log_fcb_write_mbuf(fcb, &loc, 0, om);
     if (rc != 0) {
         return rc;
     }
@@ -241,6 +349,15 @@ log_fcb_append_mbuf(struct log *log, const struct os_mbuf *om)
     if (rc != 0) {
         return rc;
     }
+#if MYNEWT_VAL(LOG_INDEX)
+    {
+        struct log_entry_hdr hdr;
+
+        if (os_mbuf_copydata(om, 0, sizeof hdr, &hdr) == 0) {
+            log_fcb_index_add(log, &loc, &hdr);
+        }
+    }
+#endif
 
     return 0;
 }
@@ -271,13 +388,12 @@ log_fcb_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
         return rc;
     }
 
-    rc = flash_area_write(loc.fe_area, loc.fe_data_off, hdr, sizeof *hdr);
+    rc = fcb_write(fcb, &loc, 0, hdr, sizeof *hdr);
     if (rc != 0) {
         return rc;
     }
-    loc.fe_data_off += sizeof *hdr;
 
-    rc = log_fcb_write_mbuf(&loc, om);
+    rc = log_fcb_write_mbuf(fcb, &loc, sizeof *hdr, om);
     if (rc != 0) {
         return rc;
     }
@@ -286,6 +402,9 @@ log_fcb_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
     if (rc != 0) {
         return rc;
     }
+#if MYNEWT_VAL(LOG_INDEX)
+    log_fcb_index_add(log, &loc, hdr);
+#endif
 
     return 0;
 }
@@ -380,9 +499,103 @@ log_fcb_walk(struct log *log, log_walk_func_t walk_func,
     return (rc);
 }
 
+#if MYNEWT_VAL(LOG_INDEX)
+static int
+log_fcb_walk_seek(struct log *log, log_walk_func_t walk_func,
+                  struct log_offset *log_offset,
+                  const struct log_filter *filter)
+{
+    struct log_fcb_index *lfi;
+    struct flash_area *fap;
+    struct fcb_entry loc;
+    struct fcb *fcb;
+    int rc;
+
+    if (log->l_idx == NULL) {
+        return log_fcb_walk(log, walk_func, log_offset);
+    }
+
+    fcb = &((struct fcb_log *)log->l_arg)->fl_fcb;
+
+    /* Walk sector by sector, skipping those whose index rules out every
+     * entry.  The active sector is always read; it is being appended to.
+     */
+    fap = fcb->f_oldest;
+    while (1) {
+        lfi = log_fcb_index_get(log, fap);
+        if (lfi == NULL || fap == fcb->f_active.fe_area ||
+            !log_fcb_index_skip(lfi, log_offset, filter)) {
+
+            memset(&loc, 0, sizeof(loc));
+            loc.fe_area = fap;
+            while (fcb_getnext(fcb, &loc) == 0 && loc.fe_area == fap) {
+                rc = walk_func(log, log_offset, (void *)&loc,
+                               loc.fe_data_len);
+                if (rc) {
+                    return rc;
+                }
+            }
+        }
+
+        if (fap == fcb->f_active.fe_area) {
+            break;
+        }
+
+        fap++;
+        if (fap >= fcb->f_sectors + fcb->f_sector_cnt) {
+            fap = fcb->f_sectors;
+        }
+    }
+
+    return 0;
+}
+
+int
+log_fcb_index_init(struct log *log, struct log_fcb_index *idx, int idx_cnt)
+{
+    struct log_entry_hdr ueh;
+    struct fcb_entry loc;
+    struct fcb *fcb;
+    int rc;
+
+    if (log->l_log != &log_fcb_handler) {
+        return SYS_EINVAL;
+    }
+
+    fcb = &((struct fcb_log *)log->l_arg)->fl_fcb;
+    if (idx_cnt < fcb->f_sector_cnt) {
+        return SYS_EINVAL;
+    }
+
+    memset(idx, 0, fcb->f_sector_cnt * sizeof *idx);
+    log->l_idx = idx;
+
+    /* Index the entries already in flash. */
+    memset(&loc, 0, sizeof(loc));
+    while (fcb_getnext(fcb, &loc) == 0) {
+        rc = log_fcb_read(log, &loc, &ueh, 0, sizeof ueh);
+        if (rc == sizeof ueh) {
+            log_fcb_index_add(log, &loc, &ueh);
+        }
+    }
+
+    return 0;
+}
+#endif
+
 static int
 log_fcb_flush(struct log *log)
 {
+#if MYNEWT_VAL(LOG_INDEX)
+    struct fcb *fcb;
+
+    if (log->l_idx != NULL) {
+        fcb = &((struct fcb_log *)log->l_arg)->fl_fcb;
+        memset(log->l_idx, 0, fcb->f_sector_cnt *
+                              sizeof (struct log_fcb_index));
+    }
+#endif
+
     return fcb_clear(&((struct fcb_log *)log->l_arg)->fl_fcb);
 }
 
@@ -533,6 +746,9 @@ const struct log_handler log_fcb_handler = {
     .log_append_mbuf_body = log_fcb_append_mbuf_body,
     .log_walk = log_fcb_walk,
     .log_flush = log_fcb_flush,
+#if MYNEWT_VAL(LOG_INDEX)
+    .log_walk_seek = log_fcb_walk_seek,
+#endif
 };
 
 #endif
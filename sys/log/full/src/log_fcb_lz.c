@@ -0,0 +1,737 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LOG_FCB_LZ)
+
+#include <string.h>
+
+#include "log/log_fcb_lz.h"
+
+/*
+ * Batch element types.
+ */
+#define LOG_FCB_LZ_TYPE_RAW     0
+#define LOG_FCB_LZ_TYPE_LZ      1
+
+/* Each entry in a batch is preceded by its 16-bit little endian length. */
+#define LOG_FCB_LZ_ENTRY_HDR_SZ 2
+
+/*
+ * Codec limits.  A compressed stream is a sequence of items:
+ *     000LLLLL <L + 1 literal bytes>
+ *     LLLooooo [LLLLLLLL if LLL == 7] oooooooo
+ *         back reference; length (L + 2) and offset (o + 1).
+ */
+#define LOG_FCB_LZ_MAX_LIT      32
+#define LOG_FCB_LZ_MAX_OFF      (1 << 13)
+#define LOG_FCB_LZ_MAX_REF      (7 + 255 + 2)
+#define LOG_FCB_LZ_HASH_BITS    MYNEWT_VAL(LOG_FCB_LZ_HASH_BITS)
+
+#define LOG_FCB_LZ_COMMIT_TIMEOUT_MS MYNEWT_VAL(LOG_FCB_LZ_COMMIT_TIMEOUT_MS)
+
+/* A log entry within a decoded batch; what walk callbacks get as dptr. */
+struct log_fcb_lz_entry {
+    const uint8_t *lze_data;
+    uint16_t lze_len;
+};
+
+STATS_NAME_START(log_fcb_lz_stats)
+    STATS_NAME(log_fcb_lz_stats, entries)
+    STATS_NAME(log_fcb_lz_stats, batches)
+    STATS_NAME(log_fcb_lz_stats, batches_raw)
+    STATS_NAME(log_fcb_lz_stats, raw_bytes)
+    STATS_NAME(log_fcb_lz_stats, stored_bytes)
+    STATS_NAME(log_fcb_lz_stats, comp_ticks)
+    STATS_NAME(log_fcb_lz_stats, decomp_ticks)
+    STATS_NAME(log_fcb_lz_stats, too_big)
+    STATS_NAME(log_fcb_lz_stats, corrupt)
+    STATS_NAME(log_fcb_lz_stats, batches_dropped)
+STATS_NAME_END(log_fcb_lz_stats)
+
+static uint32_t
+log_fcb_lz_hash(const uint8_t *p)
+{
+    uint32_t v;
+
+    v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+
+    return (v * 2654435761u) >> (32 - LOG_FCB_LZ_HASH_BITS);
+}
+
+#if LOG_FCB_LZ_COMMIT_TIMEOUT_MS > 0
+static void
+log_fcb_lz_arm_commit(struct log_fcb_lz *lz)
+{
+    os_callout_reset(&lz->lz_commit_co,
+                     os_time_ms_to_ticks32(LOG_FCB_LZ_COMMIT_TIMEOUT_MS));
+}
+#endif
+
+static int
+log_fcb_lz_put_literals(const uint8_t *lit, int lit_len, uint8_t *out,
+                        int *op, int out_len)
+{
+    int chunk;
+
+    while (lit_len > 0) {
+        chunk = min(lit_len, LOG_FCB_LZ_MAX_LIT);
+        if (*op + 1 + chunk > out_len) {
+            return -1;
+        }
+        out[(*op)++] = chunk - 1;
+        memcpy(out + *op, lit, chunk);
+        *op += chunk;
+        lit += chunk;
+        lit_len -= chunk;
+    }
+
+    return 0;
+}
+
+/**
+ * Compresses a buffer.
+ *
+ * @return                      The compressed length; -1 if the compressed
+ *                                  data does not fit in out_len bytes.
+ */
+static int
+log_fcb_lz_compress(uint16_t *htab, const uint8_t *in, int in_len,
+                    uint8_t *out, int out_len)
+{
+    int lit_start;
+    int max_len;
+    int end;
+    int ref;
+    int off;
+    int len;
+    int ip;
+    int op;
+    uint32_t h;
+
+    memset(htab, 0, sizeof(uint16_t) << LOG_FCB_LZ_HASH_BITS);
+
+    ip = 0;
+    op = 0;
+    lit_start = 0;
+    while (ip + 2 < in_len) {
+        /* Hash table slots hold position + 1; 0 is empty. */
+        h = log_fcb_lz_hash(in + ip);
+        ref = htab[h] - 1;
+        htab[h] = ip + 1;
+
+        off = ip - ref - 1;
+        if (ref < 0 || off >= LOG_FCB_LZ_MAX_OFF ||
+            memcmp(in + ref, in + ip, 3) != 0) {
+
+            ip++;
+            continue;
+        }
+
+        max_len = min(in_len - ip, LOG_FCB_LZ_MAX_REF);
+        len = 3;
+        while (len < max_len && in[ref + len] == in[ip + len]) {
+            len++;
+        }
+
+        if (log_fcb_lz_put_literals(in + lit_start, ip - lit_start,
+                                    out, &op, out_len) != 0) {
+            return -1;
+        }
+
+        len -= 2;
+        if (len < 7) {
+            if (op + 2 > out_len) {
+                return -1;
+            }
+            out[op++] = (len << 5) | (off >> 8);
+        } else {
+            if (op + 3 > out_len) {
+                return -1;
+            }
+            out[op++] = (7 << 5) | (off >> 8);
+            out[op++] = len - 7;
+        }
+        out[op++] = off;
+
+        /* Index the matched bytes so later data can refer to them too. */
+        end = ip + len + 2;
+        while (++ip < end && ip + 2 < in_len) {
+            htab[log_fcb_lz_hash(in + ip)] = ip + 1;
+        }
+        ip = end;
+        lit_start = ip;
+    }
+
+    if (log_fcb_lz_put_literals(in + lit_start, in_len - lit_start,
+                                out, &op, out_len) != 0) {
+        return -1;
+    }
+
+    return op;
+}
+
+/**
+ * Decompresses a buffer.
+ *
+ * @return                      The decompressed length; -1 if the input is
+ *                                  corrupt or does not fit in out_len bytes.
+ */
+static int
+log_fcb_lz_decompress(const uint8_t *in, int in_len, uint8_t *out,
+                      int out_len)
+{
+    uint8_t ctrl;
+    int ref;
+    int len;
+    int ip;
+    int op;
+
+    ip = 0;
+    op = 0;
+    while (ip < in_len) {
+        ctrl = in[ip++];
+        if (ctrl < LOG_FCB_LZ_MAX_LIT) {
+            len = ctrl + 1;
+            if (ip + len > in_len || op + len > out_len) {
+                return -1;
+            }
+            memcpy(out + op, in + ip, len);
+            ip += len;
+            op += len;
+            continue;
+        }
+
+        len = ctrl >> 5;
+        if (len == 7) {
+            if (ip >= in_len) {
+                return -1;
+            }
+            len += in[ip++];
+        }
+        len += 2;
+        if (ip >= in_len) {
+            return -1;
+        }
+        ref = op - ((((ctrl & 0x1f) << 8) | in[ip++]) + 1);
+        if (ref < 0 || op + len > out_len) {
+            return -1;
+        }
+
+        /* Byte-wise; the source may overlap the destination. */
+        while (len-- > 0) {
+            out[op++] = out[ref++];
+        }
+    }
+
+    return op;
+}
+
+/**
+ * Compresses the current batch and writes it to the FCB as one element.
+ * Must be called with the log mutex held.
+ */
+static int
+log_fcb_lz_write_batch(struct log_fcb_lz *lz)
+{
+    struct log_fcb_lz_batch_hdr *hdr;
+    struct fcb_entry loc;
+    struct fcb *fcb;
+    uint32_t ticks;
+    int body_len;
+    int rc;
+    int i;
+
+    if (lz->lz_batch_len == 0) {
+        return 0;
+    }
+
+    hdr = (struct log_fcb_lz_batch_hdr *)lz->lz_work;
+    hdr->lbh_raw_len = lz->lz_batch_len;
+
+    /* Store the batch as is unless compression actually saves space. */
+    ticks = os_cputime_get32();
+    body_len = log_fcb_lz_compress(lz->lz_htab, lz->lz_batch,
+                                   lz->lz_batch_len, lz->lz_work + sizeof *hdr,
+                                   lz->lz_batch_len - 1);
+    STATS_INCN(lz->lz_stats, comp_ticks, os_cputime_get32() - ticks);
+    if (body_len < 0) {
+        hdr->lbh_type = LOG_FCB_LZ_TYPE_RAW;
+        memcpy(lz->lz_work + sizeof *hdr, lz->lz_batch, lz->lz_batch_len);
+        body_len = lz->lz_batch_len;
+        STATS_INC(lz->lz_stats, batches_raw);
+    } else {
+        hdr->lbh_type = LOG_FCB_LZ_TYPE_LZ;
+    }
+
+    fcb = &lz->lz_fcb_log.fl_fcb;
+    for (i = 0; ; i++) {
+        rc = fcb_append(fcb, sizeof *hdr + body_len, &loc);
+        if (rc != FCB_ERR_NOSPACE || i >= fcb->f_sector_cnt) {
+            break;
+        }
+        rc = fcb_rotate(fcb);
+        if (rc != 0) {
+            return SYS_EIO;
+        }
+    }
+    if (rc == FCB_ERR_FLASH) {
+        return SYS_EIO;
+    }
+    if (rc != 0) {
+        /*
+         * Too big for an FCB element, or for a sector even with all the
+         * others rotated out; retrying can't help, so the batch is dropped
+         * to make room for new entries.
+         */
+        STATS_INC(lz->lz_stats, batches_dropped);
+        lz->lz_batch_len = 0;
+        lz->lz_batch_gen++;
+        return SYS_ENOMEM;
+    }
+
+    rc = fcb_write(fcb, &loc, 0, lz->lz_work, sizeof *hdr + body_len);
+    if (rc != 0) {
+        return SYS_EIO;
+    }
+    rc = fcb_append_finish(fcb, &loc);
+    if (rc != 0) {
+        return SYS_EIO;
+    }
+
+    STATS_INC(lz->lz_stats, batches);
+    STATS_INCN(lz->lz_stats, raw_bytes, lz->lz_batch_len);
+    STATS_INCN(lz->lz_stats, stored_bytes, sizeof *hdr + body_len);
+
+    lz->lz_batch_len = 0;
+    lz->lz_batch_gen++;
+
+    return 0;
+}
+
+/**
+ * Reserves room for an entry of the specified length in the current batch,
+ * writing out the batch first if it is full.  If the full batch had to be
+ * dropped, the entry starts a new one.  Returns a pointer to where the entry
+ * should be copied, or NULL on failure.  Must be called with the log mutex
+ * held.
+ */
+static uint8_t *
+log_fcb_lz_reserve(struct log_fcb_lz *lz, int len)
+{
+    uint8_t *dst;
+    int rc;
+
+    if (len > LOG_FCB_LZ_BATCH_SIZE - LOG_FCB_LZ_ENTRY_HDR_SZ) {
+        STATS_INC(lz->lz_stats, too_big);
+        return NULL;
+    }
+
+    if (lz->lz_batch_len + LOG_FCB_LZ_ENTRY_HDR_SZ + len >
+        LOG_FCB_LZ_BATCH_SIZE) {
+
+        rc = log_fcb_lz_write_batch(lz);
+        if (rc != 0 && lz->lz_batch_len != 0) {
+            return NULL;
+        }
+    }
+
+#if LOG_FCB_LZ_COMMIT_TIMEOUT_MS > 0
+    /* The first entry of a batch bounds how long the batch stays in RAM. */
+    if (lz->lz_batch_len == 0) {
+        log_fcb_lz_arm_commit(lz);
+    }
+#endif
+
+    dst = lz->lz_batch + lz->lz_batch_len;
+    put_le16(dst, len);
+    lz->lz_batch_len += LOG_FCB_LZ_ENTRY_HDR_SZ + len;
+
+    STATS_INC(lz->lz_stats, entries);
+
+    return dst + LOG_FCB_LZ_ENTRY_HDR_SZ;
+}
+
+static int
+log_fcb_lz_append(struct log *log, void *buf, int len)
+{
+    struct log_fcb_lz *lz;
+    uint8_t *dst;
+
+    lz = log->l_arg;
+
+    os_mutex_pend(&lz->lz_mtx, OS_TIMEOUT_NEVER);
+    dst = log_fcb_lz_reserve(lz, len);
+    if (dst != NULL) {
+        memcpy(dst, buf, len);
+    }
+    os_mutex_release(&lz->lz_mtx);
+
+    return dst != NULL ? 0 : SYS_ENOMEM;
+}
+
+static int
+log_fcb_lz_append_body(struct log *log, const struct log_entry_hdr *hdr,
+                       const void *body, int body_len)
+{
+    struct log_fcb_lz *lz;
+    uint8_t *dst;
+
+    lz = log->l_arg;
+
+    os_mutex_pend(&lz->lz_mtx, OS_TIMEOUT_NEVER);
+    dst = log_fcb_lz_reserve(lz, sizeof *hdr + body_len);
+    if (dst != NULL) {
+        memcpy(dst, hdr, sizeof *hdr);
+        memcpy(dst + sizeof *hdr, body, body_len);
+    }
+    os_mutex_release(&lz->lz_mtx);
+
+    return dst != NULL ? 0 : SYS_ENOMEM;
+}
+
+static int
+log_fcb_lz_append_mbuf(struct log *log, const struct os_mbuf *om)
+{
+    struct log_fcb_lz *lz;
+    uint8_t *dst;
+    int len;
+
+    lz = log->l_arg;
+    len = os_mbuf_len(om);
+
+    os_mutex_pend(&lz->lz_mtx, OS_TIMEOUT_NEVER);
+    dst = log_fcb_lz_reserve(lz, len);
+    if (dst != NULL) {
+        os_mbuf_copydata(om, 0, len, dst);
+    }
+    os_mutex_release(&lz->lz_mtx);
+
+    return dst != NULL ? 0 : SYS_ENOMEM;
+}
+
+static int
+log_fcb_lz_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
+                            const struct os_mbuf *om)
+{
+    struct log_fcb_lz *lz;
+    uint8_t *dst;
+    int len;
+
+    lz = log->l_arg;
+    len = os_mbuf_len(om);
+
+    os_mutex_pend(&lz->lz_mtx, OS_TIMEOUT_NEVER);
+    dst = log_fcb_lz_reserve(lz, sizeof *hdr + len);
+    if (dst != NULL) {
+        memcpy(dst, hdr, sizeof *hdr);
+        os_mbuf_copydata(om, 0, len, dst + sizeof *hdr);
+    }
+    os_mutex_release(&lz->lz_mtx);
+
+    return dst != NULL ? 0 : SYS_ENOMEM;
+}
+
+static int
+log_fcb_lz_read(struct log *log, void *dptr, void *buf, uint16_t offset,
+                uint16_t len)
+{
+    struct log_fcb_lz_entry *lze;
+
+    lze = dptr;
+    if (offset >= lze->lze_len) {
+        return 0;
+    }
+    if (offset + len > lze->lze_len) {
+        len = lze->lze_len - offset;
+    }
+    memcpy(buf, lze->lze_data + offset, len);
+
+    return len;
+}
+
+static int
+log_fcb_lz_read_mbuf(struct log *log, void *dptr, struct os_mbuf *om,
+                     uint16_t offset, uint16_t len)
+{
+    struct log_fcb_lz_entry *lze;
+
+    lze = dptr;
+    if (offset >= lze->lze_len) {
+        return 0;
+    }
+    if (offset + len > lze->lze_len) {
+        len = lze->lze_len - offset;
+    }
+    if (os_mbuf_append(om, lze->lze_data + offset, len) != 0) {
+        return 0;
+    }
+
+    return len;
+}
+
+/**
+ * Reads and decodes one FCB element into the decode buffer.
+ *
+ * @return                      The decoded batch length; -1 on failure.
+ */
+static int
+log_fcb_lz_load(struct log_fcb_lz *lz, const struct fcb_entry *loc)
+{
+    struct log_fcb_lz_batch_hdr hdr;
+    uint32_t ticks;
+    int body_len;
+    int rc;
+
+    body_len = loc->fe_data_len - (int)sizeof hdr;
+    if (body_len < 0 || body_len > LOG_FCB_LZ_BATCH_SIZE) {
+        goto corrupt;
+    }
+
+    rc = flash_area_read(loc->fe_area, loc->fe_data_off, &hdr, sizeof hdr);
+    if (rc != 0 || hdr.lbh_raw_len > LOG_FCB_LZ_BATCH_SIZE) {
+        goto corrupt;
+    }
+
+    if (hdr.lbh_type == LOG_FCB_LZ_TYPE_RAW) {
+        rc = flash_area_read(loc->fe_area, loc->fe_data_off + sizeof hdr,
+                             lz->lz_decode, body_len);
+        if (rc != 0 || body_len != hdr.lbh_raw_len) {
+            goto corrupt;
+        }
+        return body_len;
+    }
+
+    rc = flash_area_read(loc->fe_area, loc->fe_data_off + sizeof hdr,
+                         lz->lz_work, body_len);
+    if (rc != 0) {
+        goto corrupt;
+    }
+
+    ticks = os_cputime_get32();
+    rc = log_fcb_lz_decompress(lz->lz_work, body_len, lz->lz_decode,
+                               hdr.lbh_raw_len);
+    STATS_INCN(lz->lz_stats, decomp_ticks, os_cputime_get32() - ticks);
+    if (rc != hdr.lbh_raw_len) {
+        goto corrupt;
+    }
+
+    return rc;
+
+corrupt:
+    STATS_INC(lz->lz_stats, corrupt);
+    return -1;
+}
+
+/**
+ * Applies the walk callback to the entries of a decoded batch.  If last_only
+ * is set, only the final entry is visited.  Stops early if the batch is
+ * replaced under the walk (gen_ptr changes from gen).
+ */
+static int
+log_fcb_lz_walk_batch(struct log *log, log_walk_func_t walk_func,
+                      struct log_offset *log_offset, const uint8_t *batch,
+                      int batch_len, const uint32_t *gen_ptr, uint32_t gen,
+                      int last_only)
+{
+    struct log_fcb_lz_entry lze;
+    int off;
+    int rc;
+
+    off = 0;
+    while (off + LOG_FCB_LZ_ENTRY_HDR_SZ <= batch_len) {
+        lze.lze_len = get_le16(batch + off);
+        lze.lze_data = batch + off + LOG_FCB_LZ_ENTRY_HDR_SZ;
+        off += LOG_FCB_LZ_ENTRY_HDR_SZ + lze.lze_len;
+        if (off > batch_len) {
+            break;
+        }
+
+        if (last_only && off + LOG_FCB_LZ_ENTRY_HDR_SZ <= batch_len) {
+            continue;
+        }
+
+        rc = walk_func(log, log_offset, &lze, lze.lze_len);
+        if (rc != 0) {
+            return rc;
+        }
+
+        if (gen_ptr != NULL && *gen_ptr != gen) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+static int
+log_fcb_lz_walk(struct log *log, log_walk_func_t walk_func,
+                struct log_offset *log_offset)
+{
+    struct log_fcb_lz *lz;
+    struct fcb_entry loc;
+    struct fcb *fcb;
+    int batch_len;
+    int rc;
+
+    lz = log->l_arg;
+    fcb = &lz->lz_fcb_log.fl_fcb;
+    rc = 0;
+
+    os_mutex_pend(&lz->lz_mtx, OS_TIMEOUT_NEVER);
+
+    /*
+     * if timestamp for request is < 0, return last log entry
+     */
+    if (log_offset->lo_ts < 0) {
+        if (lz->lz_batch_len > 0) {
+            rc = log_fcb_lz_walk_batch(log, walk_func, log_offset,
+                                       lz->lz_batch, lz->lz_batch_len,
+                                       NULL, 0, 1);
+        } else if (!fcb_is_empty(fcb)) {
+            loc = fcb->f_active;
+            batch_len = log_fcb_lz_load(lz, &loc);
+            if (batch_len > 0) {
+                rc = log_fcb_lz_walk_batch(log, walk_func, log_offset,
+                                           lz->lz_decode, batch_len,
+                                           NULL, 0, 1);
+            }
+        }
+        goto done;
+    }
+
+    memset(&loc, 0, sizeof(loc));
+    while (fcb_getnext(fcb, &loc) == 0) {
+        batch_len = log_fcb_lz_load(lz, &loc);
+        if (batch_len < 0) {
+            continue;
+        }
+
+        rc = log_fcb_lz_walk_batch(log, walk_func, log_offset,
+                                   lz->lz_decode, batch_len, NULL, 0, 0);
+        if (rc != 0) {
+            goto done;
+        }
+    }
+
+    /* Entries not written to flash yet. */
+    rc = log_fcb_lz_walk_batch(log, walk_func, log_offset, lz->lz_batch,
+                               lz->lz_batch_len, &lz->lz_batch_gen,
+                               lz->lz_batch_gen, 0);
+
+done:
+    os_mutex_release(&lz->lz_mtx);
+    return rc;
+}
+
+static int
+log_fcb_lz_flush(struct log *log)
+{
+    struct log_fcb_lz *lz;
+    int rc;
+
+    lz = log->l_arg;
+
+    os_mutex_pend(&lz->lz_mtx, OS_TIMEOUT_NEVER);
+    lz->lz_batch_len = 0;
+    lz->lz_batch_gen++;
+    rc = fcb_clear(&lz->lz_fcb_log.fl_fcb);
+    os_mutex_release(&lz->lz_mtx);
+
+    return rc;
+}
+
+#if LOG_FCB_LZ_COMMIT_TIMEOUT_MS > 0
+/**
+ * Writes a partial batch once its commit timeout expires.  If the write
+ * fails and the batch is kept, it is retried after another timeout.
+ */
+static void
+log_fcb_lz_commit_ev(struct os_event *ev)
+{
+    struct log_fcb_lz *lz;
+    int rc;
+
+    lz = ev->ev_arg;
+
+    os_mutex_pend(&lz->lz_mtx, OS_TIMEOUT_NEVER);
+    rc = log_fcb_lz_write_batch(lz);
+    if (rc != 0 && lz->lz_batch_len != 0) {
+        log_fcb_lz_arm_commit(lz);
+    }
+    os_mutex_release(&lz->lz_mtx);
+}
+#endif
+
+int
+log_fcb_lz_commit(struct log *log)
+{
+    struct log_fcb_lz *lz;
+    int rc;
+
+    if (log->l_log != &log_fcb_lz_handler) {
+        return SYS_EINVAL;
+    }
+    lz = log->l_arg;
+
+    os_mutex_pend(&lz->lz_mtx, OS_TIMEOUT_NEVER);
+    rc = log_fcb_lz_write_batch(lz);
+    os_mutex_release(&lz->lz_mtx);
+
+    return rc;
+}
+
+int
+log_fcb_lz_init(struct log_fcb_lz *lz, char *stats_name)
+{
+    int rc;
+
+    os_mutex_init(&lz->lz_mtx);
+    lz->lz_batch_len = 0;
+    lz->lz_batch_gen = 0;
+#if LOG_FCB_LZ_COMMIT_TIMEOUT_MS > 0
+    os_callout_init(&lz->lz_commit_co, os_eventq_dflt_get(),
+                    log_fcb_lz_commit_ev, lz);
+#endif
+
+    rc = stats_init_and_reg(STATS_HDR(lz->lz_stats),
+                            STATS_SIZE_INIT_PARMS(lz->lz_stats, STATS_SIZE_32),
+                            STATS_NAME_INIT_PARMS(log_fcb_lz_stats),
+                            stats_name);
+    if (rc != 0) {
+        return SYS_EINVAL;
+    }
+
+    return 0;
+}
+
+const struct log_handler log_fcb_lz_handler = {
+    .log_type = LOG_TYPE_STORAGE,
+    .log_read = log_fcb_lz_read,
+    .log_read_mbuf = log_fcb_lz_read_mbuf,
+    .log_append = log_fcb_lz_append,
+    .log_append_body = log_fcb_lz_append_body,
+    .log_append_mbuf = log_fcb_lz_append_mbuf,
+    .log_append_mbuf_body = log_fcb_lz_append_mbuf_body,
+    .log_walk = log_fcb_lz_walk,
+    .log_flush = log_fcb_lz_flush,
+};
+
+#endif
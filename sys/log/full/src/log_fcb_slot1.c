@@ -96,6 +96,17 @@ log_fcb_slot1_walk(struct log *log, log_walk_func_t walk_func,
     return LOG_FCB_SLOT1_CALL(log, log_walk, walk_func, log_offset);
 }
 
+#if MYNEWT_VAL(LOG_INDEX)
+static int
+log_fcb_slot1_walk_seek(struct log *log, log_walk_func_t walk_func,
+                        struct log_offset *log_offset,
+                        const struct log_filter *filter)
+{
+    return LOG_FCB_SLOT1_CALL(log, log_walk_seek, walk_func, log_offset,
+                              filter);
+}
+#endif
+
 static int
 log_fcb_slot1_flush(struct log *log)
 {
@@ -141,6 +152,9 @@ const struct log_handler log_fcb_slot1_handler = {
     .log_append_mbuf_body = log_fcb_slot1_append_mbuf_body,
     .log_walk = log_fcb_slot1_walk,
     .log_flush = log_fcb_slot1_flush,
+#if MYNEWT_VAL(LOG_INDEX)
+    .log_walk_seek = log_fcb_slot1_walk_seek,
+#endif
     .log_registered = log_fcb_slot1_registered,
 };
 
@@ -280,6 +294,14 @@ log_fcb_slot1_unlock(void)
             continue;
         }
 
+#if MYNEWT_VAL(LOG_INDEX)
+        /* The FCB was reinitialized; rebuild its index, if any. */
+        if (s1->l_fcb.l_idx != NULL) {
+            log_fcb_index_init(&s1->l_fcb, s1->l_fcb.l_idx,
+                    ((struct fcb_log *)s1->l_fcb.l_arg)->fl_fcb.f_sector_cnt);
+        }
+#endif
+
         os_mutex_pend(&s1->mutex, OS_TIMEOUT_NEVER);
 
         if (s1->l_current) {
@@ -27,20 +27,7 @@
  * Contains the minimum log level for each of the 256 modules.  Two levels are
  * packed into a single byte, one per nibble.
  */
-static uint8_t log_level_map[(LOG_MODULE_MAX + 1) / 2];
-
-uint8_t
-log_level_get(uint8_t module)
-{
-    uint8_t byte;
-
-    byte = log_level_map[module / 2];
-    if (module % 2 == 0) {
-        return byte & 0x0f;
-    } else {
-        return byte >> 4;
-    }
-}
+uint8_t log_level_map[(LOG_MODULE_MAX + 1) / 2];
 
 int
 log_level_set(uint8_t module, uint8_t level)
@@ -28,6 +28,8 @@
 #include "cborattr/cborattr.h"
 #include "tinycbor/cbor_cnt_writer.h"
 #include "log/log.h"
+#include "log/log_deferred.h"
+#include "log/log_cbor.h"
 
 /* Source code is only included if the newtmgr library is enabled.  Otherwise
  * this file is compiled out for code size.
@@ -38,6 +40,9 @@ static int log_nmgr_clear(struct mgmt_cbuf *njb);
 static int log_nmgr_module_list(struct mgmt_cbuf *njb);
 static int log_nmgr_level_list(struct mgmt_cbuf *njb);
 static int log_nmgr_logs_list(struct mgmt_cbuf *njb);
+#if MYNEWT_VAL(LOG_CBOR)
+static int log_nmgr_cbor_key_list(struct mgmt_cbuf *njb);
+#endif
 static struct mgmt_group log_nmgr_group;
 
 
@@ -49,7 +54,10 @@ static struct mgmt_handler log_nmgr_group_handlers[] = {
     [LOGS_NMGR_OP_CLEAR] = {log_nmgr_clear, log_nmgr_clear},
     [LOGS_NMGR_OP_MODULE_LIST] = {log_nmgr_module_list, NULL},
     [LOGS_NMGR_OP_LEVEL_LIST] = {log_nmgr_level_list, NULL},
-    [LOGS_NMGR_OP_LOGS_LIST] = {log_nmgr_logs_list, NULL}
+    [LOGS_NMGR_OP_LOGS_LIST] = {log_nmgr_logs_list, NULL},
+#if MYNEWT_VAL(LOG_CBOR)
+    [LOGS_NMGR_OP_CBOR_KEY_LIST] = {log_nmgr_cbor_key_list, NULL},
+#endif
 };
 
 struct log_encode_data {
@@ -57,6 +65,103 @@ struct log_encode_data {
     CborEncoder *enc;
 };
 
+#if MYNEWT_VAL(LOG_VERSION) > 2
+#if MYNEWT_VAL(LOG_DEFERRED) && !MYNEWT_VAL(LOG_DEFERRED_HOST_FMT)
+/**
+ * Formats a deferred entry and encodes it as a string entry.
+ */
+static CborError
+log_nmgr_encode_deferred(CborEncoder *rsp, struct log *log, void *dptr,
+                         uint16_t len)
+{
+    uint8_t body[MYNEWT_VAL(LOG_DEFERRED_MAX_ENTRY_LEN)];
+    char text[LOG_PRINTF_MAX_ENTRY_LEN];
+    CborError g_err = CborNoError;
+    int rc;
+
+    rc = log_read_body(log, dptr, body, 0, min(len, sizeof(body)));
+    if (rc < 0) {
+        return CborErrorIO;
+    }
+
+    rc = log_deferred_format(body, rc, text, sizeof(text));
+    if (rc < 0) {
+        rc = 0;
+    }
+
+    g_err |= cbor_encode_text_stringz(rsp, "type");
+    g_err |= cbor_encode_text_stringz(rsp, "str");
+    g_err |= cbor_encode_text_stringz(rsp, "msg");
+    g_err |= cbor_encode_byte_string(rsp, (uint8_t *)text, rc);
+
+    return g_err;
+}
+#endif
+
+/**
+ * Encodes the type and message body of a log entry.
+ */
+static CborError
+log_nmgr_encode_msg(CborEncoder *rsp, struct log *log,
+                    const struct log_entry_hdr *ueh, void *dptr, uint16_t len)
+{
+    uint8_t data[128];
+    CborError g_err = CborNoError;
+    CborEncoder str_encoder;
+    int off;
+    int rc;
+
+    switch (ueh->ue_etype) {
+    case LOG_ETYPE_CBOR:
+        g_err |= cbor_encode_text_stringz(rsp, "type");
+        g_err |= cbor_encode_text_stringz(rsp, "cbor");
+        break;
+    case LOG_ETYPE_BINARY:
+        g_err |= cbor_encode_text_stringz(rsp, "type");
+        g_err |= cbor_encode_text_stringz(rsp, "bin");
+        break;
+#if MYNEWT_VAL(LOG_DEFERRED)
+    case LOG_ETYPE_DEFERRED:
+#if MYNEWT_VAL(LOG_DEFERRED_HOST_FMT)
+        g_err |= cbor_encode_text_stringz(rsp, "type");
+        g_err |= cbor_encode_text_stringz(rsp, "dfr");
+        break;
+#else
+        return log_nmgr_encode_deferred(rsp, log, dptr, len);
+#endif
+#endif
+    case LOG_ETYPE_STRING:
+    default:
+        /* no need for type here */
+        g_err |= cbor_encode_text_stringz(rsp, "type");
+        g_err |= cbor_encode_text_stringz(rsp, "str");
+        break;
+    }
+
+    g_err |= cbor_encode_text_stringz(rsp, "msg");
+
+    /*
+     * Write entry data as byte string. Since this may not fit into single
+     * chunk of data we will write as indefinite-length byte string which is
+     * basically a indefinite-length container with definite-length strings
+     * inside.
+     */
+    g_err |= cbor_encoder_create_indef_byte_string(rsp, &str_encoder);
+    for (off = 0; off < len && !g_err; ) {
+        rc = log_read_body(log, dptr, data, off, sizeof(data));
+        if (rc < 0) {
+            g_err |= 1;
+            break;
+        }
+        g_err |= cbor_encode_byte_string(&str_encoder, data, rc);
+        off += rc;
+    }
+    g_err |= cbor_encoder_close_container(rsp, &str_encoder);
+
+    return g_err;
+}
+#endif
+
 /**
  * Log encode entry
  * @param log structure, log_offset, dataptr, len
@@ -67,7 +172,9 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
                       const struct log_entry_hdr *ueh, void *dptr,
                       uint16_t len)
 {
+#if MYNEWT_VAL(LOG_VERSION) < 3
     uint8_t data[128];
+#endif
     int rc;
     int rsp_len;
     CborError g_err = CborNoError;
@@ -75,32 +182,12 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
     CborEncoder rsp;
     struct CborCntWriter cnt_writer;
     CborEncoder cnt_encoder;
-#if MYNEWT_VAL(LOG_VERSION) > 2
-    CborEncoder str_encoder;
-    int off;
-#endif
     rc = OS_OK;
 
-    /* If specified timestamp is nonzero, it is the primary criterion, and the
-     * specified index is the secondary criterion.  If specified timetsamp is
-     * zero, specified index is the only criterion.
-     *
-     * If specified timestamp == 0: encode entries whose index >=
-     *     specified index.
-     * Else: encode entries whose timestamp >= specified timestamp and whose
-     *      index >= specified index
+    /* Entries outside the requested range, module and level were already
+     * skipped by the filtered walk.
      */
 
-    if (log_offset->lo_ts == 0) {
-        if (log_offset->lo_index > ueh->ue_index) {
-            goto err;
-        }
-    } else if (ueh->ue_ts < log_offset->lo_ts   ||
-               (ueh->ue_ts == log_offset->lo_ts &&
-                ueh->ue_index < log_offset->lo_index)) {
-        goto err;
-    }
-
 #if MYNEWT_VAL(LOG_VERSION) < 3
     rc = log_read_body(log, dptr, data, 0, min(len, 128));
     if (rc < 0) {
@@ -119,42 +206,7 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
     rsp_len = log_offset->lo_data_len;
     g_err |= cbor_encoder_create_map(&cnt_encoder, &rsp, CborIndefiniteLength);
 #if MYNEWT_VAL(LOG_VERSION) > 2
-    switch (ueh->ue_etype) {
-    case LOG_ETYPE_CBOR:
-        g_err |= cbor_encode_text_stringz(&rsp, "type");
-        g_err |= cbor_encode_text_stringz(&rsp, "cbor");
-        break;
-    case LOG_ETYPE_BINARY:
-        g_err |= cbor_encode_text_stringz(&rsp, "type");
-        g_err |= cbor_encode_text_stringz(&rsp, "bin");
-        break;
-    case LOG_ETYPE_STRING:
-    default:
-        /* no need for type here */
-        g_err |= cbor_encode_text_stringz(&rsp, "type");
-        g_err |= cbor_encode_text_stringz(&rsp, "str");
-        break;
-    }
-
-    g_err |= cbor_encode_text_stringz(&rsp, "msg");
-
-    /*
-     * Write entry data as byte string. Since this may not fit into single
-     * chunk of data we will write as indefinite-length byte string which is
-     * basically a indefinite-length container with definite-length strings
-     * inside.
-     */
-    g_err |= cbor_encoder_create_indef_byte_string(&rsp, &str_encoder);
-    for (off = 0; off < len && !g_err; ) {
-        rc = log_read_body(log, dptr, data, off, sizeof(data));
-        if (rc < 0) {
-            g_err |= 1;
-            break;
-        }
-        g_err |= cbor_encode_byte_string(&str_encoder, data, rc);
-        off += rc;
-    }
-    g_err |= cbor_encoder_close_container(&rsp, &str_encoder);
+    g_err |= log_nmgr_encode_msg(&rsp, log, ueh, dptr, len);
 #else
     g_err |= cbor_encode_text_stringz(&rsp, "msg");
     g_err |= cbor_encode_text_stringz(&rsp, (char *)data);
@@ -182,42 +234,7 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
 
     g_err |= cbor_encoder_create_map(ed->enc, &rsp, CborIndefiniteLength);
 #if MYNEWT_VAL(LOG_VERSION) > 2
-    switch (ueh->ue_etype) {
-    case LOG_ETYPE_CBOR:
-        g_err |= cbor_encode_text_stringz(&rsp, "type");
-        g_err |= cbor_encode_text_stringz(&rsp, "cbor");
-        break;
-    case LOG_ETYPE_BINARY:
-        g_err |= cbor_encode_text_stringz(&rsp, "type");
-        g_err |= cbor_encode_text_stringz(&rsp, "bin");
-        break;
-    case LOG_ETYPE_STRING:
-    default:
-        /* no need for type here */
-        g_err |= cbor_encode_text_stringz(&rsp, "type");
-        g_err |= cbor_encode_text_stringz(&rsp, "str");
-        break;
-    }
-
-    g_err |= cbor_encode_text_stringz(&rsp, "msg");
-
-    /*
-     * Write entry data as byte string. Since this may not fit into single
-     * chunk of data we will write as indefinite-length byte string which is
-     * basically a indefinite-length container with definite-length strings
-     * inside.
-     */
-    g_err |= cbor_encoder_create_indef_byte_string(&rsp, &str_encoder);
-    for (off = 0; off < len && !g_err; ) {
-        rc = log_read_body(log, dptr, data, off, sizeof(data));
-        if (rc < 0) {
-            g_err |= 1;
-            break;
-        }
-        g_err |= cbor_encode_byte_string(&str_encoder, data, rc);
-        off += rc;
-    }
-    g_err |= cbor_encoder_close_container(&rsp, &str_encoder);
+    g_err |= log_nmgr_encode_msg(&rsp, log, ueh, dptr, len);
 #else
     g_err |= cbor_encode_text_stringz(&rsp, "msg");
     g_err |= cbor_encode_text_stringz(&rsp, (char *)data);
@@ -244,12 +261,13 @@ err:
 
 /**
  * Log encode entries
- * @param log structure, the encoder, timestamp, index
+ * @param log structure, the encoder, timestamp, index, module / level filter
  * @return 0 on success; non-zero on failure
  */
 static int
 log_encode_entries(struct log *log, CborEncoder *cb,
-                   int64_t ts, uint32_t index)
+                   int64_t ts, uint32_t index,
+                   const struct log_filter *filter)
 {
     int rc;
     struct log_offset log_offset;
@@ -288,7 +306,14 @@ log_encode_entries(struct log *log, CborEncoder *cb,
     log_offset.lo_ts        = ts;
     log_offset.lo_data_len  = rsp_len;
 
-    rc = log_walk_body(log, log_nmgr_encode_entry, &log_offset);
+    /* If specified timestamp is nonzero, it is the primary criterion, and the
+     * specified index is the secondary criterion.  If specified timetsamp is
+     * zero, specified index is the only criterion.  The walk skips
+     * non-matching entries before they are decoded, using the backend's index
+     * where there is one.
+     */
+    rc = log_walk_body_filtered(log, log_nmgr_encode_entry, &log_offset,
+                                filter);
 
     g_err |= cbor_encoder_close_container(cb, &entries);
 
@@ -299,12 +324,12 @@ err:
 /**
  * Log encode function
  * @param log structure, the encoder, json_value,
- *        timestamp, index
+ *        timestamp, index, module / level filter
  * @return 0 on success; non-zero on failure
  */
 static int
 log_encode(struct log *log, CborEncoder *cb,
-            int64_t ts, uint32_t index)
+            int64_t ts, uint32_t index, const struct log_filter *filter)
 {
     int rc;
     CborEncoder logs;
@@ -317,7 +342,7 @@ log_encode(struct log *log, CborEncoder *cb,
     g_err |= cbor_encode_text_stringz(&logs, "type");
     g_err |= cbor_encode_uint(&logs, log->l_log->log_type);
 
-    rc = log_encode_entries(log, &logs, ts, index);
+    rc = log_encode_entries(log, &logs, ts, index, filter);
     g_err |= cbor_encoder_close_container(cb, &logs);
     if (g_err) {
         return MGMT_ERR_ENOMEM;
@@ -339,10 +364,13 @@ log_nmgr_read(struct mgmt_cbuf *cb)
     int name_len;
     int64_t ts;
     uint64_t index;
+    int64_t module;
+    uint64_t level;
+    struct log_filter filter;
     CborError g_err = CborNoError;
     CborEncoder logs;
 
-    const struct cbor_attr_t attr[4] = {
+    const struct cbor_attr_t attr[6] = {
         [0] = {
             .attribute = "log_name",
             .type = CborAttrTextStringType,
@@ -360,6 +388,17 @@ log_nmgr_read(struct mgmt_cbuf *cb)
             .addr.uinteger = &index
         },
         [3] = {
+            .attribute = "module",
+            .type = CborAttrIntegerType,
+            .addr.integer = &module,
+            .dflt.integer = -1
+        },
+        [4] = {
+            .attribute = "level",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &level
+        },
+        [5] = {
             .attribute = NULL
         }
     };
@@ -369,6 +408,12 @@ log_nmgr_read(struct mgmt_cbuf *cb)
         return rc;
     }
 
+    if (module > UINT8_MAX || level > UINT8_MAX) {
+        return MGMT_ERR_EINVAL;
+    }
+    filter.lf_module = module < 0 ? -1 : module;
+    filter.lf_level = level;
+
     g_err |= cbor_encode_text_stringz(&cb->encoder, "next_index");
     g_err |= cbor_encode_int(&cb->encoder, g_log_info.li_next_index);
 
@@ -393,7 +438,7 @@ log_nmgr_read(struct mgmt_cbuf *cb)
             continue;
         }
 
-        rc = log_encode(log, &logs, ts, index);
+        rc = log_encode(log, &logs, ts, index, &filter);
         if (rc) {
             goto err;
         }
@@ -545,6 +590,46 @@ log_nmgr_level_list(struct mgmt_cbuf *cb)
     return (0);
 }
 
+#if MYNEWT_VAL(LOG_CBOR)
+/**
+ * Newtmgr structured log key list handler
+ * @param nmgr json buffer
+ * @return 0 on success; non-zero on failure
+ */
+static int
+log_nmgr_cbor_key_list(struct mgmt_cbuf *cb)
+{
+    CborError g_err = CborNoError;
+    CborEncoder key_map;
+    const char *str;
+    int id;
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, MGMT_ERR_EOK);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "key_map");
+    g_err |= cbor_encoder_create_map(&cb->encoder, &key_map,
+                                     CborIndefiniteLength);
+
+    for (id = 1; id <= MYNEWT_VAL(LOG_CBOR_MAX_KEYS); id++) {
+        str = log_cbor_key_name(id);
+        if (!str) {
+            continue;
+        }
+
+        g_err |= cbor_encode_text_stringz(&key_map, str);
+        g_err |= cbor_encode_uint(&key_map, id);
+    }
+
+    g_err |= cbor_encoder_close_container(&cb->encoder, &key_map);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return (0);
+}
+#endif
+
 /**
  * Newtmgr log clear handler
  * @param nmgr json buffer
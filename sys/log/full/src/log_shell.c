@@ -30,6 +30,7 @@
 
 #include "cbmem/cbmem.h"
 #include "log/log.h"
+#include "log/log_deferred.h"
 #if MYNEWT_VAL(LOG_FCB_SLOT1)
 #include "log/log_fcb_slot1.h"
 #endif
@@ -43,6 +44,24 @@ shell_log_dump_entry(struct log *log, struct log_offset *log_offset,
     char data[128];
     int dlen;
     int rc;
+#if MYNEWT_VAL(LOG_DEFERRED)
+    uint8_t body[MYNEWT_VAL(LOG_DEFERRED_MAX_ENTRY_LEN)];
+
+    if (ueh->ue_etype == LOG_ETYPE_DEFERRED) {
+        rc = log_read_body(log, dptr, body, 0, min(len, sizeof(body)));
+        if (rc < 0) {
+            return rc;
+        }
+
+        rc = log_deferred_format(body, rc, data, sizeof(data));
+        if (rc < 0) {
+            data[0] = '\0';
+        }
+
+        console_printf("[%llu] %s\n", ueh->ue_ts, data);
+        return 0;
+    }
+#endif
 
     dlen = min(len, 128);
 
@@ -24,6 +24,7 @@
 #include "testutil/testutil.h"
 #include "fcb/fcb.h"
 #include "log/log.h"
+#include "log/log_fcb_lz.h"
 #include "log_test_util.h"
 
 #ifdef __cplusplus
@@ -38,6 +39,9 @@ struct os_mbuf *ltu_flat_to_fragged_mbuf(const void *flat, int len,
                                          int frag_sz);
 void ltu_setup_fcb(struct fcb_log *fcb_log, struct log *log);
 void ltu_setup_cbmem(struct cbmem *cbmem, struct log *log);
+#if MYNEWT_VAL(LOG_FCB_LZ)
+void ltu_setup_fcb_lz(struct log_fcb_lz *lz, struct log *log);
+#endif
 void ltu_verify_contents(struct log *log);
 
 TEST_SUITE_DECL(log_test_suite_cbmem_flat);
@@ -60,6 +64,11 @@ TEST_CASE_DECL(log_test_case_fcb_append_mbuf_body);
 
 TEST_SUITE_DECL(log_test_suite_misc);
 TEST_CASE_DECL(log_test_case_level);
+TEST_CASE_DECL(log_test_case_deferred);
+TEST_CASE_DECL(log_test_case_async);
+TEST_CASE_DECL(log_test_case_walk_filtered);
+TEST_CASE_DECL(log_test_case_fcb_lz);
+TEST_CASE_DECL(log_test_case_cbor);
 
 #ifdef __cplusplus
 }
@@ -49,4 +49,9 @@ TEST_SUITE(log_test_suite_fcb_mbuf)
 TEST_SUITE(log_test_suite_misc)
 {
     log_test_case_level();
+    log_test_case_deferred();
+    log_test_case_async();
+    log_test_case_walk_filtered();
+    log_test_case_fcb_lz();
+    log_test_case_cbor();
 }
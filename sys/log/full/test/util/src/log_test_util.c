@@ -97,6 +97,38 @@ ltu_setup_fcb(struct fcb_log *fcb_log, struct log *log)
     log_register("log", log, &log_fcb_handler, fcb_log, LOG_SYSLEVEL);
 }
 
+#if MYNEWT_VAL(LOG_FCB_LZ)
+void
+ltu_setup_fcb_lz(struct log_fcb_lz *lz, struct log *log)
+{
+    struct fcb *fcb;
+    int rc;
+    int i;
+
+    sysinit();
+
+    memset(lz, 0, sizeof *lz);
+
+    fcb = &lz->lz_fcb_log.fl_fcb;
+    fcb->f_sectors = fcb_areas;
+    fcb->f_sector_cnt = sizeof(fcb_areas) / sizeof(fcb_areas[0]);
+    fcb->f_magic = 0x7EADBADF;
+    fcb->f_version = 0;
+
+    for (i = 0; i < fcb->f_sector_cnt; i++) {
+        rc = flash_area_erase(&fcb_areas[i], 0, fcb_areas[i].fa_size);
+        TEST_ASSERT(rc == 0);
+    }
+    rc = fcb_init(fcb);
+    TEST_ASSERT(rc == 0);
+
+    rc = log_fcb_lz_init(lz, "log_lz");
+    TEST_ASSERT(rc == 0);
+
+    log_register("log", log, &log_fcb_lz_handler, lz, LOG_SYSLEVEL);
+}
+#endif
+
 void
 ltu_setup_cbmem(struct cbmem *cbmem, struct log *log)
 {
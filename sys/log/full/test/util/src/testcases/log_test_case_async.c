@@ -0,0 +1,122 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_ASYNC)
+
+static int
+ltu_async_count(struct log *log, struct log_offset *log_offset,
+                const struct log_entry_hdr *ueh, void *dptr, uint16_t len)
+{
+    int *cnt;
+
+    cnt = log_offset->lo_arg;
+    (*cnt)++;
+
+    return 0;
+}
+
+static int
+ltu_async_num_entries(struct log *log)
+{
+    struct log_offset log_offset = { 0 };
+    int cnt;
+    int rc;
+
+    cnt = 0;
+    log_offset.lo_arg = &cnt;
+    rc = log_walk_body(log, ltu_async_count, &log_offset);
+    TEST_ASSERT(rc == 0);
+
+    return cnt;
+}
+
+TEST_CASE(log_test_case_async)
+{
+    struct os_event *ev;
+    struct cbmem cbmem;
+    struct log log;
+    uint8_t body[100];
+    uint32_t dropped;
+    char *str;
+    int i;
+
+    ltu_setup_cbmem(&cbmem, &log);
+    log_set_async(&log, 1);
+
+    /*** Entries only reach the backend once drained. */
+    for (i = 0; ; i++) {
+        str = ltu_str_logs[i];
+        if (!str) {
+            break;
+        }
+        log_printf(&log, 0, 0, str, strlen(str));
+    }
+    TEST_ASSERT(ltu_async_num_entries(&log) == 0);
+
+    /* The drain is posted to the default event queue. */
+    ev = os_eventq_get_no_wait(os_eventq_dflt_get());
+    TEST_ASSERT_FATAL(ev != NULL);
+    ev->ev_cb(ev);
+    TEST_ASSERT(os_eventq_get_no_wait(os_eventq_dflt_get()) == NULL);
+
+    ltu_verify_contents(&log);
+
+    /*** Entries which don't fit in the ring are dropped and counted. */
+    memset(body, 0xa5, sizeof(body));
+    dropped = log_async_drop_cnt();
+    for (i = 0; i < 20; i++) {
+        log_append_body(&log, 0, 0, LOG_ETYPE_STRING, body, sizeof(body));
+    }
+    dropped = log_async_drop_cnt() - dropped;
+    TEST_ASSERT(dropped > 0 && dropped < 20);
+
+    /*** Flush is a barrier. */
+    log_async_flush();
+    TEST_ASSERT(ltu_async_num_entries(&log) == 20 - dropped);
+
+    /*** The ring wraps; nothing is dropped when drained in time. */
+    dropped = log_async_drop_cnt();
+    for (i = 0; i < 20; i++) {
+        log_append_body(&log, 0, 0, LOG_ETYPE_STRING, body, sizeof(body));
+        log_async_flush();
+    }
+    TEST_ASSERT(log_async_drop_cnt() == dropped);
+
+    /*** Synchronous writes go straight to the backend. */
+    log_flush(&log);
+    log_set_async(&log, 0);
+    log_append_body(&log, 0, 0, LOG_ETYPE_STRING, body, sizeof(body));
+    TEST_ASSERT(ltu_async_num_entries(&log) == 1);
+
+    /* Drain any leftover kicks. */
+    while ((ev = os_eventq_get_no_wait(os_eventq_dflt_get())) != NULL) {
+        ev->ev_cb(ev);
+    }
+}
+
+#else
+
+TEST_CASE(log_test_case_async)
+{
+}
+
+#endif
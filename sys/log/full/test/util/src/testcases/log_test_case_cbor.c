@@ -0,0 +1,123 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_CBOR)
+
+#include "log/log_cbor.h"
+
+static int ltu_cbor_cnt;
+
+static int
+ltu_cbor_walk(struct log *log, struct log_offset *log_offset,
+              const struct log_entry_hdr *ueh, void *dptr, uint16_t len)
+{
+    static const uint8_t expected[] = {
+        0xbf,                           /* map(*) */
+        0x01, 0x24,                     /* 1: -5 */
+        0x02, 0x62, 'a', 'b',           /* 2: "ab" */
+        0x03, 0xf5,                     /* 3: true */
+        0x04, 0x42, 0xde, 0xad,         /* 4: h'dead' */
+        0x05, 0x19, 0x01, 0x2c,         /* 5: 300 */
+        0xff,                           /* break */
+    };
+    uint8_t body[sizeof(expected)];
+    int rc;
+
+    TEST_ASSERT(ueh->ue_etype == LOG_ETYPE_CBOR);
+    TEST_ASSERT(ueh->ue_level == LOG_LEVEL_WARN);
+    TEST_ASSERT(len == sizeof(expected));
+
+    rc = log_read_body(log, dptr, body, 0, sizeof(body));
+    TEST_ASSERT(rc == sizeof(body));
+    TEST_ASSERT(memcmp(body, expected, sizeof(body)) == 0);
+
+    ltu_cbor_cnt++;
+
+    return 0;
+}
+
+TEST_CASE(log_test_case_cbor)
+{
+    static const uint8_t bytes[] = { 0xde, 0xad };
+    struct log_offset log_offset = { 0 };
+    struct log_cbor_event ev;
+    struct cbmem cbmem;
+    struct log log;
+    uint16_t id;
+    int i;
+    int rc;
+
+    /*** Key registry. */
+    TEST_ASSERT(log_cbor_key_register(1, "temp") == 1);
+    TEST_ASSERT(log_cbor_key_register(1, "dup") == 0);
+    TEST_ASSERT(log_cbor_key_register(MYNEWT_VAL(LOG_CBOR_MAX_KEYS) + 1,
+                                      "big") == 0);
+    TEST_ASSERT(strcmp(log_cbor_key_name(1), "temp") == 0);
+    TEST_ASSERT(log_cbor_key_name(0) == NULL);
+
+    id = log_cbor_key_register(0, "auto");
+    TEST_ASSERT(id == 2);
+    TEST_ASSERT(strcmp(log_cbor_key_name(id), "auto") == 0);
+    TEST_ASSERT(log_cbor_key_name(3) == NULL);
+
+    /*** Entries. */
+    ltu_setup_cbmem(&cbmem, &log);
+
+    for (i = 0; i < 2; i++) {
+        rc = log_cbor_event_start(&ev, &log, 0, LOG_LEVEL_WARN);
+        TEST_ASSERT_FATAL(rc == 0);
+        log_cbor_event_int(&ev, 1, -5);
+        log_cbor_event_str(&ev, 2, "ab");
+        log_cbor_event_bool(&ev, 3, 1);
+        log_cbor_event_bytes(&ev, 4, bytes, sizeof(bytes));
+        log_cbor_event_uint(&ev, 5, 300);
+        rc = log_cbor_event_end(&ev);
+        TEST_ASSERT(rc == 0);
+    }
+
+    /* Entries below the log level are never encoded. */
+    log_level_set(0, LOG_LEVEL_ERROR);
+    rc = log_cbor_event_start(&ev, &log, 0, LOG_LEVEL_WARN);
+    TEST_ASSERT(rc == SYS_ENOENT);
+    log_cbor_event_int(&ev, 1, 1);
+    TEST_ASSERT(log_cbor_event_end(&ev) == SYS_ENOENT);
+    log_level_set(0, 0);
+
+    /* Aborted entries are not written. */
+    rc = log_cbor_event_start(&ev, &log, 0, LOG_LEVEL_WARN);
+    TEST_ASSERT_FATAL(rc == 0);
+    log_cbor_event_int(&ev, 1, 1);
+    log_cbor_event_abort(&ev);
+
+    ltu_cbor_cnt = 0;
+    rc = log_walk_body(&log, ltu_cbor_walk, &log_offset);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ltu_cbor_cnt == 2);
+}
+
+#else
+
+TEST_CASE(log_test_case_cbor)
+{
+}
+
+#endif
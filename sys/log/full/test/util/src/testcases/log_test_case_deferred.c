@@ -0,0 +1,205 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_DEFERRED)
+
+#include "log/log_deferred.h"
+
+static int ltu_deferred_idx;
+
+static void
+ltu_deferred_expect(char *dst, int dst_len, const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(dst, dst_len, fmt, args);
+    va_end(args);
+}
+
+static int
+ltu_deferred_walk(struct log *log, struct log_offset *log_offset,
+                  const struct log_entry_hdr *ueh, void *dptr, uint16_t len)
+{
+    char (*expected)[LOG_PRINTF_MAX_ENTRY_LEN];
+    uint8_t body[MYNEWT_VAL(LOG_DEFERRED_MAX_ENTRY_LEN)];
+    char text[LOG_PRINTF_MAX_ENTRY_LEN];
+    int rc;
+
+    expected = log_offset->lo_arg;
+
+    TEST_ASSERT(ueh->ue_etype == LOG_ETYPE_DEFERRED);
+    TEST_ASSERT(len <= sizeof(body));
+
+    rc = log_read_body(log, dptr, body, 0, len);
+    TEST_ASSERT(rc == len);
+
+    rc = log_deferred_format(body, len, text, sizeof(text));
+    TEST_ASSERT(rc == strlen(expected[ltu_deferred_idx]));
+    TEST_ASSERT(strcmp(text, expected[ltu_deferred_idx]) == 0);
+
+    ltu_deferred_idx++;
+
+    return 0;
+}
+
+static int
+ltu_deferred_pack(void *buf, int buf_len, const char *fmt, ...)
+{
+    va_list args;
+    int rc;
+
+    va_start(args, fmt);
+    rc = log_deferred_vpack(buf, buf_len, fmt, args);
+    va_end(args);
+
+    return rc;
+}
+
+TEST_CASE(log_test_case_deferred)
+{
+    char expected[6][LOG_PRINTF_MAX_ENTRY_LEN];
+    struct log_offset log_offset = { 0 };
+    struct log_deferred_hdr hdr;
+    struct cbmem cbmem;
+    struct log log;
+    uint8_t body[sizeof(hdr) + 6];
+    char text[LOG_PRINTF_MAX_ENTRY_LEN];
+    const char *fmt;
+    int rc;
+
+    ltu_setup_cbmem(&cbmem, &log);
+
+    log_printf_deferred(&log, 0, 0, "plain");
+    ltu_deferred_expect(expected[0], sizeof(expected[0]), "plain");
+
+    log_printf_deferred(&log, 0, 0, "%d %u %x %c", -5, 7u, 0xbeef, 'z');
+    ltu_deferred_expect(expected[1], sizeof(expected[1]),
+                        "%d %u %x %c", -5, 7u, 0xbeef, 'z');
+
+    log_printf_deferred(&log, 0, 0, "%ld %lld %zu 100%%", -70000L,
+                        1234567890123LL, (size_t)42);
+    ltu_deferred_expect(expected[2], sizeof(expected[2]),
+                        "%ld %lld %zu 100%%", -70000L, 1234567890123LL,
+                        (size_t)42);
+
+    log_printf_deferred(&log, 0, 0, "[%s] [%-6s] [%.2s]", "abc", "de",
+                        "fghij");
+    ltu_deferred_expect(expected[3], sizeof(expected[3]),
+                        "[%s] [%-6s] [%.2s]", "abc", "de", "fghij");
+
+    log_printf_deferred(&log, 0, 0, "%*d|%-*.*s|", 5, 42, 4, 2, "xyz");
+    ltu_deferred_expect(expected[4], sizeof(expected[4]),
+                        "%*d|%-*.*s|", 5, 42, 4, 2, "xyz");
+
+    log_printf_deferred(&log, 0, 0, "%p %s", (void *)&log, (char *)NULL);
+    ltu_deferred_expect(expected[5], sizeof(expected[5]),
+                        "%p %s", (void *)&log, "(null)");
+
+    /* Entries below the log level are dropped before packing. */
+    log_level_set(0, LOG_LEVEL_WARN);
+    log_printf_deferred(&log, 0, LOG_LEVEL_INFO, "dropped %d", 1);
+    log_level_set(0, 0);
+
+    log_offset.lo_arg = expected;
+    ltu_deferred_idx = 0;
+    rc = log_walk_body(&log, ltu_deferred_walk, &log_offset);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ltu_deferred_idx == 6);
+
+    /*** Arguments which don't fit are dropped; formatting stops there. */
+    rc = ltu_deferred_pack(body, sizeof(body), LOG_DEFERRED_FMT("a=%d b=%d"),
+                           1, 2);
+    TEST_ASSERT(rc == sizeof(hdr) + sizeof(int));
+
+    rc = log_deferred_format(body, rc, text, sizeof(text));
+    TEST_ASSERT(strcmp(text, "a=1 b=") == 0);
+
+    rc = ltu_deferred_pack(body, sizeof(body), LOG_DEFERRED_FMT("%s!"),
+                           "truncated");
+    TEST_ASSERT(rc == sizeof(body));
+
+    rc = log_deferred_format(body, rc, text, sizeof(text));
+    TEST_ASSERT(strcmp(text, "trunc!") == 0);
+
+    /*** Output is truncated to the destination buffer. */
+    rc = log_deferred_format(body, sizeof(body), text, 4);
+    TEST_ASSERT(rc == 3);
+    TEST_ASSERT(strcmp(text, "tru") == 0);
+
+    /*** An unknown format string produces a placeholder. */
+    memcpy(&hdr, body, sizeof(hdr));
+    TEST_ASSERT(hdr.ldh_fmt_hash == log_deferred_hash("%s!"));
+    hdr.ldh_fmt_hash++;
+    memcpy(body, &hdr, sizeof(hdr));
+
+    rc = log_deferred_format(body, sizeof(body), text, sizeof(text));
+    TEST_ASSERT(rc > 0);
+    TEST_ASSERT(strncmp(text, "<fmt 0x", 7) == 0);
+
+    /*** Entries whose address is not in the format table, e.g. written by
+     * another image, are matched by hash.  The address is never
+     * dereferenced.
+     */
+    hdr.ldh_fmt = 1;
+    hdr.ldh_fmt_hash = log_deferred_hash("%s!");
+    memcpy(body, &hdr, sizeof(hdr));
+
+    rc = log_deferred_format(body, sizeof(body), text, sizeof(text));
+    TEST_ASSERT(strcmp(text, "trunc!") == 0);
+
+    /*** Format strings are in the table whether packed or not. */
+    fmt = LOG_DEFERRED_FMT("never packed %s");
+    hdr.ldh_fmt_hash = log_deferred_hash(fmt);
+    memcpy(body, &hdr, sizeof(hdr));
+
+    rc = log_deferred_format(body, sizeof(body), text, sizeof(text));
+    TEST_ASSERT(strcmp(text, "never packed trunc") == 0);
+
+    /*** Strings sharing a hash are only matched by address. */
+    fmt = LOG_DEFERRED_FMT("liquid");
+    TEST_ASSERT_FATAL(log_deferred_hash(fmt) ==
+                      log_deferred_hash(LOG_DEFERRED_FMT("costarring")));
+
+    rc = ltu_deferred_pack(body, sizeof(body), fmt);
+    TEST_ASSERT_FATAL(rc == sizeof(hdr));
+    rc = log_deferred_format(body, sizeof(hdr), text, sizeof(text));
+    TEST_ASSERT(strcmp(text, "liquid") == 0);
+
+    memcpy(&hdr, body, sizeof(hdr));
+    hdr.ldh_fmt = 1;
+    memcpy(body, &hdr, sizeof(hdr));
+    rc = log_deferred_format(body, sizeof(hdr), text, sizeof(text));
+    TEST_ASSERT(strncmp(text, "<fmt 0x", 7) == 0);
+
+    rc = log_deferred_format(body, sizeof(hdr) - 1, text, sizeof(text));
+    TEST_ASSERT(rc == SYS_EINVAL);
+}
+
+#else
+
+TEST_CASE(log_test_case_deferred)
+{
+}
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+/* Sectors smaller than an incompressible batch. */
+static struct flash_area ltcfl_small_areas[] = {
+    [0] = {
+        .fa_off = 0x00000000,
+        .fa_size = 256
+    },
+    [1] = {
+        .fa_off = 0x00004000,
+        .fa_size = 256
+    }
+};
+
+static void
+ltcfl_append_strs(struct log *log)
+{
+    uint8_t buf[256];
+    char *str;
+    int body_len;
+    int i;
+
+    for (i = 0; ; i++) {
+        str = ltu_str_logs[i];
+        if (!str) {
+            break;
+        }
+
+        body_len = strlen(str);
+        memcpy(buf + LOG_ENTRY_HDR_SIZE, str, body_len);
+        log_append_typed(log, 0, 0, LOG_ETYPE_STRING, buf, body_len);
+    }
+}
+
+static int
+ltcfl_walk_count(struct log *log, struct log_offset *log_offset,
+                 const struct log_entry_hdr *hdr, void *dptr, uint16_t len)
+{
+    char expected[32];
+    char body[32];
+    int *count;
+    int rc;
+
+    count = log_offset->lo_arg;
+
+    snprintf(expected, sizeof expected, "sensor %d value %d", *count % 4,
+             *count * 3);
+    TEST_ASSERT_FATAL(len == strlen(expected));
+    rc = log_read_body(log, dptr, body, 0, len);
+    TEST_ASSERT_FATAL(rc == len);
+    TEST_ASSERT(memcmp(body, expected, len) == 0);
+
+    (*count)++;
+
+    return 0;
+}
+
+TEST_CASE(log_test_case_fcb_lz)
+{
+    static struct log_fcb_lz lz;
+    struct log_offset lo = { 0 };
+#if MYNEWT_VAL(LOG_FCB_LZ_COMMIT_TIMEOUT_MS) > 0
+    struct os_event *ev;
+    uint32_t batches;
+#endif
+    uint8_t body[300];
+    struct fcb *fcb;
+    struct log log;
+    uint32_t seed;
+    int count;
+    int rc;
+    int i;
+
+    ltu_setup_fcb_lz(&lz, &log);
+
+    /* Entries still in the RAM batch. */
+    ltcfl_append_strs(&log);
+    ltu_verify_contents(&log);
+
+    /* Entries written to flash. */
+    ltcfl_append_strs(&log);
+    rc = log_fcb_lz_commit(&log);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(lz.lz_batch_len == 0);
+    ltu_verify_contents(&log);
+
+    /* Enough entries to span several batches; repetitive text must
+     * compress.
+     */
+    for (i = 0; i < 100; i++) {
+        log_printf(&log, 0, 0, "sensor %d value %d", i % 4, i * 3);
+    }
+    TEST_ASSERT(STATS_GET(lz.lz_stats, batches) > 2);
+    TEST_ASSERT(STATS_GET(lz.lz_stats, stored_bytes) <
+                STATS_GET(lz.lz_stats, raw_bytes));
+    TEST_ASSERT(STATS_GET(lz.lz_stats, corrupt) == 0);
+
+    count = 0;
+    lo.lo_arg = &count;
+    rc = log_walk_body(&log, ltcfl_walk_count, &lo);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(count == 100);
+    TEST_ASSERT(STATS_GET(lz.lz_stats, corrupt) == 0);
+
+    /* Entries larger than a batch are rejected. */
+    rc = log_append_body(&log, 0, 0, LOG_ETYPE_STRING, lz.lz_decode,
+                         LOG_FCB_LZ_BATCH_SIZE);
+    TEST_ASSERT(rc != 0);
+    TEST_ASSERT(STATS_GET(lz.lz_stats, too_big) == 1);
+
+    /* A batch which can't fit in a sector is dropped, not retried. */
+    rc = log_fcb_lz_commit(&log);
+    TEST_ASSERT(rc == 0);
+
+    fcb = &lz.lz_fcb_log.fl_fcb;
+    fcb->f_sectors = ltcfl_small_areas;
+    fcb->f_sector_cnt = 2;
+    for (i = 0; i < fcb->f_sector_cnt; i++) {
+        rc = flash_area_erase(&ltcfl_small_areas[i], 0,
+                              ltcfl_small_areas[i].fa_size);
+        TEST_ASSERT(rc == 0);
+    }
+    rc = fcb_init(fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Incompressible, so it's stored raw. */
+    seed = 1;
+    for (i = 0; i < sizeof body; i++) {
+        seed = seed * 1103515245 + 12345;
+        body[i] = seed >> 16;
+    }
+    rc = log_append_body(&log, 0, 0, LOG_ETYPE_STRING, body, sizeof body);
+    TEST_ASSERT(rc == 0);
+    rc = log_fcb_lz_commit(&log);
+    TEST_ASSERT(rc != 0);
+    TEST_ASSERT(lz.lz_batch_len == 0);
+    TEST_ASSERT(STATS_GET(lz.lz_stats, batches_dropped) == 1);
+
+    /* Later batches still get written. */
+    log_printf(&log, 0, 0, "after drop");
+    rc = log_fcb_lz_commit(&log);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(STATS_GET(lz.lz_stats, batches_dropped) == 1);
+
+#if MYNEWT_VAL(LOG_FCB_LZ_COMMIT_TIMEOUT_MS) > 0
+    /* A partial batch is written once its commit timeout expires. */
+    batches = STATS_GET(lz.lz_stats, batches);
+    log_printf(&log, 0, 0, "partial");
+    TEST_ASSERT(lz.lz_batch_len != 0);
+
+    os_time_advance(
+        os_time_ms_to_ticks32(MYNEWT_VAL(LOG_FCB_LZ_COMMIT_TIMEOUT_MS)));
+    while ((ev = os_eventq_get_no_wait(os_eventq_dflt_get())) != NULL) {
+        ev->ev_cb(ev);
+    }
+    TEST_ASSERT(lz.lz_batch_len == 0);
+    TEST_ASSERT(STATS_GET(lz.lz_stats, batches) == batches + 1);
+#endif
+}
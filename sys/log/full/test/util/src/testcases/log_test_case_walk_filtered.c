@@ -0,0 +1,194 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#define LTCWF_NUM_ENTRIES   300
+
+struct ltcwf_arg {
+    int count;
+    uint32_t first_index;
+    uint8_t min_level;
+    int bad_module;
+};
+
+static int
+ltcwf_walk(struct log *log, struct log_offset *log_offset,
+           const struct log_entry_hdr *hdr, void *dptr, uint16_t len)
+{
+    struct ltcwf_arg *arg;
+
+    arg = log_offset->lo_arg;
+    if (arg->count == 0) {
+        arg->first_index = hdr->ue_index;
+    }
+    if (hdr->ue_level < arg->min_level) {
+        arg->min_level = hdr->ue_level;
+    }
+    if (hdr->ue_module != 1) {
+        arg->bad_module = 1;
+    }
+    arg->count++;
+
+    return 0;
+}
+
+static int
+ltcwf_walk_stop(struct log *log, struct log_offset *log_offset,
+                const struct log_entry_hdr *hdr, void *dptr, uint16_t len)
+{
+    int *count;
+
+    count = log_offset->lo_arg;
+    (*count)++;
+
+    return SYS_EIO;
+}
+
+static struct ltcwf_arg
+ltcwf_walk_count(struct log *log, uint32_t index,
+                 const struct log_filter *filter)
+{
+    struct log_offset lo = { 0 };
+    struct ltcwf_arg arg = { 0 };
+    int rc;
+
+    arg.min_level = UINT8_MAX;
+
+    lo.lo_arg = &arg;
+    lo.lo_index = index;
+    rc = log_walk_body_filtered(log, ltcwf_walk, &lo, filter);
+    TEST_ASSERT(rc == 0);
+
+    return arg;
+}
+
+/**
+ * Writes entries with alternating modules 0 and 1; returns their indices.
+ */
+static void
+ltcwf_fill(struct log *log, uint32_t *indices, int num_entries,
+           uint8_t level)
+{
+    int i;
+
+    for (i = 0; i < num_entries; i++) {
+        indices[i] = g_log_info.li_next_index;
+        log_printf(log, i % 2, level,
+                   "entry %d; padding padding padding padding padding", i);
+    }
+}
+
+TEST_CASE(log_test_case_walk_filtered)
+{
+    static uint32_t indices[LTCWF_NUM_ENTRIES];
+    struct log_fcb_index fcb_idx[2];
+    struct log_cbmem_index cbmem_idx;
+    struct log_offset lo = { 0 };
+    struct log_filter filter;
+    struct ltcwf_arg arg;
+    struct fcb_log fcb_log;
+    struct cbmem cbmem;
+    struct log log;
+    int count;
+    int rc;
+
+    /*** cbmem: resume from the remembered position. */
+
+    ltu_setup_cbmem(&cbmem, &log);
+    log_level_set(0, 0);
+    log_level_set(1, 0);
+    rc = log_cbmem_index_init(&log, &cbmem_idx);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ltcwf_fill(&log, indices, 20, LOG_LEVEL_INFO);
+
+    filter.lf_module = 1;
+    filter.lf_level = LOG_LEVEL_INFO;
+    arg = ltcwf_walk_count(&log, indices[10], &filter);
+    TEST_ASSERT(arg.count == 5);
+    TEST_ASSERT(arg.first_index == indices[11]);
+    TEST_ASSERT(!arg.bad_module);
+    TEST_ASSERT(cbmem_idx.lci_index == indices[19]);
+
+    /* A later read starts at the last visited entry. */
+    ltcwf_fill(&log, indices, 4, LOG_LEVEL_INFO);
+    arg = ltcwf_walk_count(&log, cbmem_idx.lci_index + 1, &filter);
+    TEST_ASSERT(arg.count == 2);
+    TEST_ASSERT(arg.first_index == indices[1]);
+
+    /* An earlier read falls back to a full walk. */
+    arg = ltcwf_walk_count(&log, 0, &filter);
+    TEST_ASSERT(arg.count == 12);
+
+    /* Nothing passes the level filter. */
+    filter.lf_level = LOG_LEVEL_ERROR;
+    arg = ltcwf_walk_count(&log, 0, &filter);
+    TEST_ASSERT(arg.count == 0);
+
+    /* An error from the callback ends the walk and is returned. */
+    count = 0;
+    lo.lo_arg = &count;
+    rc = log_walk_body_filtered(&log, ltcwf_walk_stop, &lo, NULL);
+    TEST_ASSERT(rc == SYS_EIO);
+    TEST_ASSERT(count == 1);
+
+    /*** FCB: skip sectors using the sparse index. */
+
+    ltu_setup_fcb(&fcb_log, &log);
+    rc = log_fcb_index_init(&log, fcb_idx, 1);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    rc = log_fcb_index_init(&log, fcb_idx, 2);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Debug entries fill the first sector; errors go to the second. */
+    ltcwf_fill(&log, indices, LTCWF_NUM_ENTRIES, LOG_LEVEL_DEBUG);
+    TEST_ASSERT_FATAL(fcb_idx[0].lfi_entries > 0);
+    TEST_ASSERT_FATAL(fcb_idx[1].lfi_entries > 0);
+    TEST_ASSERT(fcb_idx[0].lfi_max_level == LOG_LEVEL_DEBUG);
+    ltcwf_fill(&log, indices, 10, LOG_LEVEL_ERROR);
+    TEST_ASSERT(fcb_idx[1].lfi_max_level == LOG_LEVEL_ERROR);
+    TEST_ASSERT(fcb_idx[1].lfi_max_index == indices[9]);
+
+    filter.lf_module = 1;
+    filter.lf_level = LOG_LEVEL_ERROR;
+    arg = ltcwf_walk_count(&log, 0, &filter);
+    TEST_ASSERT(arg.count == 5);
+    TEST_ASSERT(arg.first_index == indices[1]);
+    TEST_ASSERT(arg.min_level == LOG_LEVEL_ERROR);
+
+    filter.lf_module = 1;
+    filter.lf_level = LOG_LEVEL_DEBUG;
+    arg = ltcwf_walk_count(&log, indices[6], &filter);
+    TEST_ASSERT(arg.count == 2);
+    TEST_ASSERT(arg.first_index == indices[7]);
+
+    /* Rebuilding the index from flash yields the same summary. */
+    memcpy(&fcb_idx[1], &fcb_idx[0], sizeof fcb_idx[0]);
+    rc = log_fcb_index_init(&log, fcb_idx, 2);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(fcb_idx[1].lfi_max_level == LOG_LEVEL_ERROR);
+    TEST_ASSERT(fcb_idx[1].lfi_max_index == indices[9]);
+
+    /* Flushing clears the index. */
+    rc = log_flush(&log);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fcb_idx[0].lfi_entries == 0);
+    TEST_ASSERT(fcb_idx[1].lfi_entries == 0);
+}
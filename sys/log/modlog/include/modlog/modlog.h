@@ -37,9 +37,15 @@
  *       optional set of default logs.
  *     o Minimum log level per mapping.  Writes specifying a log level less
  *       than the module's minimum level are discarded.
+ *     o Log storm protection (optional).  Writes can be rate limited per
+ *       module (`modlog_set_rate()`) and per call site (`MODLOG_RATE()`),
+ *       and consecutive identical entries can be collapsed into a single
+ *       "last message repeated N times" entry.  Dropped entries are counted
+ *       in the "modlog" statistics.
  *
  * Costs of using modlog rather than the bare `sys/log` facility are:
- *     o Increased RAM usage (`MODLOG_MAX_MAPPINGS` * 12).
+ *     o Increased RAM usage (`MODLOG_MAX_MAPPINGS` * 12, plus 128 bytes for
+ *       the per-module level filter).
  *     o Increased CPU usage - each log write requires a lookup in the set
  *       of configured modlog mappings.
  */
@@ -49,9 +55,18 @@
 
 #include "os/mynewt.h"
 #include "log/log.h"
+#if MYNEWT_VAL(LOG_FULL)
+#include "log/log_deferred.h"
+#endif
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT) || MYNEWT_VAL(MODLOG_DUP_SUPPRESS)
+#include "stats/stats.h"
+#endif
 
 #define MODLOG_MODULE_DFLT      255
 
+/** Level filter value of a module that no mapping accepts writes for. */
+#define MODLOG_FILTER_NONE      0x0f
+
 /**
  * @brief Modlog mapping descriptor.
  *
@@ -84,6 +99,51 @@ struct modlog_desc {
  */
 typedef int modlog_foreach_fn(const struct modlog_desc *desc, void *arg);
 
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT) || MYNEWT_VAL(MODLOG_DUP_SUPPRESS)
+STATS_SECT_START(modlog_stats)
+    /* Writes dropped by a module or call site rate limit. */
+    STATS_SECT_ENTRY(rate_drops)
+    /* Writes collapsed into a "repeated" entry. */
+    STATS_SECT_ENTRY(dup_drops)
+    /* "repeated" entries written. */
+    STATS_SECT_ENTRY(dup_summaries)
+STATS_SECT_END
+
+extern STATS_SECT_DECL(modlog_stats) modlog_stats;
+#endif
+
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT) || defined(__DOXYGEN__)
+/**
+ * @brief Token bucket limiting the rate of log writes.
+ *
+ * Credit is kept in units of 1/OS_TICKS_PER_SEC token, so that slow rates
+ * don't lose fractional tokens to rounding.  Initialize with
+ * `MODLOG_RATE_INIT()`.
+ */
+struct modlog_rate {
+    /** Time of the last refill. */
+    os_time_t mr_last;
+
+    /** Available credit; one write costs OS_TICKS_PER_SEC. */
+    uint32_t mr_credit;
+
+    /** Sustained rate, in writes per second. */
+    uint16_t mr_rate;
+
+    /** Maximum number of writes in a burst. */
+    uint16_t mr_burst;
+
+    /** Number of writes dropped by this bucket. */
+    uint32_t mr_drops;
+};
+
+#define MODLOG_RATE_INIT(rate_, burst_) {                       \
+    .mr_credit = (uint32_t)(burst_) * OS_TICKS_PER_SEC,          \
+    .mr_rate = (rate_),                                          \
+    .mr_burst = (burst_),                                        \
+}
+#endif
+
 /* Only enable modlog if logging is also enabled. */
 #if MYNEWT_VAL(LOG_FULL) || defined(__DOXYGEN__)
 
@@ -188,6 +248,104 @@ int modlog_foreach(modlog_foreach_fn *fn, void *arg);
  */
 void modlog_printf(uint8_t module, uint8_t level, const char *msg, ...);
 
+/* Private; two modules per nibble.  Use modlog_level_enabled(). */
+extern uint8_t modlog_level_filter[];
+
+/**
+ * @brief Indicates whether a write to the specified module and level would be
+ * accepted by at least one mapped log.
+ *
+ * The check reads a per-module filter without taking the modlog lock.  The
+ * `MODLOG_[...]` macros call it before evaluating their arguments, so a
+ * filtered out write costs a couple of loads and compares.
+ *
+ * @param module                The log module to check.
+ * @param level                 The severity of the entry.
+ *
+ * @return                      true if the write may be accepted;
+ *                              false if it would be discarded.
+ */
+static inline bool
+modlog_level_enabled(uint8_t module, uint8_t level)
+{
+    uint8_t byte;
+    uint8_t min_level;
+
+    byte = modlog_level_filter[module / 2];
+    if (module % 2 == 0) {
+        min_level = byte & 0x0f;
+    } else {
+        min_level = byte >> 4;
+    }
+
+    return level >= min_level && level >= log_level_get(module);
+}
+
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT) || defined(__DOXYGEN__)
+/**
+ * @brief Takes a token from a rate limiting bucket.
+ *
+ * @param mr                    The bucket to take from.
+ *
+ * @return                      true if the write may proceed;
+ *                              false if it should be dropped.
+ */
+bool modlog_rate_take(struct modlog_rate *mr);
+
+/**
+ * @brief Limits the rate of writes to the specified module.
+ *
+ * Writes exceeding the limit are dropped before they reach any mapped log.
+ *
+ * @param module                The log module to limit.
+ * @param rate                  Sustained rate, in writes per second; 0 to
+ *                                  remove the module's limit.
+ * @param burst                 Maximum number of writes in a burst; at
+ *                                  least 1.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if the burst is 0;
+ *                              SYS_ENOMEM if `MODLOG_RATE_MAX_MODULES`
+ *                                  modules are already limited.
+ */
+int modlog_set_rate(uint8_t module, uint16_t rate, uint16_t burst);
+#endif
+
+#if MYNEWT_VAL(MODLOG_DUP_SUPPRESS) || defined(__DOXYGEN__)
+/**
+ * @brief Writes the pending "last message repeated N times" entry, if any.
+ *
+ * The entry is normally written when a different entry arrives, or after
+ * `MODLOG_DUP_MAX_MS` of repeats.  Call this to report the tail of a storm
+ * without waiting, e.g. before reading the logs.
+ */
+void modlog_dup_flush(void);
+#endif
+
+#if MYNEWT_VAL(LOG_DEFERRED) || defined(__DOXYGEN__)
+/**
+ * @brief Writes a deferred (binary) entry to the specified log module.
+ *
+ * The format string is stored by reference and the arguments are stored raw;
+ * the entry is only formatted when it is read.  See `log_printf_deferred()`.
+ *
+ * @param module                The log module to write to.
+ * @param level                 The severity of the log entry to write.
+ * @param fmt                   The "printf" format string; must be a
+ *                                  string literal.
+ */
+#define modlog_printf_deferred(module_, level_, fmt_, ...)                 \
+    modlog_deferred_printf((module_), (level_), LOG_DEFERRED_FMT(fmt_),     \
+                           ##__VA_ARGS__)
+
+/**
+ * @brief Writes a deferred entry with a format string from
+ * LOG_DEFERRED_FMT(); see modlog_printf_deferred().
+ */
+void modlog_deferred_printf(uint8_t module, uint8_t level, const char *fmt,
+                            ...);
+#endif
+
 #else /* LOG_FULL */
 
 static inline int
@@ -238,6 +396,38 @@ static inline void
 modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
 { }
 
+static inline bool
+modlog_level_enabled(uint8_t module, uint8_t level)
+{
+    return false;
+}
+
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+static inline bool
+modlog_rate_take(struct modlog_rate *mr)
+{
+    return false;
+}
+
+static inline int
+modlog_set_rate(uint8_t module, uint16_t rate, uint16_t burst)
+{
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(MODLOG_DUP_SUPPRESS)
+static inline void
+modlog_dup_flush(void)
+{ }
+#endif
+
+#endif
+
+#if MYNEWT_VAL(MODLOG_DEFERRED)
+#define MODLOG_PRINTF_     modlog_printf_deferred
+#else
+#define MODLOG_PRINTF_     modlog_printf
 #endif
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_DEBUG || defined __DOXYGEN__
@@ -250,8 +440,10 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
  * @param ml_mod_               The log module to write to.
  * @param ml_msg_               The "printf" formatted string to write.
  */
-#define MODLOG_DEBUG(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_DEBUG, (ml_msg_), ##__VA_ARGS__)
+#define MODLOG_DEBUG(ml_mod_, ml_msg_, ...)                                 \
+    (modlog_level_enabled((ml_mod_), LOG_LEVEL_DEBUG) ?                     \
+     MODLOG_PRINTF_((ml_mod_), LOG_LEVEL_DEBUG, (ml_msg_), ##__VA_ARGS__) : \
+     (void)0)
 #else
 #define MODLOG_DEBUG(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -266,8 +458,10 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
  * @param ml_mod_               The log module to write to.
  * @param ml_msg_               The "printf" formatted string to write.
  */
-#define MODLOG_INFO(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_INFO, (ml_msg_), ##__VA_ARGS__)
+#define MODLOG_INFO(ml_mod_, ml_msg_, ...)                                  \
+    (modlog_level_enabled((ml_mod_), LOG_LEVEL_INFO) ?                      \
+     MODLOG_PRINTF_((ml_mod_), LOG_LEVEL_INFO, (ml_msg_), ##__VA_ARGS__) :  \
+     (void)0)
 #else
 #define MODLOG_INFO(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -282,8 +476,10 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
  * @param ml_mod_               The log module to write to.
  * @param ml_msg_               The "printf" formatted string to write.
  */
-#define MODLOG_WARN(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_WARN, (ml_msg_), ##__VA_ARGS__)
+#define MODLOG_WARN(ml_mod_, ml_msg_, ...)                                  \
+    (modlog_level_enabled((ml_mod_), LOG_LEVEL_WARN) ?                      \
+     MODLOG_PRINTF_((ml_mod_), LOG_LEVEL_WARN, (ml_msg_), ##__VA_ARGS__) :  \
+     (void)0)
 #else
 #define MODLOG_WARN(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -298,8 +494,10 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
  * @param ml_mod_               The log module to write to.
  * @param ml_msg_               The "printf" formatted string to write.
  */
-#define MODLOG_ERROR(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_ERROR, (ml_msg_), ##__VA_ARGS__)
+#define MODLOG_ERROR(ml_mod_, ml_msg_, ...)                                 \
+    (modlog_level_enabled((ml_mod_), LOG_LEVEL_ERROR) ?                     \
+     MODLOG_PRINTF_((ml_mod_), LOG_LEVEL_ERROR, (ml_msg_), ##__VA_ARGS__) : \
+     (void)0)
 #else
 #define MODLOG_ERROR(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -314,8 +512,10 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
  * @param ml_mod_               The log module to write to.
  * @param ml_msg_               The "printf" formatted string to write.
  */
-#define MODLOG_CRITICAL(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_CRITICAL, (ml_msg_), ##__VA_ARGS__)
+#define MODLOG_CRITICAL(ml_mod_, ml_msg_, ...)                              \
+    (modlog_level_enabled((ml_mod_), LOG_LEVEL_CRITICAL) ?                  \
+     MODLOG_PRINTF_((ml_mod_), LOG_LEVEL_CRITICAL, (ml_msg_), ##__VA_ARGS__) : \
+     (void)0)
 #else
 #define MODLOG_CRITICAL(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -359,6 +559,35 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
 #define MODLOG_DFLT(ml_lvl_, ...) \
     MODLOG(ml_lvl_, LOG_MODULE_DEFAULT, __VA_ARGS__)
 
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT) || defined __DOXYGEN__
+/**
+ * @brief Writes a formatted text entry, limiting the rate at which this call
+ * site can write.
+ *
+ * Each expansion has its own token bucket.  Writes filtered out by level
+ * don't consume tokens, and dropped writes don't evaluate their arguments.
+ *
+ * @param ml_lvl_               The log level of the entry to write; see
+ *                                  `MODLOG()`.
+ * @param ml_mod_               The log module to write to.
+ * @param ml_rate_              Sustained rate, in writes per second.
+ * @param ml_burst_             Maximum number of writes in a burst.
+ */
+#define MODLOG_RATE(ml_lvl_, ml_mod_, ml_rate_, ml_burst_, ...)             \
+    do {                                                                    \
+        static struct modlog_rate ml_rl_ =                                  \
+            MODLOG_RATE_INIT((ml_rate_), (ml_burst_));                      \
+                                                                            \
+        if (modlog_level_enabled((ml_mod_), LOG_LEVEL_ ## ml_lvl_) &&       \
+            modlog_rate_take(&ml_rl_)) {                                    \
+            MODLOG_ ## ml_lvl_((ml_mod_), __VA_ARGS__);                     \
+        }                                                                   \
+    } while (0)
+#else
+#define MODLOG_RATE(ml_lvl_, ml_mod_, ml_rate_, ml_burst_, ...) \
+    MODLOG(ml_lvl_, (ml_mod_), __VA_ARGS__)
+#endif
+
 /* If `MODLOG_LOG_MACROS` in enabled, retire the old `LOG_[...]` macros and
  * redefine them to use modlog.
  */
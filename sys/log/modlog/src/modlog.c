@@ -18,6 +18,8 @@
  */
 
 #include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
 #include "os/mynewt.h"
 #include "rwlock/rwlock.h"
 #include "log/log.h"
@@ -51,6 +53,57 @@ static struct modlog_list modlog_mappings =
  */
 static struct modlog_mapping *modlog_first_dflt;
 
+/**
+ * Lowest level accepted by any mapping that a write to each module would go
+ * to.  Two modules per byte, one per nibble.  Rebuilt whenever the mapping
+ * list changes; read without locking by modlog_level_enabled().
+ */
+uint8_t modlog_level_filter[(LOG_MODULE_MAX + 1) / 2];
+
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT) || MYNEWT_VAL(MODLOG_DUP_SUPPRESS)
+STATS_SECT_DECL(modlog_stats) modlog_stats;
+STATS_NAME_START(modlog_stats)
+    STATS_NAME(modlog_stats, rate_drops)
+    STATS_NAME(modlog_stats, dup_drops)
+    STATS_NAME(modlog_stats, dup_summaries)
+STATS_NAME_END(modlog_stats)
+#endif
+
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+struct modlog_module_rate {
+    struct modlog_rate rate;
+    uint8_t module;
+};
+
+/** Modules with a rate limit; the first `modlog_num_rates` are in use. */
+static struct modlog_module_rate
+    modlog_rates[MYNEWT_VAL(MODLOG_RATE_MAX_MODULES)];
+static uint8_t modlog_num_rates;
+#endif
+
+#if MYNEWT_VAL(MODLOG_DUP_SUPPRESS)
+#define MODLOG_DUP_FNV_BASIS        2166136261UL
+#define MODLOG_DUP_FNV_PRIME        16777619UL
+
+#define MODLOG_DUP_MAX_TICKS    \
+    ((uint32_t)MYNEWT_VAL(MODLOG_DUP_MAX_MS) * OS_TICKS_PER_SEC / 1000)
+
+/** The last entry written, and how many times it was repeated since. */
+struct modlog_dup {
+    /** Time of the first repeat since the last summary. */
+    os_time_t md_first;
+    uint32_t md_hash;
+    uint32_t md_count;
+    uint16_t md_len;
+    uint8_t md_module;
+    uint8_t md_level;
+    uint8_t md_etype;
+    uint8_t md_valid;
+};
+
+static struct modlog_dup modlog_dup;
+#endif
+
 static struct modlog_mapping *
 modlog_alloc(void)
 {
@@ -168,6 +221,75 @@ modlog_remove(struct modlog_mapping *mm, struct modlog_mapping *prev)
     }
 }
 
+static void
+modlog_filter_set(uint8_t module, uint8_t level)
+{
+    uint8_t *byte;
+
+    if (level > MODLOG_FILTER_NONE) {
+        level = MODLOG_FILTER_NONE;
+    }
+
+    byte = &modlog_level_filter[module / 2];
+    if (module % 2 == 0) {
+        *byte = (*byte & 0xf0) | level;
+    } else {
+        *byte = (*byte & 0x0f) | (level << 4);
+    }
+}
+
+static uint8_t
+modlog_filter_get(uint8_t module)
+{
+    uint8_t byte;
+
+    byte = modlog_level_filter[module / 2];
+    if (module % 2 == 0) {
+        return byte & 0x0f;
+    } else {
+        return byte >> 4;
+    }
+}
+
+/**
+ * Recomputes the per-module level filter from the mapping list.  Must be
+ * called with the write lock held.
+ */
+static void
+modlog_filter_rebuild(void)
+{
+    const struct modlog_mapping *mm;
+    uint8_t dflt;
+    int module;
+    int prev;
+
+    /* Unmapped modules go to the default mappings. */
+    dflt = MODLOG_FILTER_NONE;
+    for (mm = modlog_first_dflt; mm != NULL; mm = SLIST_NEXT(mm, next)) {
+        dflt = min(dflt, mm->desc.min_level);
+    }
+    for (module = 0; module <= LOG_MODULE_MAX; module++) {
+        modlog_filter_set(module, dflt);
+    }
+
+    /* Mapped modules only go to their own mappings.  The list is sorted by
+     * module, so each module's mappings are contiguous.
+     */
+    prev = -1;
+    SLIST_FOREACH(mm, &modlog_mappings, next) {
+        if (mm == modlog_first_dflt) {
+            break;
+        }
+
+        if (mm->desc.module != prev) {
+            prev = mm->desc.module;
+            modlog_filter_set(prev, MODLOG_FILTER_NONE);
+        }
+        modlog_filter_set(prev, min(modlog_filter_get(prev),
+                                    mm->desc.min_level));
+    }
+}
+
 static int
 modlog_register_no_lock(uint8_t module, struct log *log, uint8_t min_level,
                         uint8_t *out_handle)
@@ -191,6 +313,7 @@ modlog_register_no_lock(uint8_t module, struct log *log, uint8_t min_level,
     };
 
     modlog_insert(mm);
+    modlog_filter_rebuild();
 
     if (out_handle != NULL) {
         *out_handle = mm->desc.handle;
@@ -212,6 +335,7 @@ modlog_delete_no_lock(uint8_t handle)
 
     modlog_remove(mm, prev);
     modlog_free(mm);
+    modlog_filter_rebuild();
 
     return 0;
 }
@@ -327,6 +451,262 @@ modlog_append_mbuf_no_lock(uint8_t module, uint8_t level, uint8_t etype,
     return 0;
 }
 
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+/**
+ * Refills a bucket and takes a token from it.  Must be called from a critical
+ * section.
+ */
+static bool
+modlog_rate_take_no_lock(struct modlog_rate *mr, os_time_t now)
+{
+    uint32_t elapsed;
+    uint32_t cap;
+
+    cap = (uint32_t)mr->mr_burst * OS_TICKS_PER_SEC;
+
+    elapsed = now - mr->mr_last;
+    mr->mr_last = now;
+    if (mr->mr_rate != 0 && mr->mr_credit < cap) {
+        if (elapsed >= (cap - mr->mr_credit) / mr->mr_rate) {
+            mr->mr_credit = cap;
+        } else {
+            mr->mr_credit += elapsed * mr->mr_rate;
+        }
+    }
+
+    if (mr->mr_credit < OS_TICKS_PER_SEC) {
+        mr->mr_drops++;
+        return false;
+    }
+
+    mr->mr_credit -= OS_TICKS_PER_SEC;
+    return true;
+}
+
+bool
+modlog_rate_take(struct modlog_rate *mr)
+{
+    os_time_t now;
+    os_sr_t sr;
+    bool ok;
+
+    now = os_time_get();
+
+    OS_ENTER_CRITICAL(sr);
+    ok = modlog_rate_take_no_lock(mr, now);
+    OS_EXIT_CRITICAL(sr);
+
+    if (!ok) {
+        STATS_INC(modlog_stats, rate_drops);
+    }
+
+    return ok;
+}
+
+int
+modlog_set_rate(uint8_t module, uint16_t rate, uint16_t burst)
+{
+    struct modlog_module_rate *mmr;
+    os_sr_t sr;
+    int rc;
+    int i;
+
+    if (rate != 0 && burst == 0) {
+        return SYS_EINVAL;
+    }
+
+    rc = 0;
+
+    OS_ENTER_CRITICAL(sr);
+
+    for (i = 0; i < modlog_num_rates; i++) {
+        if (modlog_rates[i].module == module) {
+            break;
+        }
+    }
+
+    if (rate == 0) {
+        /* Remove the limit, if any. */
+        if (i < modlog_num_rates) {
+            modlog_rates[i] = modlog_rates[--modlog_num_rates];
+        }
+    } else if (i == MYNEWT_VAL(MODLOG_RATE_MAX_MODULES)) {
+        rc = SYS_ENOMEM;
+    } else {
+        if (i == modlog_num_rates) {
+            modlog_num_rates++;
+        }
+        mmr = &modlog_rates[i];
+        mmr->module = module;
+        mmr->rate = (struct modlog_rate)MODLOG_RATE_INIT(rate, burst);
+        mmr->rate.mr_last = os_time_get();
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    return rc;
+}
+
+/**
+ * Applies the rate limit of the specified module, if it has one.
+ *
+ * @return                      true if the write may proceed;
+ *                              false if it should be dropped.
+ */
+static bool
+modlog_rate_module_take(uint8_t module)
+{
+    os_time_t now;
+    os_sr_t sr;
+    bool ok;
+    int i;
+
+    /* Cheap check for the common case of no limits at all. */
+    if (modlog_num_rates == 0) {
+        return true;
+    }
+
+    now = os_time_get();
+    ok = true;
+
+    OS_ENTER_CRITICAL(sr);
+    for (i = 0; i < modlog_num_rates; i++) {
+        if (modlog_rates[i].module == module) {
+            ok = modlog_rate_take_no_lock(&modlog_rates[i].rate, now);
+            break;
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (!ok) {
+        STATS_INC(modlog_stats, rate_drops);
+    }
+
+    return ok;
+}
+#endif
+
+#if MYNEWT_VAL(MODLOG_DUP_SUPPRESS)
+static uint32_t
+modlog_dup_hash(uint8_t etype, const void *data, uint16_t len)
+{
+    const uint8_t *u8p;
+    uint32_t hash;
+    int i;
+
+    hash = MODLOG_DUP_FNV_BASIS;
+    hash = (hash ^ etype) * MODLOG_DUP_FNV_PRIME;
+
+    u8p = data;
+    for (i = 0; i < len; i++) {
+        hash = (hash ^ u8p[i]) * MODLOG_DUP_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/**
+ * Records a write in the duplicate tracker.  If a "repeated" entry is due, it
+ * is passed back via `out_sum` (nonzero md_count); the caller must write it
+ * before the entry itself.
+ *
+ * @return                      true if the entry repeats the previous one and
+ *                                  should be dropped.
+ */
+static bool
+modlog_dup_check(uint8_t module, uint8_t level, uint8_t etype,
+                 const void *data, uint16_t len, struct modlog_dup *out_sum)
+{
+    struct modlog_dup *md;
+    os_time_t now;
+    uint32_t hash;
+    os_sr_t sr;
+    bool dup;
+
+    hash = modlog_dup_hash(etype, data, len);
+    now = os_time_get();
+    out_sum->md_count = 0;
+
+    OS_ENTER_CRITICAL(sr);
+
+    md = &modlog_dup;
+    dup = md->md_valid &&
+          md->md_hash == hash &&
+          md->md_len == len &&
+          md->md_module == module &&
+          md->md_level == level &&
+          md->md_etype == etype;
+
+    if (dup) {
+        if (md->md_count == 0) {
+            md->md_first = now;
+        }
+        md->md_count++;
+
+        /* Report long storms periodically rather than only at their end. */
+        if (now - md->md_first >= MODLOG_DUP_MAX_TICKS) {
+            *out_sum = *md;
+            md->md_count = 0;
+        }
+    } else {
+        if (md->md_count > 0) {
+            *out_sum = *md;
+        }
+
+        md->md_hash = hash;
+        md->md_count = 0;
+        md->md_len = len;
+        md->md_module = module;
+        md->md_level = level;
+        md->md_etype = etype;
+        md->md_valid = 1;
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    if (dup) {
+        STATS_INC(modlog_stats, dup_drops);
+    }
+
+    return dup;
+}
+
+static void
+modlog_dup_write_no_lock(const struct modlog_dup *sum)
+{
+    char buf[48];
+    int len;
+
+    len = snprintf(buf, sizeof buf, "last message repeated %lu times",
+                   (unsigned long)sum->md_count);
+    if (len >= sizeof buf) {
+        len = sizeof buf - 1;
+    }
+
+    modlog_append_no_lock(sum->md_module, sum->md_level, LOG_ETYPE_STRING,
+                          buf, len);
+    STATS_INC(modlog_stats, dup_summaries);
+}
+
+void
+modlog_dup_flush(void)
+{
+    struct modlog_dup sum;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    sum = modlog_dup;
+    modlog_dup.md_count = 0;
+    OS_EXIT_CRITICAL(sr);
+
+    if (sum.md_count > 0) {
+        rwlock_acquire_read(&modlog_rwl);
+        modlog_dup_write_no_lock(&sum);
+        rwlock_release_read(&modlog_rwl);
+    }
+}
+#endif
+
 static int
 modlog_foreach_no_lock(modlog_foreach_fn *fn, void *arg)
 {
@@ -408,6 +788,7 @@ modlog_clear(void)
         modlog_remove(mm, NULL);
         modlog_free(mm);
     }
+    modlog_filter_rebuild();
 
     rwlock_release_write(&modlog_rwl);
 }
@@ -416,9 +797,41 @@ int
 modlog_append(uint8_t module, uint8_t level, uint8_t etype,
               void *data, uint16_t len)
 {
+#if MYNEWT_VAL(MODLOG_DUP_SUPPRESS)
+    struct modlog_dup sum;
+    bool dup;
+#endif
     int rc;
 
+    if (module != MODLOG_MODULE_DFLT && !modlog_level_enabled(module, level)) {
+        return 0;
+    }
+
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+    if (!modlog_rate_module_take(module)) {
+        return 0;
+    }
+#endif
+
+#if MYNEWT_VAL(MODLOG_DUP_SUPPRESS)
+    dup = modlog_dup_check(module, level, etype, data, len, &sum);
+    if (dup && sum.md_count == 0) {
+        return 0;
+    }
+#endif
+
     rwlock_acquire_read(&modlog_rwl);
+
+#if MYNEWT_VAL(MODLOG_DUP_SUPPRESS)
+    if (sum.md_count > 0) {
+        modlog_dup_write_no_lock(&sum);
+    }
+    if (dup) {
+        rwlock_release_read(&modlog_rwl);
+        return 0;
+    }
+#endif
+
     rc = modlog_append_no_lock(module, level, etype, data, len);
     rwlock_release_read(&modlog_rwl);
 
@@ -431,6 +844,18 @@ modlog_append_mbuf(uint8_t module, uint8_t level, uint8_t etype,
 {
     int rc;
 
+    if (!modlog_level_enabled(module, level)) {
+        os_mbuf_free_chain(om);
+        return 0;
+    }
+
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+    if (!modlog_rate_module_take(module)) {
+        os_mbuf_free_chain(om);
+        return 0;
+    }
+#endif
+
     rwlock_acquire_read(&modlog_rwl);
     rc = modlog_append_mbuf_no_lock(module, level, etype, om);
     rwlock_release_read(&modlog_rwl);
@@ -457,6 +882,10 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
     char buf[MYNEWT_VAL(MODLOG_MAX_PRINTF_LEN)];
     int len;
 
+    if (!modlog_level_enabled(module, level)) {
+        return;
+    }
+
     va_start(args, msg);
     len = vsnprintf(buf, MYNEWT_VAL(MODLOG_MAX_PRINTF_LEN), msg, args);
     va_end(args);
@@ -468,6 +897,30 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
     modlog_append(module, level, LOG_ETYPE_STRING, buf, len);
 }
 
+#if MYNEWT_VAL(LOG_DEFERRED)
+void
+modlog_deferred_printf(uint8_t module, uint8_t level, const char *fmt, ...)
+{
+    uint8_t buf[MYNEWT_VAL(LOG_DEFERRED_MAX_ENTRY_LEN)];
+    va_list args;
+    int len;
+
+    if (!modlog_level_enabled(module, level)) {
+        return;
+    }
+
+    va_start(args, fmt);
+    len = log_deferred_vpack(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    if (len < 0) {
+        return;
+    }
+
+    modlog_append(module, level, LOG_ETYPE_DEFERRED, buf, len);
+}
+#endif
+
 void
 modlog_init(void)
 {
@@ -482,10 +935,24 @@ modlog_init(void)
 
     SLIST_INIT(&modlog_mappings);
     modlog_first_dflt = NULL;
+    modlog_filter_rebuild();
 
     rc = rwlock_init(&modlog_rwl);
     SYSINIT_PANIC_ASSERT(rc == 0);
 
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+    modlog_num_rates = 0;
+#endif
+#if MYNEWT_VAL(MODLOG_DUP_SUPPRESS)
+    memset(&modlog_dup, 0, sizeof modlog_dup);
+#endif
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT) || MYNEWT_VAL(MODLOG_DUP_SUPPRESS)
+    rc = stats_init_and_reg(STATS_HDR(modlog_stats),
+                            STATS_SIZE_INIT_PARMS(modlog_stats, STATS_SIZE_32),
+                            STATS_NAME_INIT_PARMS(modlog_stats), "modlog");
+    SYSINIT_PANIC_ASSERT(rc == 0);
+#endif
+
     /* Register the default console mapping if configured. */
 #if MYNEWT_VAL(MODLOG_CONSOLE_DFLT)
     rc = modlog_register(MODLOG_MODULE_DFLT, log_console_get(),
@@ -26,6 +26,8 @@ TEST_SUITE(modlog_test_suite_all)
     modlog_test_case_basic();
     modlog_test_case_printf();
     modlog_test_case_prio();
+    modlog_test_case_filter();
+    modlog_test_case_storm();
 }
 
 #if MYNEWT_VAL(SELFTEST)
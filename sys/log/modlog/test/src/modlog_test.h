@@ -31,5 +31,7 @@ TEST_CASE_DECL(modlog_test_case_append);
 TEST_CASE_DECL(modlog_test_case_basic);
 TEST_CASE_DECL(modlog_test_case_printf);
 TEST_CASE_DECL(modlog_test_case_prio);
+TEST_CASE_DECL(modlog_test_case_filter);
+TEST_CASE_DECL(modlog_test_case_storm);
 
 #endif
@@ -0,0 +1,96 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "modlog_test.h"
+
+static int mltcf_eval_cnt;
+
+static int
+mltcf_arg(void)
+{
+    mltcf_eval_cnt++;
+    return mltcf_eval_cnt;
+}
+
+TEST_CASE(modlog_test_case_filter)
+{
+    struct mltu_log_arg mla1;
+    struct mltu_log_arg mla2;
+    struct log log1;
+    struct log log2;
+    uint8_t handle;
+    int rc;
+
+    sysinit();
+
+    memset(&mla1, 0, sizeof mla1);
+    mltu_register_log(&log1, &mla1, "log1", 0);
+
+    memset(&mla2, 0, sizeof mla2);
+    mltu_register_log(&log2, &mla2, "log2", 0);
+
+    /*** Nothing is mapped; every write is filtered out. */
+    TEST_ASSERT(!modlog_level_enabled(1, LOG_LEVEL_CRITICAL));
+    TEST_ASSERT(!modlog_level_enabled(MODLOG_MODULE_DFLT, LOG_LEVEL_CRITICAL));
+
+    /*** A module accepts the lowest level of its mappings. */
+    rc = modlog_register(1, &log1, LOG_LEVEL_WARN, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = modlog_register(1, &log2, LOG_LEVEL_INFO, &handle);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    TEST_ASSERT(!modlog_level_enabled(1, LOG_LEVEL_DEBUG));
+    TEST_ASSERT(modlog_level_enabled(1, LOG_LEVEL_INFO));
+    TEST_ASSERT(!modlog_level_enabled(2, LOG_LEVEL_CRITICAL));
+
+    /*** Unmapped modules use the default mappings. */
+    rc = modlog_register(MODLOG_MODULE_DFLT, &log1, LOG_LEVEL_ERROR, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    TEST_ASSERT(!modlog_level_enabled(2, LOG_LEVEL_WARN));
+    TEST_ASSERT(modlog_level_enabled(2, LOG_LEVEL_ERROR));
+    TEST_ASSERT(modlog_level_enabled(1, LOG_LEVEL_INFO));
+
+    /*** Deleting a mapping updates the filter. */
+    rc = modlog_delete(handle);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(!modlog_level_enabled(1, LOG_LEVEL_INFO));
+    TEST_ASSERT(modlog_level_enabled(1, LOG_LEVEL_WARN));
+
+    /*** The global module level applies too. */
+    rc = log_level_set(1, LOG_LEVEL_ERROR);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(!modlog_level_enabled(1, LOG_LEVEL_WARN));
+    rc = log_level_set(1, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Filtered out macro writes don't evaluate their arguments. */
+    mltcf_eval_cnt = 0;
+    MODLOG_INFO(1, "%d", mltcf_arg());
+    TEST_ASSERT(mltcf_eval_cnt == 0);
+    TEST_ASSERT(mla1.num_entries == 0);
+
+    MODLOG_WARN(1, "%d", mltcf_arg());
+    TEST_ASSERT(mltcf_eval_cnt == 1);
+    TEST_ASSERT(mla1.num_entries == 1);
+
+    modlog_clear();
+    TEST_ASSERT(!modlog_level_enabled(1, LOG_LEVEL_CRITICAL));
+    TEST_ASSERT(!modlog_level_enabled(2, LOG_LEVEL_CRITICAL));
+}
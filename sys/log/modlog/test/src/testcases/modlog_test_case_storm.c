@@ -0,0 +1,142 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "modlog_test.h"
+
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT) && MYNEWT_VAL(MODLOG_DUP_SUPPRESS)
+
+static void
+mltcs_expect(const struct mltu_log_arg *mla, int idx, const char *str)
+{
+    TEST_ASSERT_FATAL(idx < mla->num_entries);
+    TEST_ASSERT(mla->entries[idx].len == strlen(str));
+    TEST_ASSERT(memcmp(mla->entries[idx].body, str, strlen(str)) == 0);
+}
+
+TEST_CASE(modlog_test_case_storm)
+{
+    struct mltu_log_arg mla;
+    struct log log;
+    int rc;
+    int i;
+
+    sysinit();
+
+    memset(&mla, 0, sizeof mla);
+    mltu_register_log(&log, &mla, "log", 0);
+
+    rc = modlog_register(1, &log, 0, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = modlog_register(2, &log, 0, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Repeats are collapsed until a different entry arrives. */
+    for (i = 0; i < 5; i++) {
+        modlog_printf(1, 1, "storm");
+    }
+    TEST_ASSERT(mla.num_entries == 1);
+
+    modlog_printf(1, 1, "calm");
+    TEST_ASSERT_FATAL(mla.num_entries == 3);
+    mltcs_expect(&mla, 0, "storm");
+    mltcs_expect(&mla, 1, "last message repeated 4 times");
+    TEST_ASSERT(mla.entries[1].hdr.ue_module == 1);
+    TEST_ASSERT(mla.entries[1].hdr.ue_level == 1);
+    mltcs_expect(&mla, 2, "calm");
+
+    /* Same body at another level or module is not a repeat. */
+    modlog_printf(1, 2, "calm");
+    modlog_printf(2, 2, "calm");
+    TEST_ASSERT(mla.num_entries == 5);
+
+    /*** Pending repeats can be flushed. */
+    modlog_printf(2, 2, "calm");
+    modlog_printf(2, 2, "calm");
+    TEST_ASSERT(mla.num_entries == 5);
+    modlog_dup_flush();
+    TEST_ASSERT_FATAL(mla.num_entries == 6);
+    mltcs_expect(&mla, 5, "last message repeated 2 times");
+    modlog_dup_flush();
+    TEST_ASSERT(mla.num_entries == 6);
+
+    /*** Long storms are reported periodically. */
+    modlog_printf(2, 2, "calm");
+    os_time_advance(os_time_ms_to_ticks32(MYNEWT_VAL(MODLOG_DUP_MAX_MS)));
+    modlog_printf(2, 2, "calm");
+    TEST_ASSERT_FATAL(mla.num_entries == 7);
+    mltcs_expect(&mla, 6, "last message repeated 2 times");
+
+    TEST_ASSERT(STATS_GET(modlog_stats, dup_drops) == 8);
+    TEST_ASSERT(STATS_GET(modlog_stats, dup_summaries) == 3);
+
+    /*** Per-module rate limit: a burst of 3, then 1 per second. */
+    mla.num_entries = 0;
+    TEST_ASSERT(modlog_set_rate(1, 1, 0) == SYS_EINVAL);
+    rc = modlog_set_rate(1, 1, 3);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < 10; i++) {
+        modlog_printf(1, 1, "flood %d", i);
+    }
+    TEST_ASSERT(mla.num_entries == 3);
+    TEST_ASSERT(STATS_GET(modlog_stats, rate_drops) == 7);
+
+    /* Other modules are not affected. */
+    modlog_printf(2, 1, "other");
+    TEST_ASSERT(mla.num_entries == 4);
+
+    os_time_advance(2 * OS_TICKS_PER_SEC);
+    for (i = 0; i < 10; i++) {
+        modlog_printf(1, 1, "flood %d", i);
+    }
+    TEST_ASSERT(mla.num_entries == 6);
+
+    /* Removing the limit. */
+    rc = modlog_set_rate(1, 0, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (i = 0; i < 10; i++) {
+        modlog_printf(1, 1, "flood %d", i);
+    }
+    TEST_ASSERT(mla.num_entries == 16);
+
+    /* The table of limited modules is bounded. */
+    for (i = 0; i < MYNEWT_VAL(MODLOG_RATE_MAX_MODULES); i++) {
+        rc = modlog_set_rate(10 + i, 1, 1);
+        TEST_ASSERT(rc == 0);
+    }
+    TEST_ASSERT(modlog_set_rate(9, 1, 1) == SYS_ENOMEM);
+    TEST_ASSERT(modlog_set_rate(10, 2, 2) == 0);
+
+    /*** Per-call-site rate limit. */
+    mla.num_entries = 0;
+    for (i = 0; i < 5; i++) {
+        MODLOG_RATE(INFO, 2, 1, 2, "site %d", i);
+    }
+    TEST_ASSERT(mla.num_entries == 2);
+    mltcs_expect(&mla, 0, "site 0");
+    mltcs_expect(&mla, 1, "site 1");
+}
+
+#else
+
+TEST_CASE(modlog_test_case_storm)
+{
+}
+
+#endif
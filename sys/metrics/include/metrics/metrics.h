@@ -22,6 +22,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "os/mynewt.h"
 #include "log/log.h"
 
 #ifdef __cplusplus
@@ -142,6 +143,29 @@ extern "C" {
  * As number of values increases in a series it may be necessary to allocate
  * more blocks for the same data series. Once event data is reset, all blocks
  * allocated for an event are freed.
+ *
+ * Alternatively, a series metric can be given its own fixed-size ring of
+ * values with metrics_set_ring(). Appending to a ring never allocates; once
+ * it is full, the oldest values are overwritten. Each ring slot can hold
+ * a single value, or the minimum, maximum or average of a number of
+ * consecutive values:
+ *
+ *     static uint16_t pps_buf[32];
+ *     static struct metrics_ring pps_ring;
+ *
+ *     metrics_set_ring(&my_power_event.hdr, POWER_METRIC_PPS, &pps_ring,
+ *                      pps_buf, 32, METRICS_RING_AVG, 10);
+ *
+ * keeps averages of the last 320 values logged in an event.
+ *
+ * With METRICS_STAGING enabled, an event can be given a staging ring with
+ * metrics_event_set_stage(). Setting values, starting and ending such an
+ * event then only queues the operation, which is safe from any task or
+ * interrupt, and an aggregation task applies queued operations every
+ * METRICS_AGG_PERIOD_MS. Logging of finished events, including CBOR
+ * encoding, is done by the aggregation task as well. Call metrics_flush()
+ * to apply queued operations immediately, e.g. before calling
+ * metrics_event_to_cbor().
  */
 
 /* Helper to define metric type - use types defined below instead! */
@@ -167,6 +191,7 @@ struct metrics_metric_def {
 };
 
 /* Event header - use EVENT_DECLARE() helpers to create */
+struct metrics_stage;
 struct metrics_event_hdr {
     const char *name;
     struct log *log;
@@ -175,9 +200,11 @@ struct metrics_event_hdr {
     uint32_t timestamp;
     uint32_t enabled;
     uint32_t set;
+    uint32_t ring;
     uint8_t count;
     STAILQ_ENTRY(metrics_event_hdr) next;
     const struct metrics_metric_def *defs;
+    struct metrics_stage *stage;
 };
 
 /*
@@ -396,6 +423,112 @@ int metrics_set_single_value(struct metrics_event_hdr *hdr, uint8_t metric,
 int metrics_set_series_value(struct metrics_event_hdr *hdr, uint8_t metric,
                              uint32_t val);
 
+/* Ring slot contents - see metrics_set_ring() */
+#define METRICS_RING_LAST               0
+#define METRICS_RING_MIN                1
+#define METRICS_RING_MAX                2
+#define METRICS_RING_AVG                3
+
+/* Series ring - see metrics_set_ring() */
+struct metrics_ring {
+    void *buf;
+    uint16_t size;
+    uint16_t head;
+    uint16_t cnt;
+    uint8_t mode;
+    uint8_t per_slot;
+    uint8_t slot_cnt;
+    int64_t acc;
+};
+
+/**
+ * Helper to compute size of values buffer for a ring
+ *
+ * @param _type  Metric type
+ * @param _size  Number of ring slots
+ */
+#define METRICS_RING_BUF_SIZE(_type, _size) \
+    ((_size) * ((_type) & 0x0f))
+
+/**
+ * Store series metric in a ring
+ *
+ * Values of a series metric are stored in a fixed-size ring instead of the
+ * metrics mempool. Once the ring is full, each new slot overwrites the oldest
+ * one. Each slot holds per_slot consecutive values reduced as selected by
+ * mode; the last slot may hold fewer values. With METRICS_RING_LAST, the slot
+ * holds the last of its values.
+ *
+ * Ring memory is owned by the caller and has to stay valid as long as the
+ * event is used. Any values collected for the metric in current event are
+ * dropped.
+ *
+ * @param hdr       Event header
+ * @param metric    Metric identifier
+ * @param ring      Ring to initialize
+ * @param buf       Buffer for values, see METRICS_RING_BUF_SIZE()
+ * @param size      Number of slots in buf
+ * @param mode      One of METRICS_RING_* values
+ * @param per_slot  Number of values reduced into each slot
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int metrics_set_ring(struct metrics_event_hdr *hdr, uint8_t metric,
+                     struct metrics_ring *ring, void *buf, uint16_t size,
+                     uint8_t mode, uint8_t per_slot);
+
+#if MYNEWT_VAL(METRICS_STAGING)
+/* Queued event operation - see metrics_event_set_stage() */
+struct metrics_sample {
+    uint32_t val;
+    uint8_t op;
+};
+
+/* Staging ring - see metrics_event_set_stage() */
+struct metrics_stage {
+    struct metrics_event_hdr *hdr;
+    struct metrics_sample *samples;
+    uint16_t size;
+    volatile uint16_t head;
+    volatile uint16_t tail;
+    /* Number of operations dropped because ring was full */
+    uint32_t dropped;
+    SLIST_ENTRY(metrics_stage) next;
+};
+
+/**
+ * Set staging ring for an event
+ *
+ * Once set, metrics_set_value(), metrics_set_single_value(),
+ * metrics_set_series_value(), metrics_event_start() and metrics_event_end()
+ * only queue the operation in the ring; they can be called from any task or
+ * interrupt. Queued operations are applied by the aggregation task, which
+ * also logs finished events. Operations which do not fit in the ring are
+ * dropped and counted.
+ *
+ * Ring memory is owned by the caller and has to stay valid for the lifetime
+ * of the event; one slot of the ring is always left unused.
+ *
+ * @param hdr      Event header
+ * @param stage    Staging ring to initialize
+ * @param samples  Buffer for queued operations
+ * @param size     Number of entries in samples buffer
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int metrics_event_set_stage(struct metrics_event_hdr *hdr,
+                            struct metrics_stage *stage,
+                            struct metrics_sample *samples, uint16_t size);
+
+/**
+ * Apply all queued operations
+ *
+ * Applies operations queued for all staged events, logging any events which
+ * were ended. Shall not be called from an interrupt.
+ */
+void metrics_flush(void);
+#endif
+
 /**
  * Serialize event data to CBOR
  *
@@ -44,6 +44,7 @@ union metrics_metric_val {
     uintptr_t notused;
     uint32_t val;
     struct os_mbuf *series;
+    struct metrics_ring *ring;
 };
 
 struct metrics_event {
@@ -62,6 +63,81 @@ static os_membuf_t event_metric_data[ OS_MEMPOOL_SIZE(MEMPOOL_COUNT, MEMPOOL_SIZ
 static struct os_mbuf_pool event_metric_mbuf_pool;
 static struct os_mempool event_metric_mempool;
 
+#if MYNEWT_VAL(METRICS_STAGING)
+/*
+ * Staged events.
+ *
+ * Operations on a staged event are queued in its staging ring. Producers
+ * only disable interrupts for the few instructions needed to claim a slot and
+ * fill it in, so this can be done from any task or interrupt. The aggregation
+ * task is the only consumer; it applies queued operations to event data and
+ * logs finished events.
+ */
+
+/* Queued operations other than setting a metric (metric ids are < 32) */
+#define METRICS_OP_START    0xfe
+#define METRICS_OP_END      0xff
+
+static SLIST_HEAD(, metrics_stage) metrics_stages;
+
+/* Serializes consumers (aggregation task and metrics_flush() callers) */
+static struct os_mutex metrics_agg_mtx;
+
+static struct os_callout metrics_agg_callout;
+
+#if MYNEWT_VAL(METRICS_AGG_TASK)
+static struct os_task metrics_agg_task;
+static struct os_eventq metrics_agg_evq;
+static os_stack_t metrics_agg_stack[MYNEWT_VAL(METRICS_AGG_TASK_STACK_SIZE)];
+
+static void
+metrics_agg_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&metrics_agg_evq);
+    }
+}
+#endif
+
+static int
+metrics_stage_put(struct metrics_stage *stage, uint8_t op, uint32_t val)
+{
+    struct metrics_sample *sample;
+    uint16_t next;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+
+    next = stage->head + 1;
+    if (next == stage->size) {
+        next = 0;
+    }
+    if (next == stage->tail) {
+        stage->dropped++;
+        OS_EXIT_CRITICAL(sr);
+        return -1;
+    }
+
+    sample = &stage->samples[stage->head];
+    sample->val = val;
+    sample->op = op;
+    stage->head = next;
+
+    OS_EXIT_CRITICAL(sr);
+
+    return 0;
+}
+#endif
+
+static void
+metrics_ring_reset(struct metrics_ring *ring)
+{
+    ring->head = 0;
+    ring->cnt = 0;
+    ring->slot_cnt = 0;
+    ring->acc = 0;
+}
+
 int
 metrics_event_init(struct metrics_event_hdr *hdr,
                   const struct metrics_metric_def *metrics, uint8_t count,
@@ -95,11 +171,14 @@ metrics_event_set_log(struct metrics_event_hdr *hdr, struct log *log,
     return 0;
 }
 
-int
-metrics_event_start(struct metrics_event_hdr *hdr, uint32_t timestamp)
+static int
+event_end(struct metrics_event_hdr *hdr);
+
+static int
+event_start(struct metrics_event_hdr *hdr, uint32_t timestamp)
 {
     if (hdr->set) {
-        metrics_event_end(hdr);
+        event_end(hdr);
     }
 
     hdr->timestamp = timestamp;
@@ -107,8 +186,8 @@ metrics_event_start(struct metrics_event_hdr *hdr, uint32_t timestamp)
     return 0;
 }
 
-int
-metrics_event_end(struct metrics_event_hdr *hdr)
+static int
+event_end(struct metrics_event_hdr *hdr)
 {
     struct metrics_event *em = (struct metrics_event *)hdr;
     const struct metrics_metric_def *def;
@@ -117,6 +196,8 @@ metrics_event_end(struct metrics_event_hdr *hdr)
     int ret;
     int i;
 
+    ret = 0;
+
     if (hdr->log) {
         om = metrics_get_mbuf();
         if (om) {
@@ -139,7 +220,9 @@ metrics_event_end(struct metrics_event_hdr *hdr)
         def = &hdr->defs[i];
         v = &em->vals[i];
 
-        if (def->type & METRICS_TYPE_SERIES_MASK) {
+        if (hdr->ring & (1 << i)) {
+            metrics_ring_reset(v->ring);
+        } else if (def->type & METRICS_TYPE_SERIES_MASK) {
             if (v->series) {
                 os_mbuf_free_chain(v->series);
             }
@@ -152,6 +235,30 @@ metrics_event_end(struct metrics_event_hdr *hdr)
     return ret;
 }
 
+int
+metrics_event_start(struct metrics_event_hdr *hdr, uint32_t timestamp)
+{
+#if MYNEWT_VAL(METRICS_STAGING)
+    if (hdr->stage) {
+        return metrics_stage_put(hdr->stage, METRICS_OP_START, timestamp);
+    }
+#endif
+
+    return event_start(hdr, timestamp);
+}
+
+int
+metrics_event_end(struct metrics_event_hdr *hdr)
+{
+#if MYNEWT_VAL(METRICS_STAGING)
+    if (hdr->stage) {
+        return metrics_stage_put(hdr->stage, METRICS_OP_END, 0);
+    }
+#endif
+
+    return event_end(hdr);
+}
+
 int
 metrics_set_state(struct metrics_event_hdr *hdr, uint8_t metric, bool state)
 {
@@ -203,6 +310,162 @@ set_single_value(struct metrics_event_hdr *hdr, uint8_t metric,
     return 0;
 }
 
+int
+metrics_set_ring(struct metrics_event_hdr *hdr, uint8_t metric,
+                 struct metrics_ring *ring, void *buf, uint16_t size,
+                 uint8_t mode, uint8_t per_slot)
+{
+    struct metrics_event *em = (struct metrics_event *)hdr;
+    union metrics_metric_val *v;
+
+    assert(metric < hdr->count);
+
+    if ((hdr->defs[metric].type & METRICS_TYPE_SERIES_MASK) == 0) {
+        return -1;
+    }
+    if (!buf || (size == 0) || (mode > METRICS_RING_AVG) || (per_slot == 0)) {
+        return -1;
+    }
+
+    v = &em->vals[metric];
+    if (((hdr->ring & (1 << metric)) == 0) && v->series) {
+        os_mbuf_free_chain(v->series);
+    }
+
+    ring->buf = buf;
+    ring->size = size;
+    ring->mode = mode;
+    ring->per_slot = per_slot;
+    metrics_ring_reset(ring);
+
+    v->ring = ring;
+    hdr->ring |= (1 << metric);
+    hdr->set &= ~(1 << metric);
+
+    return 0;
+}
+
+/* Value as seen by metric type, i.e. truncated and sign extended */
+static int64_t
+metrics_ring_val(uint32_t val, uint8_t type)
+{
+    switch (type) {
+    case METRICS_TYPE_SERIES_U8:
+        return (uint8_t)val;
+    case METRICS_TYPE_SERIES_S8:
+        return (int8_t)val;
+    case METRICS_TYPE_SERIES_U16:
+        return (uint16_t)val;
+    case METRICS_TYPE_SERIES_S16:
+        return (int16_t)val;
+    case METRICS_TYPE_SERIES_S32:
+        return (int32_t)val;
+    default:
+        return val;
+    }
+}
+
+static int64_t
+metrics_ring_get(struct metrics_ring *ring, uint16_t idx, uint8_t type)
+{
+    switch (type) {
+    case METRICS_TYPE_SERIES_U8:
+        return ((uint8_t *)ring->buf)[idx];
+    case METRICS_TYPE_SERIES_S8:
+        return ((int8_t *)ring->buf)[idx];
+    case METRICS_TYPE_SERIES_U16:
+        return ((uint16_t *)ring->buf)[idx];
+    case METRICS_TYPE_SERIES_S16:
+        return ((int16_t *)ring->buf)[idx];
+    case METRICS_TYPE_SERIES_S32:
+        return ((int32_t *)ring->buf)[idx];
+    default:
+        return ((uint32_t *)ring->buf)[idx];
+    }
+}
+
+static void
+metrics_ring_put(struct metrics_ring *ring, uint16_t idx, int64_t val,
+                 uint8_t type)
+{
+    switch (type & METRICS_TYPE_SIZE_MASK) {
+    case sizeof(uint8_t):
+        ((uint8_t *)ring->buf)[idx] = val;
+        break;
+    case sizeof(uint16_t):
+        ((uint16_t *)ring->buf)[idx] = val;
+        break;
+    default:
+        ((uint32_t *)ring->buf)[idx] = val;
+        break;
+    }
+}
+
+static int
+set_ring_value(struct metrics_event_hdr *hdr, uint8_t metric,
+               uint32_t val, uint8_t type)
+{
+    struct metrics_event *em = (struct metrics_event *)hdr;
+    struct metrics_ring *ring;
+    int64_t x;
+    int idx;
+
+    ring = em->vals[metric].ring;
+    x = metrics_ring_val(val, type);
+
+    if (ring->slot_cnt == 0) {
+        /* Start new slot, dropping the oldest one if ring is full */
+        if (ring->cnt == ring->size) {
+            ring->head++;
+            if (ring->head == ring->size) {
+                ring->head = 0;
+            }
+        } else {
+            ring->cnt++;
+        }
+        ring->acc = x;
+    } else {
+        switch (ring->mode) {
+        case METRICS_RING_MIN:
+            if (x < ring->acc) {
+                ring->acc = x;
+            }
+            break;
+        case METRICS_RING_MAX:
+            if (x > ring->acc) {
+                ring->acc = x;
+            }
+            break;
+        case METRICS_RING_AVG:
+            ring->acc += x;
+            break;
+        default:
+            ring->acc = x;
+            break;
+        }
+    }
+    ring->slot_cnt++;
+
+    x = ring->acc;
+    if (ring->mode == METRICS_RING_AVG) {
+        x /= ring->slot_cnt;
+    }
+
+    idx = ring->head + ring->cnt - 1;
+    if (idx >= ring->size) {
+        idx -= ring->size;
+    }
+    metrics_ring_put(ring, idx, x, type);
+
+    if (ring->slot_cnt == ring->per_slot) {
+        ring->slot_cnt = 0;
+    }
+
+    hdr->set |= (1 << metric);
+
+    return 0;
+}
+
 static int
 set_series_value(struct metrics_event_hdr *hdr, uint8_t metric,
                  uint32_t val, uint8_t type)
@@ -211,6 +474,10 @@ set_series_value(struct metrics_event_hdr *hdr, uint8_t metric,
     union metrics_metric_val *v;
     uint16_t type_len;
 
+    if (hdr->ring & (1 << metric)) {
+        return set_ring_value(hdr, metric, val, type);
+    }
+
     v = &em->vals[metric];
 
     if (!v->series) {
@@ -240,6 +507,12 @@ metrics_set_value(struct metrics_event_hdr *hdr, uint8_t metric,
         return 0;
     }
 
+#if MYNEWT_VAL(METRICS_STAGING)
+    if (hdr->stage) {
+        return metrics_stage_put(hdr->stage, metric, val);
+    }
+#endif
+
     def = &hdr->defs[metric];
 
     if (def->type & METRICS_TYPE_SERIES_MASK) {
@@ -267,6 +540,12 @@ metrics_set_single_value(struct metrics_event_hdr *hdr, uint8_t metric, uint32_t
         return 0;
     }
 
+#if MYNEWT_VAL(METRICS_STAGING)
+    if (hdr->stage) {
+        return metrics_stage_put(hdr->stage, metric, val);
+    }
+#endif
+
     return set_single_value(hdr, metric, val);
 }
 
@@ -286,6 +565,12 @@ metrics_set_series_value(struct metrics_event_hdr *hdr, uint8_t metric, uint32_t
         return 0;
     }
 
+#if MYNEWT_VAL(METRICS_STAGING)
+    if (hdr->stage) {
+        return metrics_stage_put(hdr->stage, metric, val);
+    }
+#endif
+
     return set_series_value(hdr, metric, val, def->type);
 }
 
@@ -427,6 +712,36 @@ append_series_s32_to_cbor(CborEncoder *encoder, struct os_mbuf *om)
     return 0;
 }
 
+static int
+append_ring_to_cbor(CborEncoder *encoder, struct metrics_ring *ring,
+                    uint8_t type)
+{
+    int64_t val;
+    uint16_t idx;
+    uint16_t i;
+    int rc;
+
+    idx = ring->head;
+    for (i = 0; i < ring->cnt; i++) {
+        val = metrics_ring_get(ring, idx, type);
+        if (type & METRICS_TYPE_SIGNED_MASK) {
+            rc = cbor_encode_int(encoder, val);
+        } else {
+            rc = cbor_encode_uint(encoder, val);
+        }
+        if (rc) {
+            return -1;
+        }
+
+        idx++;
+        if (idx == ring->size) {
+            idx = 0;
+        }
+    }
+
+    return 0;
+}
+
 int
 metrics_event_to_cbor(struct metrics_event_hdr *hdr, struct os_mbuf *om)
 {
@@ -479,6 +794,20 @@ metrics_event_to_cbor(struct metrics_event_hdr *hdr, struct os_mbuf *om)
             continue;
         }
 
+        /* Rings are encoded in place, their length is known upfront */
+        if (hdr->ring & (1 << i)) {
+            rc = cbor_encoder_create_array(&map, &arr, v->ring->cnt);
+            if (rc != 0) {
+                goto failed;
+            }
+            rc = append_ring_to_cbor(&arr, v->ring, def->type);
+            rc |= cbor_encoder_close_container(&map, &arr);
+            if (rc != 0) {
+                goto failed;
+            }
+            continue;
+        }
+
         rc = cbor_encoder_create_array(&map, &arr, CborIndefiniteLength);
         if (rc != 0) {
             goto failed;
@@ -536,6 +865,122 @@ failed:
     return -1;
 }
 
+#if MYNEWT_VAL(METRICS_STAGING)
+static void
+metrics_stage_apply(struct metrics_stage *stage)
+{
+    struct metrics_event_hdr *hdr;
+    const struct metrics_metric_def *def;
+    struct metrics_sample *sample;
+    uint16_t tail;
+
+    hdr = stage->hdr;
+    tail = stage->tail;
+
+    while (tail != stage->head) {
+        sample = &stage->samples[tail];
+
+        switch (sample->op) {
+        case METRICS_OP_START:
+            event_start(hdr, sample->val);
+            break;
+        case METRICS_OP_END:
+            event_end(hdr);
+            break;
+        default:
+            def = &hdr->defs[sample->op];
+            if (def->type & METRICS_TYPE_SERIES_MASK) {
+                set_series_value(hdr, sample->op, sample->val, def->type);
+            } else {
+                set_single_value(hdr, sample->op, sample->val);
+            }
+            break;
+        }
+
+        tail++;
+        if (tail == stage->size) {
+            tail = 0;
+        }
+        /* Producers can only reuse the slot after this */
+        stage->tail = tail;
+    }
+}
+
+int
+metrics_event_set_stage(struct metrics_event_hdr *hdr,
+                        struct metrics_stage *stage,
+                        struct metrics_sample *samples, uint16_t size)
+{
+    if (hdr->stage || !samples || (size < 2)) {
+        return -1;
+    }
+
+    stage->hdr = hdr;
+    stage->samples = samples;
+    stage->size = size;
+    stage->head = 0;
+    stage->tail = 0;
+    stage->dropped = 0;
+
+    os_mutex_pend(&metrics_agg_mtx, OS_WAIT_FOREVER);
+    SLIST_INSERT_HEAD(&metrics_stages, stage, next);
+    hdr->stage = stage;
+    os_mutex_release(&metrics_agg_mtx);
+
+    return 0;
+}
+
+void
+metrics_flush(void)
+{
+    struct metrics_stage *stage;
+
+    os_mutex_pend(&metrics_agg_mtx, OS_WAIT_FOREVER);
+    SLIST_FOREACH(stage, &metrics_stages, next) {
+        metrics_stage_apply(stage);
+    }
+    os_mutex_release(&metrics_agg_mtx);
+}
+
+static void
+metrics_agg_cb(struct os_event *ev)
+{
+    metrics_flush();
+
+    os_callout_reset(&metrics_agg_callout,
+                     os_time_ms_to_ticks32(MYNEWT_VAL(METRICS_AGG_PERIOD_MS)));
+}
+
+static void
+metrics_stage_init(void)
+{
+    struct os_eventq *evq;
+    int rc;
+
+    SLIST_INIT(&metrics_stages);
+
+    rc = os_mutex_init(&metrics_agg_mtx);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+#if MYNEWT_VAL(METRICS_AGG_TASK)
+    os_eventq_init(&metrics_agg_evq);
+    rc = os_task_init(&metrics_agg_task, "metrics", metrics_agg_task_handler,
+                      NULL, MYNEWT_VAL(METRICS_AGG_TASK_PRIO),
+                      OS_WAIT_FOREVER, metrics_agg_stack,
+                      MYNEWT_VAL(METRICS_AGG_TASK_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    evq = &metrics_agg_evq;
+#else
+    evq = os_eventq_dflt_get();
+#endif
+
+    os_callout_init(&metrics_agg_callout, evq, metrics_agg_cb, NULL);
+    os_callout_reset(&metrics_agg_callout,
+                     os_time_ms_to_ticks32(MYNEWT_VAL(METRICS_AGG_PERIOD_MS)));
+}
+#endif
+
 struct os_mbuf *
 metrics_get_mbuf(void)
 {
@@ -557,6 +1002,10 @@ metrics_pkg_init(void)
                            MEMPOOL_SIZE, MEMPOOL_COUNT);
     assert(rc == 0);
 
+#if MYNEWT_VAL(METRICS_STAGING)
+    metrics_stage_init();
+#endif
+
 #if MYNEWT_VAL(METRICS_CLI)
     metrics_cli_init();
 #endif
@@ -0,0 +1,149 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_mbuf_reader.h"
+
+#include "metrics_test.h"
+
+#define METRICS_TEST_MBUF_CNT   8
+#define METRICS_TEST_MBUF_SZ    256
+
+static os_membuf_t metrics_test_mbuf_mem[
+    OS_MEMPOOL_SIZE(METRICS_TEST_MBUF_CNT, METRICS_TEST_MBUF_SZ)];
+static struct os_mempool metrics_test_mbuf_mpool;
+static struct os_mbuf_pool metrics_test_mbuf_pool;
+
+/*
+ * Encodes an event and looks a metric up in it.  Returns the mbuf holding
+ * the encoding, which val refers to.
+ */
+static struct os_mbuf *
+metrics_test_find(struct metrics_event_hdr *hdr, const char *name,
+                  struct cbor_mbuf_reader *reader, CborParser *parser,
+                  CborValue *val)
+{
+    struct os_mbuf *om;
+    CborValue map;
+    int rc;
+
+    om = os_mbuf_get_pkthdr(&metrics_test_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+
+    rc = metrics_event_to_cbor(hdr, om);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    cbor_mbuf_reader_init(reader, om, 0);
+    rc = cbor_parser_init(&reader->r, 0, parser, &map);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = cbor_value_map_find_value(&map, name, val);
+    TEST_ASSERT_FATAL(rc == 0 && cbor_value_is_valid(val));
+
+    return om;
+}
+
+int64_t
+metrics_test_single(struct metrics_event_hdr *hdr, const char *name)
+{
+    struct cbor_mbuf_reader reader;
+    struct os_mbuf *om;
+    CborParser parser;
+    CborValue val;
+    int64_t i64;
+    int rc;
+
+    om = metrics_test_find(hdr, name, &reader, &parser, &val);
+    if (cbor_value_is_null(&val)) {
+        i64 = -1;
+    } else {
+        rc = cbor_value_get_int64(&val, &i64);
+        TEST_ASSERT(rc == 0);
+    }
+    os_mbuf_free_chain(om);
+
+    return i64;
+}
+
+int
+metrics_test_series(struct metrics_event_hdr *hdr, const char *name,
+                    int64_t *vals, int max)
+{
+    struct cbor_mbuf_reader reader;
+    struct os_mbuf *om;
+    CborParser parser;
+    CborValue arr;
+    CborValue val;
+    int cnt;
+    int rc;
+
+    om = metrics_test_find(hdr, name, &reader, &parser, &arr);
+    if (cbor_value_is_null(&arr)) {
+        os_mbuf_free_chain(om);
+        return -1;
+    }
+
+    TEST_ASSERT_FATAL(cbor_value_is_array(&arr));
+    rc = cbor_value_enter_container(&arr, &val);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (cnt = 0; !cbor_value_at_end(&val); cnt++) {
+        TEST_ASSERT_FATAL(cnt < max);
+        rc = cbor_value_get_int64(&val, &vals[cnt]);
+        TEST_ASSERT(rc == 0);
+        rc = cbor_value_advance_fixed(&val);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    os_mbuf_free_chain(om);
+
+    return cnt;
+}
+
+TEST_CASE_DECL(metrics_test_case_stage)
+TEST_CASE_DECL(metrics_test_case_ring)
+
+TEST_SUITE(metrics_test_all)
+{
+    int rc;
+
+    rc = os_mempool_init(&metrics_test_mbuf_mpool, METRICS_TEST_MBUF_CNT,
+                         METRICS_TEST_MBUF_SZ, metrics_test_mbuf_mem,
+                         "metrics_test");
+    TEST_ASSERT(rc == 0);
+    rc = os_mbuf_pool_init(&metrics_test_mbuf_pool, &metrics_test_mbuf_mpool,
+                           METRICS_TEST_MBUF_SZ, METRICS_TEST_MBUF_CNT);
+    TEST_ASSERT(rc == 0);
+
+    metrics_test_case_stage();
+    metrics_test_case_ring();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    metrics_test_all();
+
+    return tu_any_failed;
+}
+#endif
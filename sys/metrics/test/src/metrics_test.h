@@ -0,0 +1,51 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _METRICS_TEST_H
+#define _METRICS_TEST_H
+
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#include "metrics/metrics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Encodes an event and returns the value of a single metric; -1 if it is
+ * not set.
+ */
+int64_t metrics_test_single(struct metrics_event_hdr *hdr, const char *name);
+
+/*
+ * Encodes an event and copies the values of a series metric into vals.
+ * Returns the number of values; -1 if the metric is not set.
+ */
+int metrics_test_series(struct metrics_event_hdr *hdr, const char *name,
+                        int64_t *vals, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _METRICS_TEST_H */
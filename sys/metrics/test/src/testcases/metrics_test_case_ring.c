@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "metrics_test.h"
+
+METRICS_SECT_START(mtcr_metrics)
+    METRICS_SECT_ENTRY(id, METRICS_TYPE_SINGLE_U)
+    METRICS_SECT_ENTRY(rssi, METRICS_TYPE_SERIES_S8)
+    METRICS_SECT_ENTRY(load, METRICS_TYPE_SERIES_U32)
+METRICS_SECT_END;
+
+METRICS_EVENT_DECLARE(mtcr_event, mtcr_metrics);
+
+/* A pool with a single mbuf, to run out of room while encoding. */
+#define MTCR_MBUF_SZ    128
+
+static os_membuf_t mtcr_mbuf_mem[OS_MEMPOOL_SIZE(1, MTCR_MBUF_SZ)];
+static struct os_mempool mtcr_mbuf_mpool;
+static struct os_mbuf_pool mtcr_mbuf_pool;
+
+TEST_CASE(metrics_test_case_ring)
+{
+    static struct mtcr_event ev;
+    static struct metrics_ring rssi_ring;
+    static struct metrics_ring load_ring;
+    static int8_t rssi_buf[4];
+    static uint32_t load_buf[2];
+    struct os_mbuf *om;
+    int64_t vals[8];
+    int rc;
+    int i;
+
+    rc = metrics_event_init(&ev.hdr, mtcr_metrics,
+                            METRICS_SECT_COUNT(mtcr_metrics), "mtcr");
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = metrics_set_ring(&ev.hdr, 0, &rssi_ring, rssi_buf, 4,
+                          METRICS_RING_LAST, 1);
+    TEST_ASSERT(rc != 0);
+
+    rc = metrics_set_ring(&ev.hdr, 1, &rssi_ring, rssi_buf, 4,
+                          METRICS_RING_LAST, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = metrics_set_ring(&ev.hdr, 2, &load_ring, load_buf, 2,
+                          METRICS_RING_AVG, 2);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** A full ring keeps the newest values. */
+    for (i = 1; i <= 6; i++) {
+        rc = metrics_set_value(&ev.hdr, 1, -i);
+        TEST_ASSERT(rc == 0);
+    }
+    TEST_ASSERT_FATAL(metrics_test_series(&ev.hdr, "rssi", vals, 8) == 4);
+    for (i = 0; i < 4; i++) {
+        TEST_ASSERT(vals[i] == -3 - i);
+    }
+
+    /*** Slots reduce per_slot values; the last one may hold fewer. */
+    for (i = 1; i <= 5; i++) {
+        metrics_set_value(&ev.hdr, 2, i * 10);
+    }
+    TEST_ASSERT_FATAL(metrics_test_series(&ev.hdr, "load", vals, 8) == 2);
+    TEST_ASSERT(vals[0] == 35);
+    TEST_ASSERT(vals[1] == 50);
+
+    /*** Encoding fails if the ring doesn't fit in the mbuf chain. */
+    rc = os_mempool_init(&mtcr_mbuf_mpool, 1, MTCR_MBUF_SZ, mtcr_mbuf_mem,
+                         "mtcr");
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_mbuf_pool_init(&mtcr_mbuf_pool, &mtcr_mbuf_mpool, MTCR_MBUF_SZ,
+                           1);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    om = os_mbuf_get_pkthdr(&mtcr_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+
+    /*
+     * Only the load ring is encoded, and room is left for the event up to
+     * the ring contents:
+     *     map(1) "ev"(3) "mtcr"(5) "ts"(3) 0(1) "load"(5) array(1)
+     * One byte is left, too few for 35(2).
+     */
+    metrics_clr_state_mask(&ev.hdr, UINT32_MAX);
+    metrics_set_state(&ev.hdr, 2, true);
+    TEST_ASSERT_FATAL(os_mbuf_extend(om, OS_MBUF_TRAILINGSPACE(om) - 20) !=
+                      NULL);
+
+    rc = metrics_event_to_cbor(&ev.hdr, om);
+    TEST_ASSERT(rc != 0);
+
+    /* The failed encoding freed the mbuf. */
+    om = os_mbuf_get_pkthdr(&mtcr_mbuf_pool, 0);
+    TEST_ASSERT(om != NULL);
+    os_mbuf_free_chain(om);
+}
@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "metrics_test.h"
+
+#if MYNEWT_VAL(METRICS_STAGING)
+
+METRICS_SECT_START(mtcs_metrics)
+    METRICS_SECT_ENTRY(speed, METRICS_TYPE_SINGLE_U)
+    METRICS_SECT_ENTRY(hops, METRICS_TYPE_SERIES_U16)
+METRICS_SECT_END;
+
+METRICS_EVENT_DECLARE(mtcs_event, mtcs_metrics);
+
+TEST_CASE(metrics_test_case_stage)
+{
+    static struct metrics_stage stage;
+    static struct metrics_sample samples[4];
+    static struct mtcs_event ev;
+    struct metrics_stage other;
+    int64_t vals[8];
+    int rc;
+    int i;
+
+    rc = metrics_event_init(&ev.hdr, mtcs_metrics,
+                            METRICS_SECT_COUNT(mtcs_metrics), "mtcs");
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = metrics_event_set_stage(&ev.hdr, &stage, samples, 4);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = metrics_event_set_stage(&ev.hdr, &other, samples, 4);
+    TEST_ASSERT(rc != 0);
+
+    /*** Operations are only queued until applied. */
+    rc = metrics_event_start(&ev.hdr, 10);
+    TEST_ASSERT(rc == 0);
+    rc = metrics_set_value(&ev.hdr, 0, 1);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ev.hdr.timestamp == 0);
+    TEST_ASSERT(ev.hdr.set == 0);
+
+    metrics_flush();
+    TEST_ASSERT(ev.hdr.timestamp == 10);
+    TEST_ASSERT(metrics_test_single(&ev.hdr, "speed") == 1);
+    TEST_ASSERT(metrics_test_series(&ev.hdr, "hops", vals, 8) == -1);
+
+    /*** Operations are applied in the order they were queued. */
+    metrics_set_value(&ev.hdr, 1, 5);
+    metrics_set_value(&ev.hdr, 1, 6);
+    metrics_set_value(&ev.hdr, 0, 2);
+    metrics_flush();
+    TEST_ASSERT(metrics_test_single(&ev.hdr, "speed") == 2);
+    TEST_ASSERT_FATAL(metrics_test_series(&ev.hdr, "hops", vals, 8) == 2);
+    TEST_ASSERT(vals[0] == 5 && vals[1] == 6);
+
+    /* Starting an event drops the data of the previous one. */
+    metrics_event_start(&ev.hdr, 20);
+    metrics_set_value(&ev.hdr, 0, 3);
+    metrics_flush();
+    TEST_ASSERT(ev.hdr.timestamp == 20);
+    TEST_ASSERT(metrics_test_single(&ev.hdr, "speed") == 3);
+    TEST_ASSERT(metrics_test_series(&ev.hdr, "hops", vals, 8) == -1);
+
+    /*** Operations which don't fit are dropped and counted; one slot of
+     * the ring is always left unused.
+     */
+    for (i = 0; i < 5; i++) {
+        rc = metrics_set_value(&ev.hdr, 1, 100 + i);
+        TEST_ASSERT(rc == (i < 3 ? 0 : -1));
+    }
+    TEST_ASSERT(stage.dropped == 2);
+
+    metrics_flush();
+    TEST_ASSERT_FATAL(metrics_test_series(&ev.hdr, "hops", vals, 8) == 3);
+    for (i = 0; i < 3; i++) {
+        TEST_ASSERT(vals[i] == 100 + i);
+    }
+
+    /* Applied operations free their slots. */
+    rc = metrics_set_value(&ev.hdr, 1, 110);
+    TEST_ASSERT(rc == 0);
+    metrics_flush();
+    TEST_ASSERT_FATAL(metrics_test_series(&ev.hdr, "hops", vals, 8) == 4);
+    TEST_ASSERT(vals[3] == 110);
+    TEST_ASSERT(stage.dropped == 2);
+}
+
+#else
+
+TEST_CASE(metrics_test_case_stage)
+{
+}
+
+#endif
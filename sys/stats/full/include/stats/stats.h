@@ -36,7 +36,7 @@ struct stats_hdr {
     char *s_name;
     uint8_t s_size;
     uint8_t s_cnt;
-    uint16_t s_pad1;
+    uint16_t s_flags;
 #if MYNEWT_VAL(STATS_NAMES)
     const struct stats_name_map *s_map;
     int s_map_cnt;
@@ -44,6 +44,9 @@ struct stats_hdr {
     STAILQ_ENTRY(stats_hdr) s_next;
 };
 
+/* The section is the header of a struct stats_hist. */
+#define STATS_HDR_F_HIST    0x0001
+
 #define STATS_SECT_DECL(__name)             \
     struct stats_ ## __name
 
@@ -130,6 +133,169 @@ int stats_group_walk(stats_group_walk_func_t, void *);
 
 struct stats_hdr *stats_group_find(char *name);
 
+/**
+ * A histogram of unsigned 32-bit samples (e.g. latencies), with log-linear
+ * buckets.
+ *
+ * Values below 2^sub_bits each get a bucket of their own.  Above that, every
+ * power of two range is split into 2^sub_bits equal buckets, so the relative
+ * error of a reported value is below 2^-sub_bits.  Values past the last
+ * bucket are counted in it.
+ *
+ * The histogram is registered as a statistics section whose entries are a
+ * summary of the recorded samples: count, min, max, p50, p90 and p99.  The
+ * summary is computed from the buckets when the section is read through
+ * stats_walk(), so all statistics readers (shell, newtmgr, snapshots) report
+ * it without special handling.
+ *
+ * Recording a sample takes no lock; like the STATS_INC() counters, a sample
+ * recorded concurrently with another one may rarely be lost.
+ */
+struct stats_hist {
+    struct stats_hdr sh_hdr;
+
+    /* Summary; only valid after a stats_walk(). */
+    uint32_t sh_count;
+    uint32_t sh_min;
+    uint32_t sh_max;
+    uint32_t sh_p50;
+    uint32_t sh_p90;
+    uint32_t sh_p99;
+
+    uint32_t *sh_buckets;
+    uint16_t sh_bucket_cnt;
+    uint8_t sh_sub_bits;
+
+    /* Extremes of the recorded samples. */
+    uint32_t sh_lo;
+    uint32_t sh_hi;
+};
+
+/**
+ * The number of buckets a histogram needs to resolve every value below
+ * 2^max_bits, with the specified number of sub-bucket bits.
+ */
+#define STATS_HIST_BUCKET_CNT(__sub_bits, __max_bits)                       \
+    (((__max_bits) - (__sub_bits) + 1) << (__sub_bits))
+
+/**
+ * Initializes a histogram.
+ *
+ * @param hist The histogram to initialize.
+ * @param buckets The bucket counters; zeroed here.
+ * @param bucket_cnt The number of bucket counters; nonzero.
+ * @param sub_bits log2 of the number of buckets per power of two; 0 to 7.
+ *
+ * @return 0 on success; SYS_EINVAL on bad arguments.
+ */
+int stats_hist_init(struct stats_hist *hist, uint32_t *buckets,
+                    uint16_t bucket_cnt, uint8_t sub_bits);
+
+/**
+ * Initializes a histogram and registers it as a statistics section.
+ */
+int stats_hist_init_and_reg(struct stats_hist *hist, uint32_t *buckets,
+                            uint16_t bucket_cnt, uint8_t sub_bits,
+                            char *name);
+
+/**
+ * Adds a sample to a histogram.  Safe to call from interrupt context.
+ */
+void stats_hist_record(struct stats_hist *hist, uint32_t val);
+
+/**
+ * Computes a percentile of the recorded samples.  The result is the upper
+ * bound of the bucket holding it, capped by the largest recorded sample.
+ *
+ * @param pct The percentile, 0 to 100.
+ *
+ * @return The percentile; 0 if the histogram is empty.
+ */
+uint32_t stats_hist_percentile(const struct stats_hist *hist, uint8_t pct);
+
+/**
+ * Discards the samples recorded in a histogram.
+ */
+void stats_hist_reset(struct stats_hist *hist);
+
+/* Private */
+void stats_hist_update(struct stats_hist *hist);
+
+#if MYNEWT_VAL(STATS_SNAPSHOT)
+/**
+ * A copy of the values of all registered statistics, taken in one pass.
+ *
+ * The buffer is supplied by the caller.  For each group, it holds a pointer
+ * to the group's header followed by the raw values of its entries, so it
+ * needs a little more than the combined size of all statistics sections.
+ * It must be pointer aligned.
+ */
+struct stats_snapshot {
+    uint8_t *ss_buf;
+    uint16_t ss_buf_len;
+
+    /* Bytes of ss_buf in use; 0 if no snapshot has been taken. */
+    uint16_t ss_len;
+
+    /* Identifies the snapshot; unique among the snapshots taken since
+     * startup, never 0.
+     */
+    uint32_t ss_gen;
+};
+
+/**
+ * Initializes a snapshot with the specified buffer.
+ */
+void stats_snapshot_init(struct stats_snapshot *snap, void *buf,
+                         uint16_t buf_len);
+
+/**
+ * Captures the values of all registered statistics into a snapshot.
+ *
+ * Each group is copied with interrupts disabled, so its values are
+ * consistent with one another.
+ *
+ * @return 0 on success; SYS_ENOMEM if the buffer is too small, in which case
+ *         the snapshot is left empty.
+ */
+int stats_snapshot_take(struct stats_snapshot *snap);
+
+/**
+ * Calls walk_func for each statistic whose value differs from the one in
+ * the specified snapshot.  Groups are compared as a whole first, so
+ * unchanged groups cost a single memcmp.
+ *
+ * @param prev The snapshot to compare against.  If NULL or empty, or for
+ *             groups registered after it was taken, every statistic is
+ *             reported.
+ *
+ * @return 0 on success, the return code of the walk_func on abort.
+ */
+int stats_snapshot_delta(const struct stats_snapshot *prev,
+                         stats_walk_func_t walk_func, void *arg);
+
+struct CborEncoder;
+
+/**
+ * Encodes the statistics of a snapshot which differ from an earlier one, as
+ * a CBOR map of group names to maps of statistic names to values.
+ * Unchanged groups are omitted.
+ *
+ * The values are those stored in the snapshot, so that the snapshot can
+ * serve as the baseline of the next delta without missing updates made
+ * while encoding.
+ *
+ * @param enc The encoder (a map) to add the entries to.
+ * @param cur The snapshot to encode.
+ * @param prev The snapshot to compare against; NULL to encode everything.
+ *
+ * @return 0 on success, nonzero CBOR error on failure.
+ */
+int stats_snapshot_encode(struct CborEncoder *enc,
+                          const struct stats_snapshot *cur,
+                          const struct stats_snapshot *prev);
+#endif
+
 /* Private */
 #if MYNEWT_VAL(STATS_NEWTMGR)
 int stats_nmgr_register_group(void);
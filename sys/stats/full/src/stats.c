@@ -109,6 +109,11 @@ stats_walk(struct stats_hdr *hdr, stats_walk_func_t walk_func, void *arg)
     int i;
 #endif
 
+    /* A histogram's entries summarize its buckets; bring them up to date. */
+    if (hdr->s_flags & STATS_HDR_F_HIST) {
+        stats_hist_update((struct stats_hist *)hdr);
+    }
+
     cur = sizeof(*hdr);
     end = sizeof(*hdr) + (hdr->s_size * hdr->s_cnt);
 
@@ -217,6 +222,7 @@ stats_init(struct stats_hdr *shdr, uint8_t size, uint8_t cnt,
 
     shdr->s_size = size;
     shdr->s_cnt = cnt;
+    shdr->s_flags = 0;
 #if MYNEWT_VAL(STATS_NAMES)
     shdr->s_map = map;
     shdr->s_map_cnt = map_cnt;
@@ -361,6 +367,11 @@ stats_reset(struct stats_hdr *hdr)
     uint16_t end;
     void *stat_val;
 
+    if (hdr->s_flags & STATS_HDR_F_HIST) {
+        stats_hist_reset((struct stats_hist *)hdr);
+        return;
+    }
+
     cur = sizeof(*hdr);
     end = sizeof(*hdr) + (hdr->s_size * hdr->s_cnt);
 
@@ -0,0 +1,268 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include <stddef.h>
+
+#include "os/mynewt.h"
+#include "stats/stats.h"
+
+#define STATS_HIST_MAX_SUB_BITS     7
+
+#if MYNEWT_VAL(STATS_NAMES)
+static const struct stats_name_map stats_hist_map[] = {
+    { offsetof(struct stats_hist, sh_count), "count" },
+    { offsetof(struct stats_hist, sh_min), "min" },
+    { offsetof(struct stats_hist, sh_max), "max" },
+    { offsetof(struct stats_hist, sh_p50), "p50" },
+    { offsetof(struct stats_hist, sh_p90), "p90" },
+    { offsetof(struct stats_hist, sh_p99), "p99" },
+};
+#define STATS_HIST_MAP_PARMS                                                \
+    stats_hist_map, sizeof(stats_hist_map) / sizeof(stats_hist_map[0])
+#else
+#define STATS_HIST_MAP_PARMS NULL, 0
+#endif
+
+/* Number of summary entries following the histogram's header. */
+#define STATS_HIST_SUMMARY_CNT                                              \
+    ((offsetof(struct stats_hist, sh_p99) + sizeof(uint32_t) -              \
+      offsetof(struct stats_hist, sh_count)) / sizeof(uint32_t))
+
+/**
+ * Maps a value to its bucket, before clamping to the bucket count.
+ */
+static uint32_t
+stats_hist_bucket(uint8_t sub_bits, uint32_t val)
+{
+    uint32_t sub_cnt;
+    int shift;
+
+    sub_cnt = 1 << sub_bits;
+    if (val < sub_cnt) {
+        return val;
+    }
+
+    /* Position of the most significant bit, relative to the sub-bucket
+     * bits.  The bits below those are dropped.
+     */
+    shift = 31 - __builtin_clz(val) - sub_bits;
+
+    return ((shift + 1) << sub_bits) + ((val >> shift) & (sub_cnt - 1));
+}
+
+/**
+ * Returns the largest value which maps to the specified bucket.
+ */
+static uint32_t
+stats_hist_bucket_max(uint8_t sub_bits, uint32_t idx)
+{
+    uint32_t sub_cnt;
+    uint32_t lo;
+    int shift;
+
+    sub_cnt = 1 << sub_bits;
+    if (idx < sub_cnt) {
+        return idx;
+    }
+
+    shift = (idx >> sub_bits) - 1;
+    lo = (sub_cnt + (idx & (sub_cnt - 1))) << shift;
+
+    return lo + ((1UL << shift) - 1);
+}
+
+int
+stats_hist_init(struct stats_hist *hist, uint32_t *buckets,
+                uint16_t bucket_cnt, uint8_t sub_bits)
+{
+    int rc;
+
+    if (buckets == NULL || bucket_cnt == 0 ||
+        sub_bits > STATS_HIST_MAX_SUB_BITS) {
+        return SYS_EINVAL;
+    }
+
+    rc = stats_init(&hist->sh_hdr, STATS_SIZE_32, STATS_HIST_SUMMARY_CNT,
+                    STATS_HIST_MAP_PARMS);
+    if (rc != 0) {
+        return rc;
+    }
+
+    hist->sh_hdr.s_flags |= STATS_HDR_F_HIST;
+    hist->sh_buckets = buckets;
+    hist->sh_bucket_cnt = bucket_cnt;
+    hist->sh_sub_bits = sub_bits;
+    stats_hist_reset(hist);
+
+    return 0;
+}
+
+int
+stats_hist_init_and_reg(struct stats_hist *hist, uint32_t *buckets,
+                        uint16_t bucket_cnt, uint8_t sub_bits, char *name)
+{
+    int rc;
+
+    rc = stats_hist_init(hist, buckets, bucket_cnt, sub_bits);
+    if (rc != 0) {
+        return rc;
+    }
+
+    return stats_register(name, &hist->sh_hdr);
+}
+
+void
+stats_hist_record(struct stats_hist *hist, uint32_t val)
+{
+    uint32_t idx;
+
+    idx = stats_hist_bucket(hist->sh_sub_bits, val);
+    if (idx >= hist->sh_bucket_cnt) {
+        idx = hist->sh_bucket_cnt - 1;
+    }
+
+    /* A single word increment, as with STATS_INC(); the extremes only ever
+     * move outwards, so a racing update is at worst undone by one sample.
+     */
+    hist->sh_buckets[idx]++;
+    if (val < hist->sh_lo) {
+        hist->sh_lo = val;
+    }
+    if (val > hist->sh_hi) {
+        hist->sh_hi = val;
+    }
+}
+
+/**
+ * Finds the value of the sample with the specified rank (1 being the
+ * smallest).
+ */
+static uint32_t
+stats_hist_value_at(const struct stats_hist *hist, uint32_t rank)
+{
+    uint32_t total;
+    uint32_t val;
+    uint16_t i;
+
+    total = 0;
+    for (i = 0; i < hist->sh_bucket_cnt; i++) {
+        total += hist->sh_buckets[i];
+        if (total >= rank) {
+            break;
+        }
+    }
+
+    /* The last bucket also holds the values past its range; only the
+     * largest sample bounds those.
+     */
+    if (i >= hist->sh_bucket_cnt - 1) {
+        return hist->sh_hi;
+    }
+
+    val = stats_hist_bucket_max(hist->sh_sub_bits, i);
+    if (val > hist->sh_hi) {
+        val = hist->sh_hi;
+    }
+    if (val < hist->sh_lo) {
+        val = hist->sh_lo;
+    }
+
+    return val;
+}
+
+static uint32_t
+stats_hist_count(const struct stats_hist *hist)
+{
+    uint32_t count;
+    uint16_t i;
+
+    count = 0;
+    for (i = 0; i < hist->sh_bucket_cnt; i++) {
+        count += hist->sh_buckets[i];
+    }
+
+    return count;
+}
+
+static uint32_t
+stats_hist_rank(uint32_t count, uint8_t pct)
+{
+    uint32_t rank;
+
+    rank = ((uint64_t)count * pct + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    return rank;
+}
+
+uint32_t
+stats_hist_percentile(const struct stats_hist *hist, uint8_t pct)
+{
+    uint32_t count;
+
+    if (pct > 100) {
+        pct = 100;
+    }
+
+    count = stats_hist_count(hist);
+    if (count == 0) {
+        return 0;
+    }
+
+    return stats_hist_value_at(hist, stats_hist_rank(count, pct));
+}
+
+void
+stats_hist_reset(struct stats_hist *hist)
+{
+    memset(hist->sh_buckets, 0, hist->sh_bucket_cnt * sizeof(uint32_t));
+    memset(&hist->sh_count, 0, STATS_HIST_SUMMARY_CNT * sizeof(uint32_t));
+    hist->sh_lo = UINT32_MAX;
+    hist->sh_hi = 0;
+}
+
+/**
+ * Recomputes the summary entries of a histogram.  Called whenever the
+ * histogram is read as a statistics section.
+ */
+void
+stats_hist_update(struct stats_hist *hist)
+{
+    uint32_t count;
+
+    count = stats_hist_count(hist);
+    hist->sh_count = count;
+    if (count == 0) {
+        hist->sh_min = 0;
+        hist->sh_max = 0;
+        hist->sh_p50 = 0;
+        hist->sh_p90 = 0;
+        hist->sh_p99 = 0;
+        return;
+    }
+
+    hist->sh_min = hist->sh_lo;
+    hist->sh_max = hist->sh_hi;
+    hist->sh_p50 = stats_hist_value_at(hist, stats_hist_rank(count, 50));
+    hist->sh_p90 = stats_hist_value_at(hist, stats_hist_rank(count, 90));
+    hist->sh_p99 = stats_hist_value_at(hist, stats_hist_rank(count, 99));
+}
@@ -33,20 +33,51 @@
  */
 static int stats_nmgr_read(struct mgmt_cbuf *cb);
 static int stats_nmgr_list(struct mgmt_cbuf *cb);
+#if MYNEWT_VAL(STATS_SNAPSHOT)
+static int stats_nmgr_delta(struct mgmt_cbuf *cb);
+#endif
 
 static struct mgmt_group shell_nmgr_group;
 
 #define STATS_NMGR_ID_READ  (0)
 #define STATS_NMGR_ID_LIST  (1)
+#define STATS_NMGR_ID_DELTA (2)
 
 /* ORDER MATTERS HERE.
  * Each element represents the command ID, referenced from newtmgr.
  */
 static struct mgmt_handler shell_nmgr_group_handlers[] = {
     [STATS_NMGR_ID_READ] = {stats_nmgr_read, stats_nmgr_read},
-    [STATS_NMGR_ID_LIST] = {stats_nmgr_list, stats_nmgr_list}
+    [STATS_NMGR_ID_LIST] = {stats_nmgr_list, stats_nmgr_list},
+#if MYNEWT_VAL(STATS_SNAPSHOT)
+    [STATS_NMGR_ID_DELTA] = {stats_nmgr_delta, stats_nmgr_delta},
+#endif
 };
 
+#if MYNEWT_VAL(STATS_SNAPSHOT)
+#define STATS_NMGR_SNAP_BUF_WORDS                                           \
+    ((MYNEWT_VAL(STATS_SNAPSHOT_NMGR_BUF_SIZE) + sizeof(uintptr_t) - 1) /   \
+     sizeof(uintptr_t))
+
+/* Values last reported by the delta command, and the snapshot the next
+ * response is built from; the two swap roles after each response.
+ */
+static uintptr_t stats_nmgr_snap_buf[2][STATS_NMGR_SNAP_BUF_WORDS];
+static struct stats_snapshot stats_nmgr_snap[2] = {
+    {
+        .ss_buf = (uint8_t *)stats_nmgr_snap_buf[0],
+        .ss_buf_len = sizeof(stats_nmgr_snap_buf[0]),
+    },
+    {
+        .ss_buf = (uint8_t *)stats_nmgr_snap_buf[1],
+        .ss_buf_len = sizeof(stats_nmgr_snap_buf[1]),
+    },
+};
+
+/* Index of the snapshot last reported. */
+static uint8_t stats_nmgr_snap_last;
+#endif
+
 static int
 stats_nmgr_walk_func(struct stats_hdr *hdr, void *arg, char *sname,
         uint16_t stat_off)
@@ -151,6 +182,75 @@ stats_nmgr_list(struct mgmt_cbuf *cb)
     return (0);
 }
 
+#if MYNEWT_VAL(STATS_SNAPSHOT)
+/**
+ * Reports the statistics which changed since the previous delta request.
+ *
+ * The request carries the "gen" returned by the previous response.  If it
+ * matches the last snapshot taken here, only changed statistics are returned;
+ * otherwise (first request, another collector polled in between, or the
+ * device rebooted) all of them are, with "full" set.
+ *
+ * The response is encoded from a snapshot, which becomes the baseline of the
+ * next request, so updates made while encoding are reported next time.
+ */
+static int
+stats_nmgr_delta(struct mgmt_cbuf *cb)
+{
+    const struct stats_snapshot *prev;
+    struct stats_snapshot *cur;
+    uint64_t gen;
+    struct cbor_attr_t attrs[] = {
+        { "gen", CborAttrUnsignedIntegerType, .addr.uinteger = &gen },
+        { NULL },
+    };
+    CborError g_err = CborNoError;
+    CborEncoder groups;
+    int rc;
+
+    gen = 0;
+    g_err = cbor_read_object(&cb->it, attrs);
+    if (g_err != 0) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    prev = &stats_nmgr_snap[stats_nmgr_snap_last];
+    if (gen == 0 || gen != prev->ss_gen) {
+        prev = NULL;
+    }
+
+    cur = &stats_nmgr_snap[!stats_nmgr_snap_last];
+    rc = stats_snapshot_take(cur);
+    if (rc != 0) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, MGMT_ERR_EOK);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "full");
+    g_err |= cbor_encode_boolean(&cb->encoder, prev == NULL);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "groups");
+    g_err |= cbor_encoder_create_map(&cb->encoder, &groups,
+                                     CborIndefiniteLength);
+    g_err |= stats_snapshot_encode(&groups, cur, prev);
+    g_err |= cbor_encoder_close_container(&cb->encoder, &groups);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "gen");
+    g_err |= cbor_encode_uint(&cb->encoder, cur->ss_gen);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    /* Only a response that made it out becomes the new baseline. */
+    stats_nmgr_snap_last = !stats_nmgr_snap_last;
+
+    return (0);
+}
+#endif
+
 /**
  * Register nmgr group handlers
  */
@@ -0,0 +1,338 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(STATS_SNAPSHOT)
+
+#include "tinycbor/cbor.h"
+#include "stats/stats.h"
+
+/* Header of each group's record in a snapshot buffer; followed by the raw
+ * values of the group's statistics.  Records are pointer aligned.
+ */
+struct stats_snapshot_rec {
+    const struct stats_hdr *ssr_hdr;
+    uint16_t ssr_len;
+};
+
+#define STATS_SNAPSHOT_REC_SIZE(__len)                              \
+    OS_ALIGN(sizeof(struct stats_snapshot_rec) + (__len), sizeof(void *))
+
+static uint32_t stats_snapshot_next_gen;
+
+/* Position in a snapshot, in registry order. */
+struct stats_snapshot_cursor {
+    const struct stats_snapshot *ssc_snap;
+    uint16_t ssc_off;
+};
+
+struct stats_snapshot_take_arg {
+    struct stats_snapshot *snap;
+    uint16_t off;
+};
+
+struct stats_snapshot_delta_arg {
+    struct stats_snapshot_cursor cur;
+
+    /* Previous values of the group being walked; NULL if none. */
+    const uint8_t *prev_vals;
+
+    /* Values of the group to compare and report; NULL for the live ones. */
+    const uint8_t *cur_vals;
+
+    stats_walk_func_t walk_func;
+    void *arg;
+};
+
+void
+stats_snapshot_init(struct stats_snapshot *snap, void *buf, uint16_t buf_len)
+{
+    memset(snap, 0, sizeof(*snap));
+    snap->ss_buf = buf;
+    snap->ss_buf_len = buf_len;
+}
+
+static int
+stats_snapshot_take_group(struct stats_hdr *hdr, void *arg)
+{
+    struct stats_snapshot_take_arg *sta;
+    struct stats_snapshot_rec *rec;
+    uint16_t len;
+    os_sr_t sr;
+
+    sta = arg;
+    len = hdr->s_size * hdr->s_cnt;
+
+    if (sta->off + STATS_SNAPSHOT_REC_SIZE(len) > sta->snap->ss_buf_len) {
+        return SYS_ENOMEM;
+    }
+
+    rec = (struct stats_snapshot_rec *)(sta->snap->ss_buf + sta->off);
+    rec->ssr_hdr = hdr;
+    rec->ssr_len = len;
+
+    if (hdr->s_flags & STATS_HDR_F_HIST) {
+        stats_hist_update((struct stats_hist *)hdr);
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    memcpy(rec + 1, hdr + 1, len);
+    OS_EXIT_CRITICAL(sr);
+
+    sta->off += STATS_SNAPSHOT_REC_SIZE(len);
+
+    return 0;
+}
+
+int
+stats_snapshot_take(struct stats_snapshot *snap)
+{
+    struct stats_snapshot_take_arg sta;
+    int rc;
+
+    sta.snap = snap;
+    sta.off = 0;
+
+    rc = stats_group_walk(stats_snapshot_take_group, &sta);
+    if (rc != 0) {
+        snap->ss_len = 0;
+        snap->ss_gen = 0;
+        return rc;
+    }
+
+    snap->ss_len = sta.off;
+    if (++stats_snapshot_next_gen == 0) {
+        ++stats_snapshot_next_gen;
+    }
+    snap->ss_gen = stats_snapshot_next_gen;
+
+    return 0;
+}
+
+/**
+ * Retrieves the values of a group in a snapshot.  Groups are only ever
+ * appended to the registry, so a cursor advancing in registry order finds
+ * them in one pass.
+ *
+ * @return The group's values; NULL if the group is not in the snapshot.
+ */
+static const uint8_t *
+stats_snapshot_find(struct stats_snapshot_cursor *cur,
+                    const struct stats_hdr *hdr)
+{
+    const struct stats_snapshot_rec *rec;
+
+    if (cur->ssc_snap == NULL || cur->ssc_off >= cur->ssc_snap->ss_len) {
+        return NULL;
+    }
+
+    rec = (const struct stats_snapshot_rec *)
+        (cur->ssc_snap->ss_buf + cur->ssc_off);
+    if (rec->ssr_hdr != hdr || rec->ssr_len != hdr->s_size * hdr->s_cnt) {
+        return NULL;
+    }
+
+    cur->ssc_off += STATS_SNAPSHOT_REC_SIZE(rec->ssr_len);
+
+    return (const uint8_t *)(rec + 1);
+}
+
+static int
+stats_snapshot_delta_entry(struct stats_hdr *hdr, void *arg, char *name,
+                           uint16_t stat_off)
+{
+    struct stats_snapshot_delta_arg *sda;
+    const uint8_t *val;
+
+    sda = arg;
+
+    if (sda->cur_vals != NULL) {
+        val = sda->cur_vals + stat_off - sizeof(*hdr);
+    } else {
+        val = (uint8_t *)hdr + stat_off;
+    }
+
+    if (sda->prev_vals != NULL &&
+        memcmp(val, sda->prev_vals + stat_off - sizeof(*hdr),
+               hdr->s_size) == 0) {
+        return 0;
+    }
+
+    return sda->walk_func(hdr, sda->arg, name, stat_off);
+}
+
+/**
+ * Looks up a group in the snapshot being compared against.
+ *
+ * @return 1 if the group changed since the snapshot (or is not in it); 0 if
+ *         not.
+ */
+static int
+stats_snapshot_group_changed(struct stats_hdr *hdr,
+                             struct stats_snapshot_delta_arg *sda)
+{
+    sda->prev_vals = stats_snapshot_find(&sda->cur, hdr);
+
+    if (hdr->s_flags & STATS_HDR_F_HIST) {
+        stats_hist_update((struct stats_hist *)hdr);
+    }
+
+    return sda->prev_vals == NULL ||
+           memcmp(hdr + 1, sda->prev_vals, hdr->s_size * hdr->s_cnt) != 0;
+}
+
+static int
+stats_snapshot_delta_group(struct stats_hdr *hdr, void *arg)
+{
+    struct stats_snapshot_delta_arg *sda;
+
+    sda = arg;
+
+    if (!stats_snapshot_group_changed(hdr, sda)) {
+        return 0;
+    }
+
+    return stats_walk(hdr, stats_snapshot_delta_entry, sda);
+}
+
+int
+stats_snapshot_delta(const struct stats_snapshot *prev,
+                     stats_walk_func_t walk_func, void *arg)
+{
+    struct stats_snapshot_delta_arg sda;
+
+    sda.cur.ssc_snap = prev;
+    sda.cur.ssc_off = 0;
+    sda.cur_vals = NULL;
+    sda.walk_func = walk_func;
+    sda.arg = arg;
+
+    return stats_group_walk(stats_snapshot_delta_group, &sda);
+}
+
+struct stats_snapshot_encode_arg {
+    struct stats_snapshot_delta_arg sda;
+    CborEncoder *enc;
+};
+
+/**
+ * Encodes one statistic, with its value from the snapshot being encoded.
+ */
+static int
+stats_snapshot_encode_entry(struct stats_hdr *hdr, void *arg, char *sname,
+                            uint16_t stat_off)
+{
+    struct stats_snapshot_encode_arg *sea;
+    CborError g_err = CborNoError;
+    const void *stat_val;
+
+    sea = arg;
+    stat_val = sea->sda.cur_vals + stat_off - sizeof(*hdr);
+
+    g_err |= cbor_encode_text_stringz(sea->enc, sname);
+
+    switch (hdr->s_size) {
+        case sizeof(uint16_t):
+            g_err |= cbor_encode_uint(sea->enc,
+                                      *(const uint16_t *) stat_val);
+            break;
+        case sizeof(uint32_t):
+            g_err |= cbor_encode_uint(sea->enc,
+                                      *(const uint32_t *) stat_val);
+            break;
+        case sizeof(uint64_t):
+            g_err |= cbor_encode_uint(sea->enc,
+                                      *(const uint64_t *) stat_val);
+            break;
+    }
+
+    return (g_err);
+}
+
+/**
+ * Encodes the statistics of a group which changed between the two
+ * snapshots.
+ */
+static int
+stats_snapshot_encode_group(const struct stats_snapshot_rec *rec,
+                            struct stats_snapshot_encode_arg *sea)
+{
+    struct stats_hdr *hdr;
+    CborError g_err = CborNoError;
+    CborEncoder *groups;
+    CborEncoder fields;
+
+    /* The walk only uses the header for the entry names and offsets; the
+     * values come from the snapshot.
+     */
+    hdr = (struct stats_hdr *)rec->ssr_hdr;
+
+    sea->sda.cur_vals = (const uint8_t *)(rec + 1);
+    sea->sda.prev_vals = stats_snapshot_find(&sea->sda.cur, hdr);
+    if (sea->sda.prev_vals != NULL &&
+        memcmp(sea->sda.cur_vals, sea->sda.prev_vals, rec->ssr_len) == 0) {
+        return 0;
+    }
+
+    groups = sea->enc;
+    g_err |= cbor_encode_text_stringz(groups, hdr->s_name);
+    g_err |= cbor_encoder_create_map(groups, &fields, CborIndefiniteLength);
+
+    sea->enc = &fields;
+    g_err |= stats_walk(hdr, stats_snapshot_delta_entry, &sea->sda);
+    sea->enc = groups;
+
+    g_err |= cbor_encoder_close_container(groups, &fields);
+
+    return (g_err);
+}
+
+int
+stats_snapshot_encode(struct CborEncoder *enc,
+                      const struct stats_snapshot *cur,
+                      const struct stats_snapshot *prev)
+{
+    const struct stats_snapshot_rec *rec;
+    struct stats_snapshot_encode_arg sea;
+    uint16_t off;
+    int rc;
+
+    sea.sda.cur.ssc_snap = prev;
+    sea.sda.cur.ssc_off = 0;
+    sea.sda.walk_func = stats_snapshot_encode_entry;
+    sea.sda.arg = &sea;
+    sea.enc = enc;
+
+    off = 0;
+    while (off < cur->ss_len) {
+        rec = (const struct stats_snapshot_rec *)(cur->ss_buf + off);
+        rc = stats_snapshot_encode_group(rec, &sea);
+        if (rc != 0) {
+            return rc;
+        }
+        off += STATS_SNAPSHOT_REC_SIZE(rec->ssr_len);
+    }
+
+    return 0;
+}
+
+#endif /* MYNEWT_VAL(STATS_SNAPSHOT) */
@@ -0,0 +1,66 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#include "stats_test.h"
+
+int
+stats_test_sum_walk(struct stats_hdr *hdr, void *arg, char *name,
+                    uint16_t off)
+{
+    uint64_t *sum;
+
+    sum = arg;
+    switch (hdr->s_size) {
+    case sizeof(uint16_t):
+        *sum += *(uint16_t *)((uint8_t *)hdr + off);
+        break;
+    case sizeof(uint32_t):
+        *sum += *(uint32_t *)((uint8_t *)hdr + off);
+        break;
+    case sizeof(uint64_t):
+        *sum += *(uint64_t *)((uint8_t *)hdr + off);
+        break;
+    }
+
+    return 0;
+}
+
+TEST_CASE_DECL(stats_test_case_hist)
+TEST_CASE_DECL(stats_test_case_snapshot)
+
+TEST_SUITE(stats_test_all)
+{
+    stats_test_case_hist();
+    stats_test_case_snapshot();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    stats_test_all();
+
+    return tu_any_failed;
+}
+#endif
@@ -0,0 +1,133 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "stats_test.h"
+
+STATS_SECT_START(stats_test_plain)
+    STATS_SECT_ENTRY(a)
+    STATS_SECT_ENTRY(b)
+STATS_SECT_END
+
+TEST_CASE(stats_test_case_hist)
+{
+    STATS_SECT_DECL(stats_test_plain) plain;
+    uint32_t buckets[STATS_HIST_BUCKET_CNT(7, 8)];
+    struct stats_hist hist;
+    uint64_t sum;
+    uint32_t i;
+    int rc;
+
+    /*** Bad arguments. */
+    rc = stats_hist_init(&hist, NULL, 4, 2);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    rc = stats_hist_init(&hist, buckets, 0, 2);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    rc = stats_hist_init(&hist, buckets, 4, 8);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    /*** Values below 2^sub_bits are exact. */
+    rc = stats_hist_init(&hist, buckets, STATS_HIST_BUCKET_CNT(7, 8), 7);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stats_hist_percentile(&hist, 50) == 0);
+
+    for (i = 1; i <= 100; i++) {
+        stats_hist_record(&hist, i);
+    }
+    TEST_ASSERT(stats_hist_percentile(&hist, 0) == 1);
+    TEST_ASSERT(stats_hist_percentile(&hist, 50) == 50);
+    TEST_ASSERT(stats_hist_percentile(&hist, 90) == 90);
+    TEST_ASSERT(stats_hist_percentile(&hist, 99) == 99);
+    TEST_ASSERT(stats_hist_percentile(&hist, 100) == 100);
+    TEST_ASSERT(stats_hist_percentile(&hist, 200) == 100);
+
+    /* Walking the section brings the summary up to date. */
+    sum = 0;
+    rc = stats_walk(&hist.sh_hdr, stats_test_sum_walk, &sum);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(hist.sh_count == 100);
+    TEST_ASSERT(hist.sh_min == 1);
+    TEST_ASSERT(hist.sh_max == 100);
+    TEST_ASSERT(hist.sh_p50 == 50);
+    TEST_ASSERT(hist.sh_p90 == 90);
+    TEST_ASSERT(hist.sh_p99 == 99);
+    TEST_ASSERT(sum == 100 + 1 + 100 + 50 + 90 + 99);
+
+    stats_reset(&hist.sh_hdr);
+    TEST_ASSERT(stats_hist_percentile(&hist, 100) == 0);
+    rc = stats_walk(&hist.sh_hdr, stats_test_sum_walk, &sum);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(hist.sh_count == 0);
+    TEST_ASSERT(hist.sh_max == 0);
+
+    /*** Above 2^sub_bits, four buckets per power of two. */
+    rc = stats_hist_init(&hist, buckets, STATS_HIST_BUCKET_CNT(2, 8), 2);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* 8 and 9 share a bucket; its upper bound is capped by the largest
+     * sample.
+     */
+    stats_hist_record(&hist, 8);
+    TEST_ASSERT(stats_hist_percentile(&hist, 50) == 8);
+    stats_hist_record(&hist, 9);
+    TEST_ASSERT(stats_hist_percentile(&hist, 50) == 9);
+    TEST_ASSERT(stats_hist_percentile(&hist, 100) == 9);
+
+    /* 96..111 share a bucket. */
+    stats_hist_reset(&hist);
+    stats_hist_record(&hist, 100);
+    stats_hist_record(&hist, 200);
+    TEST_ASSERT(stats_hist_percentile(&hist, 50) == 111);
+    TEST_ASSERT(stats_hist_percentile(&hist, 100) == 200);
+
+    /* The last bucket reports the largest sample. */
+    stats_hist_reset(&hist);
+    stats_hist_record(&hist, 101);
+    stats_hist_record(&hist, 255);
+    TEST_ASSERT(stats_hist_percentile(&hist, 50) == 111);
+    TEST_ASSERT(stats_hist_percentile(&hist, 100) == 255);
+
+    /*** Values past the last bucket are counted in it. */
+    rc = stats_hist_init(&hist, buckets, 8, 2);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    stats_hist_record(&hist, 2);
+    stats_hist_record(&hist, 1000);
+    stats_hist_record(&hist, 70000);
+    TEST_ASSERT(stats_hist_percentile(&hist, 30) == 2);
+    TEST_ASSERT(stats_hist_percentile(&hist, 50) == 70000);
+    TEST_ASSERT(stats_hist_percentile(&hist, 100) == 70000);
+
+    /*** A plain section is never taken for a histogram, whatever its
+     * memory held before initialization.
+     */
+    memset(&plain, 0xff, sizeof(plain));
+    rc = stats_init(STATS_HDR(plain),
+                    STATS_SIZE_INIT_PARMS(plain, STATS_SIZE_32),
+                    NULL, 0);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(plain.s_hdr.s_flags == 0);
+
+    STATS_INCN(plain, a, 3);
+    STATS_INCN(plain, b, 4);
+
+    sum = 0;
+    rc = stats_walk(STATS_HDR(plain), stats_test_sum_walk, &sum);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(sum == 7);
+}
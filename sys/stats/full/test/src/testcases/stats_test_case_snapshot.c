@@ -0,0 +1,211 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "stats_test.h"
+
+#if MYNEWT_VAL(STATS_SNAPSHOT)
+
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_buf_reader.h"
+#include "tinycbor/cbor_buf_writer.h"
+
+STATS_SECT_START(stats_test_snap)
+    STATS_SECT_ENTRY(a)
+    STATS_SECT_ENTRY(b)
+STATS_SECT_END
+
+STATS_NAME_START(stats_test_snap)
+    STATS_NAME(stats_test_snap, a)
+    STATS_NAME(stats_test_snap, b)
+STATS_NAME_END(stats_test_snap)
+
+STATS_SECT_START(stats_test_snap64)
+    STATS_SECT_ENTRY64(c)
+STATS_SECT_END
+
+STATS_NAME_START(stats_test_snap64)
+    STATS_NAME(stats_test_snap64, c)
+STATS_NAME_END(stats_test_snap64)
+
+static STATS_SECT_DECL(stats_test_snap) stats_test_snap;
+static STATS_SECT_DECL(stats_test_snap64) stats_test_snap64;
+
+static uintptr_t stats_test_snap_buf[2][64];
+
+/* Records the reported entries of the two test groups in *arg: bit 0 for a,
+ * 1 for b, 2 for c.  Other groups are ignored.
+ */
+static int
+stats_test_snap_walk(struct stats_hdr *hdr, void *arg, char *name,
+                     uint16_t off)
+{
+    int *seen;
+
+    seen = arg;
+    if (hdr == STATS_HDR(stats_test_snap)) {
+        *seen |= 1 << ((off - sizeof(*hdr)) / sizeof(uint32_t));
+    } else if (hdr == STATS_HDR(stats_test_snap64)) {
+        *seen |= 1 << 2;
+    }
+
+    return 0;
+}
+
+static int
+stats_test_snap_delta(const struct stats_snapshot *prev)
+{
+    int seen;
+    int rc;
+
+    seen = 0;
+    rc = stats_snapshot_delta(prev, stats_test_snap_walk, &seen);
+    TEST_ASSERT(rc == 0);
+
+    return seen;
+}
+
+TEST_CASE(stats_test_case_snapshot)
+{
+    struct stats_snapshot prev;
+    struct stats_snapshot cur;
+    struct cbor_buf_writer writer;
+    struct cbor_buf_reader reader;
+    struct stats_snapshot small;
+    CborEncoder enc;
+    CborEncoder groups;
+    CborParser parser;
+    CborValue map;
+    CborValue grp;
+    CborValue val;
+    uint8_t cbor_buf[256];
+    uint64_t u64;
+    int rc;
+
+    rc = stats_init_and_reg(STATS_HDR(stats_test_snap),
+                            STATS_SIZE_INIT_PARMS(stats_test_snap,
+                                                  STATS_SIZE_32),
+                            STATS_NAME_INIT_PARMS(stats_test_snap),
+                            "snap32");
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = stats_init_and_reg(STATS_HDR(stats_test_snap64),
+                            STATS_SIZE_INIT_PARMS(stats_test_snap64,
+                                                  STATS_SIZE_64),
+                            STATS_NAME_INIT_PARMS(stats_test_snap64),
+                            "snap64");
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** A buffer which can't hold every group leaves the snapshot empty. */
+    stats_snapshot_init(&small, stats_test_snap_buf[0], 8);
+    rc = stats_snapshot_take(&small);
+    TEST_ASSERT(rc == SYS_ENOMEM);
+    TEST_ASSERT(small.ss_len == 0);
+    TEST_ASSERT(small.ss_gen == 0);
+
+    /*** Deltas only report the statistics which changed. */
+    stats_snapshot_init(&prev, stats_test_snap_buf[0],
+                        sizeof(stats_test_snap_buf[0]));
+    stats_snapshot_init(&cur, stats_test_snap_buf[1],
+                        sizeof(stats_test_snap_buf[1]));
+
+    rc = stats_snapshot_take(&prev);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(prev.ss_gen != 0);
+
+    TEST_ASSERT(stats_test_snap_delta(&prev) == 0);
+    TEST_ASSERT(stats_test_snap_delta(NULL) == 0x7);
+    TEST_ASSERT(stats_test_snap_delta(&small) == 0x7);
+
+    STATS_INC(stats_test_snap, b);
+    TEST_ASSERT(stats_test_snap_delta(&prev) == 0x2);
+
+    STATS_INCN(stats_test_snap64, c, 1ULL << 40);
+    TEST_ASSERT(stats_test_snap_delta(&prev) == 0x6);
+
+    /*** Encoding reports the values stored in the snapshot, not updates
+     * made after it was taken; those show up against it next time.
+     */
+    rc = stats_snapshot_take(&cur);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(cur.ss_gen != prev.ss_gen);
+
+    STATS_INC(stats_test_snap, a);
+    STATS_INC(stats_test_snap, b);
+
+    cbor_buf_writer_init(&writer, cbor_buf, sizeof(cbor_buf));
+    cbor_encoder_init(&enc, &writer.enc, 0);
+    rc = cbor_encoder_create_map(&enc, &groups, CborIndefiniteLength);
+    TEST_ASSERT(rc == 0);
+    rc = stats_snapshot_encode(&groups, &cur, &prev);
+    TEST_ASSERT(rc == 0);
+    rc = cbor_encoder_close_container(&enc, &groups);
+    TEST_ASSERT(rc == 0);
+
+    cbor_buf_reader_init(&reader, cbor_buf,
+                         cbor_buf_writer_buffer_size(&writer, cbor_buf));
+    rc = cbor_parser_init(&reader.r, 0, &parser, &map);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = cbor_value_map_find_value(&map, "snap32", &grp);
+    TEST_ASSERT_FATAL(rc == 0 && cbor_value_is_map(&grp));
+    rc = cbor_value_map_find_value(&grp, "b", &val);
+    TEST_ASSERT(rc == 0);
+    rc = cbor_value_get_uint64(&val, &u64);
+    TEST_ASSERT(rc == 0 && u64 == 1);
+    rc = cbor_value_map_find_value(&grp, "a", &val);
+    TEST_ASSERT(rc == 0 && !cbor_value_is_valid(&val));
+
+    rc = cbor_value_map_find_value(&map, "snap64", &grp);
+    TEST_ASSERT_FATAL(rc == 0 && cbor_value_is_map(&grp));
+    rc = cbor_value_map_find_value(&grp, "c", &val);
+    TEST_ASSERT(rc == 0);
+    rc = cbor_value_get_uint64(&val, &u64);
+    TEST_ASSERT(rc == 0 && u64 == 1ULL << 40);
+
+    TEST_ASSERT(stats_test_snap_delta(&cur) == 0x3);
+
+    /*** Without a baseline, everything is encoded. */
+    cbor_buf_writer_init(&writer, cbor_buf, sizeof(cbor_buf));
+    cbor_encoder_init(&enc, &writer.enc, 0);
+    rc = cbor_encoder_create_map(&enc, &groups, CborIndefiniteLength);
+    TEST_ASSERT(rc == 0);
+    rc = stats_snapshot_encode(&groups, &cur, NULL);
+    TEST_ASSERT(rc == 0);
+    rc = cbor_encoder_close_container(&enc, &groups);
+    TEST_ASSERT(rc == 0);
+
+    cbor_buf_reader_init(&reader, cbor_buf,
+                         cbor_buf_writer_buffer_size(&writer, cbor_buf));
+    rc = cbor_parser_init(&reader.r, 0, &parser, &map);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = cbor_value_map_find_value(&map, "snap32", &grp);
+    TEST_ASSERT_FATAL(rc == 0 && cbor_value_is_map(&grp));
+    rc = cbor_value_map_find_value(&grp, "a", &val);
+    TEST_ASSERT(rc == 0);
+    rc = cbor_value_get_uint64(&val, &u64);
+    TEST_ASSERT(rc == 0 && u64 == 0);
+}
+
+#else
+
+TEST_CASE(stats_test_case_snapshot)
+{
+}
+
+#endif
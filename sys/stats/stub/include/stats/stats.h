@@ -35,7 +35,7 @@ struct stats_hdr {
     char *s_name;
     uint8_t s_size;
     uint8_t s_cnt;
-    uint16_t s_pad1;
+    uint16_t s_flags;
 #if MYNEWT_VAL(STATS_NAMES)
     const struct stats_name_map *s_map;
     int s_map_cnt;
@@ -76,6 +76,18 @@ struct stats_hdr {
 #define stats_init_and_reg(...) 0
 #define stats_reset(shdr)
 
+struct stats_hist {
+    struct stats_hdr sh_hdr;
+};
+
+#define STATS_HIST_BUCKET_CNT(__sub_bits, __max_bits) 1
+
+#define stats_hist_init(...) 0
+#define stats_hist_init_and_reg(...) 0
+#define stats_hist_record(hist, val)
+#define stats_hist_percentile(hist, pct) 0
+#define stats_hist_reset(hist)
+
 #ifdef __cplusplus
 }
 #endif
@@ -38,6 +38,13 @@ struct cbmem {
     uint8_t *c_buf;
     uint8_t *c_buf_end;
     uint8_t *c_buf_cur_end;
+
+    /* Incremented each time the write position wraps to the buffer start
+     * (and on flush); entries written in one pass share a generation.
+     */
+    uint32_t c_gen;
+    /* Generation of the entry at c_entry_start. */
+    uint32_t c_start_gen;
 };
 
 struct cbmem_iter {
@@ -67,6 +74,29 @@ struct cbmem_scat_gath {
     int count;
 };
 
+/**
+ * An entry's data, in place in the cbmem buffer.  Entries are never split
+ * across the end of the buffer, so each entry is a single span.
+ */
+struct cbmem_span {
+    const uint8_t *cs_data;
+    uint16_t cs_len;
+};
+
+/**
+ * A reader's position in a cbmem.  Cursors are independent; any number of
+ * readers can stream the same cbmem, and no lock is held between calls.
+ * A cursor refers to the last entry it returned (see cbmem_cursor_next()).
+ */
+struct cbmem_cursor {
+    struct cbmem_entry_hdr *cc_hdr;
+    uint32_t cc_gen;
+    uint8_t cc_flags;
+
+    /* Number of times the reader fell behind and lost entries. */
+    uint32_t cc_overruns;
+};
+
 #define CBMEM_ENTRY_SIZE(__p) (sizeof(struct cbmem_entry_hdr) \
         + ((struct cbmem_entry_hdr *) (__p))->ceh_len)
 #define CBMEM_ENTRY_NEXT(__p) ((struct cbmem_entry_hdr *) \
@@ -93,6 +123,14 @@ int cbmem_append_scat_gath(struct cbmem *cbmem,
                            const struct cbmem_scat_gath *sg);
 
 void cbmem_iter_start(struct cbmem *cbmem, struct cbmem_iter *iter);
+
+/**
+ * @brief Starts an iteration at the specified entry rather than at the
+ * oldest one.  The entry must currently be present in the cbmem (see
+ * cbmem_entry_valid()).  Must be called with the cbmem lock held.
+ */
+void cbmem_iter_start_at(struct cbmem *cbmem, struct cbmem_iter *iter,
+                         struct cbmem_entry_hdr *hdr);
 struct cbmem_entry_hdr *cbmem_iter_next(struct cbmem *cbmem, 
         struct cbmem_iter *iter);
 int cbmem_read(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr, void *buf, 
@@ -103,6 +141,78 @@ int cbmem_walk(struct cbmem *cbmem, cbmem_walk_func_t walk_func, void *arg);
 
 int cbmem_flush(struct cbmem *);
 
+/**
+ * @brief Retrieves the generation of an entry currently held in the cbmem.
+ * A (pointer, generation) pair identifies an entry across later appends; see
+ * cbmem_entry_valid().  Must be called with the cbmem lock held.
+ */
+uint32_t cbmem_entry_gen(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr);
+
+/**
+ * @brief Indicates whether an entry previously seen at the given generation
+ * is still held in the cbmem, i.e., has not been overwritten or flushed.
+ * Must be called with the cbmem lock held.
+ *
+ * @return                      1 if the entry is still present; 0 otherwise.
+ */
+int cbmem_entry_valid(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr,
+                      uint32_t gen);
+
+/**
+ * @brief Initializes a cursor; the first call to cbmem_cursor_next() returns
+ * the oldest entry.
+ */
+void cbmem_cursor_init(struct cbmem_cursor *cur);
+
+/**
+ * @brief Initializes a cursor such that the first call to cbmem_cursor_next()
+ * returns the specified entry, identified by its generation (see
+ * cbmem_entry_gen()).  If the entry has been overwritten by then, the cursor
+ * starts at the oldest entry instead.
+ */
+void cbmem_cursor_init_at(struct cbmem_cursor *cur,
+                          struct cbmem_entry_hdr *hdr, uint32_t gen);
+
+/**
+ * @brief Advances a cursor to the next entry and exposes its data in place.
+ *
+ * The cbmem lock is only held for the duration of the call, so writers can
+ * overwrite the span while the caller uses it.  Use cbmem_cursor_valid()
+ * after consuming the span, or cbmem_cursor_read() to copy it out, to
+ * detect this.  If the cursor's entry was overwritten since the previous
+ * call, cc_overruns is incremented and the cursor continues at the oldest
+ * entry.
+ *
+ * @param cbmem                 The cbmem to read.
+ * @param cur                   The reader's cursor.
+ * @param span                  On success, describes the entry's data.
+ *
+ * @return                      0 on success; SYS_ENOENT if the cursor is at
+ *                                  the newest entry.
+ */
+int cbmem_cursor_next(struct cbmem *cbmem, struct cbmem_cursor *cur,
+                      struct cbmem_span *span);
+
+/**
+ * @brief Indicates whether the cursor's current entry is still intact, i.e.,
+ * whether data obtained from its span can be trusted.
+ *
+ * @return                      1 if the entry is intact; 0 otherwise.
+ */
+int cbmem_cursor_valid(struct cbmem *cbmem, const struct cbmem_cursor *cur);
+
+/**
+ * @brief Copies data out of the cursor's current entry, provided it has not
+ * been overwritten.
+ *
+ * @return                      The number of bytes read; -1 on failure.
+ */
+int cbmem_cursor_read(struct cbmem *cbmem, const struct cbmem_cursor *cur,
+                      void *buf, uint16_t off, uint16_t len);
+int cbmem_cursor_read_mbuf(struct cbmem *cbmem,
+                           const struct cbmem_cursor *cur,
+                           struct os_mbuf *om, uint16_t off, uint16_t len);
+
 #ifdef __cplusplus
 }
 #endif
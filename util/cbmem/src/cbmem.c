@@ -102,8 +102,10 @@ cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
         cbmem->c_buf_cur_end = (uint8_t *) dst;
         dst = (struct cbmem_entry_hdr *) cbmem->c_buf;
         end = (uint8_t *) dst + len + sizeof(*dst);
+        cbmem->c_gen++;
         if ((uint8_t *) cbmem->c_entry_start >= cbmem->c_buf_cur_end) {
             cbmem->c_entry_start = (struct cbmem_entry_hdr *) cbmem->c_buf;
+            cbmem->c_start_gen = cbmem->c_gen - 1;
         }
     }
 
@@ -118,6 +120,7 @@ cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
             start = (uint8_t *) CBMEM_ENTRY_NEXT(start);
             if (start == cbmem->c_buf_cur_end) {
                 start = cbmem->c_buf;
+                cbmem->c_start_gen = cbmem->c_gen;
                 break;
             }
         }
@@ -132,6 +135,7 @@ cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
     cbmem->c_entry_end = dst;
     if (!cbmem->c_entry_start) {
         cbmem->c_entry_start = dst;
+        cbmem->c_start_gen = cbmem->c_gen;
     }
 
     rc = cbmem_lock_release(cbmem);
@@ -231,6 +235,15 @@ cbmem_iter_start(struct cbmem *cbmem, struct cbmem_iter *iter)
     iter->ci_end = cbmem->c_entry_end;
 }
 
+void
+cbmem_iter_start_at(struct cbmem *cbmem, struct cbmem_iter *iter,
+                    struct cbmem_entry_hdr *hdr)
+{
+    iter->ci_start = hdr;
+    iter->ci_cur = hdr;
+    iter->ci_end = cbmem->c_entry_end;
+}
+
 struct cbmem_entry_hdr *
 cbmem_iter_next(struct cbmem *cbmem, struct cbmem_iter *iter)
 {
@@ -275,6 +288,10 @@ cbmem_flush(struct cbmem *cbmem)
     cbmem->c_entry_end = NULL;
     cbmem->c_buf_cur_end = NULL;
 
+    /* Invalidate all outstanding (entry, generation) pairs. */
+    cbmem->c_gen++;
+    cbmem->c_start_gen = cbmem->c_gen;
+
     rc = cbmem_lock_release(cbmem);
     if (rc != 0) {
         goto err;
@@ -285,6 +302,41 @@ err:
     return (rc);
 }
 
+uint32_t
+cbmem_entry_gen(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr)
+{
+    /* Entries between the buffer start and the newest entry belong to the
+     * current pass; anything after the newest entry is left over from the
+     * previous one.
+     */
+    if (hdr <= cbmem->c_entry_end) {
+        return cbmem->c_gen;
+    } else {
+        return cbmem->c_gen - 1;
+    }
+}
+
+int
+cbmem_entry_valid(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr,
+                  uint32_t gen)
+{
+    int32_t diff;
+
+    if (cbmem->c_entry_start == NULL) {
+        return 0;
+    }
+
+    diff = (int32_t)(gen - cbmem->c_start_gen);
+    if (diff < 0 || (int32_t)(cbmem->c_gen - gen) < 0) {
+        return 0;
+    }
+    if (diff == 0 && hdr < cbmem->c_entry_start) {
+        return 0;
+    }
+
+    return 1;
+}
+
 int
 cbmem_read(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr, void *buf,
         uint16_t off, uint16_t len)
@@ -392,3 +444,162 @@ cbmem_walk(struct cbmem *cbmem, cbmem_walk_func_t walk_func, void *arg)
 err:
     return (rc);
 }
+
+/* The cursor's entry has not been returned yet. */
+#define CBMEM_CURSOR_F_AT   0x01
+
+void
+cbmem_cursor_init(struct cbmem_cursor *cur)
+{
+    memset(cur, 0, sizeof(*cur));
+}
+
+void
+cbmem_cursor_init_at(struct cbmem_cursor *cur, struct cbmem_entry_hdr *hdr,
+                     uint32_t gen)
+{
+    cur->cc_hdr = hdr;
+    cur->cc_gen = gen;
+    cur->cc_flags = CBMEM_CURSOR_F_AT;
+    cur->cc_overruns = 0;
+}
+
+/**
+ * Retrieves the entry following a valid entry; NULL if it is the newest.  Must
+ * be called with the cbmem lock held.
+ */
+static struct cbmem_entry_hdr *
+cbmem_entry_next(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr)
+{
+    struct cbmem_entry_hdr *next;
+
+    if (hdr == cbmem->c_entry_end) {
+        return NULL;
+    }
+
+    next = CBMEM_ENTRY_NEXT(hdr);
+    if (hdr > cbmem->c_entry_end &&
+        (uint8_t *) next >= cbmem->c_buf_cur_end) {
+        next = (struct cbmem_entry_hdr *) cbmem->c_buf;
+    }
+
+    return next;
+}
+
+int
+cbmem_cursor_next(struct cbmem *cbmem, struct cbmem_cursor *cur,
+                  struct cbmem_span *span)
+{
+    struct cbmem_entry_hdr *hdr;
+    int rc;
+
+    rc = cbmem_lock_acquire(cbmem);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (cur->cc_hdr != NULL &&
+        !cbmem_entry_valid(cbmem, cur->cc_hdr, cur->cc_gen)) {
+        /* Overwritten or flushed; continue with the oldest entry left. */
+        cur->cc_overruns++;
+        cur->cc_hdr = NULL;
+        cur->cc_flags = 0;
+    }
+
+    if (cur->cc_hdr == NULL) {
+        hdr = cbmem->c_entry_start;
+    } else if (cur->cc_flags & CBMEM_CURSOR_F_AT) {
+        hdr = cur->cc_hdr;
+    } else {
+        hdr = cbmem_entry_next(cbmem, cur->cc_hdr);
+    }
+
+    if (hdr == NULL) {
+        cbmem_lock_release(cbmem);
+        return SYS_ENOENT;
+    }
+
+    cur->cc_hdr = hdr;
+    cur->cc_gen = cbmem_entry_gen(cbmem, hdr);
+    cur->cc_flags = 0;
+
+    span->cs_data = (uint8_t *) hdr + sizeof(*hdr);
+    span->cs_len = hdr->ceh_len;
+
+    return cbmem_lock_release(cbmem);
+}
+
+int
+cbmem_cursor_valid(struct cbmem *cbmem, const struct cbmem_cursor *cur)
+{
+    int valid;
+
+    if (cur->cc_hdr == NULL || cbmem_lock_acquire(cbmem) != 0) {
+        return 0;
+    }
+
+    valid = cbmem_entry_valid(cbmem, cur->cc_hdr, cur->cc_gen);
+
+    cbmem_lock_release(cbmem);
+
+    return valid;
+}
+
+int
+cbmem_cursor_read(struct cbmem *cbmem, const struct cbmem_cursor *cur,
+                  void *buf, uint16_t off, uint16_t len)
+{
+    int rc;
+
+    if (cur->cc_hdr == NULL || cbmem_lock_acquire(cbmem) != 0) {
+        return -1;
+    }
+
+    if (!cbmem_entry_valid(cbmem, cur->cc_hdr, cur->cc_gen) ||
+        off > cur->cc_hdr->ceh_len) {
+        rc = -1;
+    } else {
+        if (off + len > cur->cc_hdr->ceh_len) {
+            len = cur->cc_hdr->ceh_len - off;
+        }
+        memcpy(buf, (uint8_t *) cur->cc_hdr + sizeof(*cur->cc_hdr) + off,
+               len);
+        rc = len;
+    }
+
+    cbmem_lock_release(cbmem);
+
+    return rc;
+}
+
+int
+cbmem_cursor_read_mbuf(struct cbmem *cbmem, const struct cbmem_cursor *cur,
+                       struct os_mbuf *om, uint16_t off, uint16_t len)
+{
+    int rc;
+
+    if (cur->cc_hdr == NULL || cbmem_lock_acquire(cbmem) != 0) {
+        return -1;
+    }
+
+    if (!cbmem_entry_valid(cbmem, cur->cc_hdr, cur->cc_gen) ||
+        off > cur->cc_hdr->ceh_len) {
+        rc = -1;
+    } else {
+        if (off + len > cur->cc_hdr->ceh_len) {
+            len = cur->cc_hdr->ceh_len - off;
+        }
+        rc = os_mbuf_append(om,
+                            (uint8_t *) cur->cc_hdr + sizeof(*cur->cc_hdr) +
+                            off, len);
+        if (rc == 0) {
+            rc = len;
+        } else {
+            rc = -1;
+        }
+    }
+
+    cbmem_lock_release(cbmem);
+
+    return rc;
+}
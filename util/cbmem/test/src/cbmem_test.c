@@ -84,12 +84,16 @@ cbmem_test_case_1_walk(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr,
 TEST_CASE_DECL(cbmem_test_case_1)
 TEST_CASE_DECL(cbmem_test_case_2)
 TEST_CASE_DECL(cbmem_test_case_3)
+TEST_CASE_DECL(cbmem_test_case_4)
+TEST_CASE_DECL(cbmem_test_case_5)
 
 TEST_SUITE(cbmem_test_suite)
 {
     cbmem_test_case_1();
     cbmem_test_case_2();
     cbmem_test_case_3();
+    cbmem_test_case_4();
+    cbmem_test_case_5();
 }
 
 #if MYNEWT_VAL(SELFTEST)
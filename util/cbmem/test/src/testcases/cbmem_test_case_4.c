@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "cbmem_test.h"
+
+#define CBMEM_TEST_GEN_ENTRY_SIZE   12
+
+static void
+cbmem_test_gen_append(struct cbmem *cbmem, uint8_t val)
+{
+    uint8_t entry[CBMEM_TEST_GEN_ENTRY_SIZE];
+    int rc;
+
+    memset(entry, val, sizeof entry);
+    rc = cbmem_append(cbmem, entry, sizeof entry);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+TEST_CASE(cbmem_test_case_4)
+{
+    struct cbmem_entry_hdr *hdrs[4];
+    struct cbmem_entry_hdr *hdr;
+    struct cbmem_iter iter;
+    struct cbmem cbmem;
+    uint8_t buf[4 * (CBMEM_TEST_GEN_ENTRY_SIZE +
+                     sizeof(struct cbmem_entry_hdr))];
+    uint32_t gen;
+    uint8_t val;
+    int rc;
+    int i;
+
+    cbmem_init(&cbmem, buf, sizeof buf);
+
+    /* Fill the buffer exactly; all entries share one generation. */
+    for (i = 0; i < 4; i++) {
+        cbmem_test_gen_append(&cbmem, i);
+        hdrs[i] = cbmem.c_entry_end;
+    }
+    gen = cbmem_entry_gen(&cbmem, hdrs[0]);
+    for (i = 0; i < 4; i++) {
+        TEST_ASSERT(cbmem_entry_gen(&cbmem, hdrs[i]) == gen);
+        TEST_ASSERT(cbmem_entry_valid(&cbmem, hdrs[i], gen));
+    }
+
+    /* Iterate from the middle of the buffer. */
+    val = 0;
+    cbmem_iter_start_at(&cbmem, &iter, hdrs[2]);
+    for (i = 2; ; i++) {
+        hdr = cbmem_iter_next(&cbmem, &iter);
+        if (hdr == NULL) {
+            break;
+        }
+        rc = cbmem_read(&cbmem, hdr, &val, 0, sizeof val);
+        TEST_ASSERT_FATAL(rc == 1);
+        TEST_ASSERT(val == i);
+    }
+    TEST_ASSERT(i == 4);
+
+    /* Wrapping overwrites the oldest entry only. */
+    cbmem_test_gen_append(&cbmem, 4);
+    TEST_ASSERT(cbmem_entry_gen(&cbmem, cbmem.c_entry_end) == gen + 1);
+    TEST_ASSERT(!cbmem_entry_valid(&cbmem, hdrs[0], gen));
+    for (i = 1; i < 4; i++) {
+        TEST_ASSERT(cbmem_entry_valid(&cbmem, hdrs[i], gen));
+        TEST_ASSERT(cbmem_entry_gen(&cbmem, hdrs[i]) == gen);
+    }
+
+    /* Iteration from a leftover entry wraps to the buffer start. */
+    cbmem_iter_start_at(&cbmem, &iter, hdrs[3]);
+    hdr = cbmem_iter_next(&cbmem, &iter);
+    TEST_ASSERT(hdr == hdrs[3]);
+    hdr = cbmem_iter_next(&cbmem, &iter);
+    TEST_ASSERT(hdr == cbmem.c_entry_end);
+    TEST_ASSERT(cbmem_iter_next(&cbmem, &iter) == NULL);
+
+    /* Flushing invalidates everything. */
+    cbmem_flush(&cbmem);
+    for (i = 1; i < 4; i++) {
+        TEST_ASSERT(!cbmem_entry_valid(&cbmem, hdrs[i], gen));
+    }
+    cbmem_test_gen_append(&cbmem, 5);
+    TEST_ASSERT(!cbmem_entry_valid(&cbmem, hdrs[1], gen));
+    TEST_ASSERT(cbmem_entry_valid(&cbmem, cbmem.c_entry_end,
+                cbmem_entry_gen(&cbmem, cbmem.c_entry_end)));
+}
@@ -0,0 +1,119 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "cbmem_test.h"
+
+#define CBMEM_TEST_CUR_ENTRY_SIZE   12
+
+static void
+cbmem_test_cur_append(struct cbmem *cbmem, uint8_t val)
+{
+    uint8_t entry[CBMEM_TEST_CUR_ENTRY_SIZE];
+    int rc;
+
+    memset(entry, val, sizeof entry);
+    rc = cbmem_append(cbmem, entry, sizeof entry);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+static void
+cbmem_test_cur_expect(struct cbmem *cbmem, struct cbmem_cursor *cur,
+                      uint8_t val)
+{
+    struct cbmem_span span;
+    uint8_t buf[CBMEM_TEST_CUR_ENTRY_SIZE];
+    int rc;
+
+    rc = cbmem_cursor_next(cbmem, cur, &span);
+    TEST_ASSERT_FATAL(rc == 0, "no entry; expected %d", val);
+    TEST_ASSERT_FATAL(span.cs_len == CBMEM_TEST_CUR_ENTRY_SIZE);
+
+    /* The span points into the buffer itself. */
+    TEST_ASSERT(span.cs_data >= cbmem->c_buf &&
+                span.cs_data + span.cs_len <= cbmem->c_buf_end);
+    TEST_ASSERT(span.cs_data[0] == val);
+    TEST_ASSERT(span.cs_data[span.cs_len - 1] == val);
+    TEST_ASSERT(cbmem_cursor_valid(cbmem, cur));
+
+    rc = cbmem_cursor_read(cbmem, cur, buf, 1, sizeof buf);
+    TEST_ASSERT(rc == sizeof buf - 1);
+    TEST_ASSERT(buf[0] == val);
+}
+
+TEST_CASE(cbmem_test_case_5)
+{
+    struct cbmem_cursor cur1;
+    struct cbmem_cursor cur2;
+    struct cbmem_span span;
+    struct cbmem cbmem;
+    uint8_t buf[4 * (CBMEM_TEST_CUR_ENTRY_SIZE +
+                     sizeof(struct cbmem_entry_hdr))];
+    uint8_t val;
+    int i;
+
+    cbmem_init(&cbmem, buf, sizeof buf);
+
+    /* Empty cbmem. */
+    cbmem_cursor_init(&cur1);
+    TEST_ASSERT(cbmem_cursor_next(&cbmem, &cur1, &span) == SYS_ENOENT);
+    TEST_ASSERT(!cbmem_cursor_valid(&cbmem, &cur1));
+
+    for (i = 0; i < 3; i++) {
+        cbmem_test_cur_append(&cbmem, i);
+    }
+
+    /* Two independent readers. */
+    cbmem_cursor_init(&cur2);
+    cbmem_test_cur_expect(&cbmem, &cur1, 0);
+    cbmem_test_cur_expect(&cbmem, &cur2, 0);
+    cbmem_test_cur_expect(&cbmem, &cur2, 1);
+    cbmem_test_cur_expect(&cbmem, &cur2, 2);
+    TEST_ASSERT(cbmem_cursor_next(&cbmem, &cur2, &span) == SYS_ENOENT);
+
+    /* A reader at the newest entry picks up new entries, across the wrap. */
+    cbmem_test_cur_append(&cbmem, 3);
+    cbmem_test_cur_append(&cbmem, 4);
+    cbmem_test_cur_expect(&cbmem, &cur2, 3);
+    cbmem_test_cur_expect(&cbmem, &cur2, 4);
+    TEST_ASSERT(cbmem_cursor_next(&cbmem, &cur2, &span) == SYS_ENOENT);
+    TEST_ASSERT(cur2.cc_overruns == 0);
+
+    /* Entry 0, held by the slow reader, was overwritten.  It detects this and
+     * continues at the oldest entry.
+     */
+    TEST_ASSERT(!cbmem_cursor_valid(&cbmem, &cur1));
+    TEST_ASSERT(cbmem_cursor_read(&cbmem, &cur1, &val, 0, 1) == -1);
+    cbmem_test_cur_expect(&cbmem, &cur1, 1);
+    TEST_ASSERT(cur1.cc_overruns == 1);
+    for (i = 2; i <= 4; i++) {
+        cbmem_test_cur_expect(&cbmem, &cur1, i);
+    }
+    TEST_ASSERT(cbmem_cursor_next(&cbmem, &cur1, &span) == SYS_ENOENT);
+
+    /* Resume at a remembered entry. */
+    cbmem_cursor_init_at(&cur2, cbmem.c_entry_end,
+                         cbmem_entry_gen(&cbmem, cbmem.c_entry_end));
+    cbmem_test_cur_expect(&cbmem, &cur2, 4);
+
+    /* Flushing invalidates all readers. */
+    cbmem_flush(&cbmem);
+    TEST_ASSERT(!cbmem_cursor_valid(&cbmem, &cur1));
+    cbmem_test_cur_append(&cbmem, 5);
+    cbmem_test_cur_expect(&cbmem, &cur1, 5);
+    TEST_ASSERT(cur1.cc_overruns == 2);
+}